@@ -0,0 +1,158 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_ASYNCLOGBACKEND_H
+#define STREAMGATE_ASYNCLOGBACKEND_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Logger.h"
+
+/**
+ * @brief 异步日志后端
+ * * 职责：
+ * 1. 调用线程（I/O 线程 / ThreadPool worker）只把定长记录拷进本线程的 SPSC 环形缓冲区，不格式化、不加锁、不做系统调用。
+ * 2. 后台线程批量收集所有线程的记录，按时间戳归并后格式化，并通过 writev 一次性写出。
+ * 3. 缓冲区写满时按 LogOverflowPolicy 丢弃（计数）或自旋等待后台线程腾出空间。
+ * * 超过 kTextCapacity 的消息会被截断并标注 [truncated]；file 只保存指针，要求是 __FILE__ 这类静态字符串。
+ */
+class AsyncLogBackend
+{
+public:
+    static constexpr size_t kRecordSize = 512;
+    static constexpr size_t kTextCapacity = kRecordSize - 32;
+
+    struct Config
+    {
+        size_t ring_capacity = 1024; // 每个线程的记录数，向上取整为 2 的幂（每条 kRecordSize 字节）
+        LogOverflowPolicy overflow_policy = LogOverflowPolicy::Drop;
+        std::chrono::milliseconds flush_interval{10}; // 空闲时后台线程的轮询间隔
+        bool to_console = true;
+        std::string file_path; // 为空则不写文件
+        bool include_milliseconds = true;
+    };
+
+    explicit AsyncLogBackend(const Config& config);
+    ~AsyncLogBackend();
+
+    AsyncLogBackend(const AsyncLogBackend&) = delete;
+    AsyncLogBackend& operator=(const AsyncLogBackend&) = delete;
+
+    /**
+     * @brief 写入当前线程的环形缓冲区
+     * @return false 表示后端已停止，调用方应退回同步输出；按策略丢弃的记录仍返回 true
+     */
+    bool enqueue(LogLevel level, std::string_view message, const char* file, int line);
+
+    /**
+     * @brief 阻塞直到调用前已入队的记录全部写出
+     */
+    void flush();
+
+    /**
+     * @brief 停止后台线程并写出剩余记录；可重复调用
+     */
+    void stop();
+
+    [[nodiscard]] LogAsyncStats getStats() const;
+
+private:
+    struct Record
+    {
+        int64_t timestamp_us;
+        const char* file;
+        int32_t line;
+        LogLevel level;
+        uint16_t length;
+        bool truncated;
+        char text[kTextCapacity];
+    };
+
+    static_assert(sizeof(Record) <= kRecordSize);
+
+    // 单生产者（所属线程）单消费者（后台线程）
+    struct ThreadRing
+    {
+        explicit ThreadRing(size_t capacity);
+
+        std::unique_ptr<Record[]> slots;
+        const size_t mask;
+
+        alignas(64) std::atomic<uint64_t> head{0}; // 消费者推进
+        alignas(64) std::atomic<uint64_t> tail{0}; // 生产者推进；同时是该线程累计入队数
+        uint64_t cached_head = 0; // 生产者本地缓存，减少对 head 缓存行的读取
+        std::atomic<bool> closed{false}; // 所属线程已退出，排空后即可回收
+    };
+
+    friend struct AsyncLogRingHandle;
+
+    ThreadRing* localRing();
+    bool waitForSpace(ThreadRing& ring, uint64_t tail);
+    bool settleAfterStop(ThreadRing& ring, uint64_t tail);
+
+    void run(const std::stop_token& stoken);
+    size_t drainOnce();
+    void writeBatch();
+    void appendFormatted(const Record& record);
+    void refreshRings();
+    void wake();
+
+    const uint64_t _id; // 进程内唯一，线程局部句柄据此判断是否已在本后端注册
+    const size_t _ringCapacity;
+    const LogOverflowPolicy _overflowPolicy;
+    const std::chrono::milliseconds _flushInterval;
+    const bool _toConsole;
+    const bool _includeMs;
+    int _fileFd = -1;
+
+    // 环注册表：生产者首次写日志时注册，后台线程按版本号刷新本地副本
+    mutable std::mutex _ringsMutex;
+    std::vector<std::shared_ptr<ThreadRing>> _rings;
+    std::atomic<uint64_t> _ringsVersion{0};
+
+    // 以下成员只由后台线程（或 stop 之后的调用方）访问
+    std::vector<std::shared_ptr<ThreadRing>> _drainRings;
+    uint64_t _drainVersion = ~uint64_t{0};
+    std::vector<const Record*> _batch;
+    std::vector<uint64_t> _snapshots; // 本轮排空时各环的 tail 快照
+    std::string _plain; // 不带颜色的格式化结果，文件与控制台共享
+    struct Span
+    {
+        size_t offset; // 在 _plain 中的起始位置
+        size_t length;
+        LogLevel level; // 控制台着色用
+    };
+
+    std::vector<Span> _spans;
+    int64_t _cachedSecond = -1;
+    char _cachedPrefix[32]{};
+
+    std::mutex _wakeMutex;
+    std::condition_variable_any _wakeCondition;
+    std::condition_variable _flushCondition;
+    uint64_t _flushRequested = 0; // 受 _wakeMutex 保护
+    uint64_t _flushCompleted = 0; // 受 _wakeMutex 保护
+    std::atomic<bool> _wakePending{false}; // 去重：避免多个生产者反复 notify
+
+    std::atomic<bool> _running{false};
+    std::jthread _worker;
+    std::mutex _finalDrainMutex; // 串行化 stop() 的最后一轮排空与停止期间入队的生产者
+    bool _finalDrained = false; // 受 _finalDrainMutex 保护
+
+    uint64_t _retiredEnqueued = 0; // 受 _ringsMutex 保护：已回收线程环的累计入队数
+    std::atomic<uint64_t> _written{0};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<uint64_t> _truncated{0};
+    std::atomic<uint64_t> _blocked{0};
+    std::atomic<uint64_t> _writeErrors{0};
+};
+#endif //STREAMGATE_ASYNCLOGBACKEND_H
@@ -0,0 +1,127 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_AUTHL1CACHE_H
+#define STREAMGATE_AUTHL1CACHE_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "StreamAuthData.h"
+
+/**
+ * @brief 进程内 L1 鉴权缓存 (Segmented LRU + TTL + 字节预算)
+ * * 职责：
+ * 1. 挡在 Redis 之前，吸收 flash crowd 下对同一 stream_key/client_id 的重复鉴权。
+ * 2. 同时缓存正向结果与负向结果（对应 Redis 中的 __EMPTY__），负向条目同样遵守 TTL。
+ * 3. 按 key 哈希分片，每个分片独立加锁；容量按条目的估算字节数计费，而非条目个数。
+ * * 淘汰策略 (SLRU)：
+ * - 新条目进入 probation 段；在 probation 中再次命中则晋升到 protected 段。
+ * - protected 段超出配额时，其尾部降级回 probation 头部。
+ * - 需要腾空间时只从 probation 尾部淘汰，一次性扫描流量无法冲掉热点 key。
+ */
+class AuthL1Cache
+{
+public:
+    struct Config
+    {
+        size_t capacity_bytes = 16 * 1024 * 1024; // 总字节预算，平均分摊到各分片
+        size_t num_shards = 16;
+        double protected_ratio = 0.8; // protected 段占分片预算的比例
+    };
+
+    enum class Lookup
+    {
+        Miss, // 未命中或已过期
+        Hit, // 命中正向结果，数据写入 out
+        NegativeHit // 命中负缓存：已知不存在 / DB 短暂异常，out.authToken 为被拒绝的 Token
+    };
+
+    struct Stats
+    {
+        uint64_t hits;
+        uint64_t negative_hits;
+        uint64_t misses;
+        uint64_t evictions; // 因字节预算被淘汰
+        uint64_t expirations; // 因 TTL 过期被移除
+        size_t entries;
+        size_t bytes;
+        size_t capacity_bytes;
+    };
+
+    explicit AuthL1Cache(const Config& config);
+
+    AuthL1Cache(const AuthL1Cache&) = delete;
+    AuthL1Cache& operator=(const AuthL1Cache&) = delete;
+
+    Lookup get(const std::string& key, StreamAuthData& out);
+
+    void put(const std::string& key, const StreamAuthData& data, std::chrono::seconds ttl);
+
+    /**
+     * @brief 写入负缓存
+     * @param rejectedToken 被拒绝的 Token：调用方据此区分"同一 key 换了 Token 重试"，避免错误 Token 误伤合法请求
+     */
+    void putNegative(const std::string& key, const std::string& rejectedToken, std::chrono::seconds ttl);
+
+    void erase(const std::string& key);
+    void clear();
+
+    [[nodiscard]] Stats getStats() const;
+    void resetStats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        std::string key;
+        StreamAuthData data;
+        bool negative; // 负缓存条目只保存被拒绝的 authToken
+        Clock::time_point expires_at;
+        size_t charge;
+        bool is_protected;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        EntryList probation;
+        EntryList protected_;
+        // key 视图指向链表节点内的 Entry::key，节点地址在 splice 时保持不变
+        std::unordered_map<std::string_view, EntryList::iterator> index;
+        size_t probation_bytes = 0;
+        size_t protected_bytes = 0;
+    };
+
+    Shard& shardFor(std::string_view key) const;
+    void insert(const std::string& key, StreamAuthData data, bool negative, std::chrono::seconds ttl);
+
+    // 以下函数要求调用方已持有分片锁
+    void removeLocked(Shard& shard, EntryList::iterator it);
+    void promoteLocked(Shard& shard, EntryList::iterator it);
+    void evictLocked(Shard& shard);
+
+    static size_t estimateCharge(const std::string& key, const StreamAuthData& data);
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+    size_t _shardCapacity;
+    size_t _protectedCapacity;
+    size_t _capacityBytes;
+
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _negativeHits{0};
+    std::atomic<uint64_t> _misses{0};
+    std::atomic<uint64_t> _evictions{0};
+    std::atomic<uint64_t> _expirations{0};
+};
+#endif //STREAMGATE_AUTHL1CACHE_H
@@ -7,9 +7,12 @@
 #include <string>
 #include <future>
 #include <functional>
+#include <vector>
 #include "IAuthRepository.h"
 #include "ThreadPool.h"
 
+class HookTrace;
+
 /**
  * @brief 鉴权管理器 (AuthManager)
  * * [线程安全说明]:
@@ -62,7 +65,20 @@ public:
     using AuthCallback = std::function<void(int)>;
     void checkAuthAsync(const std::string& streamKey, const std::string& clientId, const std::string& token,
                         AuthCallback cb) const;
-    void checkAuthAsync(const AuthRequest& req, AuthCallback cb) const;
+
+    /**
+     * @brief 异步鉴权接口（结构化请求）
+     * @param trace 阶段计时上下文（可为空）：投递时复制一份，worker 只写副本；记录 QueueWait，
+     *        并在 worker 上通过 HookTrace::Scope 把副本暴露给仓储层与 cb（作用域覆盖 cb 的整个执行）
+     */
+    void checkAuthAsync(const AuthRequest& req, AuthCallback cb, HookTrace* trace = nullptr) const;
+
+    /**
+     * @brief 批量异步鉴权接口 (批量 Hook 接入 / 缓存预热)
+     * @param cb 回调函数，接收与 requests 顺序一致的 AuthError 错误码列表；整批只占用一个线程池任务
+     */
+    using AuthBatchCallback = std::function<void(const std::vector<int>&)>;
+    void checkAuthBatchAsync(std::vector<AuthRequest> requests, AuthBatchCallback cb) const;
 
     // 状态查询
     [[nodiscard]] bool isShutdown() const
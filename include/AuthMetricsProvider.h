@@ -0,0 +1,41 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_AUTHMETRICSPROVIDER_H
+#define STREAMGATE_AUTHMETRICSPROVIDER_H
+#include "IMetricsProvider.h"
+
+// 前向声明
+class HybridAuthRepository;
+
+/**
+ * @brief 鉴权仓储指标提供者
+ * 负责导出 L1 / Redis / DB 三级查询的命中情况与 DB 请求合并 (Single-Flight) 统计
+ */
+class AuthMetricsProvider final : public IMetricsProvider
+{
+public:
+    explicit AuthMetricsProvider(const HybridAuthRepository* repo = nullptr)
+        : _repo(repo)
+    {
+    }
+
+    ~AuthMetricsProvider() override = default;
+
+    REGISTER_METRICS_NAME("auth_metrics")
+
+    /**
+     * @brief 注入仓储实例
+     */
+    void setRepository(const HybridAuthRepository* repo) noexcept
+    {
+        _repo = repo;
+    }
+
+    void refresh() noexcept override;
+
+private:
+    const HybridAuthRepository* _repo; // 观察者指针，生命周期由 AuthManager 管理
+};
+#endif //STREAMGATE_AUTHMETRICSPROVIDER_H
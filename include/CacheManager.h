@@ -5,8 +5,10 @@
 #ifndef STREAMGATE_CACHEMANAGER_H
 #define STREAMGATE_CACHEMANAGER_H
 #include <sw/redis++/redis++.h>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include "StreamAuthData.h"
@@ -19,6 +21,55 @@ enum CacheResult
     CACHE_ERROR = -2
 };
 
+/**
+ * @brief 认证数据缓存读取结果（三态）
+ * * 外层 nullopt：未命中 / 解析失败 / Redis 故障 / 负缓存属于其它 Token，调用方应继续查询 DB
+ * * 内层 nullopt：命中同一 Token 的负缓存标记，已知不存在，不应再查询 DB
+ */
+using CachedAuthData = std::optional<std::optional<StreamAuthData>>;
+
+/**
+ * @brief 批量回写条目：data 为空时写入负缓存标记，标记中只记录 rejectedToken 的摘要
+ */
+struct AuthCacheEntry
+{
+    std::string key;
+    std::optional<StreamAuthData> data;
+    int ttl;
+    std::string rejectedToken;
+};
+
+/**
+ * @brief Lua 脚本句柄
+ * * 启动时通过 CacheManager::loadScript 执行 SCRIPT LOAD 并缓存 SHA1；执行时优先 EVALSHA，
+ * * Redis 重启 / SCRIPT FLUSH 导致 NOSCRIPT 时回退到 EVAL（EVAL 会顺带把脚本重新放回服务端缓存，SHA1 不变）。
+ * * 注意：sha 仅在启动阶段写入一次，之后只读，可跨线程共享。
+ */
+class RedisScript
+{
+public:
+    explicit RedisScript(std::string source)
+        : _source(std::move(source))
+    {
+    }
+
+    [[nodiscard]] const std::string& source() const
+    {
+        return _source;
+    }
+
+    [[nodiscard]] const std::string& sha() const
+    {
+        return _sha;
+    }
+
+private:
+    friend class CacheManager;
+
+    std::string _source;
+    std::string _sha; // 为空表示未能预加载，直接走 EVAL
+};
+
 class CacheManager
 {
 public:
@@ -34,18 +85,34 @@ public:
     [[nodiscard]] int getAuthResultByKey(const std::string& cacheKey) const;
     void setAuthResultByKey(const std::string& cacheKey, int result) const;
 
-    [[nodiscard]] std::optional<StreamAuthData> getAuthDataFromCache(const std::string& streamKey) const;
+    [[nodiscard]] CachedAuthData getAuthDataFromCache(const std::string& streamKey, const std::string& authToken) const;
     void setAuthDataToCache(const StreamAuthData& data, int ttl) const;
 
-    [[nodiscard]] std::optional<StreamAuthData> getAuthDataFromCacheByKey(const std::string& customKey) const;
+    [[nodiscard]] CachedAuthData getAuthDataFromCacheByKey(const std::string& customKey,
+                                                           const std::string& authToken) const;
     void setAuthDataToCacheByKey(const std::string& key, const StreamAuthData& data, int ttl) const;
-    void setEmptyAuthDataToCache(const std::string& key, int ttl) const;
+    // 负缓存只对 rejectedToken 生效：key 不含 Token，不能让一次错误 Token 把同一 stream/client 的合法请求一起拒掉
+    void setEmptyAuthDataToCache(const std::string& key, const std::string& rejectedToken, int ttl) const;
+
+    // 负缓存标记："__EMPTY__:" + Token 的 FNV-1a 摘要（不落明文）；不带摘要的旧标记不匹配任何 Token
+    [[nodiscard]] static std::string negativeAuthMarker(std::string_view rejectedToken);
+    [[nodiscard]] static bool isNegativeAuthMarkerFor(std::string_view value, std::string_view authToken);
+
+    // === 认证缓存批量接口（单次网络往返）===
+    // MGET：返回结果与 keys 顺序一致，每项语义同 CachedAuthData (未命中 / 负缓存 / 命中)；authTokens 与 keys 一一对应
+    [[nodiscard]] std::vector<CachedAuthData> getAuthDataBatchFromCacheByKeys(
+        const std::vector<std::string>& keys, const std::vector<std::string>& authTokens) const;
+    // Pipeline SETEX：全部命令一次性发送
+    [[nodiscard]] bool setAuthDataBatchToCacheByKeys(const std::vector<AuthCacheEntry>& entries) const;
 
     // === 高层语义封装（全部为 const，线程安全）===
     // Hash 操作
     [[nodiscard]] bool hashSet(const std::string& key,
                                const std::unordered_map<std::string, std::string>& fields) const;
     [[nodiscard]] std::unordered_map<std::string, std::string> hashGetAll(const std::string& key) const;
+    // HMGET：结果与 fields 顺序一致，字段不存在为 nullopt；key 不存在或故障时全部为 nullopt
+    [[nodiscard]] std::vector<std::optional<std::string>> hashMGet(const std::string& key,
+                                                                   const std::vector<std::string>& fields) const;
     [[nodiscard]] bool hashDel(const std::string& key, const std::string& field) const;
     [[nodiscard]] bool hashKeyDel(const std::string& key) const;
     [[nodiscard]] long long hashIncrBy(const std::string& key, const std::string& field, long long increment) const;
@@ -61,8 +128,28 @@ public:
     // ZSet 操作
     [[nodiscard]] bool zsetAdd(const std::string& key, double score, const std::string& member) const;
     [[nodiscard]] std::vector<std::string> zsetRangeByScore(const std::string& key, double min, double max) const;
+    // 带 LIMIT offset count 的分页版本；失败抛出 sw::redis::Error，由调用方决定本轮是否中止
+    [[nodiscard]] std::vector<std::string> zsetRangeByScore(const std::string& key, double min, double max,
+                                                            long long offset, long long count) const;
+    [[nodiscard]] size_t zsetCount(const std::string& key, double min, double max) const;
     [[nodiscard]] bool zsetRem(const std::string& key, const std::string& member) const;
 
+    // Lua 脚本
+    [[nodiscard]] bool loadScript(RedisScript& script) const; // SCRIPT LOAD，启动阶段调用
+    /**
+     * @brief 执行返回整数的脚本：EVALSHA -> (NOSCRIPT) -> EVAL
+     * @throws sw::redis::Error 其它 Redis 错误交由调用方处理（调用方决定是否回滚/重试）
+     */
+    [[nodiscard]] long long evalScriptInt(const RedisScript& script, const std::vector<std::string>& keys,
+                                          const std::vector<std::string>& args) const;
+    /**
+     * @brief 执行返回字符串数组的脚本，回退规则同 evalScriptInt
+     * @throws sw::redis::Error
+     */
+    [[nodiscard]] std::vector<std::string> evalScriptList(const RedisScript& script,
+                                                          const std::vector<std::string>& keys,
+                                                          const std::vector<std::string>& args) const;
+
     // 通用操作
     [[nodiscard]] bool keyExpire(const std::string& key, int seconds) const;
     [[nodiscard]] bool keyDel(const std::string& key) const;
@@ -76,6 +163,19 @@ public:
 
     [[nodiscard]] bool ping() const;
 
+    // === 键空间通知 ===
+    /**
+     * @brief 确保服务端开启过期事件通知（notify-keyspace-events 含 E 与 x），缺失时追加
+     * @return false 表示无法确认或修改（如托管 Redis 禁用了 CONFIG），调用方应退回轮询
+     */
+    [[nodiscard]] bool enableKeyspaceEvents() const;
+
+    /**
+     * @brief 创建独立连接的订阅者；socket_timeout 使 consume() 定期以 TimeoutError 返回，便于检查停止标志
+     * @throws sw::redis::Error 连接失败
+     */
+    [[nodiscard]] sw::redis::Subscriber createSubscriber(std::chrono::milliseconds socket_timeout) const;
+
     [[nodiscard]] bool isReady() const
     {
         return _io_running.load(std::memory_order_acquire);
@@ -101,6 +201,7 @@ private:
     ~CacheManager();
 
     std::unique_ptr<sw::redis::Redis> _redis;
+    sw::redis::ConnectionOptions _options; // 订阅连接沿用同一组连接参数
     int _cacheTTL = 300;
     std::atomic<bool> _io_running{false};
 
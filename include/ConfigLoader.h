@@ -6,11 +6,60 @@
 #define STREAMGATE_CONFIGLOADER_H
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <functional>
 #include <stdexcept>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <optional>
+#include <cstdint>
+
+/**
+ * @brief 不可变的类型化配置快照
+ * * load / reload / set 时整体构建后发布，发布后不再修改；读者持有 shared_ptr 期间内容不变。
+ * * 每个值在构建时预解析为 int / double / bool，读取时不再做 stoi / stod。
+ */
+class ConfigSnapshot
+{
+public:
+    struct Value
+    {
+        std::string text;
+        std::optional<int> as_int;
+        std::optional<double> as_double;
+        std::optional<bool> as_bool;
+    };
+
+    ConfigSnapshot(const std::map<std::string, std::string>& entries, uint64_t version);
+
+    // 未找到返回 nullptr；string_view 查找不构造临时 std::string
+    [[nodiscard]] const Value* find(std::string_view key) const noexcept;
+
+    [[nodiscard]] std::map<std::string, std::string> entries() const;
+
+    [[nodiscard]] uint64_t version() const noexcept
+    {
+        return _version;
+    }
+
+private:
+    struct KeyHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view key) const noexcept
+        {
+            return std::hash<std::string_view>{}(key);
+        }
+    };
+
+    std::unordered_map<std::string, Value, KeyHash, std::equal_to<>> _values;
+    uint64_t _version;
+};
 
 class ConfigLoader
 {
@@ -48,9 +97,25 @@ public:
     bool load(const std::string& ini_filename, const std::string& env_filename = "",
               const LoadOptions& options = LoadOptions());
 
-    void reload();
+    /**
+     * @brief 按上次 load 的文件与选项重新加载；失败时保持旧配置
+     */
+    bool reload();
+
+    /**
+     * @brief 当前配置快照；需要一次读多个 key 且要求彼此一致时使用
+     */
+    [[nodiscard]] std::shared_ptr<const ConfigSnapshot> snapshot() const noexcept
+    {
+        return _snapshot.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] uint64_t version() const noexcept
+    {
+        return _version.load(std::memory_order_acquire);
+    }
 
-    // 类型安全接口 (带缓存锁)
+    // 类型安全接口：无锁读取线程本地缓存的快照，版本号变化时才重新加载
     [[nodiscard]] std::string getString(const std::string& key) const;
     [[nodiscard]] std::string getString(const std::string& key, const std::string& default_value) const;
 
@@ -70,6 +135,8 @@ public:
     void addValidator(const std::string& key, Validator validator, const std::string& err_msg);
 
 private:
+    friend class ConfigSnapshot; // 预解析复用 parseBool
+
     ConfigLoader();
 
     // 内部解析方法：解析到传入的临时 Map 中，不直接动成员变量
@@ -78,12 +145,20 @@ private:
     static void loadEnvToMap(const std::vector<std::string>& keys, std::map<std::string, std::string>& targetMap);
     bool validateMap(const std::map<std::string, std::string>& targetMap) const;
 
+    // 调用方持有 _mutex
+    void publish(const std::map<std::string, std::string>& entries);
+
+    // 本线程缓存的快照；版本号未变时只有一次原子读，不触碰 shared_ptr 引用计数
+    [[nodiscard]] const ConfigSnapshot& current() const noexcept;
+
     static std::string trim(const std::string& str);
     static std::string unquote(const std::string& str);
     static bool parseBool(const std::string& str);
 
+    // 写者互斥：load / set / addValidator 串行化；读者不加锁
     mutable std::mutex _mutex;
-    std::map<std::string, std::string> _configMap;
+    std::atomic<std::shared_ptr<const ConfigSnapshot>> _snapshot;
+    std::atomic<uint64_t> _version{0};
 
     // 状态记录用于 reload
     std::string _last_ini_file;
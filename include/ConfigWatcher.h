@@ -0,0 +1,75 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_CONFIGWATCHER_H
+#define STREAMGATE_CONFIGWATCHER_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 配置文件热加载触发器
+ * * 职责：
+ * 1. 通过 inotify 监视文件所在目录（编辑器 / 部署工具常以 rename 方式替换文件，直接监视文件会丢失 watch）。
+ * 2. requestReload() 只向 eventfd 写入 8 字节，可在信号处理函数中调用（SIGHUP），触发全部回调。
+ * 3. 同一文件在 debounce 窗口内的多次事件合并为一次回调；回调在后台线程串行执行，异常会被记录并吞掉。
+ * * 回调负责解析与校验，失败时应保持旧配置不变。watch() 须在 start() 之前调用。
+ */
+class ConfigWatcher
+{
+public:
+    using Callback = std::function<void()>;
+
+    explicit ConfigWatcher(std::chrono::milliseconds debounce = std::chrono::milliseconds(200));
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    void watch(const std::string& path, Callback on_change);
+
+    /**
+     * @brief 启动后台线程；inotify 不可用时仍支持 requestReload
+     */
+    void start();
+    void stop();
+
+    /**
+     * @brief 重新加载全部已注册的文件（async-signal-safe）
+     */
+    void requestReload() noexcept;
+
+    // 成功执行的回调次数（每个文件每次计 1）
+    [[nodiscard]] uint64_t reloadCount() const noexcept
+    {
+        return _reloads.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry
+    {
+        std::string path;
+        std::string dir;
+        std::string name;
+        Callback callback;
+        int wd = -1;
+        bool pending = false;
+    };
+
+    void run(const std::stop_token& stoken);
+    void drainInotify(std::chrono::steady_clock::time_point& deadline);
+    void fire(Entry& entry);
+
+    const std::chrono::milliseconds _debounce;
+    int _inotifyFd = -1;
+    int _eventFd = -1;
+    std::vector<Entry> _entries;
+    std::atomic<uint64_t> _reloads{0};
+    std::jthread _worker;
+};
+#endif //STREAMGATE_CONFIGWATCHER_H
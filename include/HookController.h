@@ -24,26 +24,27 @@ public:
 
     /**
      * @brief 路由 Hook 请求到对应的处理函数
-     * * @param hook 已解析并验证过的 Hook 请求对象
+     * * @param hook 已解析并验证过的 Hook 请求视图（仅在本调用栈内有效，下游跨线程前需自行物化）
      * @param callback 结果回调函数
      * * 时间语义：
      * - Publish / Play: 可能会涉及外部鉴权或数据库操作，回调通常在线程池中【异步】执行。
-     * - Done / NoneReader: 属于状态清理通知，回调将在当前调用栈【同步】执行。
+     * - Done / NoneReader: 属于状态清理通知，回调将在当前调用栈【同步】立即应答，
+     *   实际的 Redis 清理由 HookUseCase 投递到 LifecycleExecutor 异步执行（按 stream 保序）。
      */
-    void routeHook(const ZlmHookRequest& hook, ZlmHookCallback callback) const;
+    void routeHook(const ZlmHookRequestView& hook, ZlmHookCallback callback) const;
 
 private:
     // 处理流发布（推流开始）
-    void handlePublish(const ZlmHookRequest& hook, ZlmHookCallback callback) const;
+    void handlePublish(const ZlmHookRequestView& hook, ZlmHookCallback callback) const;
 
     // 处理播放（拉流开始）
-    void handlePlay(const ZlmHookRequest& hook, ZlmHookCallback callback) const;
+    void handlePlay(const ZlmHookRequestView& hook, ZlmHookCallback callback) const;
 
     // 处理发布停止（推流结束，合并了 StreamNoneReader 逻辑）
-    void handlePublishDone(const ZlmHookRequest& hook, const ZlmHookCallback& callback) const;
+    void handlePublishDone(const ZlmHookRequestView& hook, const ZlmHookCallback& callback) const;
 
     // 处理播放停止（拉流结束）
-    void handlePlayDone(const ZlmHookRequest& hook, const ZlmHookCallback& callback) const;
+    void handlePlayDone(const ZlmHookRequestView& hook, const ZlmHookCallback& callback) const;
 
     HookUseCase& _use_case;
 };
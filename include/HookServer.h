@@ -9,8 +9,12 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <atomic>
+#include <optional>
+#include <thread>
 #include "HookController.h"
+#include "HookTrace.h"
 
 namespace net = boost::asio;
 namespace beast = boost::beast;
@@ -42,7 +46,12 @@ private:
     void handle_request();
 
     //异步写
+    // 抢占本次请求的应答权并记录成功 / 失败；返回 false 表示已有其他路径应答过
+    bool complete_tracked(bool ok);
+
     void send_response(int http_status, int business_code, const std::string& message);
+    // 200 + 任意 Content-Type 的原样输出（/metrics、/health 等 GET 端点）
+    void send_payload(std::string_view content_type, std::string_view body);
     void on_write(bool keep_alive, const beast::error_code& ec, std::size_t bytes_transferred);
 
     tcp::socket _socket;
@@ -53,6 +62,16 @@ private:
 
     HookController& _controller;
     std::atomic<bool> _responded{false};
+    std::optional<HookAction> _tracked_action; // 仅 Hook 请求有值，应答写出后清空
+    std::size_t _bytes_in = 0;
+
+    // 阶段计时：HttpRead 只统计连接上的首个请求（keep-alive 后续请求的读等待包含客户端空闲时间）
+    HookTrace _trace;
+    bool _first_request = true;
+    HookTrace::Clock::time_point _read_started{};
+    HookTrace::Clock::time_point _received{};
+    HookTrace::Clock::time_point _write_started{};
+    HookTrace::Clock::duration _read_elapsed{};
 };
 
 /**
@@ -61,10 +80,16 @@ private:
 class HookListener : public std::enable_shared_from_this<HookListener>
 {
 public:
+    /**
+     * @param reuse_port 是否开启 SO_REUSEPORT（分片模式下多个 Acceptor 绑定同一端口，由内核分发连接）
+     * @param single_threaded 所属 io_context 是否仅由单线程驱动；为 true 时会话直接绑定该 io_context，省去 strand 开销
+     */
     HookListener(
         net::io_context& ioc,
         const tcp::endpoint& endpoint,
-        HookController& controller
+        HookController& controller,
+        bool reuse_port = false,
+        bool single_threaded = false
     );
 
     void start();
@@ -76,6 +101,7 @@ private:
     net::io_context& _ioc;
     tcp::acceptor _acceptor;
     HookController& _controller;
+    bool _single_threaded;
 };
 
 /**
@@ -89,6 +115,11 @@ public:
         std::string address = "0.0.0.0";
         int port = 8080;
         int io_threads = 2;
+
+        // I/O 分片数：0 = 共享 io_context 模式（io_threads 个线程争用同一个 epoll 与 accept 队列）
+        // >0 = 分片模式：每个分片独立 io_context + SO_REUSEPORT Acceptor + 一个绑核线程，会话不跨分片迁移
+        int io_shards = 0;
+        bool pin_shard_threads = true;
     };
 
     HookServer(Config config, HookController& controller);
@@ -97,13 +128,39 @@ public:
     bool start();
     void stop();
 
+    [[nodiscard]] bool isSharded() const
+    {
+        return _config.io_shards > 0;
+    }
+
 private:
+    /**
+     * @brief 单个 I/O 分片：独占的 io_context、Acceptor 与驱动线程
+     */
+    struct IoShard
+    {
+        // 并发提示 1：该 io_context 只会被一个线程 run()，Asio 可省去内部锁
+        net::io_context ioc{1};
+        std::optional<net::executor_work_guard<net::io_context::executor_type>> work_guard;
+        std::shared_ptr<HookListener> listener;
+        std::thread thread;
+    };
+
+    void startShared(const tcp::endpoint& ep);
+    void startSharded(const tcp::endpoint& ep);
+
     Config _config;
     HookController& _controller;
+
+    // 共享模式
     net::io_context _ioc;
     std::optional<net::executor_work_guard<net::io_context::executor_type>> _work_guard;
     std::shared_ptr<HookListener> _listener;
     std::vector<std::thread> _worker_threads;
+
+    // 分片模式
+    std::vector<std::unique_ptr<IoShard>> _shards;
+
     std::atomic<bool> _running{false};
 };
 #endif //STREAMGATE_HOOKSERVER_CPP_H
@@ -0,0 +1,118 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_HOOKTRACE_H
+#define STREAMGATE_HOOKTRACE_H
+#include "LatencyHistogram.h"
+#include <chrono>
+
+/**
+ * @brief 单个 Hook 请求的阶段计时上下文
+ * * 由 HookSession 持有，以裸指针经 ZlmHookRequestView -> HookUseCase -> StreamTaskScheduler -> AuthManager 逐层传递；
+ * * 仓储层接口不带上下文参数，AuthManager 在 worker 上通过 Scope 暴露为 current()。
+ * * 生命周期：会话持有的实例只在本请求应答之前有效；AuthManager 投递时复制一份，worker 侧各阶段只写副本，
+ * * 不会与会话处理下一个 keep-alive 请求时的 reset() 竞争。
+ * * 传入 nullptr 表示不计时，StageTimer 此时连时钟都不读。
+ */
+class HookTrace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void reset(HookAction action, Clock::time_point received) noexcept
+    {
+        _action = action;
+        _received = received;
+        _enqueued = {};
+    }
+
+    [[nodiscard]] HookAction action() const noexcept
+    {
+        return _action;
+    }
+
+    [[nodiscard]] Clock::time_point received() const noexcept
+    {
+        return _received;
+    }
+
+    void record(HookStage stage, Clock::duration elapsed) const noexcept
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        LatencyHistogramRegistry::instance().record(_action, stage, ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    // 投递到线程池前打点；worker 取出后调用 recordQueueWait
+    void markEnqueued() noexcept
+    {
+        _enqueued = Clock::now();
+    }
+
+    void recordQueueWait() const noexcept
+    {
+        if (_enqueued != Clock::time_point{})
+        {
+            record(HookStage::QueueWait, Clock::now() - _enqueued);
+        }
+    }
+
+    /**
+     * @brief 当前线程正在处理的请求（仅在 Scope 内有效）
+     */
+    static HookTrace* current() noexcept;
+
+    class Scope
+    {
+    public:
+        explicit Scope(HookTrace* trace) noexcept;
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        HookTrace* _previous;
+    };
+
+private:
+    HookAction _action = HookAction::Unknown;
+    Clock::time_point _received{};
+    Clock::time_point _enqueued{};
+};
+
+/**
+ * @brief RAII 阶段计时：析构时记录到当前线程的直方图
+ */
+class StageTimer
+{
+public:
+    StageTimer(const HookTrace* trace, HookStage stage) noexcept
+        : _trace(trace), _stage(stage), _start(trace ? HookTrace::Clock::now() : HookTrace::Clock::time_point{})
+    {
+    }
+
+    ~StageTimer()
+    {
+        stop();
+    }
+
+    // 提前结束计时（只记录一次），用于阶段边界落在作用域中间的场景
+    void stop() noexcept
+    {
+        if (_trace)
+        {
+            _trace->record(_stage, HookTrace::Clock::now() - _start);
+            _trace = nullptr;
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    const HookTrace* _trace;
+    HookStage _stage;
+    HookTrace::Clock::time_point _start;
+};
+#endif //STREAMGATE_HOOKTRACE_H
@@ -6,26 +6,37 @@
 #define STREAMGATE_HOOKUSECASE_H
 #include "ZlmHookCommon.h"
 #include "StreamTaskScheduler.h"
+#include "LifecycleExecutor.h"
 
 using HookDecisionCallback = std::function<void(const HookDecision&)>;
 
 class HookUseCase
 {
 public:
-    explicit HookUseCase(StreamTaskScheduler& s) : _scheduler(s)
+    /**
+     * @param lifecycle 生命周期事件执行器；为空时 Done 类事件在调用线程同步清理（兼容旧行为）
+     */
+    explicit HookUseCase(StreamTaskScheduler& s, LifecycleExecutor* lifecycle = nullptr)
+        : _scheduler(s),
+          _lifecycle(lifecycle)
     {
     }
 
-    // 异步操作：涉及鉴权和资源调度
-    void processPublish(const ZlmHookRequest& req, HookDecisionCallback cb) const;
-    void processPlay(const ZlmHookRequest& req, HookDecisionCallback cb) const;
+    // 异步操作：涉及鉴权和资源调度（视图字段在此处物化为 std::string 后才跨入 ThreadPool）
+    void processPublish(const ZlmHookRequestView& req, HookDecisionCallback cb) const;
+    void processPlay(const ZlmHookRequestView& req, HookDecisionCallback cb) const;
 
-    // 同步操作：纯状态清理，无需等待回调
-    HookDecision processPublishDone(const ZlmHookRequest& req) const;
-    HookDecision processPlayDone(const ZlmHookRequest& req) const;
+    // 立即应答：状态清理投递到 LifecycleExecutor（按 stream_key 保序），不占用调用线程
+    HookDecision processPublishDone(const ZlmHookRequestView& req) const;
+    HookDecision processPlayDone(const ZlmHookRequestView& req) const;
 
 private:
     static HookDecision mapResult(const StreamTaskScheduler::SchedulerResult& res);
+
+    // 投递清理任务；未注入执行器时同步执行，队列满 / 已关闭时丢弃并交给超时扫描
+    void dispatchLifecycle(const std::string& stream_key, LifecycleExecutor::Task task) const;
+
     StreamTaskScheduler& _scheduler;
+    LifecycleExecutor* _lifecycle;
 };
 #endif //STREAMGATE_HOOKUSECASE_H
@@ -7,10 +7,15 @@
 #include <string>
 #include <optional>
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <string_view>
+#include <vector>
+#include "AuthL1Cache.h"
 #include "CacheManager.h"
 #include "DBManager.h"
 #include "IAuthRepository.h"
+#include "SingleFlight.h"
 #include "StreamAuthData.h"
 
 class HybridAuthRepository : public IAuthRepository
@@ -25,15 +30,51 @@ public:
         uint64_t db_errors;
         uint64_t validation_failures; // 逻辑校验失败次数（Token/ClientId 不匹配，或 DB 数据校验失败）
         double cache_hit_rate; // 物理缓存命中率
+
+        // L1 进程内缓存 (未启用时全为 0)
+        uint64_t l1_hits;
+        uint64_t l1_negative_hits;
+        uint64_t l1_misses;
+        uint64_t l1_evictions;
+        uint64_t l1_expirations;
+        size_t l1_entries;
+        size_t l1_bytes;
+        size_t l1_capacity_bytes;
+        double l1_hit_rate; // (正向 + 负向命中) / 总查询
+
+        // DB Single-Flight
+        uint64_t db_flight_leaders; // 实际发往 DB 的查询次数
+        uint64_t db_coalesced_waiters; // 复用在途查询结果、未访问 DB 的请求数
+        uint64_t db_serialized_waiters; // 同 key 不同 Token，排队后各自查询的请求数
+        uint64_t db_waiting; // 当前挂起等待的请求数
+        uint64_t db_in_flight; // 当前在途的 key 数
+
+        // 网络往返次数 (用于评估批量接口的收益)
+        uint64_t redis_round_trips;
+        uint64_t db_round_trips;
+    };
+
+    struct Config
+    {
+        size_t l1_capacity_bytes = 16 * 1024 * 1024; // 0 表示关闭 L1
+        size_t l1_shards = 16;
+        std::chrono::seconds l1_ttl{10}; // 实际 TTL 取 min(l1_ttl, Redis TTL)，限制 DB 侧吊销的生效延迟
     };
 
     HybridAuthRepository(DBManager& dbManager, CacheManager& cacheManager);
+    HybridAuthRepository(DBManager& dbManager, CacheManager& cacheManager, const Config& config);
 
     // 核心业务接口
     std::optional<StreamAuthData> getAuthData(const std::string& streamKey,
                                               const std::string& clientId,
                                               const std::string& authToken) override;
 
+    /**
+     * @brief 批量鉴权：L1 -> 一次 MGET -> 分块 SELECT ... IN (...) -> 一次 Pipeline SETEX 回写
+     * @note 批量路径不经过 Single-Flight，适用于批量 Hook 接入与缓存预热
+     */
+    std::vector<std::optional<StreamAuthData>> getAuthDataBatch(const std::vector<AuthRequest>& requests) override;
+
     // 运维接口
     [[nodiscard]] Stats getStats() const;
     void resetStats();
@@ -43,14 +84,34 @@ private:
     // 内部逻辑拆分
     static std::string buildCacheKey(const std::string& streamKey, const std::string& clientId);
 
+    // 记录不存在返回 nullopt；连接获取失败 / SQL 异常抛出，由调用方按 DB 异常处理（短 TTL 负缓存）
     std::optional<StreamAuthData> getAuthDataFromDB(const std::string& streamKey,
                                                     const std::string& clientId,
                                                     const std::string& authToken) const;
 
     //增加透明化日志
-    std::optional<StreamAuthData> tryGetFromCache(const std::string& cacheKey) const;
+    CachedAuthData tryGetFromCache(const std::string& cacheKey, const std::string& authToken) const;
     void cacheAuthData(const std::string& cacheKey, const StreamAuthData& data) const;
-    void cacheNegativeResult(const std::string& cacheKey, int ttl) const;
+    void cacheNegativeResult(const std::string& cacheKey, const std::string& authToken, int ttl) const;
+    // Redis 中同一 Token 的负缓存命中后仅回填 L1，不重复写 Redis
+    void rememberNegative(const std::string& cacheKey, const std::string& authToken) const;
+
+    // 清理 L1 与 Redis 中的条目（Token/ClientId 不匹配时调用）
+    void invalidateCache(const std::string& cacheKey) const;
+
+    /**
+     * @brief 批量 DB 查询，按 kBatchQueryChunk 分块，每块一次往返
+     * @param indices requests 中需要查询的下标
+     * @return 与 indices 对齐的查询结果；取不到连接或 SQL 异常时抛出
+     */
+    std::vector<std::optional<StreamAuthData>> queryDatabaseBatch(const std::vector<AuthRequest>& requests,
+                                                                  const std::vector<size_t>& indices) const;
+
+    // DB 查询 + 校验 + 回写缓存，作为 Single-Flight 的加载函数整体执行一次
+    std::optional<StreamAuthData> loadFromDatabase(const std::string& streamKey,
+                                                   const std::string& clientId,
+                                                   const std::string& authToken,
+                                                   const std::string& cacheKey);
 
     //增加 cacheKey 参数，避免重复计算
     std::optional<StreamAuthData> queryDatabase(const std::string& streamKey,
@@ -69,8 +130,16 @@ private:
     CacheManager& _cacheManager;
 
     const int _cacheTTL;
+
+    // L1 进程内缓存，capacity 为 0 时为空
+    std::unique_ptr<AuthL1Cache> _l1;
+    const std::chrono::seconds _l1TTL;
+
+    // 缓存未命中时的 DB 查询合并 (key = cacheKey, tag = authToken)
+    SingleFlight<std::optional<StreamAuthData>> _dbFlight;
     static constexpr int NEGATIVE_CACHE_TTL = 30; // 记录不存在时的负缓存TTL
     static constexpr int TRANSIENT_DB_ERROR_TTL = 5; // DB异常时的短期负缓存TTL (Anti-Collapse)
+    static constexpr size_t kBatchQueryChunk = 200; // 单条 IN 查询的最大行数
 
     // 统计指标（原子变量确保线程安全）
     std::atomic<uint64_t> _cacheHits{0};
@@ -79,6 +148,8 @@ private:
     std::atomic<uint64_t> _dbMisses{0};
     std::atomic<uint64_t> _dbErrors{0};
     std::atomic<uint64_t> _validationFailures{0};
+    mutable std::atomic<uint64_t> _redisRoundTrips{0};
+    mutable std::atomic<uint64_t> _dbRoundTrips{0};
 };
 
 #endif //STREAMGATE_HYBRIDAUTHREPOSITORY_H
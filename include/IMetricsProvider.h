@@ -7,7 +7,9 @@
 #include <string_view>
 #include <atomic>
 #include <memory>
+#include <string>
 #include <nlohmann/json.hpp>
+#include "PrometheusWriter.h"
 
 /**
  * @brief 平台适配与段名定义
@@ -25,6 +27,15 @@
 #endif
 
 
+/**
+ * @brief 一次刷新产生的不可变快照：JSON 视图与预渲染的 Prometheus 文本同时发布
+ */
+struct MetricsSnapshot
+{
+    nlohmann::json json = nlohmann::json::object();
+    std::string exposition; // Prometheus 文本格式，每行以 '\n' 结尾
+};
+
 /**
  * @brief IMetricsProvider
  * * 核心设计哲学：
@@ -40,10 +51,7 @@ public:
      */
     IMetricsProvider() : _metrics_cache()
     {
-        _metrics_cache.store(
-            std::make_shared<const nlohmann::json>(nlohmann::json::object()),
-            std::memory_order_relaxed
-        );
+        _metrics_cache.store(std::make_shared<const MetricsSnapshot>(), std::memory_order_relaxed);
     }
 
     virtual ~IMetricsProvider() = default;
@@ -72,27 +80,47 @@ public:
         auto ptr = _metrics_cache.load(std::memory_order_acquire);
         if (!ptr) return nlohmann::json::object();
         // 契约保证：构造函数已初始化，ptr 永远不为 nullptr
-        return *ptr;
+        return ptr->json;
+    }
+
+    /**
+     * @brief 导出完整快照（含预渲染的 Prometheus 文本）
+     * 只增加引用计数，不拷贝内容；/metrics 抓取走这条路径。
+     */
+    std::shared_ptr<const MetricsSnapshot> exportSnapshot() const
+    {
+        return _metrics_cache.load(std::memory_order_acquire);
     }
 
 protected:
     /**
      * @brief 更新内存快照 (CoW 模式)
-     * @param new_json 新构建的完整指标 JSON
+     * @param new_json 新构建的完整指标 JSON，Prometheus 文本由其自动展平生成
      * @note 建议在后台线程调用。构建 new_json 的过程会有堆分配，不要放在 QPS 极高的主业务流中。
      */
     void updateSnapshot(const nlohmann::json& new_json)
+    {
+        std::string exposition;
+        PrometheusWriter::appendJson(exposition, PrometheusWriter::metricPrefix(metricsName()), new_json);
+        updateSnapshot(new_json, std::move(exposition));
+    }
+
+    /**
+     * @brief 更新内存快照，Prometheus 文本由子类自行渲染（需要 # TYPE 或标签时使用）
+     */
+    void updateSnapshot(nlohmann::json new_json, std::string exposition)
     {
         // 在内存中创建新副本，不影响正在读取旧副本的线程
-        auto next = std::make_shared<const nlohmann::json>(new_json);
+        auto next = std::make_shared<const MetricsSnapshot>(
+            MetricsSnapshot{std::move(new_json), std::move(exposition)});
 
-        // 原子地切换指针，从此以后 exportMetrics 拿到的就是新数据
-        _metrics_cache.store(next, std::memory_order_release);
+        // 原子地切换指针，从此以后 exportMetrics / exportSnapshot 拿到的就是新数据
+        _metrics_cache.store(std::move(next), std::memory_order_release);
     }
 
 private:
     // 使用 C++20 原子智能指针特性的底层模拟（支持 shared_ptr 的原子存储）
-    std::atomic<std::shared_ptr<const nlohmann::json>> _metrics_cache;
+    std::atomic<std::shared_ptr<const MetricsSnapshot>> _metrics_cache;
 };
 
 /**
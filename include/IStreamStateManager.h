@@ -5,6 +5,7 @@
 #ifndef STREAMGATE_ISTREAMSTATEMANAGER_H
 #define STREAMGATE_ISTREAMSTATEMANAGER_H
 #include "StreamTask.h"
+#include <algorithm>
 #include <vector>
 #include <optional>
 #include <chrono>
@@ -19,6 +20,46 @@ struct TaskIdentifier
     StreamType type;
 };
 
+/**
+ * @brief 单个边缘节点上的在线任务数（负载表的一行）
+ */
+struct NodeLoad
+{
+    std::string host;
+    int port = 0;
+    uint64_t publishers = 0;
+    uint64_t players = 0;
+};
+
+/**
+ * @brief 推流端所在节点（getPublisherLocation 的投影结果，只含调度播放端需要的字段）
+ */
+struct PublisherLocation
+{
+    std::string client_id;
+    std::string host;
+    int port = 0;
+};
+
+/**
+ * @brief 超时扫描的分页与时间预算
+ */
+struct TimeoutScanOptions
+{
+    size_t page_size = 256; // 每页候选数（ZRANGEBYSCORE ... LIMIT）
+    std::chrono::milliseconds time_budget{500}; // 单轮扫描的耗时上限，用尽后剩余候选留给下一轮
+};
+
+/**
+ * @brief 一轮超时扫描的结果
+ */
+struct TimeoutScanResult
+{
+    std::vector<StreamTask> expired; // 已注销的任务（仅 stream_name / client_id / type / last_active_time 有效）
+    size_t backlog = 0; // 预算用尽时仍已超时但未处理的任务数；扫描完毕为 0
+    size_t pages = 0;
+};
+
 /**
  * @brief 流状态管理器接口 (IStreamStateManager)
  * 职责：维护推流 (Publisher) 和播放 (Player) 的实时生命周期。
@@ -84,6 +125,15 @@ public:
     [[nodiscard]] virtual size_t getActivePublisherCount() const =0;
     [[nodiscard]] virtual size_t getActivePlayerCount() const =0;
 
+    /**
+     * @brief 某条流的在线观众数（不含推流端）；默认实现遍历成员列表，后端应覆盖为 O(1)
+     */
+    [[nodiscard]] virtual size_t getPlayerCount(const std::string& stream_name) const
+    {
+        const size_t members = getStreamClientIds(stream_name).size();
+        return members > 0 && getPublisherLocation(stream_name) ? members - 1 : members;
+    }
+
     /**
      * @brief 获取特定流的当前发布者详情
      * @param stream_name stream_name 流名
@@ -91,41 +141,114 @@ public:
      */
     [[nodiscard]] virtual std::optional<StreamTask> getPublisherTask(const std::string& stream_name) const =0;
 
+    /**
+     * @brief 只读取推流端的 client_id 与节点地址（播放端调度的热路径），不解析完整任务
+     * * 默认实现基于 getPublisherTask，后端应覆盖为按字段读取
+     */
+    [[nodiscard]] virtual std::optional<PublisherLocation> getPublisherLocation(const std::string& stream_name) const
+    {
+        auto task = getPublisherTask(stream_name);
+        if (!task)return std::nullopt;
+        return PublisherLocation{std::move(task->client_id), std::move(task->server_ip), task->server_port};
+    }
+
     /**
      * @brief 后端存储健康检查
      */
     [[nodiscard]] virtual bool isHealthy() const =0;
 
     /**
-    * @brief   扫描超时的任务（用于定时器清理僵尸流）
+    * @brief   扫描并注销超时的任务（用于定时器清理僵尸流）
     * @param timeout
-    * @return  超时的任务列表（调用方负责 deregister）
+    * @param options 分页大小与单轮时间预算
+    * @return  本轮已注销的任务及剩余积压；调用方无需再 deregister，只需处理推流端超时的联动清场
     */
-    [[nodiscard]] virtual std::vector<StreamTask> scanTimeoutTasks(std::chrono::milliseconds timeout) =0;
+    [[nodiscard]] virtual TimeoutScanResult scanTimeoutTasks(std::chrono::milliseconds timeout,
+                                                             const TimeoutScanOptions& options) =0;
+
+    /**
+     * @brief 启用本地超时定时器（时间轮），之后由 expireDueTasks 按 tick 回收；默认实现不支持，忽略调用
+     */
+    virtual void enableLocalExpiry(std::chrono::milliseconds /*timeout*/, std::chrono::milliseconds /*tick*/)
+    {
+    }
+
+    /**
+     * @brief 注销本地定时器上已到期的任务（事件驱动的超时检测，按 tick 调用）
+     * * 默认实现没有本地定时器，只依赖 scanTimeoutTasks；返回语义同 scanTimeoutTasks
+     */
+    [[nodiscard]] virtual TimeoutScanResult expireDueTasks(std::chrono::milliseconds /*timeout*/)
+    {
+        return {};
+    }
+
+    /**
+     * @brief 任务记录已被存储层按 TTL 删除（键空间过期通知），清理它遗留的索引
+     * * 多实例同时收到同一通知时只有一个返回任务；记录已重新注册时不做任何修改
+     * @return 被清理的任务（只保证 stream_name / client_id / type 有效）；默认实现没有 TTL，返回 nullopt
+     */
+    [[nodiscard]] virtual std::optional<StreamTask> reclaimExpiredTask(const std::string& /*stream_name*/,
+                                                                       const std::string& /*client_id*/)
+    {
+        return std::nullopt;
+    }
 
     //批量操作优化 (默认实现)
-    virtual size_t registerTasksBatch(const std::vector<StreamTask>& tasks)
+    // results 非空时按下标输出每个任务是否成功
+    virtual size_t registerTasksBatch(const std::vector<StreamTask>& tasks, std::vector<bool>* results = nullptr)
     {
+        if (results)results->assign(tasks.size(), false);
         size_t successCount = 0;
-        for (const auto& t : tasks)
+        for (size_t i = 0; i < tasks.size(); ++i)
         {
-            if (registerTask(t))
-                successCount++;
+            if (!registerTask(tasks[i]))continue;
+            successCount++;
+            if (results)(*results)[i] = true;
         }
         return successCount;
     }
 
-    [[nodiscard]] virtual size_t touchTasksBatch(const std::vector<TaskIdentifier>& tasks) const
+    [[nodiscard]] virtual size_t touchTasksBatch(const std::vector<TaskIdentifier>& tasks,
+                                                 std::vector<bool>* results = nullptr) const
     {
+        if (results)results->assign(tasks.size(), false);
         size_t successCount = 0;
-        for (const auto& [streamName, clientId,type] : tasks)
+        for (size_t i = 0; i < tasks.size(); ++i)
         {
-            if (touchTask(streamName, clientId))
-                successCount++;
+            if (!touchTask(tasks[i].streamName, tasks[i].clientId))continue;
+            successCount++;
+            if (results)(*results)[i] = true;
         }
         return successCount;
     }
 
+    /**
+     * @brief 按边缘节点聚合在线推流 / 播放数（调度器的负载表刷新线程调用，不在请求路径上）
+     * * 播放端总是绑定到推流端所在节点，因此按推流任务的 server_ip:server_port 归属。
+     * @throws std::exception 底层存储故障，调用方应保留上一次的负载表
+     */
+    [[nodiscard]] virtual std::vector<NodeLoad> getNodeLoads() const
+    {
+        std::vector<NodeLoad> loads;
+        for (const auto& pub : getAllPublisherTasks())
+        {
+            auto it = std::ranges::find_if(loads, [&pub](const NodeLoad& l)
+            {
+                return l.host == pub.server_ip && l.port == pub.server_port;
+            });
+            if (it == loads.end())
+            {
+                it = loads.insert(loads.end(), NodeLoad{pub.server_ip, pub.server_port, 0, 0});
+            }
+
+            ++it->publishers;
+            // 成员集合包含推流端自身
+            const size_t members = getStreamClientIds(pub.stream_name).size();
+            it->players += members > 0 ? members - 1 : 0;
+        }
+        return loads;
+    }
+
     virtual size_t deregisterTasksBatch(const std::vector<TaskIdentifier>& tasks)
     {
         size_t successCount = 0;
@@ -0,0 +1,168 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_INMEMORYSTREAMSTATEMANAGER_H
+#define STREAMGATE_INMEMORYSTREAMSTATEMANAGER_H
+#include "IStreamStateManager.h"
+#include "TimingWheel.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 进程内权威状态管理器（单网关 + 单流媒体节点部署，或无 Redis 的单元测试 / 基准）
+ * * 职责：
+ * 1. 按 stream 哈希分片，每片一把读写锁；同一条流的推流位、成员表在同一分片内原子更新。
+ * 2. 在线推流数 / 播放数由原子计数器维护，查询为 O(1)。
+ * 3. 可选持久化：每次变更在持有分片锁时追加到 journal 缓冲，后台线程按 journal_flush_interval 成批写出；
+ *    周期性快照后删除已覆盖的 journal，重启时加载快照并重放其后的 journal。
+ * * 语义与 RedisStreamStateManager 一致：推流位冲突拒绝、同 client 重复注册幂等、成员表包含推流端自身。
+ */
+class InMemoryStreamStateManager : public IStreamStateManager
+{
+public:
+    struct Config
+    {
+        size_t shards = 16;
+        std::string data_dir; // 为空则不持久化
+        std::chrono::milliseconds journal_flush_interval{20};
+        std::chrono::seconds snapshot_interval{60};
+        size_t snapshot_journal_bytes = 64 * 1024 * 1024; // journal 超过该大小时提前快照
+        bool fsync = false; // 每次写出 journal 后 fdatasync
+    };
+
+    struct PersistenceStats
+    {
+        uint64_t recovered_tasks;
+        uint64_t recovery_ms;
+        uint64_t journal_bytes; // 当前 journal 已写出的字节数
+        uint64_t snapshots;
+        uint64_t write_errors;
+    };
+
+    InMemoryStreamStateManager(); // 不持久化的默认配置
+    explicit InMemoryStreamStateManager(const Config& config);
+    ~InMemoryStreamStateManager() override;
+
+    InMemoryStreamStateManager(const InMemoryStreamStateManager&) = delete;
+    InMemoryStreamStateManager& operator=(const InMemoryStreamStateManager&) = delete;
+
+    bool registerTask(const StreamTask& task) override;
+    bool deregisterTask(const std::string& stream_name, const std::string& client_id) override;
+    void deregisterAllMembers(const std::string& stream_name) override;
+
+    [[nodiscard]] std::vector<std::string> getStreamClientIds(const std::string& stream_name) const override;
+    [[nodiscard]] bool touchTask(const std::string& stream_name, const std::string& client_id) const override;
+    [[nodiscard]] std::optional<StreamTask> getTask(const std::string& stream_name,
+                                                    const std::string& client_id) const override;
+    [[nodiscard]] std::vector<StreamTask> getAllPublisherTasks() const override;
+    [[nodiscard]] size_t getActivePublisherCount() const override;
+    [[nodiscard]] size_t getActivePlayerCount() const override;
+    [[nodiscard]] size_t getPlayerCount(const std::string& stream_name) const override;
+    [[nodiscard]] std::optional<StreamTask> getPublisherTask(const std::string& stream_name) const override;
+    [[nodiscard]] std::optional<PublisherLocation> getPublisherLocation(
+        const std::string& stream_name) const override;
+    [[nodiscard]] std::vector<NodeLoad> getNodeLoads() const override;
+
+    [[nodiscard]] bool isHealthy() const override
+    {
+        return true;
+    }
+
+    /**
+     * @brief 逐分片扫描；page_size 不适用，预算按分片检查
+     */
+    [[nodiscard]] TimeoutScanResult scanTimeoutTasks(std::chrono::milliseconds timeout,
+                                                     const TimeoutScanOptions& options) override;
+
+    /**
+     * @brief 启用超时时间轮；已恢复的任务按 last_active_time + timeout 登记
+     */
+    void enableLocalExpiry(std::chrono::milliseconds timeout, std::chrono::milliseconds tick) override;
+    [[nodiscard]] TimeoutScanResult expireDueTasks(std::chrono::milliseconds timeout) override;
+
+    /**
+     * @brief 立即写快照并删除已覆盖的 journal；未启用持久化时返回 false
+     */
+    bool snapshot();
+
+    [[nodiscard]] PersistenceStats persistenceStats() const;
+
+private:
+    struct StreamEntry
+    {
+        std::string publisher; // 当前持有推流位的 client，空表示无推流端
+        std::unordered_map<std::string, StreamTask> members; // 包含推流端自身
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, StreamEntry> streams;
+    };
+
+    [[nodiscard]] Shard& shardFor(const std::string& stream_name) const;
+
+    // 以下 apply* 由调用方持有分片写锁；重放 journal 时同样复用，因此不做推流位冲突检查
+    void applyRegister(Shard& shard, const StreamTask& task);
+    bool applyTouch(Shard& shard, const std::string& stream_name, const std::string& client_id,
+                    int64_t last_ms) const;
+    std::optional<StreamTask> applyDeregister(Shard& shard, const std::string& stream_name,
+                                              const std::string& client_id);
+    size_t applyDeregisterAll(Shard& shard, const std::string& stream_name);
+    void eraseMember(StreamEntry& entry, const std::string& client_id);
+
+    void armExpiry(const std::string& stream_name, const std::string& client_id,
+                   std::chrono::system_clock::time_point last_active) const;
+    void cancelExpiry(const std::string& stream_name, const std::string& client_id) const;
+
+    // 持久化
+    void recover();
+    bool replayFile(const std::string& path, bool is_snapshot, uint64_t* covered_generation);
+    bool applyRecord(std::string_view payload);
+    void appendJournal(const std::string& record) const;
+    void openJournal(uint64_t generation);
+    bool writeJournalLocked() const;
+    void persistLoop(const std::stop_token& stoken);
+    [[nodiscard]] std::string journalPath(uint64_t generation) const;
+
+    const Config _config;
+    std::unique_ptr<Shard[]> _shards;
+    const size_t _shardCount;
+
+    std::atomic<int64_t> _publishers{0};
+    std::atomic<int64_t> _players{0};
+
+    std::unique_ptr<TimingWheel> _expiryWheel;
+    std::chrono::milliseconds _expiryTimeout{0};
+
+    // journal：变更在持有分片锁时追加到缓冲区，保证同一条流的记录顺序与内存中的生效顺序一致
+    mutable std::mutex _journalMutex;
+    mutable std::string _journalBuffer;
+    mutable int _journalFd = -1;
+    uint64_t _journalGeneration = 0; // 受 _journalMutex 保护
+    mutable std::atomic<uint64_t> _journalBytes{0};
+    mutable std::atomic<uint64_t> _writeErrors{0};
+
+    std::mutex _snapshotMutex; // 串行化快照
+    std::atomic<uint64_t> _snapshots{0};
+    uint64_t _recoveredTasks = 0;
+    uint64_t _recoveryMs = 0;
+
+    std::mutex _wakeMutex;
+    std::condition_variable_any _wakeCondition;
+    std::jthread _persister;
+};
+
+#endif //STREAMGATE_INMEMORYSTREAMSTATEMANAGER_H
@@ -0,0 +1,144 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_INLINETASK_H
+#define STREAMGATE_INLINETASK_H
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief 只移动的 void() 任务槽 (Small Buffer Optimization)
+ * * 职责：
+ * 1. 替代 ThreadPool 内部的 std::function<void()>：不要求可拷贝，可直接装下持有 unique_ptr / promise 的 lambda。
+ * 2. 捕获体不超过 kInlineSize 且 nothrow-move 时原地构造，不触发堆分配；否则退化为一次 new。
+ * * 内联容量按 AuthManager::checkAuthAsync 的捕获体定：this + 3 个 std::string + AuthCallback 约 136 字节，
+ * * 整个对象恰好 3 条缓存行 (192 字节)。
+ */
+class InlineTask
+{
+public:
+    static constexpr size_t kInlineSize = 176;
+
+    template <typename Fn>
+    static constexpr bool fits_inline =
+        sizeof(Fn) <= kInlineSize &&
+        alignof(Fn) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<Fn>;
+
+    InlineTask() noexcept = default;
+
+    template <typename F>
+        requires (!std::same_as<std::remove_cvref_t<F>, InlineTask> && std::invocable<std::decay_t<F>&>)
+    InlineTask(F&& f) // NOLINT(google-explicit-constructor)
+    {
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>)
+        {
+            ::new(static_cast<void*>(_storage)) Fn(std::forward<F>(f));
+            _ops = &kInlineOps<Fn>;
+        }
+        else
+        {
+            ::new(static_cast<void*>(_storage)) Fn*(new Fn(std::forward<F>(f)));
+            _ops = &kHeapOps<Fn>;
+        }
+    }
+
+    InlineTask(InlineTask&& other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    InlineTask& operator=(InlineTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    ~InlineTask()
+    {
+        reset();
+    }
+
+    void operator()()
+    {
+        _ops->invoke(_storage);
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return _ops != nullptr;
+    }
+
+    // 构造时是否落在内联缓冲区（false 表示发生过一次堆分配）
+    [[nodiscard]] bool is_inline() const noexcept
+    {
+        return _ops != nullptr && _ops->is_inline;
+    }
+
+    void reset() noexcept
+    {
+        if (_ops)
+        {
+            _ops->destroy(_storage);
+            _ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops
+    {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* dst, void* src) noexcept; // 移动到 dst 并析构 src
+        void (*destroy)(void* storage) noexcept;
+        bool is_inline;
+    };
+
+    template <typename Fn>
+    static constexpr Ops kInlineOps{
+        [](void* s) { std::invoke(*static_cast<Fn*>(s)); },
+        [](void* dst, void* src) noexcept
+        {
+            ::new(dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* s) noexcept { static_cast<Fn*>(s)->~Fn(); },
+        true
+    };
+
+    template <typename Fn>
+    static constexpr Ops kHeapOps{
+        [](void* s) { std::invoke(**static_cast<Fn**>(s)); },
+        [](void* dst, void* src) noexcept
+        {
+            ::new(dst) Fn*(*static_cast<Fn**>(src));
+        },
+        [](void* s) noexcept { delete *static_cast<Fn**>(s); },
+        false
+    };
+
+    void moveFrom(InlineTask& other) noexcept
+    {
+        if (other._ops)
+        {
+            other._ops->relocate(_storage, other._storage);
+            _ops = std::exchange(other._ops, nullptr);
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char _storage[kInlineSize]{};
+    const Ops* _ops = nullptr;
+};
+#endif //STREAMGATE_INLINETASK_H
@@ -0,0 +1,161 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_LATENCYHISTOGRAM_H
+#define STREAMGATE_LATENCYHISTOGRAM_H
+#include "ZlmHookCommon.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Hook 处理链路上的阶段
+ */
+enum class HookStage : uint8_t
+{
+    HttpRead, // 新连接上首个请求：发起读到请求完整到达
+    JsonParse, // 请求体解析（零拷贝扫描 + DOM 兜底）
+    QueueWait, // 鉴权任务在 ThreadPool 中的排队时间
+    AuthCache, // Redis 鉴权缓存 GET
+    AuthDb, // MariaDB 鉴权查询
+    RegisterTask, // StateManager 注册任务（含播放端反查推流端）
+    ResponseWrite, // 发起写到写完成
+    Total // 请求读完到应答写完
+};
+
+inline constexpr size_t kHookStageCount = static_cast<size_t>(HookStage::Total) + 1;
+
+// 指标标签用的小写名称，例如 auth_cache
+std::string_view hookStageLabel(HookStage stage) noexcept;
+
+/**
+ * @brief HDR 风格对数-线性分桶（单位：纳秒）
+ * * 每个 2 的幂区间再均分 2^kSubBucketBits 个子桶，相对误差 ≤ 1/32；取桶中点后约 ±1.6%。
+ * * 量程 [0, 2^kMaxExponent) ns ≈ 68.7s，超出量程的值计入最后一个桶。
+ */
+struct LatencyBuckets
+{
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr uint64_t kSubBucketCount = uint64_t{1} << kSubBucketBits;
+    static constexpr unsigned kMaxExponent = 36;
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBucketCount;
+
+    static constexpr size_t indexOf(uint64_t v) noexcept
+    {
+        constexpr uint64_t kMax = (uint64_t{1} << kMaxExponent) - 1;
+        if (v > kMax)v = kMax;
+        if (v < kSubBucketCount)return static_cast<size_t>(v);
+
+        const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - 1 - kSubBucketBits;
+        return (shift + 1) * kSubBucketCount + static_cast<size_t>((v >> shift) - kSubBucketCount);
+    }
+
+    static constexpr uint64_t lowerBound(size_t index) noexcept
+    {
+        if (index < kSubBucketCount)return index;
+        const size_t shift = index / kSubBucketCount - 1;
+        return (kSubBucketCount + index % kSubBucketCount) << shift;
+    }
+
+    static constexpr uint64_t width(size_t index) noexcept
+    {
+        return index < kSubBucketCount ? 1 : uint64_t{1} << (index / kSubBucketCount - 1);
+    }
+};
+
+/**
+ * @brief 合并后的直方图（普通内存，供 MetricsProvider 计算分位数）
+ */
+struct LatencyHistogramData
+{
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    std::vector<uint64_t> buckets; // 未出现过样本时为空
+
+    /**
+     * @param q 分位 (0, 1]；无样本返回 0
+     * @return 所在桶的中点（纳秒）
+     */
+    [[nodiscard]] uint64_t percentile(double q) const noexcept;
+
+    void add(const LatencyHistogramData& other);
+
+    // 计算窗口增量：调用方保证 base 是本对象更早时刻的快照
+    void subtract(const LatencyHistogramData& base);
+};
+
+/**
+ * @brief 所有 (HookAction, HookStage) 组合的快照
+ */
+struct LatencySnapshot
+{
+    static constexpr size_t kCells = kHookActionCount * kHookStageCount;
+
+    std::array<LatencyHistogramData, kCells> cells;
+
+    static constexpr size_t cellIndex(HookAction action, HookStage stage) noexcept
+    {
+        return static_cast<size_t>(action) * kHookStageCount + static_cast<size_t>(stage);
+    }
+
+    [[nodiscard]] const LatencyHistogramData& at(HookAction action, HookStage stage) const noexcept
+    {
+        return cells[cellIndex(action, stage)];
+    }
+};
+
+/**
+ * @brief 线程局部延迟直方图注册表
+ * * 职责：
+ * 1. record() 只写当前线程自己的直方图：relaxed load + store，无 RMW、无锁，单次约数纳秒。
+ * 2. (action, stage) 组合在线程首次记录时才分配（每个 8KB），io 线程与 worker 各自只会用到少数几个。
+ * 3. 线程退出时把计数并入历史快照；snapshot() 与退出归并共用一把锁，汇总值单调不回退。
+ */
+class LatencyHistogramRegistry
+{
+public:
+    static LatencyHistogramRegistry& instance();
+
+    void record(HookAction action, HookStage stage, uint64_t nanos) noexcept;
+
+    [[nodiscard]] LatencySnapshot snapshot() const;
+
+    LatencyHistogramRegistry(const LatencyHistogramRegistry&) = delete;
+    LatencyHistogramRegistry& operator=(const LatencyHistogramRegistry&) = delete;
+
+private:
+    LatencyHistogramRegistry() = default;
+
+    // 单写者直方图
+    struct Cell
+    {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum_ns{0};
+        std::array<std::atomic<uint64_t>, LatencyBuckets::kBucketCount> buckets{};
+
+        void mergeInto(LatencyHistogramData& out) const;
+    };
+
+    struct ThreadHistograms
+    {
+        std::array<std::atomic<Cell*>, LatencySnapshot::kCells> cells{};
+        std::array<std::unique_ptr<Cell>, LatencySnapshot::kCells> owned;
+    };
+
+    friend struct LatencyThreadHandle;
+
+    ThreadHistograms* local() noexcept;
+    void attach(ThreadHistograms* histograms);
+    void detach(ThreadHistograms* histograms);
+
+    mutable std::mutex _mutex;
+    std::vector<ThreadHistograms*> _threads;
+    LatencySnapshot _retired;
+};
+#endif //STREAMGATE_LATENCYHISTOGRAM_H
@@ -0,0 +1,35 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_LATENCYMETRICSPROVIDER_H
+#define STREAMGATE_LATENCYMETRICSPROVIDER_H
+#include "IMetricsProvider.h"
+#include "LatencyHistogram.h"
+#include <chrono>
+
+/**
+ * @brief Hook 阶段延迟指标提供者
+ * * 以 Prometheus summary 导出 streamgate_hook_stage_latency_seconds{action,stage,quantile}。
+ * * 分位数按滚动窗口计算：保留两份历史快照，窗口长度在 [window, 2*window) 之间；_sum / _count 为累计值。
+ * * 只导出出现过样本的 (action, stage) 组合。
+ */
+class LatencyMetricsProvider final : public IMetricsProvider
+{
+public:
+    explicit LatencyMetricsProvider(std::chrono::seconds window = std::chrono::seconds(30));
+    ~LatencyMetricsProvider() override = default;
+
+    REGISTER_METRICS_NAME("latency_metrics")
+
+    void refresh() noexcept override;
+
+private:
+    const std::chrono::steady_clock::duration _window;
+
+    // 仅刷新线程访问
+    LatencySnapshot _base; // 窗口起点
+    LatencySnapshot _next; // 下一个窗口起点
+    std::chrono::steady_clock::time_point _nextTakenAt;
+};
+#endif //STREAMGATE_LATENCYMETRICSPROVIDER_H
@@ -0,0 +1,108 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_LIFECYCLEEXECUTOR_H
+#define STREAMGATE_LIFECYCLEEXECUTOR_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 生命周期事件执行器 (LifecycleExecutor)
+ * * 职责：
+ * 1. 承接 on_publish_done / on_play_done 等状态清理事件，让 HTTP I/O 线程立即应答。
+ * 2. 按 ordering_key（通常为 stream_key）哈希到固定 Lane，同一条流的事件严格 FIFO 执行。
+ * 3. 对外暴露队列深度与排队延迟 (lag)，供 /metrics 观测背压。
+ * * 注意：不同 Lane 之间无顺序保证；同一 Lane 由单线程串行消费。
+ */
+class LifecycleExecutor
+{
+public:
+    struct Config
+    {
+        size_t num_lanes = 2;
+        size_t max_queue_per_lane = 10000; // 0 表示不限
+    };
+
+    struct Stats
+    {
+        size_t num_lanes;
+        size_t queue_depth; // 当前所有 Lane 的堆积总数
+        uint64_t total_submitted;
+        uint64_t completed_tasks;
+        uint64_t failed_tasks;
+        uint64_t rejected_tasks;
+        uint64_t oldest_pending_us; // 队头最老事件已等待的时长
+        uint64_t last_lag_us; // 最近一次出队时的排队延迟
+        uint64_t max_lag_us; // 启动以来最大排队延迟
+    };
+
+    using Task = std::function<void()>;
+
+    explicit LifecycleExecutor(const Config& config);
+    ~LifecycleExecutor();
+
+    LifecycleExecutor(const LifecycleExecutor&) = delete;
+    LifecycleExecutor& operator=(const LifecycleExecutor&) = delete;
+
+    /**
+     * @brief 投递事件
+     * @param ordering_key 顺序键：相同 key 的事件按提交顺序执行
+     * @return false 表示执行器已关闭或 Lane 已满（计入 rejected_tasks），此时 task 不会被移走；
+     *         调用方不应在当前线程就地执行它，否则会越过同一 key 仍在排队的事件
+     */
+    [[nodiscard]] bool submit(std::string_view ordering_key, Task&& task);
+
+    /**
+     * @brief 优雅停机：拒绝新事件，排空已入队事件后回收线程
+     */
+    void stop_and_wait();
+
+    [[nodiscard]] bool is_stopped() const
+    {
+        return _stop.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] Stats get_stats() const;
+
+private:
+    struct Item
+    {
+        Task task;
+        std::chrono::steady_clock::time_point enqueued_at;
+    };
+
+    struct Lane
+    {
+        mutable std::mutex mutex;
+        std::condition_variable_any cv;
+        std::deque<Item> queue;
+    };
+
+    void lane_thread(Lane& lane, const std::stop_token& stoken);
+    void recordLag(std::chrono::steady_clock::duration lag) noexcept;
+
+    size_t _maxQueuePerLane;
+
+    std::vector<std::unique_ptr<Lane>> _lanes;
+    std::vector<std::jthread> _threads;
+    std::atomic<bool> _stop{false};
+
+    std::atomic<size_t> _pending{0};
+    std::atomic<uint64_t> _totalSubmitted{0};
+    std::atomic<uint64_t> _completedTasks{0};
+    std::atomic<uint64_t> _failedTasks{0};
+    std::atomic<uint64_t> _rejectedTasks{0};
+    std::atomic<uint64_t> _lastLagUs{0};
+    std::atomic<uint64_t> _maxLagUs{0};
+};
+#endif //STREAMGATE_LIFECYCLEEXECUTOR_H
@@ -0,0 +1,41 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_LIFECYCLEMETRICSPROVIDER_H
+#define STREAMGATE_LIFECYCLEMETRICSPROVIDER_H
+#include "IMetricsProvider.h"
+
+// 前向声明
+class LifecycleExecutor;
+
+/**
+ * @brief 生命周期事件执行器指标提供者
+ * 负责导出 Done 类事件的队列深度与排队延迟 (lag)
+ */
+class LifecycleMetricsProvider final : public IMetricsProvider
+{
+public:
+    explicit LifecycleMetricsProvider(LifecycleExecutor* executor = nullptr)
+        : _executor(executor)
+    {
+    }
+
+    ~LifecycleMetricsProvider() override = default;
+
+    REGISTER_METRICS_NAME("lifecycle_metrics")
+
+    /**
+     * @brief 注入执行器实例
+     */
+    void setExecutor(LifecycleExecutor* executor) noexcept
+    {
+        _executor = executor;
+    }
+
+    void refresh() noexcept override;
+
+private:
+    LifecycleExecutor* _executor; // 观察者指针
+};
+#endif //STREAMGATE_LIFECYCLEMETRICSPROVIDER_H
@@ -8,6 +8,8 @@
 #include <mutex>
 #include <atomic>
 #include <fstream>
+#include <memory>
+#include <vector>
 #include <bits/shared_ptr_atomic.h>
 
 enum class LogLevel
@@ -19,6 +21,31 @@ enum class LogLevel
     FATAL
 };
 
+/**
+ * @brief 异步模式下线程环形缓冲区写满时的处理策略
+ * - Drop：丢弃当前记录并计数，调用线程永不阻塞。
+ * - Block：等待后台线程腾出空间，不丢日志但调用线程可能被拖慢。
+ */
+enum class LogOverflowPolicy
+{
+    Drop,
+    Block
+};
+
+struct LogAsyncStats
+{
+    bool enabled;
+    uint64_t enqueued; // 累计写入环形缓冲区的记录数
+    uint64_t written; // 累计由后台线程写出的记录数
+    uint64_t dropped; // 因缓冲区写满被丢弃的记录数 (Drop 策略)
+    uint64_t truncated; // 超长被截断的记录数
+    uint64_t blocked; // 因缓冲区写满而等待的次数 (Block 策略)
+    uint64_t write_errors; // writev 失败次数
+    size_t active_threads; // 当前持有环形缓冲区的线程数
+};
+
+class AsyncLogBackend;
+
 class Logger
 {
 public:
@@ -29,6 +56,11 @@ public:
         bool log_to_file = false;
         std::string log_file_path;
         bool include_milliseconds = true;
+
+        // 异步模式：调用线程只拷贝定长记录，格式化与写出交给后台线程
+        bool async = false;
+        size_t async_ring_capacity = 1024; // 每线程环形缓冲区记录数
+        LogOverflowPolicy overflow_policy = LogOverflowPolicy::Drop;
     };
 
     /**
@@ -56,19 +88,25 @@ public:
     void set_min_level(LogLevel level);
     Config get_config() const;
 
-private:
-    Logger()
-    {
-        _min_level.store(LogLevel::INFO);
+    /**
+     * @brief 阻塞直到已提交的异步日志全部写出；同步模式下为空操作
+     */
+    void flush() const;
 
-        std::lock_guard<std::mutex> lock1(_config_mutex);
-        std::lock_guard<std::mutex> lock2(_file_mutex);
+    /**
+     * @brief 停止异步后端并写出剩余日志，之后退回同步模式（进程退出前调用）
+     */
+    void stop_async();
 
-        _config = Config{};
-        _file_stream = nullptr;
-    }
+    LogAsyncStats get_async_stats() const;
 
-    ~Logger() = default;
+private:
+    friend class AsyncLogBackend;
+
+    Logger();
+    ~Logger();
+
+    void retire_async_backend();
 
     static const char* level_to_string(LogLevel level);
     static const char* level_to_color_code(LogLevel level);
@@ -83,6 +121,11 @@ private:
     Config _config;
     std::unique_ptr<std::ofstream> _file_stream;
     std::atomic<LogLevel> _min_level;
+
+    // 异步后端：停用的后端不析构，留到进程结束（其他线程可能刚读到指针），受 _config_mutex 保护
+    std::unique_ptr<AsyncLogBackend> _async_backend;
+    std::vector<std::unique_ptr<AsyncLogBackend>> _retired_backends;
+    std::atomic<AsyncLogBackend*> _async_view{nullptr};
 };
 
 //安全的日志宏定义：do-while(0) 结构 + 原子 Fast-Path
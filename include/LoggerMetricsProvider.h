@@ -0,0 +1,23 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_LOGGERMETRICSPROVIDER_H
+#define STREAMGATE_LOGGERMETRICSPROVIDER_H
+#include "IMetricsProvider.h"
+
+/**
+ * @brief 日志子系统指标提供者
+ * 负责导出异步日志的入队 / 写出 / 丢弃计数；Logger 为进程单例，无需注入
+ */
+class LoggerMetricsProvider final : public IMetricsProvider
+{
+public:
+    LoggerMetricsProvider() = default;
+    ~LoggerMetricsProvider() override = default;
+
+    REGISTER_METRICS_NAME("logger_metrics")
+
+    void refresh() noexcept override;
+};
+#endif //STREAMGATE_LOGGERMETRICSPROVIDER_H
@@ -12,6 +12,7 @@
 #include <thread>
 #include <condition_variable>
 #include <functional>
+#include <string>
 
 /**
  * @brief MetricsCollector - 监控指标汇总器
@@ -35,6 +36,12 @@ public:
      */
     [[nodiscard]] nlohmann::json collectAll() const;
 
+    /**
+     * @brief 获取 Prometheus 文本格式的完整指标
+     * 返回刷新线程上一轮拼接好的缓冲区（仅一次原子加载）；刷新线程未启动时现场拼接。
+     */
+    [[nodiscard]] std::shared_ptr<const std::string> exportPrometheus() const;
+
     /**
      * @brief 获取单例（如果需要全局访问）
      */
@@ -42,6 +49,7 @@ public:
 
     /**
      * @brief 启动定时导出线程
+     * @param exporter 每轮刷新后接收 JSON 报告；为空则跳过 JSON 构建
      */
     void start(std::chrono::milliseconds interval, std::move_only_function<void(const nlohmann::json&) const> exporter);
 
@@ -55,10 +63,16 @@ public:
 private:
     MetricsCollector() = default;
 
+    // 按 metricsName 顺序拼接各 Provider 预渲染的文本，不解析、不构建 DOM
+    [[nodiscard]] std::string renderExposition() const;
+
     // 使用 shared_mutex 保证注册时安全，收集时高并发读取
     mutable std::shared_mutex _mutex;
     std::vector<std::shared_ptr<IMetricsProvider>> _providers;
 
+    // 刷新线程每轮发布一次，/metrics 直接引用
+    std::atomic<std::shared_ptr<const std::string>> _exposition;
+
     std::jthread _worker;
     std::condition_variable_any _cv;
     std::mutex _cv_m;
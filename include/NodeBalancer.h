@@ -0,0 +1,114 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_NODEBALANCER_H
+#define STREAMGATE_NODEBALANCER_H
+#include "IStreamStateManager.h"
+#include "NodeConfig.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief 推流节点选择策略
+ */
+enum class BalanceStrategy
+{
+    RoundRobin, // 轮询（不看负载）
+    LeastTasks, // 在线任务最少
+    Weighted, // 在线任务 / nodes.json 中的 weight 最小
+    PowerOfTwo, // 随机取两个节点，选 (任务数 / weight) 较小者
+    ConsistentHash // 按 stream_key 加权 rendezvous 哈希，节点超出负载上限时顺延到下一名
+};
+
+// 配置值：round_robin / least_tasks / weighted / p2c / consistent_hash；无法识别返回 nullopt
+std::optional<BalanceStrategy> parseBalanceStrategy(std::string_view name) noexcept;
+std::string_view balanceStrategyName(BalanceStrategy strategy) noexcept;
+
+/**
+ * @brief 单个集群（rtmp_srt / http_hls）的负载感知节点选择器
+ * * 职责：
+ * 1. 维护进程内负载表：每个节点一个原子计数，由刷新线程按 Redis 索引周期性覆盖 (updateLoads)。
+ * 2. select() 只读本地计数并对选中节点 +1，两次刷新之间新分配的任务立即可见，不会集中压到同一节点；
+ *    选中后注册失败的由 release() 撤销。
+ * 3. 请求路径上没有锁、没有 Redis 往返；节点列表构造后不可变。
+ * * 负载 = 推流数 + 播放数：播放端总是跟随推流端所在节点，热门流的观众会计入该节点。
+ * * ConsistentHash：同一 stream_key 重连时落在同一节点（GOP 缓存 / 录制保持热），增删节点只迁移约 1/N 的流；
+ * * 首选节点超过负载上限时按哈希排名顺延（Consistent Hashing with Bounded Loads, Mirrokni et al. 2018）。
+ * * 健康掩码由 NodeHealthProber 的快照提供：被剔除的节点不参与任何策略；全部不可用时忽略掩码（fail open）。
+ */
+class NodeBalancer
+{
+public:
+    /**
+     * @param load_factor ConsistentHash 的负载上限系数 c：节点负载不超过 c * 平均值（按 weight 缩放）
+     */
+    NodeBalancer(BalanceStrategy strategy, std::vector<NodeEndpoint> nodes, double load_factor = 1.25);
+
+    NodeBalancer(const NodeBalancer&) = delete;
+    NodeBalancer& operator=(const NodeBalancer&) = delete;
+
+    /**
+     * @brief 选择节点并计入一次分配
+     * @param key 放置键（stream_key），仅 ConsistentHash 使用；为空时退化为 least_tasks
+     * @param eligible 与 nodes() 下标对应的可用掩码（0 = 不可用），nullptr 或越界的下标视为可用
+     * @return 节点列表为空时返回 nullptr
+     */
+    [[nodiscard]] const NodeEndpoint* select(std::string_view key = {},
+                                             const std::vector<uint8_t>* eligible = nullptr) noexcept;
+
+    /**
+     * @brief 撤销一次 select() 计入的分配（选中节点后注册失败）；计数不会减到 0 以下
+     * @param node select() 的返回值；nullptr 或不属于本实例的指针忽略
+     */
+    void release(const NodeEndpoint* node) noexcept;
+
+    /**
+     * @brief 用存储层的最新快照覆盖负载表；不在 loads 中的节点视为空载
+     */
+    void updateLoads(const std::vector<NodeLoad>& loads);
+
+    // 当前负载表（与 nodes() 下标对应），用于监控与模拟
+    [[nodiscard]] std::vector<uint64_t> loads() const;
+
+    [[nodiscard]] const std::vector<NodeEndpoint>& nodes() const noexcept
+    {
+        return _nodes;
+    }
+
+    [[nodiscard]] BalanceStrategy strategy() const noexcept
+    {
+        return _strategy;
+    }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> load{0};
+    };
+
+    // a 是否比 b 更空闲（按 weight 归一化）
+    [[nodiscard]] bool lighter(size_t a, uint64_t la, size_t b, uint64_t lb) const noexcept;
+    [[nodiscard]] static bool usable(const std::vector<uint8_t>* eligible, size_t index) noexcept
+    {
+        return eligible == nullptr || index >= eligible->size() || (*eligible)[index] != 0;
+    }
+
+    [[nodiscard]] size_t nextRoundRobin(const std::vector<uint8_t>* eligible) noexcept;
+    [[nodiscard]] size_t scanLightest(const std::vector<uint8_t>* eligible) noexcept;
+    [[nodiscard]] size_t pickTwo(const std::vector<uint8_t>* eligible, size_t usable_count) const noexcept;
+    [[nodiscard]] size_t pickByHash(std::string_view key, const std::vector<uint8_t>* eligible) const noexcept;
+
+    const BalanceStrategy _strategy;
+    const std::vector<NodeEndpoint> _nodes;
+    const double _loadFactor;
+    std::vector<uint64_t> _nodeHashes; // host:port 的哈希，只与节点自身有关，增删其它节点不影响排名
+    uint64_t _totalWeight = 0;
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<size_t> _cursor{0}; // 轮询位置；负载相同时作为扫描起点，避免总是落在第一个节点
+};
+#endif //STREAMGATE_NODEBALANCER_H
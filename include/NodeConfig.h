@@ -5,6 +5,8 @@
 #ifndef STREAMGATE_NODECONFIG_H
 #define STREAMGATE_NODECONFIG_H
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <vector>
 #include <atomic>
 #include <nlohmann/json.hpp>
@@ -14,11 +16,12 @@ using json = nlohmann::json;
 struct NodeEndpoint
 {
     std::string host;
-    int port;
+    int port = 0;
+    int weight = 1; // 加权调度用的相对容量，nodes.json 中可省略
 
     [[nodiscard]] bool isValid() const
     {
-        return !host.empty() && port > 0 && port <= 65535;
+        return !host.empty() && port > 0 && port <= 65535 && weight > 0;
     }
 
     [[nodiscard]] std::string toString() const
@@ -27,7 +30,7 @@ struct NodeEndpoint
     }
 };
 
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(NodeEndpoint, host, port)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(NodeEndpoint, host, port, weight)
 
 class NodeConfig
 {
@@ -66,6 +69,10 @@ public:
 
     static NodeConfig fromJsonFile(const std::string& filepath, const ValidationOptions& opts = ValidationOptions());
     static Category stringToCategory(const std::string& category);
+    static std::string_view categoryName(Category category) noexcept; // rtmp_srt / http_hls / webrtc
+
+    // 节点列表（含顺序与 weight）的指纹：热加载时用于判断两个组件看到的是否为同一版 nodes.json
+    [[nodiscard]] uint64_t fingerprint() const noexcept;
 
     NodeEndpoint getRoundRobinEndpoint(Category cat) const;
     NodeEndpoint getRandomEndpoint(Category cat) const;
@@ -0,0 +1,42 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_NODEHEALTHMETRICSPROVIDER_H
+#define STREAMGATE_NODEHEALTHMETRICSPROVIDER_H
+#include "IMetricsProvider.h"
+
+// 前向声明
+class NodeHealthProber;
+
+/**
+ * @brief 媒体节点健康探测指标提供者
+ * * 导出 streamgate_node_up / streamgate_node_probe_latency_ms 两个 gauge 与
+ * * streamgate_node_probe_failures_total / streamgate_node_ejections_total 两个 counter，标签为 {category,node}。
+ */
+class NodeHealthMetricsProvider final : public IMetricsProvider
+{
+public:
+    explicit NodeHealthMetricsProvider(const NodeHealthProber* prober = nullptr)
+        : _prober(prober)
+    {
+    }
+
+    ~NodeHealthMetricsProvider() override = default;
+
+    REGISTER_METRICS_NAME("node_health_metrics")
+
+    /**
+     * @brief 注入探测器实例
+     */
+    void setProber(const NodeHealthProber* prober) noexcept
+    {
+        _prober = prober;
+    }
+
+    void refresh() noexcept override;
+
+private:
+    const NodeHealthProber* _prober; // 观察者指针
+};
+#endif //STREAMGATE_NODEHEALTHMETRICSPROVIDER_H
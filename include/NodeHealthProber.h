@@ -0,0 +1,155 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_NODEHEALTHPROBER_H
+#define STREAMGATE_NODEHEALTHPROBER_H
+#include "NodeConfig.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 媒体节点健康状态
+ */
+enum class NodeHealthState
+{
+    Healthy, // 参与调度
+    Ejected, // 已剔除，剔除期满后进入 HalfOpen
+    HalfOpen // 试探期：连续成功 readmit_successes 次后重新接纳，任一失败即再次剔除（时长翻倍）
+};
+
+std::string_view nodeHealthStateName(NodeHealthState state) noexcept;
+
+struct NodeProbeStatus
+{
+    NodeConfig::Category category = NodeConfig::Category::UNKNOWN;
+    NodeEndpoint endpoint;
+    NodeHealthState state = NodeHealthState::Healthy;
+    double ewma_ms = 0; // 探测延迟 EWMA，0 表示尚无成功样本
+    uint32_t consecutive_failures = 0;
+    uint32_t consecutive_successes = 0;
+    uint64_t probes = 0;
+    uint64_t failures = 0;
+    uint64_t ejections = 0;
+    std::string last_error;
+};
+
+/**
+ * @brief 不可变的健康快照（RCU：探测线程整体替换，读者持有 shared_ptr 期间内容不变）
+ */
+struct NodeHealthSnapshot
+{
+    static constexpr size_t kCategoryCount = 3; // RTMP_SRT / HTTP_HLS / WEBRTC
+
+    std::vector<NodeProbeStatus> nodes;
+    // 按 Category 下标，与 NodeConfig 中对应列表逐项对应：1 = 可调度
+    std::array<std::vector<uint8_t>, kCategoryCount> eligible;
+    uint64_t round = 0;
+    uint64_t topology = 0; // 对应 NodeConfig::fingerprint()；与调度器的节点表不一致时掩码无效
+
+    [[nodiscard]] const std::vector<uint8_t>* eligibleFor(NodeConfig::Category category) const noexcept
+    {
+        const auto index = static_cast<size_t>(category);
+        return index < kCategoryCount ? &eligible[index] : nullptr;
+    }
+};
+
+/**
+ * @brief 媒体节点主动健康探测 (对标 HealthChecker，但面向 nodes.json 中的边缘节点)
+ * * 职责：
+ * 1. 后台线程按周期并发探测所有节点：非阻塞 connect + poll，可选 HTTP GET（2xx/3xx 视为成功）。
+ * 2. 连续失败 failure_threshold 次剔除；延迟 EWMA 超过健康节点中位数 outlier_factor 倍的离群节点同样剔除（受 max_ejection_percent 约束）。
+ * 3. 剔除期满进入 HalfOpen 试探，成功后重新接纳；试探失败则剔除时长指数退避。
+ * 4. 每轮结束发布新的 NodeHealthSnapshot；调度器只做一次原子 load，不加锁、不等待探测。
+ * * 初始状态全部 Healthy，启动阶段不会因为尚未探测而拒绝调度。
+ */
+class NodeHealthProber
+{
+public:
+    struct Config
+    {
+        std::chrono::milliseconds interval{2000};
+        std::chrono::milliseconds timeout{500}; // 单轮探测的总超时（所有节点并发）
+        std::string http_path; // 为空则只做 TCP connect
+        int http_port = 0; // HTTP 探测端口，0 = 节点自身端口
+        uint32_t failure_threshold = 3;
+        uint32_t readmit_successes = 2;
+        double ewma_alpha = 0.3;
+        double outlier_factor = 3.0;
+        std::chrono::milliseconds outlier_min_latency{50}; // 低于此值的 EWMA 不判离群，避免 1ms vs 3ms 的误判
+        uint32_t max_ejection_percent = 50; // 仅约束离群剔除；连接失败的节点总是剔除
+        std::chrono::milliseconds base_ejection{10000};
+        std::chrono::milliseconds max_ejection{300000};
+    };
+
+    NodeHealthProber(const NodeConfig& nodes, Config cfg);
+    ~NodeHealthProber();
+
+    NodeHealthProber(const NodeHealthProber&) = delete;
+    NodeHealthProber& operator=(const NodeHealthProber&) = delete;
+
+    void start();
+    void stop();
+
+    /**
+     * @brief 同步执行一轮探测并发布快照（后台线程与单元测试共用）
+     */
+    void probeOnce();
+
+    /**
+     * @brief 热加载 nodes.json：保留仍在列表中的节点的探测状态，新节点视为健康
+     */
+    void updateNodes(const NodeConfig& nodes);
+
+    [[nodiscard]] std::shared_ptr<const NodeHealthSnapshot> snapshot() const noexcept
+    {
+        return _snapshot.load(std::memory_order_acquire);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct NodeState
+    {
+        NodeProbeStatus status;
+        Clock::time_point ejected_until{};
+        uint32_t backoff_level = 0;
+    };
+
+    struct ProbeResult
+    {
+        bool ok = false;
+        double latency_ms = 0;
+        std::string error;
+    };
+
+    void assignNodes(const NodeConfig& nodes);
+    [[nodiscard]] std::vector<ProbeResult> probeAll(const std::vector<size_t>& targets) const;
+    void applyResult(NodeState& node, const ProbeResult& result, Clock::time_point now);
+    void ejectOutliers(Clock::time_point now);
+    void eject(NodeState& node, Clock::time_point now, const std::string& reason);
+    void publish();
+    void run(const std::stop_token& stoken);
+
+    const Config _config;
+
+    std::mutex _probeMutex; // 串行化 probeOnce；保护 _nodes 与 _round
+    std::vector<NodeState> _nodes;
+    uint64_t _round = 0;
+    uint64_t _topology = 0;
+
+    std::atomic<std::shared_ptr<const NodeHealthSnapshot>> _snapshot;
+
+    std::mutex _wakeMutex;
+    std::condition_variable_any _wakeCondition;
+    std::jthread _worker;
+};
+#endif //STREAMGATE_NODEHEALTHPROBER_H
@@ -0,0 +1,46 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_PROMETHEUSWRITER_H
+#define STREAMGATE_PROMETHEUSWRITER_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Prometheus 文本格式 (text/plain; version=0.0.4) 渲染工具
+ * * 只在监控刷新线程中调用：Provider 在 refresh() 里渲染好字节缓冲区，抓取时直接拼接，不再解析 JSON。
+ * * 命名规则：streamgate_<组件名去掉 _metrics 后缀>_<JSON 路径>，非法字符统一替换为 '_'。
+ */
+class PrometheusWriter
+{
+public:
+    static constexpr std::string_view kContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+    /**
+     * @brief 将 JSON 快照展平为样本行
+     * * 数值 -> 样本；布尔 -> 0/1；字符串 -> <name>_info{value="..."} 1；数组与 null 忽略
+     */
+    static void appendJson(std::string& out, std::string_view prefix, const nlohmann::json& j);
+
+    static void appendType(std::string& out, std::string_view name, std::string_view type);
+    static void appendSample(std::string& out, std::string_view name, uint64_t value, std::string_view labels = {});
+    static void appendSample(std::string& out, std::string_view name, double value, std::string_view labels = {});
+
+    /**
+     * @brief 组件名 -> 指标前缀，例如 "auth_metrics" -> "streamgate_auth"
+     */
+    static std::string metricPrefix(std::string_view component);
+
+    /**
+     * @brief 按 Prometheus 规则转义标签值 (\\ " \n)
+     */
+    static void appendLabelValue(std::string& out, std::string_view value);
+
+private:
+    static void appendName(std::string& out, std::string_view name);
+    static void appendJsonImpl(std::string& out, std::string& name, const nlohmann::json& j);
+};
+#endif //STREAMGATE_PROMETHEUSWRITER_H
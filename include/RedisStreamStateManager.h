@@ -6,7 +6,12 @@
 #define STREAMGATE_REDISSTREAMSTATEMANAGER_H
 #include "CacheManager.h"
 #include "IStreamStateManager.h"
+#include "TimingWheel.h"
+#include <atomic>
+#include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <optional>
 #include <chrono>
@@ -22,7 +27,7 @@ enum class StreamType;
 *  - 任务注册 / 注销
  * - 心跳更新（touch）
  * - 超时扫描回收
- * - 索引维护：active_pubs 集合、players 集合、stream/player_count 计数器、全局在线人数
+ * - 索引维护：active_pubs 集合、stream:members 集合、按 client 分片的全局在线人数计数器
  *
  *  线程安全：假设由外部保证同步，或依赖 Redis 操作的原子性
  */
@@ -30,12 +35,22 @@ class RedisStreamStateManager : public IStreamStateManager
 {
 public:
     static constexpr int TASK_TTL_SEC = 60;
+    // 全局在线人数拆成 global_players:<0..N-1>，按 client_id 哈希选择；所有网关必须一致，读取时求和
+    static constexpr size_t PLAYER_COUNTER_SHARDS = 16;
 
     /**
      * @brief 构造函数
      * @param cacheMgr  已连接的 CacheManager 实例（Redis 客户端封装）
      */
     explicit RedisStreamStateManager(CacheManager& cacheMgr);
+    ~RedisStreamStateManager() override;
+
+    /**
+     * @brief 启用在线人数本地聚合：后台线程每 refresh_interval 汇总一次（2 次往返），
+     *        之后 getActivePlayerCount / getPlayerCount 只读本地快照，最多滞后一个刷新周期
+     * * 未启用时两者每次直接访问 Redis
+     */
+    void enablePlayerCountCache(std::chrono::milliseconds refresh_interval);
 
     [[nodiscard]] std::vector<std::string> getStreamClientIds(const std::string& stream_name) const override;
 
@@ -44,7 +59,8 @@ public:
     /**
      *@brief  注册一个新任务（Publisher 或 Player）
      * @param task
-     * @return  成功返回 true；失败时已完整回滚所有副作用，返回 false
+     * @return  成功返回 true；失败时不产生任何副作用，返回 false
+     * @note  推流位校验、旧状态清理、任务写入、TTL、索引与超时 ZSet 由单个 Lua 脚本原子完成（1 次往返）
      */
     bool registerTask(const StreamTask& task) override;
 
@@ -65,6 +81,11 @@ public:
 
     [[nodiscard]] std::optional<StreamTask> getPublisherTask(const std::string& stream_name) const override;
 
+    /**
+     * @brief HMGET pub:<stream> active client_id server_ip server_port（1 次往返），不解码任务记录
+     */
+    [[nodiscard]] std::optional<PublisherLocation> getPublisherLocation(const std::string& stream_name) const override;
+
     [[nodiscard]] std::vector<StreamTask> getPlayerTasks(const std::string& stream_name) const;
 
     [[nodiscard]] std::vector<StreamTask> getAllPublisherTasks() const override;
@@ -82,45 +103,112 @@ public:
     /**
      *@brief 扫描并回收超时任务，同时清理其所有索引
      * @param timeout
-     * @return 返回已回收的任务列表（可用于日志或通知）
+     * @param options 分页大小与单轮时间预算
+     * @return 返回已回收的任务列表（可用于日志或通知）及预算用尽时的剩余积压
+     * @note  每页 3 次往返：ZRANGEBYSCORE ... LIMIT 取候选 -> Pipeline HGET last_active_time_ms 预检查
+     *        -> 单个 Lua 脚本原子完成 ZREM 抢占、二次校验、注销与分数修正
+     */
+    TimeoutScanResult scanTimeoutTasks(std::chrono::milliseconds timeout, const TimeoutScanOptions& options) override;
+
+    /**
+     * @brief 启用进程内超时时间轮：本实例 register / touch 的任务在 timeout 后由 expireDueTasks 回收
+     * * 需在任何任务注册之前调用；Redis 仍是跨实例的权威状态，到期任务提交前会在脚本内再次校验
+     */
+    void enableLocalExpiry(std::chrono::milliseconds timeout, std::chrono::milliseconds tick) override;
+
+    /**
+     * @brief 推进时间轮并提交到期任务（每批 2 次往返）；没有到期项时不访问 Redis
+     * * 已被其它实例续期的任务按剩余时间重新登记
+     */
+    TimeoutScanResult expireDueTasks(std::chrono::milliseconds timeout) override;
+
+    /**
+     * @brief 处理 task:<stream>:<client> 的过期通知：单个 Lua 脚本清理推流位 / 成员 / 计数 / 超时 ZSet（1 次往返）
+     * * hash 已被删除，类型由 pub:<stream> 的持有者推断；ZREM task_timestamps 成功者获得清理权
+     */
+    std::optional<StreamTask> reclaimExpiredTask(const std::string& stream_name,
+                                                 const std::string& client_id) override;
+
+    //批量写入（写回缓存的后台刷新线程调用）
+
+    /**
+     * @brief 一次 Pipeline 发送全部注册脚本（EVALSHA），1 次往返
+     * @return 成功注册的任务数
+     * @note  NOSCRIPT 或 Pipeline 故障时逐个回退到 registerTask；注册脚本幂等，重复执行无副作用
+     */
+    size_t registerTasksBatch(const std::vector<StreamTask>& tasks, std::vector<bool>* results = nullptr) override;
+
+    /**
+     * @brief 一次 Pipeline 刷新全部任务的活跃时间与 TTL，1 次往返
+     * @return 仍存在的任务数；已过期 / 已注销的任务由 HSET 的返回值识别，顺带删除误建的残留 hash
      */
-    std::vector<StreamTask> scanTimeoutTasks(std::chrono::milliseconds timeout) override;
+    [[nodiscard]] size_t touchTasksBatch(const std::vector<TaskIdentifier>& tasks,
+                                         std::vector<bool>* results = nullptr) const override;
 
     //统计信息
 
     [[nodiscard]] size_t getActivePublisherCount() const override; // 当前活跃 Publisher 数量
 
-    [[nodiscard]] size_t getActivePlayerCount() const override; // 全局在线 Player 总数
+    [[nodiscard]] size_t getActivePlayerCount() const override; // 全局在线 Player 总数（各分片之和）
+
+    [[nodiscard]] size_t getPlayerCount(const std::string& stream_name) const override; // 某 stream 的在线观众数
 
-    [[nodiscard]] size_t getPlayerCount(const std::string& stream_name) const; // 某 stream 的在线观众数
+    /**
+     * @brief SMEMBERS active_pubs + 一次 Pipeline (每个流 HMGET pub + SCARD members)，共 2 次往返
+     */
+    [[nodiscard]] std::vector<NodeLoad> getNodeLoads() const override;
 
     //健康检查
 
     [[nodiscard]] bool isHealthy() const override; // 检查底层 Redis 连接是否正常
 private:
+    // 在线人数快照：发布后不再修改，读取方持有 shared_ptr 即可无锁访问
+    struct PlayerCounts
+    {
+        size_t total = 0;
+        std::unordered_map<std::string, size_t> per_stream; // 仅包含有推流端的流
+    };
+
     //成员变量
     CacheManager& _cacheManager; // 底层 Redis 客户端引用
+    RedisScript _registerScript; // registerTask 原子注册脚本（构造时预加载）
+    RedisScript _timeoutCommitScript; // 超时扫描单页提交脚本（构造时预加载）
+    RedisScript _expiredTaskScript; // 过期通知清理脚本（构造时预加载）
+    std::unique_ptr<TimingWheel> _expiryWheel; // 为空表示只依赖 ZSet 扫描
+    std::chrono::milliseconds _expiryTimeout{0};
+    std::atomic<std::shared_ptr<const PlayerCounts>> _playerCounts; // 为空表示未启用本地聚合
 
-    //索引注册/注销逻辑
-    bool registerPublisherIndices(const StreamTask& task) const; // 注册 Publisher 相关索引
-    bool registerPlayerIndices(const StreamTask& task) const; // 注册 Player 相关索引
-
-    void deregisterPublisherIndices(const std::string& stream_name) const; // 清理 Publisher 索引
-    void deregisterPlayerIndices(const std::string& stream_name, const std::string& client_id) const; // 清理 Player 索引
+    //索引注销逻辑
 
     size_t deregisterTasksBatch(const std::vector<TaskIdentifier>& tasks) override;
 
     //内部辅助函数
-    [[nodiscard]] std::optional<StreamTask> getTaskByKey(const std::string& task_key) const; // 通过完整 key 加载任务
+    void commitTimeoutCandidates(const std::vector<std::string>& candidates, int64_t cutoff_ms,
+                                 std::vector<StreamTask>& expired,
+                                 std::vector<std::pair<std::string, int64_t>>* refreshed) const;
+    void armExpiry(const std::string& task_key) const; // 登记 / 刷新本地时间轮
+    // HMGET 读取紧凑编码的任务（1 次往返）；client_id 为空时取 hash 中的 client_id 字段（推流位）
+    // 升级前写入的多字段 hash 回退到 HGETALL 按旧格式解析
+    [[nodiscard]] std::optional<StreamTask> loadTask(const std::string& key, const std::string& stream_name,
+                                                     const std::string& client_id) const;
+    // 汇总各计数分片；with_streams 时一并取每条推流中的流的成员数
+    [[nodiscard]] std::shared_ptr<const PlayerCounts> loadPlayerCounts(bool with_streams) const;
+    // 组装注册脚本的 KEYS / ARGV
+    static void buildRegisterCall(const StreamTask& task, int64_t now_ms,
+                                  std::vector<std::string>& keys, std::vector<std::string>& args);
 
     //Redis Key 构造器（统一命名规范）
     [[nodiscard]] static std::string buildTaskKey(const std::string& stream_name, const std::string& client_id);
     //task:stream:client
     [[nodiscard]] static std::string buildPublisherKey(const std::string& stream_name); //pub:stream
-    [[nodiscard]] static std::string buildPlayerSetKey(const std::string& stream_name); //players:stream
+    [[nodiscard]] static std::string buildStreamMembersKey(const std::string& stream_name); //stream:members:stream
     [[nodiscard]] static std::string buildStreamMetaKey(const std::string& stream_name); //meta:stream
     [[nodiscard]] static std::string buildActivePublishersKey(); //active_pubs (global set)
-    [[nodiscard]] static std::string buildGlobalPlayerCountKey(); //global_players(hash with "total")
+    [[nodiscard]] static std::string buildPlayerCountShardKey(const std::string& client_id);
+    //global_players:<shard>(hash with "total")
+    [[nodiscard]] static std::string buildPlayerCountShardKey(size_t shard);
     [[nodiscard]] static std::string buildTaskTimestampZSetKey(); //task_timestamp(zset for time out)
+
+    std::jthread _countRefresher; // 最后声明：先于其它成员停止
 };
 #endif //STREAMGATE_REDISSTREAMSTATEMANAGER_H
@@ -5,33 +5,75 @@
 #ifndef STREAMGATE_SERVERMETRICSPROVIDER_H
 #define STREAMGATE_SERVERMETRICSPROVIDER_H
 #include "IMetricsProvider.h"
+#include "ZlmHookCommon.h"
 #include <array>
 #include <atomic>
+#include <mutex>
 #include <optional>
 
 /**
- * @brief 强一致性统计槽位
+ * @brief 单个 HookAction 的计数值（读出后的普通副本）
  */
-struct alignas(64) WorkerStatsSlot
+struct ActionCounters
+{
+    uint64_t requests = 0;
+    uint64_t success = 0;
+    uint64_t failed = 0;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+
+    ActionCounters& operator+=(const ActionCounters& o) noexcept
+    {
+        requests += o.requests;
+        success += o.success;
+        failed += o.failed;
+        bytes_in += o.bytes_in;
+        bytes_out += o.bytes_out;
+        return *this;
+    }
+};
+
+/**
+ * @brief 强一致性统计组：一个 HookAction 独占一条缓存行
+ * * add() 为单写者路径：seqlock + relaxed load/store，不使用 RMW 指令。
+ * * fetchAdd() 为多写者路径（仅用于未认领槽位的线程与历史归并），不改动 seq。
+ */
+struct alignas(64) ActionStatsGroup
 {
     std::atomic<uint64_t> seq{0};
-    uint64_t total_requests{0};
-    uint64_t success_requests{0};
-    uint64_t failed_requests{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> success{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> bytes_in{0};
+    std::atomic<uint64_t> bytes_out{0};
 
-    void update(uint64_t t, uint64_t s, uint64_t f) noexcept;
-    void read(uint64_t& t, uint64_t& s, uint64_t& f) const noexcept;
+    void add(const ActionCounters& delta) noexcept;
+    void fetchAdd(const ActionCounters& delta) noexcept;
+    [[nodiscard]] ActionCounters read() const noexcept;
+    void reset() noexcept;
 
 private:
     //偏执校验：确保不同平台下的布局严格锁定为一个 Cacheline
-    [[maybe_unused]] std::byte _padding[64 - 32]{};
+    [[maybe_unused]] std::byte _padding[64 - 48]{};
     static_assert(sizeof(std::atomic<uint64_t>) == 8);
 };
 
-static_assert(sizeof(WorkerStatsSlot) == 64, "WorkerStatsSlot must be exactly 64 bytes to prevent false sharing");
+static_assert(sizeof(ActionStatsGroup) == 64, "ActionStatsGroup must be exactly 64 bytes to prevent false sharing");
+
+/**
+ * @brief 线程槽位：每个 HookAction 一个统计组
+ */
+struct WorkerStatsSlot
+{
+    std::array<ActionStatsGroup, kHookActionCount> actions;
+
+    void reset() noexcept;
+};
 
 /**
  * @brief 线程局部注册表
+ * * io 线程与 ThreadPool worker 启动时 bindCurrentThread() 认领槽位，退出时 unbindCurrentThread() 归还；
+ * * 归还时计数并入历史组，保证 counter 单调。未认领槽位的线程（或槽位耗尽）退化为共享原子累加。
  */
 class ThreadLocalRegistry
 {
@@ -41,13 +83,55 @@ public:
 
     std::optional<size_t> acquireSlot();
     void releaseSlot(size_t id);
+
+    /**
+     * @brief 为当前线程认领槽位并缓存到 thread_local；重复调用无副作用
+     * @return false 表示槽位耗尽，该线程的记录走共享路径
+     */
+    bool bindCurrentThread();
+    void unbindCurrentThread();
+
+    // --- 请求路径记录入口：均只写当前线程的槽位 ---
+    void recordRequest(HookAction action, uint64_t bytes_in) noexcept;
+    void recordResult(HookAction action, bool ok) noexcept;
+    void recordBytesOut(HookAction action, uint64_t bytes_out) noexcept;
+
+    using Snapshot = std::array<ActionCounters, kHookActionCount>;
+    void aggregate(Snapshot& out) const noexcept;
     void aggregate(uint64_t& t, uint64_t& s, uint64_t& f) const noexcept;
 
 private:
     ThreadLocalRegistry() = default;
+
+    void record(HookAction action, const ActionCounters& delta) noexcept;
+
     alignas(64) std::array<WorkerStatsSlot, kMaxWorkers> _slots;
     alignas(64) std::atomic<uint64_t> _active_mask[2]{0, 0};
+
+    // 认领 / 归还 / 汇总互斥：归还时"清零 + 并入历史"对汇总方必须原子可见，否则 counter 会短暂回退
+    mutable std::mutex _membership_mutex;
     WorkerStatsSlot _historical_stats;
+    WorkerStatsSlot _shared_stats; // 未认领槽位线程的多写者计数
+};
+
+/**
+ * @brief RAII：线程入口处认领槽位，退出时归还
+ */
+class ScopedWorkerStats
+{
+public:
+    ScopedWorkerStats()
+    {
+        ThreadLocalRegistry::instance().bindCurrentThread();
+    }
+
+    ~ScopedWorkerStats()
+    {
+        ThreadLocalRegistry::instance().unbindCurrentThread();
+    }
+
+    ScopedWorkerStats(const ScopedWorkerStats&) = delete;
+    ScopedWorkerStats& operator=(const ScopedWorkerStats&) = delete;
 };
 
 class ServerMetricsProvider final : public IMetricsProvider
@@ -0,0 +1,161 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_SINGLEFLIGHT_H
+#define STREAMGATE_SINGLEFLIGHT_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief 请求合并器 (Single-Flight)
+ * * 职责：
+ * 1. 同一 key 同一时刻只允许一个调用方 (leader) 真正执行加载函数。
+ * 2. 在途期间到达、且 tag 相同的调用方 (waiter) 挂起等待，直接复用 leader 的结果。
+ * 3. tag 不同的调用方同样等待在途调用结束，随后重新竞争 leader（同一 key 的加载严格串行）。
+ * * tag 用于区分"同 key 但结果不可共享"的请求，例如同一 stream/client 使用了不同的 Token。
+ * * 注意：leader 抛出的异常会原样传播给所有共享结果的 waiter。
+ */
+template <typename T>
+class SingleFlight
+{
+public:
+    struct Stats
+    {
+        uint64_t leaders; // 真正执行加载的次数
+        uint64_t coalesced_waiters; // 复用在途结果的次数
+        uint64_t serialized_waiters; // tag 不同、等待后重新竞争的次数
+        uint64_t waiting; // 当前挂起中的 waiter 数
+        uint64_t in_flight; // 当前在途的 key 数
+    };
+
+    SingleFlight() = default;
+    SingleFlight(const SingleFlight&) = delete;
+    SingleFlight& operator=(const SingleFlight&) = delete;
+
+    template <typename Fn>
+    T execute(const std::string& key, const std::string& tag, Fn&& fn)
+    {
+        while (true)
+        {
+            std::shared_ptr<Call> call;
+            bool leader = false;
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto [it, inserted] = _calls.try_emplace(key);
+                if (inserted)
+                {
+                    it->second = std::make_shared<Call>(tag);
+                    leader = true;
+                }
+                call = it->second;
+            }
+
+            if (leader)
+            {
+                _leaders.fetch_add(1, std::memory_order_relaxed);
+                try
+                {
+                    T result = fn();
+                    complete(key, call, result, nullptr);
+                    return result;
+                }
+                catch (...)
+                {
+                    complete(key, call, std::nullopt, std::current_exception());
+                    throw;
+                }
+            }
+
+            // Call::tag 创建后不再修改，无需加锁读取
+            const bool shareable = (call->tag == tag);
+            (shareable ? _coalescedWaiters : _serializedWaiters).fetch_add(1, std::memory_order_relaxed);
+
+            _waiting.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::unique_lock<std::mutex> lock(call->mutex);
+                call->cv.wait(lock, [&call] { return call->done; });
+            }
+            _waiting.fetch_sub(1, std::memory_order_relaxed);
+
+            if (shareable)
+            {
+                if (call->error)std::rethrow_exception(call->error);
+                return *call->result;
+            }
+        }
+    }
+
+    [[nodiscard]] Stats getStats() const
+    {
+        Stats s{};
+        s.leaders = _leaders.load(std::memory_order_relaxed);
+        s.coalesced_waiters = _coalescedWaiters.load(std::memory_order_relaxed);
+        s.serialized_waiters = _serializedWaiters.load(std::memory_order_relaxed);
+        s.waiting = _waiting.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            s.in_flight = _calls.size();
+        }
+        return s;
+    }
+
+    void resetStats()
+    {
+        _leaders = 0;
+        _coalescedWaiters = 0;
+        _serializedWaiters = 0;
+    }
+
+private:
+    struct Call
+    {
+        explicit Call(std::string t)
+            : tag(std::move(t))
+        {
+        }
+
+        const std::string tag;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        std::optional<T> result;
+        std::exception_ptr error;
+    };
+
+    void complete(const std::string& key, const std::shared_ptr<Call>& call, std::optional<T> result,
+                  std::exception_ptr error)
+    {
+        //先摘除在途记录：此后到达的调用方会发起新一轮加载，而不是拿到旧结果
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _calls.erase(key);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(call->mutex);
+            call->result = std::move(result);
+            call->error = std::move(error);
+            call->done = true;
+        }
+        call->cv.notify_all();
+    }
+
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, std::shared_ptr<Call>> _calls;
+
+    std::atomic<uint64_t> _leaders{0};
+    std::atomic<uint64_t> _coalescedWaiters{0};
+    std::atomic<uint64_t> _serializedWaiters{0};
+    std::atomic<uint64_t> _waiting{0};
+};
+#endif //STREAMGATE_SINGLEFLIGHT_H
@@ -0,0 +1,41 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_STATEMETRICSPROVIDER_H
+#define STREAMGATE_STATEMETRICSPROVIDER_H
+#include "IMetricsProvider.h"
+
+// 前向声明
+class WriteBehindStreamStateManager;
+
+/**
+ * @brief 状态写回层指标提供者
+ * 负责导出待写队列深度、合并率、批大小与刷新延迟 (flush lag)
+ */
+class StateMetricsProvider final : public IMetricsProvider
+{
+public:
+    explicit StateMetricsProvider(const WriteBehindStreamStateManager* manager = nullptr)
+        : _manager(manager)
+    {
+    }
+
+    ~StateMetricsProvider() override = default;
+
+    REGISTER_METRICS_NAME("state_metrics")
+
+    /**
+     * @brief 注入写回层实例（未启用写回时保持 nullptr）
+     */
+    void setManager(const WriteBehindStreamStateManager* manager) noexcept
+    {
+        _manager = manager;
+    }
+
+    void refresh() noexcept override;
+
+private:
+    const WriteBehindStreamStateManager* _manager; // 观察者指针
+};
+#endif //STREAMGATE_STATEMETRICSPROVIDER_H
@@ -8,6 +8,8 @@
 #include "AuthManager.h"
 #include "StreamTask.h"
 #include "NodeConfig.h"
+#include "NodeBalancer.h"
+#include "NodeHealthProber.h"
 #include <atomic>
 #include <thread>
 #include <mutex>
@@ -23,6 +25,17 @@ public:
     {
         std::chrono::seconds cleanup_interval{30};
         std::chrono::seconds task_timeout{60};
+        // 超时扫描按页提交；单轮超出预算时剩余积压在 cleanup_time_budget 后继续，而不是等满 cleanup_interval
+        size_t cleanup_page_size = 256;
+        std::chrono::milliseconds cleanup_time_budget{500};
+        // > 0 时每个 tick 调用 IStreamStateManager::expireDueTasks（进程内时间轮），cleanup_interval 的全量扫描退为兜底
+        std::chrono::milliseconds expiry_tick{0};
+
+        // 推流节点选择策略（按集群分别配置）；RoundRobin 以外的策略依赖负载表刷新线程
+        BalanceStrategy rtmp_srt_strategy = BalanceStrategy::LeastTasks;
+        BalanceStrategy http_hls_strategy = BalanceStrategy::LeastTasks;
+        double hash_load_factor = 1.25; // ConsistentHash 的负载上限系数
+        std::chrono::milliseconds load_refresh_interval{2000};
     };
 
     /**
@@ -57,6 +70,8 @@ public:
         uint64_t success_play;
         uint64_t auth_failures;
         uint64_t tasks_cleaned;
+        uint64_t timeout_backlog; // 最近一轮超时扫描结束时仍未处理的超时任务数
+        uint64_t keyspace_expired; // 由过期通知回收的任务数（已计入 tasks_cleaned）
         uint64_t last_update_ms;
     };
 
@@ -86,10 +101,11 @@ public:
      * @param auth_token 认证 Token
      * @param protocol 推流协议
      * @param callback 异步回调
+     * @param trace 阶段计时上下文（可为空），交给 AuthManager 复制；鉴权之后的阶段经 HookTrace::current() 记录
      */
     void onPublish(const std::string& stream_name, const std::string& client_id,
                    const std::string& auth_token,
-                   StreamProtocol protocol, SchedulerCallback callback);
+                   StreamProtocol protocol, SchedulerCallback callback, HookTrace* trace = nullptr);
 
     /**
      *@brief  处理推流结束 (on_publish_done hook)
@@ -105,10 +121,11 @@ public:
      * @param auth_token
      * @param protocol
      * @param callback
+     * @param trace 同 onPublish
      */
     void onPlay(const std::string& stream_name, const std::string& client_id,
                 const std::string& auth_token,
-                StreamProtocol protocol, SchedulerCallback callback);
+                StreamProtocol protocol, SchedulerCallback callback, HookTrace* trace = nullptr);
 
     /**
      *@brief 处理拉流结束 (on_play_done hook)
@@ -117,6 +134,12 @@ public:
      */
     void onPlayDone(const std::string& stream_name, const std::string& client_id) const;
 
+    /**
+     * @brief 处理存储层的任务过期通知（TaskExpiryListener 经生命周期执行器投递，同一条流串行）
+     * * 清理过期任务的索引；推流端过期时联动清场。已由其它实例或超时扫描处理的通知直接忽略
+     */
+    void onTaskExpired(const std::string& stream_name, const std::string& client_id);
+
     // --- 生命周期管理 ---
     /**
      * @brief 启动调度器（启动超时清理定时器等）
@@ -130,30 +153,97 @@ public:
 
     Metrics getMetrics() const;
 
+    /**
+     * @brief 注入节点健康探测器；选点时跳过被剔除的节点
+     * * 需在 start() 之前调用，prober 的生命周期须长于调度器；传 nullptr 表示不做健康过滤
+     */
+    void setNodeHealth(const NodeHealthProber* prober) noexcept
+    {
+        _nodeHealth = prober;
+    }
+
+    /**
+     * @brief 热加载 nodes.json：构建新的节点表与负载表后原子替换
+     * * 正在处理的 Hook 继续使用旧节点表完成本次选择；仍存在的节点沿用原有负载计数
+     */
+    void updateNodes(const NodeConfig& nodes);
+
 private:
+    // nodes.json 的一个版本及其按协议划分的负载表；发布后节点列表不变，负载计数原子更新
+    struct NodeTopology
+    {
+        NodeTopology(const NodeConfig& nodes, const Config& cfg);
+
+        const uint64_t fingerprint;
+        NodeBalancer rtmp;
+        NodeBalancer http;
+    };
+
+    // 一次节点分配：析构时撤销 select() 计入的负载，注册成功后 commit() 保留；持有节点表，热加载后仍撤销到原表
+    class NodeReservation
+    {
+    public:
+        NodeReservation(std::shared_ptr<NodeTopology> topology, NodeBalancer* balancer, const NodeEndpoint* node)
+            : _topology(std::move(topology)), _balancer(balancer), _node(node)
+        {
+        }
+
+        ~NodeReservation()
+        {
+            if (_balancer)_balancer->release(_node);
+        }
+
+        NodeReservation(const NodeReservation&) = delete;
+        NodeReservation& operator=(const NodeReservation&) = delete;
+
+        // 节点表为空时沿用默认地址
+        [[nodiscard]] std::string host() const
+        {
+            return _node ? _node->host : "127.0.0.1";
+        }
+
+        [[nodiscard]] int port() const
+        {
+            return _node ? _node->port : 1935;
+        }
+
+        void commit() noexcept
+        {
+            _balancer = nullptr;
+        }
+
+    private:
+        std::shared_ptr<NodeTopology> _topology;
+        NodeBalancer* _balancer;
+        const NodeEndpoint* _node;
+    };
+
     static bool validateRequest(const std::string& stream_name, const std::string& client_id,
                                 const std::string& auth_token,
                                 const SchedulerCallback& callback);
     // 内部：选择最优节点
-    [[nodiscard]] std::pair<std::string, int> selectBestNode(StreamProtocol protocol);
+    [[nodiscard]] NodeReservation selectBestNode(StreamProtocol protocol, const std::string& stream_name);
     StreamTask createTask(const std::string& stream_name, const std::string& client_id, const std::string& auth_token,
                           StreamType type, StreamProtocol protocol, const std::string& ip, int port);
     void timeoutCleanupThread();
+    void handleExpiredTasks(const TimeoutScanResult& scan);
+    void loadRefreshThread();
 
     // 依赖项
     AuthManager& _authManager;
     IStreamStateManager& _stateManager;
-    NodeConfig _node_config;
     Config _config;
 
     // 运行状态
     std::atomic<bool> _running{false};
     std::thread _cleanup_thread;
+    std::thread _load_refresh_thread;
     std::mutex _cleanup_mutex;
     std::condition_variable _cleanup_cv;
 
-    // 轮询调度
-    std::atomic<size_t> _nodeIndex{0};
+    // 节点选择：按协议分集群，各自维护负载表；热加载时整体替换
+    std::atomic<std::shared_ptr<NodeTopology>> _topology;
+    const NodeHealthProber* _nodeHealth = nullptr;
     std::atomic<uint64_t> _nextTaskId{1000};
 
     // 统计指标
@@ -163,5 +253,7 @@ private:
     mutable std::atomic<uint64_t> _successPlay{0};
     mutable std::atomic<uint64_t> _authFail{0};
     mutable std::atomic<uint64_t> _tasksCleaned{0};
+    std::atomic<uint64_t> _timeoutBacklog{0};
+    std::atomic<uint64_t> _keyspaceExpired{0};
 };
 #endif //STREAMGATE_STREAMTASKSCHEDULER_H
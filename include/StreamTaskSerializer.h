@@ -6,9 +6,12 @@
 #define STREAMGATE_STREAMTASKSERIALIZER_H
 #include "StreamTask.h"
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <unordered_map>
 
 class StreamTaskSerializer
 {
@@ -26,6 +29,28 @@ public:
      */
     static std::optional<StreamTask> deserialize(const std::map<std::string, std::string>& fields);
 
+    // === 紧凑二进制编码（Redis 任务 hash 的 "d" 字段）===
+    static constexpr uint8_t COMPACT_VERSION = 1;
+
+    /**
+     * @brief 编码为版本化的紧凑二进制：定长头 + varint 整数 + 长度前缀字符串，枚举按固定编号存 1 字节
+     * * 不包含 stream_name / client_id / last_active_time：前两者由 key 给出，活跃时间是心跳与超时脚本
+     * * 直接读写的独立字段，避免每次心跳重写整块数据
+     */
+    static std::string encodeCompact(const StreamTask& task);
+
+    /**
+     * @brief 解码 encodeCompact 的结果，只覆盖编码中包含的字段，不分配中间容器
+     * @return 版本未知、数据截断或枚举越界时返回 false，task 处于未定义的部分写入状态
+     */
+    static bool decodeCompact(std::string_view data, StreamTask& task);
+
+    /**
+     * @brief 迁移读取：解析升级前写入的 16 字段 hash（HGETALL 结果）
+     * @return 必需字段缺失或时间戳不合理时返回 std::nullopt
+     */
+    static std::optional<StreamTask> decodeLegacyHash(const std::unordered_map<std::string, std::string>& fields);
+
 private:
     //辅助函数
     static std::string time_point_to_string(const std::chrono::system_clock::time_point& tp);
@@ -0,0 +1,81 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_TASKEXPIRYLISTENER_H
+#define STREAMGATE_TASKEXPIRYLISTENER_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+class CacheManager;
+class LifecycleExecutor;
+
+/**
+ * @brief Redis 键空间过期通知监听器：把 task:<stream>:<client> 的 TTL 过期转成索引清理
+ * * 职责：
+ * 1. 独占一条订阅连接 PSUBSCRIBE __keyevent@*__:expired，只转发 task: 前缀的 key；连接建立时确保服务端开启 Ex 通知。
+ * 2. 回调在监听线程上执行，应只做投递（如提交到 LifecycleExecutor），不要在这里访问 Redis。
+ * 3. 连接断开后按指数退避重连。Pub/Sub 不保证送达，断线期间的通知会丢失，由超时 ZSet 的对账扫描兜底。
+ * * 过期事件在 Redis 实际删除 key 时发出（访问触发或后台周期采样），通常滞后 TTL 不到一秒，key 很多时可能更久。
+ */
+class TaskExpiryListener
+{
+public:
+    using Handler = std::function<void(const std::string& stream_name, const std::string& client_id)>;
+
+    struct Config
+    {
+        std::chrono::milliseconds poll_timeout{500}; // consume() 的最长阻塞时间，决定 stop() 的响应延迟
+        std::chrono::milliseconds max_backoff{5000}; // 重连退避上限
+    };
+
+    TaskExpiryListener(CacheManager& cacheMgr, Handler handler);
+    TaskExpiryListener(CacheManager& cacheMgr, Handler handler, const Config& config);
+    ~TaskExpiryListener();
+
+    TaskExpiryListener(const TaskExpiryListener&) = delete;
+    TaskExpiryListener& operator=(const TaskExpiryListener&) = delete;
+
+    void start();
+    void stop();
+
+    // 收到并转发的 task: 过期通知数
+    [[nodiscard]] uint64_t eventCount() const noexcept
+    {
+        return _events.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 解析 task:<stream>:<client>；client_id 取最后一个 ':' 之后的部分
+     * @return 前缀不符或任一部分为空时返回 false
+     */
+    static bool parseTaskKey(std::string_view key, std::string& stream_name, std::string& client_id);
+
+    /**
+     * @brief 处理一条过期通知：task: 前缀的 key 解析后交给 handler，其余忽略；handler 抛出的异常在此吞掉
+     * * 由订阅回调在监听线程上调用，不依赖订阅连接本身
+     */
+    void dispatch(const std::string& key);
+
+    /**
+     * @brief 把 on_expired 包装成投递到 lifecycle 的 handler：按 stream_name 保序，与 Done 事件共用 lane
+     * * 投递失败（队列已满 / 执行器已停止）时丢弃（计入 lifecycle 的 rejected），由对账扫描回收；
+     * * 不在监听线程就地执行，否则会越过同一条流仍在排队的 Done 事件
+     */
+    static Handler postToLifecycle(LifecycleExecutor& lifecycle, Handler on_expired);
+
+private:
+    void run(const std::stop_token& stoken);
+
+    CacheManager& _cacheManager;
+    const Handler _handler;
+    const Config _config;
+    std::atomic<uint64_t> _events{0};
+    std::jthread _worker;
+};
+#endif //STREAMGATE_TASKEXPIRYLISTENER_H
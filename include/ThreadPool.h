@@ -14,16 +14,34 @@
 #include <atomic>
 #include <stop_token>
 
+#include "InlineTask.h"
 #include "Logger.h"
+#include "WorkStealingQueue.h"
 
 class ThreadPool
 {
 public:
+    /**
+     * @brief 调度模式
+     * - SharedQueue：单一 std::queue + 互斥锁，任务严格 FIFO，适合线程数较少的部署。
+     * - WorkStealing：外部提交进入无锁注入队列，每个 worker 持有 Chase-Lev deque，
+     *   池内提交压入本地 deque，空闲 worker 从其他 deque 窃取。适合 THREAD_POOL_SIZE >= 16。
+     */
+    enum class Mode
+    {
+        SharedQueue,
+        WorkStealing
+    };
+
     struct Config
     {
         size_t num_threads{};
-        size_t max_queue_size = 1000;
+        size_t max_queue_size = 1000; // WorkStealing 模式下约束注入队列深度；0 表示不限（注入队列取默认容量）
         bool log_exceptions = true;
+        Mode mode = Mode::SharedQueue;
+        // 在每个 worker 线程内、开始取任务前 / 退出前调用，用于绑定线程局部资源（如指标槽位）
+        std::function<void()> on_thread_start{};
+        std::function<void()> on_thread_exit{};
     };
 
     struct Stats
@@ -34,6 +52,8 @@ public:
         uint64_t completed_tasks; // 累计执行成功数 (无异常)
         uint64_t failed_tasks; // 累计执行失败数 (捕获异常)
         uint64_t rejected_tasks; // 累计被拒绝数 (满额或关闭)
+        uint64_t stolen_tasks; // 累计被窃取执行数 (仅 WorkStealing 模式)
+        uint64_t task_allocations; // 累计入队成功任务的堆分配次数，除以 total_submitted 即每任务分配数
     };
 
     explicit ThreadPool(size_t threads);
@@ -61,38 +81,35 @@ public:
 
         std::future<return_type> result = task->get_future();
 
+        // packaged_task 本体 + future 共享状态；包装 lambda 只持有 shared_ptr，落在 InlineTask 内联缓冲区
+        throwIfRejected(enqueue([task]()
         {
-            std::unique_lock<std::mutex> lock(_queueMutex);
-
-            //严格的状态判定：关闭后拒绝所有新任务
-            if (_stop.load(std::memory_order_relaxed))[[unlikely]]
-            {
-                _rejectedTasks.fetch_add(1, std::memory_order_relaxed);
-                throw std::runtime_error("ThreadPool is stopping or closed");
-            }
-
-            //队列容量保护
-            if (_maxQueueSize > 0 && _tasks.size() >= _maxQueueSize)
-            {
-                _rejectedTasks.fetch_add(1, std::memory_order_relaxed);
-                throw std::runtime_error("ThreadPool queue is full (" + std::to_string(_maxQueueSize) + ")");
-            }
+            (*task)();
+        }, kSubmitAllocations));
 
-            _tasks.emplace([task]()
-            {
-                (*task)();
-            });
-
-            _totalSubmitted.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
 
-            if (_tasks.size() > _maxQueueSize / 2)[[unlikely]]
-            {
-                checkQueueSize(_tasks.size());
-            }
-        }
+    /**
+     * @brief 投递 fire-and-forget 任务：无 future、无共享状态
+     * * callable 不超过 InlineTask::kInlineSize 时全程零堆分配（WorkStealing 池内提交除外，需要一个 deque 节点）。
+     * * 任务抛出的异常由 worker 捕获并计入 failed_tasks，调用方无从得知；需要结果时请使用 submit。
+     * @throw std::runtime_error 如果池子已关闭或队列已满
+     */
+    template <class F>
+    void post(F&& f)
+    {
+        throwIfRejected(enqueue(InlineTask(std::forward<F>(f)), 0));
+    }
 
-        _condition.notify_one();
-        return result;
+    /**
+     * @brief post 的不抛异常版本
+     * @return false 表示池子已关闭或队列已满，此时 callable 已被销毁
+     */
+    template <class F>
+    bool try_post(F&& f)
+    {
+        return enqueue(InlineTask(std::forward<F>(f)), 0) == EnqueueStatus::Ok;
     }
 
     void stop_and_wait(std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
@@ -102,19 +119,80 @@ public:
         return _stop.load(std::memory_order_relaxed);
     }
 
+    Mode mode() const
+    {
+        return _mode;
+    }
+
     Stats get_stats() const;
     void reset_stats();
 
 private:
+    using Task = InlineTask;
+
+    enum class EnqueueStatus
+    {
+        Ok,
+        Stopped,
+        Full
+    };
+
+    static constexpr uint32_t kSubmitAllocations = 2;
+
+    // 每个 worker 的本地 deque 独占缓存行，避免相邻 worker 的 top/bottom 伪共享
+    struct alignas(kCacheLineSize) WorkerQueue
+    {
+        explicit WorkerQueue(size_t capacity)
+            : deque(capacity)
+        {
+        }
+
+        ChaseLevDeque<Task*> deque;
+    };
+
+    /**
+     * @brief 按模式入队；被拒绝时 task 保持原样，由调用方销毁
+     * @param allocations 调用方在构造 task 之外已发生的堆分配次数，入队成功后计入统计
+     */
+    EnqueueStatus enqueue(Task&& task, uint32_t allocations);
+    EnqueueStatus enqueueShared(Task& task);
+    EnqueueStatus enqueueStealing(Task& task, uint64_t& allocations);
+    void throwIfRejected(EnqueueStatus status) const;
+
     void worker_thread(std::stop_token stoken);
+    void work_stealing_thread(std::stop_token stoken, size_t index);
+
+    // 以下函数仅在 WorkStealing 模式下使用
+    bool findTask(size_t index, Task& out);
+    bool stealTask(size_t index, Task& out);
+    bool searchTask(size_t index, Task& out);
+    bool parkWorker(const std::stop_token& stoken);
+    bool hasVisibleWork() const;
+    void notifyWorker();
+    size_t queuedStealing() const;
+    size_t discardLeftovers();
+
+    void runTask(Task& task);
     void checkQueueSize(size_t size);
 
     size_t _numThreads;
     size_t _maxQueueSize;
     bool _logExceptions;
+    Mode _mode;
+    std::function<void()> _onThreadStart;
+    std::function<void()> _onThreadExit;
 
     std::vector<std::jthread> _workers;
-    std::queue<std::function<void()>> _tasks;
+    std::queue<Task> _tasks;
+
+    // WorkStealing 模式
+    std::unique_ptr<MpmcBoundedQueue<Task>> _injection; // 按值存放，外部 post 不产生节点分配
+    std::vector<std::unique_ptr<WorkerQueue>> _localQueues;
+    std::mutex _parkMutex;
+    std::condition_variable_any _parkCondition;
+    size_t _pendingWakes = 0; // 受 _parkMutex 保护：已发出、尚未被 worker 认领的唤醒数
+    std::atomic<size_t> _idleWorkers{0};
+    std::atomic<size_t> _searchingWorkers{0};
 
     mutable std::mutex _queueMutex;
     std::condition_variable_any _condition;
@@ -124,6 +202,8 @@ private:
     std::atomic<uint64_t> _completedTasks{0};
     std::atomic<uint64_t> _failedTasks{0};
     std::atomic<uint64_t> _rejectedTasks{0};
+    std::atomic<uint64_t> _stolenTasks{0};
+    std::atomic<uint64_t> _taskAllocations{0};
     std::atomic<size_t> _lastLoggedSize{0};
 };
 #endif //STREAMGATE_THREADPOOL_H
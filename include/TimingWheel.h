@@ -0,0 +1,111 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_TIMINGWHEEL_H
+#define STREAMGATE_TIMINGWHEEL_H
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 分层时间轮（按 key 去重的超时跟踪）
+ * * 职责：
+ * 1. schedule / cancel 为 O(1)：哈希定位节点 + 双向链表摘挂。
+ * 2. 对已存在的 key 推迟截止时间（心跳）只改写节点上的截止 tick，不移动节点；
+ *    节点被级联或到期时按最新截止时间重新放置（惰性重排）。
+ * 3. advance() 逐 tick 推进，返回截止时间已到的 key，精度为一个 tick，只会晚到不会早到。
+ * * 每层 slots_per_level 个槽，第 L 层一个槽覆盖 slots_per_level^L 个 tick；超出总跨度的截止时间先放在最高层，到期前会被重新放置。
+ * * 线程安全：内部一把互斥锁。
+ */
+class TimingWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config
+    {
+        std::chrono::milliseconds tick{1000};
+        size_t slots_per_level = 64; // 向上取整为 2 的幂
+        size_t levels = 4; // 1s tick 时 64^4 个 tick 约 194 天
+    };
+
+    explicit TimingWheel(const Config& config, Clock::time_point start = Clock::now());
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    /**
+     * @brief 登记或刷新 key 的截止时间
+     * @return true 新登记；false 已存在并更新了截止时间
+     */
+    bool schedule(const std::string& key, Clock::time_point deadline);
+
+    /**
+     * @return 是否存在并已移除
+     */
+    bool cancel(std::string_view key);
+
+    /**
+     * @brief 推进到 now 所在的 tick
+     * @return 本次到期的 key（已从时间轮移除）
+     */
+    [[nodiscard]] std::vector<std::string> advance(Clock::time_point now);
+
+    [[nodiscard]] size_t size() const;
+
+    [[nodiscard]] std::chrono::milliseconds tick() const noexcept
+    {
+        return _tick;
+    }
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Node
+    {
+        std::string key;
+        uint64_t deadline = 0; // 截止 tick
+        uint32_t slot = kNil; // 所在槽（层号 * 槽数 + 槽号），kNil 表示空闲
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+    };
+
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view s) const noexcept
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    [[nodiscard]] uint64_t toTick(Clock::time_point tp, bool round_up) const;
+    void place(uint32_t index);
+    void link(uint32_t index, uint32_t slot);
+    void unlink(uint32_t index);
+    uint32_t allocate();
+    void release(uint32_t index);
+    // 取出整个槽的链表，返回头结点
+    uint32_t detachSlot(uint32_t slot);
+
+    const std::chrono::milliseconds _tick;
+    const Clock::time_point _start;
+    const uint32_t _bits; // log2(slots_per_level)
+    const uint32_t _levels;
+    const uint64_t _mask;
+
+    mutable std::mutex _mutex;
+    uint64_t _current = 0; // 最近一次处理完的 tick
+    std::vector<uint32_t> _slots; // 每个槽的链表头
+    std::vector<Node> _nodes;
+    uint32_t _freeHead = kNil;
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> _index;
+};
+
+#endif //STREAMGATE_TIMINGWHEEL_H
@@ -0,0 +1,230 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_WORKSTEALINGQUEUE_H
+#define STREAMGATE_WORKSTEALINGQUEUE_H
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 固定 64 字节，避免 hardware_destructive_interference_size 随编译参数变化导致 ABI 不一致
+inline constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @brief Chase-Lev 工作窃取双端队列 (固定容量)
+ * * 职责：
+ * 1. 所属 worker 独占 bottom 端：push / pop 为 LIFO，刚产生的任务趁热执行。
+ * 2. 其他 worker 通过 steal 从 top 端取走最早的任务，仅在争抢最后一个元素时使用 CAS。
+ * * 容量固定为 2 的幂且不扩容：push 失败时由调用方回退到注入队列，省去旧缓冲区的回收问题。
+ * * 实现参考 Lê et al. "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP'13)。
+ */
+template <typename T>
+class ChaseLevDeque
+{
+public:
+    explicit ChaseLevDeque(size_t capacity)
+        : _capacity(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)),
+          _mask(_capacity - 1),
+          _buffer(std::make_unique<std::atomic<T>[]>(_capacity))
+    {
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // 仅限所属 worker 调用
+    bool push(T item)
+    {
+        const int64_t b = _bottom.load(std::memory_order_relaxed);
+        const int64_t t = _top.load(std::memory_order_acquire);
+        if (b - t >= static_cast<int64_t>(_capacity))
+        {
+            return false;
+        }
+
+        _buffer[static_cast<size_t>(b) & _mask].store(item, std::memory_order_relaxed);
+        // 论文中为 release fence + relaxed store；改用 release store 语义等价，且能被 TSan 识别
+        _bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅限所属 worker 调用；队列为空或最后一个元素被窃取时返回 false
+    bool pop(T& out)
+    {
+        const int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = _top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out = _buffer[static_cast<size_t>(b) & _mask].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // 最后一个元素：与 thief 竞争
+            const bool won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                          std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // 任意线程可调用；竞争失败同样返回 false，由调用方换一个 victim 继续
+    bool steal(T& out)
+    {
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = _bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+        {
+            return false;
+        }
+
+        out = _buffer[static_cast<size_t>(t) & _mask].load(std::memory_order_relaxed);
+        return _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // 近似值：仅用于统计与 park 前的复查
+    [[nodiscard]] size_t size_approx() const
+    {
+        const int64_t b = _bottom.load(std::memory_order_relaxed);
+        const int64_t t = _top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return _capacity;
+    }
+
+private:
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<std::atomic<T>[]> _buffer;
+
+    alignas(kCacheLineSize) std::atomic<int64_t> _top{0};
+    alignas(kCacheLineSize) std::atomic<int64_t> _bottom{0};
+};
+
+/**
+ * @brief 有界多生产者多消费者无锁队列 (Vyukov MPMC)
+ * * 每个槽位携带序号，生产者/消费者各自通过一次 CAS 抢占位置，之后只写自己的槽位。
+ * * 用作 ThreadPool 的注入队列：外部线程 push，任意 worker pop。元素按值存放在槽位内。
+ */
+template <typename T>
+class MpmcBoundedQueue
+{
+public:
+    explicit MpmcBoundedQueue(size_t capacity)
+        : _capacity(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)),
+          _mask(_capacity - 1),
+          _cells(std::make_unique<Cell[]>(_capacity))
+    {
+        for (size_t i = 0; i < _capacity; ++i)
+        {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcBoundedQueue(const MpmcBoundedQueue&) = delete;
+    MpmcBoundedQueue& operator=(const MpmcBoundedQueue&) = delete;
+
+    // 入队失败时 item 保持原样
+    bool try_push(T&& item)
+    {
+        Cell* cell;
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &_cells[pos & _mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // 已满
+            }
+            else
+            {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out)
+    {
+        Cell* cell;
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &_cells[pos & _mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // 为空
+            }
+            else
+            {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        out = std::move(cell->data);
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] size_t size_approx() const
+    {
+        const size_t enq = _enqueuePos.load(std::memory_order_relaxed);
+        const size_t deq = _dequeuePos.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return _capacity;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data{};
+    };
+
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    alignas(kCacheLineSize) std::atomic<size_t> _enqueuePos{0};
+    alignas(kCacheLineSize) std::atomic<size_t> _dequeuePos{0};
+};
+#endif //STREAMGATE_WORKSTEALINGQUEUE_H
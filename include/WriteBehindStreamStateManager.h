@@ -0,0 +1,186 @@
+//
+// Created by wxx on 2026/10/16.
+//
+
+#ifndef STREAMGATE_WRITEBEHINDSTREAMSTATEMANAGER_H
+#define STREAMGATE_WRITEBEHINDSTREAMSTATEMANAGER_H
+#include "IStreamStateManager.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 写回（write-behind）状态管理器：包装另一个 IStreamStateManager（通常是 Redis），把热路径写入移出请求线程
+ * * 职责：
+ * 1. 播放端注册、心跳、注销先写入本地分片缓存并立即返回，ZLM 只需要允许 / 拒绝的结果。
+ * 2. 后台线程每 flush_interval（或累计 flush_batch 个待写 key 时提前）把变更按 key 合并后成批写入后端：
+ *    同一任务的多次心跳只写一次，注册后紧跟的心跳并入注册。
+ * 3. 推流端注册需要跨实例抢占推流位，仍同步写入后端；写入前先把同一条流的待写变更落盘，保证顺序。
+ * 4. 内存有界：待写 key 超过 max_pending 时写入方等待刷新（超时则按存储故障返回 false）；
+ *    已落盘的缓存项超过 max_cached_tasks 时淘汰，之后该任务的心跳回退为同步写入。
+ * * 读取：本地尚未落盘的变更优先（读到自己的写入），其余直接读后端；计数与负载表最多滞后一个刷新周期。
+ */
+class WriteBehindStreamStateManager : public IStreamStateManager
+{
+public:
+    struct Config
+    {
+        size_t shards = 16;
+        std::chrono::milliseconds flush_interval{20};
+        size_t flush_batch = 512; // 单个 Pipeline 的最大操作数，累计到该数量时提前刷新
+        size_t max_pending = 65536; // 待写 key 上限
+        std::chrono::milliseconds backpressure_timeout{1000};
+        size_t max_cached_tasks = 262144; // 已落盘缓存项上限
+    };
+
+    struct Stats
+    {
+        uint64_t pending; // 当前待写 key 数
+        uint64_t cached; // 当前缓存项数（含待写）
+        uint64_t batches; // 已执行的刷新轮数
+        uint64_t flushed_ops; // 已写入后端的操作数（合并后）
+        uint64_t coalesced_ops; // 被合并掉的写入数
+        uint64_t last_batch_size;
+        uint64_t max_batch_size;
+        uint64_t last_flush_lag_us; // 上一轮中最早一次变更从发生到写入后端的耗时
+        uint64_t max_flush_lag_us;
+        uint64_t flush_errors; // 写入后端失败（已重新排队）的操作数
+        uint64_t backpressure_waits;
+        uint64_t rejected; // 等待超时而拒绝的写入
+        uint64_t sync_fallbacks; // 未命中缓存而同步透传的心跳 / 注销
+    };
+
+    /**
+     * @param backend 被包装的状态管理器，生命周期须长于本对象
+     */
+    WriteBehindStreamStateManager(IStreamStateManager& backend, const Config& config);
+    ~WriteBehindStreamStateManager() override;
+
+    WriteBehindStreamStateManager(const WriteBehindStreamStateManager&) = delete;
+    WriteBehindStreamStateManager& operator=(const WriteBehindStreamStateManager&) = delete;
+
+    /**
+     * @brief 停止后台线程并把剩余变更写入后端；之后的调用全部同步透传。析构时自动调用
+     */
+    void stop();
+
+    bool registerTask(const StreamTask& task) override;
+    bool deregisterTask(const std::string& stream_name, const std::string& client_id) override;
+    void deregisterAllMembers(const std::string& stream_name) override;
+
+    [[nodiscard]] std::vector<std::string> getStreamClientIds(const std::string& stream_name) const override;
+    [[nodiscard]] bool touchTask(const std::string& stream_name, const std::string& client_id) const override;
+    [[nodiscard]] std::optional<StreamTask> getTask(const std::string& stream_name,
+                                                    const std::string& client_id) const override;
+    [[nodiscard]] std::vector<StreamTask> getAllPublisherTasks() const override;
+    [[nodiscard]] size_t getActivePublisherCount() const override;
+    [[nodiscard]] size_t getActivePlayerCount() const override;
+    [[nodiscard]] size_t getPlayerCount(const std::string& stream_name) const override;
+    [[nodiscard]] std::optional<StreamTask> getPublisherTask(const std::string& stream_name) const override;
+    [[nodiscard]] std::optional<PublisherLocation> getPublisherLocation(
+        const std::string& stream_name) const override;
+    [[nodiscard]] std::vector<NodeLoad> getNodeLoads() const override;
+    [[nodiscard]] bool isHealthy() const override;
+
+    [[nodiscard]] TimeoutScanResult scanTimeoutTasks(std::chrono::milliseconds timeout,
+                                                     const TimeoutScanOptions& options) override;
+    void enableLocalExpiry(std::chrono::milliseconds timeout, std::chrono::milliseconds tick) override;
+    [[nodiscard]] TimeoutScanResult expireDueTasks(std::chrono::milliseconds timeout) override;
+    [[nodiscard]] std::optional<StreamTask> reclaimExpiredTask(const std::string& stream_name,
+                                                               const std::string& client_id) override;
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    enum class PendingOp : uint8_t
+    {
+        None,
+        Register,
+        Touch,
+        Deregister
+    };
+
+    struct CachedTask
+    {
+        StreamTask task;
+        PendingOp pending = PendingOp::None;
+        bool removed = false; // 已在本地注销，Deregister 落盘后删除
+        bool persisted = false; // 后端已有该注册（含在途、尚未返回结果的 Register）
+        bool inflight = false; // 有操作正在写入后端，结果返回前不删除缓存项
+        std::chrono::steady_clock::time_point since; // 最早一次未落盘变更的时间
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::unordered_map<std::string, CachedTask>> streams; // stream -> client
+        std::vector<std::pair<std::string, std::string>> dirty; // 有待写操作的 (stream, client)
+    };
+
+    struct FlushItem
+    {
+        PendingOp op;
+        StreamTask task;
+        std::chrono::steady_clock::time_point since;
+        bool prior_persisted; // 写入失败时恢复
+    };
+
+    [[nodiscard]] Shard& shardFor(const std::string& stream_name) const;
+    // 推流端已在本地注销但尚未落盘
+    [[nodiscard]] bool publisherRemovedLocally(const std::string& stream_name) const;
+
+    // 调用方持有分片锁：合并 op 并在需要时登记到 dirty
+    void markDirty(Shard& shard, CachedTask& entry, PendingOp op) const;
+    [[nodiscard]] bool waitForCapacity() const;
+
+    bool registerSync(const StreamTask& task);
+    void flushLoop(const std::stop_token& stoken);
+    // 以下由持有 _flushMutex 的线程调用
+    size_t flushPending();
+    void flushStream(const std::string& stream_name);
+    void collect(Shard& shard, std::vector<FlushItem>& items, const std::string* only_stream);
+    void writeItems(std::vector<FlushItem>& items);
+    void settle(const FlushItem& item, bool ok);
+    void evictIfOverCapacity();
+    void evictExpired(const std::vector<StreamTask>& expired);
+
+    IStreamStateManager& _backend;
+    const Config _config;
+    std::unique_ptr<Shard[]> _shards;
+    const size_t _shardCount;
+
+    mutable std::atomic<int64_t> _pending{0};
+    mutable std::atomic<int64_t> _cached{0};
+    std::atomic<bool> _stopped{false};
+
+    std::mutex _flushMutex; // 串行化所有写后端的路径（后台刷新 / 推流端同步注册 / 整流注销）
+
+    mutable std::mutex _wakeMutex;
+    mutable std::condition_variable_any _wakeCondition; // 唤醒刷新线程
+    mutable std::condition_variable _capacityCondition; // 刷新后唤醒等待容量的写入方
+
+    mutable std::atomic<uint64_t> _batches{0};
+    mutable std::atomic<uint64_t> _flushedOps{0};
+    mutable std::atomic<uint64_t> _coalescedOps{0};
+    mutable std::atomic<uint64_t> _lastBatchSize{0};
+    mutable std::atomic<uint64_t> _maxBatchSize{0};
+    mutable std::atomic<uint64_t> _lastFlushLagUs{0};
+    mutable std::atomic<uint64_t> _maxFlushLagUs{0};
+    mutable std::atomic<uint64_t> _flushErrors{0};
+    mutable std::atomic<uint64_t> _backpressureWaits{0};
+    mutable std::atomic<uint64_t> _rejected{0};
+    mutable std::atomic<uint64_t> _syncFallbacks{0};
+
+    std::jthread _flusher;
+};
+
+#endif //STREAMGATE_WRITEBEHINDSTREAMSTATEMANAGER_H
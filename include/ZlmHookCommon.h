@@ -5,7 +5,9 @@
 #ifndef STREAMGATE_ZLMHOOKCOMMON_H
 #define STREAMGATE_ZLMHOOKCOMMON_H
 #include <nlohmann/json.hpp>
+#include <boost/container/small_vector.hpp>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <utility>
 #include <map>
@@ -17,6 +19,11 @@ enum class HookAction
     Publish, PublishDone, Play, PlayDone, StreamNoneReader, StreamNotFound, Unknown
 };
 
+inline constexpr size_t kHookActionCount = static_cast<size_t>(HookAction::Unknown) + 1;
+
+// 指标标签用的小写名称，例如 publish / play_done
+std::string_view hookActionLabel(HookAction action) noexcept;
+
 enum class StreamProtocol
 {
     RTMP, HTTP_FLV, HLS, RTSP, WebRTC, SRT, HTTP_TS, HTTP_FMP4, Unknown
@@ -33,6 +40,9 @@ enum class ZlmHookResult
     RESOURCE_NOT_READY = 6
 };
 
+struct ZlmHookRequestView;
+class HookTrace;
+
 struct ZlmHookRequest
 {
     HookAction action;
@@ -59,12 +69,78 @@ struct ZlmHookRequest
 
     static std::optional<ZlmHookRequest> from_json(const json& j);
 
+    /**
+     * @brief 生成指向本对象存储的视图（DOM 兜底路径与零拷贝路径共用同一套下游接口）
+     * @note 视图生命周期不得超过本对象
+     */
+    [[nodiscard]] ZlmHookRequestView view() const;
+
 private:
+    friend struct ZlmHookRequestView;
+
     static HookAction parse_action(std::string_view action_str);
     static StreamProtocol parse_protocol(std::string_view schema_str);
     static void parse_url_params(const std::string& query, std::map<std::string, std::string>& out);
 };
 
+/**
+ * @brief Hook 请求的零拷贝视图 (ZlmHookRequestView)
+ * * 职责：
+ * 1. 直接在 HTTP 请求体（Session 的 flat_buffer）上单遍扫描，不构建 JSON DOM。
+ * 2. 所有字段均为 string_view，params 存放在小型内联数组中，常见请求全程零堆分配。
+ * 3. 仅在请求跨入 ThreadPool 时（HookUseCase -> StreamTaskScheduler）才物化为 std::string。
+ * * 注意：视图只在 routeHook 调用栈内有效，严禁跨线程或异步回调持有。
+ */
+struct ZlmHookRequestView
+{
+    struct Param
+    {
+        std::string_view key;
+        std::string_view value;
+    };
+
+    // ZLM 的 params 通常只有 token 等少量键，超出内联容量才会退化为堆分配
+    static constexpr size_t kInlineParams = 8;
+    using ParamList = boost::container::small_vector<Param, kInlineParams>;
+
+    HookAction action = HookAction::Unknown;
+    StreamProtocol protocol = StreamProtocol::RTMP;
+
+    std::string_view app = "live";
+    std::string_view stream;
+    std::string_view vhost = "__defaultVhost__";
+    std::string_view client_id;
+    std::string_view ip;
+
+    ParamList params;
+
+    // 阶段计时上下文（由 HookSession 持有，非拥有）；为空表示不计时
+    HookTrace* trace = nullptr;
+
+    [[nodiscard]] std::string stream_key() const;
+
+    /**
+     * @brief 查找参数 (与 ZlmHookRequest 的 map 语义一致：重复键以最后一次出现为准)
+     */
+    [[nodiscard]] std::string_view find_param(std::string_view key) const;
+
+    [[nodiscard]] std::string_view get_token() const
+    {
+        return find_param("token");
+    }
+
+    /**
+     * @brief 零拷贝快速解析
+     * @param body 原始 JSON 请求体，调用方需保证其在视图使用期间有效
+     * @return false 表示快速路径无法处理（格式非法、字段含转义字符、params 为 JSON 编码等），
+     *         调用方应退回 json::parse + ZlmHookRequest::from_json 的完整路径，由后者给出最终结论
+     */
+    static bool parse(std::string_view body, ZlmHookRequestView& out);
+
+private:
+    static void parse_url_params(std::string_view query, ParamList& out);
+};
+
 struct ZlmHookResponse
 {
     ZlmHookResult code;
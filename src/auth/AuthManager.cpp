@@ -4,6 +4,8 @@
 #include "AuthManager.h"
 #include "ThreadPool.h"
 #include "Logger.h"
+#include "HookTrace.h"
+#include <optional>
 #include <stdexcept>
 
 AuthManager::AuthManager(std::unique_ptr<IAuthRepository> repo, ThreadPool& pool, Config config)
@@ -55,8 +57,8 @@ bool AuthManager::checkAuth(const std::string& streamKey, const std::string& cli
     const auto promise = std::make_shared<std::promise<int>>();
     auto future = promise->get_future();
 
-    // 提交任务到线程池
-    _pool.submit([this,streamKey,clientId,token,promise]()
+    // 投递到线程池：结果经 promise 回传，不需要 submit 的 future
+    _pool.post([this,streamKey,clientId,token,promise]()
     {
         if (_shutdown.load())return;
 
@@ -100,7 +102,7 @@ void AuthManager::checkAuthAsync(const std::string& streamKey, const std::string
     if (_shutdown.load() || !cb)return;
 
     // 异步模式：直接投递任务，不阻塞当前线程
-    _pool.submit([this,streamKey,clientId,token,cb=std::move(cb)]()
+    _pool.post([this,streamKey,clientId,token,cb=std::move(cb)]()
     {
         if (_shutdown.load())return;
 
@@ -118,15 +120,28 @@ void AuthManager::checkAuthAsync(const std::string& streamKey, const std::string
     });
 }
 
-void AuthManager::checkAuthAsync(const AuthRequest& req, AuthCallback cb) const
+void AuthManager::checkAuthAsync(const AuthRequest& req, AuthCallback cb, HookTrace* trace) const
 {
     if (_shutdown.load() || !cb)return;
 
+    // worker 只写本次请求的计时副本：回调一旦应答，会话就可能复用自己的 HookTrace 处理下一个 keep-alive 请求
+    std::optional<HookTrace> local;
+    if (trace)
+    {
+        local.emplace(*trace);
+        local->markEnqueued();
+    }
+
     // 直接透传 req 成员给线程池
-    _pool.submit([this,req,cb=std::move(cb)]()
+    _pool.post([this,req,cb=std::move(cb),local]() mutable
     {
         if (_shutdown.load())return;
 
+        HookTrace* const worker_trace = local ? &*local : nullptr;
+        if (worker_trace)worker_trace->recordQueueWait();
+
+        // Scope 同时覆盖回调：调度器在回调中经 HookTrace::current() 记录 RegisterTask
+        HookTrace::Scope scope(worker_trace);
         const int result = this->performAuthLogic(req.streamKey, req.clientId, req.authToken);
 
         try
@@ -139,3 +154,44 @@ void AuthManager::checkAuthAsync(const AuthRequest& req, AuthCallback cb) const
         }
     });
 }
+
+void AuthManager::checkAuthBatchAsync(std::vector<AuthRequest> requests, AuthBatchCallback cb) const
+{
+    if (_shutdown.load() || !cb)return;
+
+    _pool.post([this,requests=std::move(requests),cb=std::move(cb)]()
+    {
+        if (_shutdown.load())return;
+
+        std::vector<int> results(requests.size(), AuthError::RUNTIME_ERROR);
+
+        try
+        {
+            const auto authData = _repository->getAuthDataBatch(requests);
+
+            for (size_t i = 0; i < requests.size() && i < authData.size(); ++i)
+            {
+                results[i] = (authData[i].has_value() && authData[i]->isAuthorized)
+                                 ? AuthError::SUCCESS
+                                 : AuthError::AUTH_DENIED;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("AuthManager: Repository 批量查询异常: " + std::string(e.what()));
+        }
+        catch (...)
+        {
+            LOG_ERROR("AuthManager: Repository 批量查询发生未知异常");
+        }
+
+        try
+        {
+            cb(results);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("AuthManager: 批量回调执行异常: " + std::string(e.what()));
+        }
+    });
+}
@@ -0,0 +1,203 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// 鉴权批量接口对比：逐条 getAuthData vs getAuthDataBatch (MGET + IN 查询 + Pipeline 回写)
+// 负载：预置 N 条 stream_auth 记录，分别度量冷路径 (Redis 未命中，全部回源 DB) 与热路径 (Redis 命中)
+// 依赖：需要本地 Redis 与 MariaDB（与集成测试相同，RUN_INTEGRATION_TEST=1 时启用）
+// 关注指标：redis_rt/req 与 db_rt/req —— 每个鉴权请求平均产生的网络往返次数
+//
+
+#include <benchmark/benchmark.h>
+
+#include "CacheManager.h"
+#include "ConfigLoader.h"
+#include "DBManager.h"
+#include "HybridAuthRepository.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int kMaxBatch = 256;
+    const std::string kStreamPrefix = "__defaultVhost__/live/bench_batch_";
+
+    struct AuthHarness
+    {
+        std::unique_ptr<DBManager> db;
+        std::unique_ptr<HybridAuthRepository> repo;
+        std::vector<AuthRequest> requests;
+        std::string error;
+
+        AuthHarness()
+        {
+            if (!std::getenv("RUN_INTEGRATION_TEST"))
+            {
+                error = "Set RUN_INTEGRATION_TEST=1 (requires Redis + MariaDB)";
+                return;
+            }
+
+            try
+            {
+                ConfigLoader::instance().load("config/config.ini", ".env");
+
+                DBManager::Config db_cfg;
+                db_cfg.url = "tcp://" + ConfigLoader::instance().getString("DB_HOST", "127.0.0.1") + ":" +
+                    ConfigLoader::instance().getString("DB_PORT", "3306") + "/" +
+                    ConfigLoader::instance().getString("DB_NAME", "streamgate_db");
+                db_cfg.user = ConfigLoader::instance().getString("DB_USER", "root");
+                db_cfg.password = ConfigLoader::instance().getString("DB_PASS", "");
+                db = std::make_unique<DBManager>(db_cfg);
+
+                CacheManager::instance().init(ConfigLoader::instance().getString("REDIS_HOST", "127.0.0.1"),
+                                              ConfigLoader::instance().getInt("REDIS_PORT", 6380), 4);
+                if (!CacheManager::instance().ping())
+                {
+                    error = "Redis ping failed";
+                    return;
+                }
+
+                // 关闭 L1：只度量 Redis / DB 的往返
+                HybridAuthRepository::Config repo_cfg;
+                repo_cfg.l1_capacity_bytes = 0;
+                repo = std::make_unique<HybridAuthRepository>(*db, CacheManager::instance(), repo_cfg);
+
+                seed();
+            }
+            catch (const std::exception& e)
+            {
+                error = e.what();
+            }
+        }
+
+        ~AuthHarness()
+        {
+            if (!db || !error.empty())return;
+            try
+            {
+                ConnectionGuard conn(*db);
+                auto stmt = conn->prepareStatement("DELETE FROM stream_auth WHERE stream_key LIKE ?");
+                stmt->setString(1, kStreamPrefix + "%");
+                stmt->execute();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        void seed()
+        {
+            ConnectionGuard conn(*db);
+            auto stmt = conn->prepareStatement(
+                "INSERT IGNORE INTO stream_auth (stream_key, client_id, auth_token, is_active) VALUES (?, ?, ?, 1)");
+
+            for (int i = 0; i < kMaxBatch; ++i)
+            {
+                AuthRequest req{kStreamPrefix + std::to_string(i), "client_" + std::to_string(i),
+                                "token_" + std::to_string(i)};
+                stmt->setString(1, req.streamKey);
+                stmt->setString(2, req.clientId);
+                stmt->setString(3, req.authToken);
+                stmt->execute();
+                requests.push_back(std::move(req));
+            }
+        }
+
+        // 冷路径前清空 Redis 中的缓存条目
+        void evictCache(size_t n) const
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                (void)CacheManager::instance().keyDel("auth_data:" + requests[i].streamKey + ":" + requests[i].clientId);
+            }
+        }
+    };
+
+    AuthHarness& harness()
+    {
+        static AuthHarness h;
+        return h;
+    }
+
+    void reportRoundTrips(benchmark::State& state, const HybridAuthRepository::Stats& before,
+                          const HybridAuthRepository::Stats& after, size_t batch)
+    {
+        const auto total = static_cast<double>(state.iterations()) * static_cast<double>(batch);
+        if (total <= 0)return;
+
+        state.counters["redis_rt/req"] = static_cast<double>(after.redis_round_trips - before.redis_round_trips) /
+            total;
+        state.counters["db_rt/req"] = static_cast<double>(after.db_round_trips - before.db_round_trips) / total;
+        state.counters["req/s"] = benchmark::Counter(total, benchmark::Counter::kIsRate);
+    }
+
+    template <bool Batch>
+    void runAuthLookup(benchmark::State& state)
+    {
+        auto& h = harness();
+        if (!h.error.empty())
+        {
+            state.SkipWithError(h.error.c_str());
+            return;
+        }
+
+        const auto batch = static_cast<size_t>(state.range(0));
+        const bool cold = state.range(1) != 0;
+        const std::vector<AuthRequest> requests(h.requests.begin(), h.requests.begin() + static_cast<long>(batch));
+
+        // 热路径预先填充 Redis
+        if (!cold)(void)h.repo->getAuthDataBatch(requests);
+
+        const auto before = h.repo->getStats();
+        for (auto _ : state)
+        {
+            if (cold)
+            {
+                state.PauseTiming();
+                h.evictCache(batch);
+                state.ResumeTiming();
+            }
+
+            if constexpr (Batch)
+            {
+                auto results = h.repo->getAuthDataBatch(requests);
+                benchmark::DoNotOptimize(results);
+            }
+            else
+            {
+                // 等价于 IAuthRepository 的默认批量实现：逐条查询
+                for (const auto& req : requests)
+                {
+                    auto result = h.repo->getAuthData(req.streamKey, req.clientId, req.authToken);
+                    benchmark::DoNotOptimize(result);
+                }
+            }
+        }
+        reportRoundTrips(state, before, h.repo->getStats(), batch);
+    }
+}
+
+static void BM_AuthLookup_Loop(benchmark::State& state)
+{
+    runAuthLookup<false>(state);
+}
+
+static void BM_AuthLookup_Batch(benchmark::State& state)
+{
+    runAuthLookup<true>(state);
+}
+
+// Args: {batch_size, cold(1)/warm(0)}
+BENCHMARK(BM_AuthLookup_Loop)
+    ->ArgsProduct({{1, 16, 64, kMaxBatch}, {1, 0}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_AuthLookup_Batch)
+    ->ArgsProduct({{1, 16, 64, kMaxBatch}, {1, 0}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
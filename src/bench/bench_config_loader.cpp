@@ -0,0 +1,188 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// 配置读取成本：旧实现（全局 mutex + std::map + 每次 stoi）与快照实现（线程本地缓存 + 预解析）对比
+// 负载：1 / 16 个线程反复读取同一批 key；BM_*_DuringReload 在后台每 1ms 发布一次新配置
+// 关注指标：每次 getInt / getString 的耗时；多线程下旧实现受 mutex 争用影响，快照实现应与单线程持平
+//
+
+#include <benchmark/benchmark.h>
+
+#include "ConfigLoader.h"
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace
+{
+    // 改造前 ConfigLoader getter 的等价实现，作为基线
+    class MutexMapConfig
+    {
+    public:
+        void set(const std::string& key, const std::string& value)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _map[key] = value;
+        }
+
+        int getInt(const std::string& key, int default_value) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const auto it = _map.find(key);
+            if (it == _map.end())return default_value;
+            try
+            {
+                return std::stoi(it->second);
+            }
+            catch (...)
+            {
+                return default_value;
+            }
+        }
+
+        std::string getString(const std::string& key, const std::string& default_value) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const auto it = _map.find(key);
+            return it != _map.end() ? it->second : default_value;
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        std::map<std::string, std::string> _map;
+    };
+
+    // 与 config.ini.example 规模相当：约 60 个 key
+    const std::array<std::string, 4> kKeys = {
+        "SCHEDULER_LOAD_REFRESH_MS", "NODE_PROBE_TIMEOUT_MS", "THREAD_POOL_SIZE", "CACHE_TTL_SECONDS"
+    };
+
+    template <typename Cfg>
+    void fill(Cfg& cfg)
+    {
+        for (int i = 0; i < 56; ++i)
+        {
+            cfg.set("FILLER_KEY_" + std::to_string(i), std::to_string(i));
+        }
+        for (const auto& key : kKeys)
+        {
+            cfg.set(key, "2000");
+        }
+    }
+
+    MutexMapConfig& baseline()
+    {
+        static MutexMapConfig cfg;
+        static const bool filled = (fill(cfg), true);
+        (void)filled;
+        return cfg;
+    }
+
+    ConfigLoader& snapshotLoader()
+    {
+        static const bool filled = (fill(ConfigLoader::instance()), true);
+        (void)filled;
+        return ConfigLoader::instance();
+    }
+
+    // 后台写者：每 1ms 发布一次新快照
+    class ReloadStorm
+    {
+    public:
+        ReloadStorm()
+            : _thread([this]
+            {
+                int v = 0;
+                while (!_stop.load(std::memory_order_relaxed))
+                {
+                    ConfigLoader::instance().set("FILLER_KEY_0", std::to_string(++v));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            })
+        {
+        }
+
+        ~ReloadStorm()
+        {
+            _stop = true;
+            _thread.join();
+        }
+
+    private:
+        std::atomic<bool> _stop{false};
+        std::thread _thread;
+    };
+}
+
+static void BM_MutexMap_GetInt(benchmark::State& state)
+{
+    const auto& cfg = baseline();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(cfg.getInt(kKeys[i++ & 3], 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_Snapshot_GetInt(benchmark::State& state)
+{
+    const auto& cfg = snapshotLoader();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(cfg.getInt(kKeys[i++ & 3], 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_MutexMap_GetString(benchmark::State& state)
+{
+    const auto& cfg = baseline();
+    const std::string fallback;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(cfg.getString(kKeys[i++ & 3], fallback));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_Snapshot_GetString(benchmark::State& state)
+{
+    const auto& cfg = snapshotLoader();
+    const std::string fallback;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(cfg.getString(kKeys[i++ & 3], fallback));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_Snapshot_GetInt_DuringReload(benchmark::State& state)
+{
+    const auto& cfg = snapshotLoader();
+    std::unique_ptr<ReloadStorm> storm;
+    if (state.thread_index() == 0)storm = std::make_unique<ReloadStorm>();
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(cfg.getInt(kKeys[i++ & 3], 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MutexMap_GetInt)->Threads(1)->Threads(16)->UseRealTime();
+BENCHMARK(BM_Snapshot_GetInt)->Threads(1)->Threads(16)->UseRealTime();
+BENCHMARK(BM_MutexMap_GetString)->Threads(1)->Threads(16)->UseRealTime();
+BENCHMARK(BM_Snapshot_GetString)->Threads(1)->Threads(16)->UseRealTime();
+BENCHMARK(BM_Snapshot_GetInt_DuringReload)->Threads(16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,155 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// HookServer I/O 模型对比：共享 io_context vs 每核分片 (SO_REUSEPORT)
+// 负载：多个 keep-alive 客户端并发打 GET /health，隔离业务逻辑，只度量 accept/读/写路径
+//
+
+#include <benchmark/benchmark.h>
+
+#include "AuthManager.h"
+#include "HookController.h"
+#include "HookServer.h"
+#include "HookUseCase.h"
+#include "IStreamStateManager.h"
+#include "Logger.h"
+#include "StreamTaskScheduler.h"
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int kBenchPort = 18090;
+    constexpr int kClients = 16;
+    constexpr int kRequestsPerClient = 200;
+
+    // 空实现：HookServer 只需要一个可路由的 HookController，/health 不会触达这些依赖
+    class NullAuthRepository final : public IAuthRepository
+    {
+    public:
+        std::optional<StreamAuthData> getAuthData(const std::string&, const std::string&, const std::string&) override
+        {
+            return std::nullopt;
+        }
+
+        bool isHealthy() override
+        {
+            return true;
+        }
+    };
+
+    class NullStateManager final : public IStreamStateManager
+    {
+    public:
+        bool registerTask(const StreamTask&) override { return true; }
+        bool deregisterTask(const std::string&, const std::string&) override { return true; }
+        void deregisterAllMembers(const std::string&) override {}
+        std::vector<std::string> getStreamClientIds(const std::string&) const override { return {}; }
+        bool touchTask(const std::string&, const std::string&) const override { return true; }
+
+        std::optional<StreamTask> getTask(const std::string&, const std::string&) const override
+        {
+            return std::nullopt;
+        }
+
+        std::vector<StreamTask> getAllPublisherTasks() const override { return {}; }
+        size_t getActivePublisherCount() const override { return 0; }
+        size_t getActivePlayerCount() const override { return 0; }
+        std::optional<StreamTask> getPublisherTask(const std::string&) const override { return std::nullopt; }
+        bool isHealthy() const override { return true; }
+        TimeoutScanResult scanTimeoutTasks(std::chrono::milliseconds, const TimeoutScanOptions&) override { return {}; }
+    };
+
+    struct ServerHarness
+    {
+        ThreadPool pool{1};
+        NullStateManager state;
+        AuthManager auth{std::make_unique<NullAuthRepository>(), pool, AuthManager::Config{}};
+        StreamTaskScheduler scheduler{auth, state, NodeConfig{}, StreamTaskScheduler::Config{}};
+        HookUseCase use_case{scheduler};
+        HookController controller{use_case};
+        std::unique_ptr<HookServer> server;
+
+        explicit ServerHarness(HookServer::Config cfg)
+        {
+            server = std::make_unique<HookServer>(std::move(cfg), controller);
+            if (!server->start())
+            {
+                throw std::runtime_error("bench: HookServer failed to start");
+            }
+        }
+    };
+
+    // 单个 keep-alive 客户端连续发送 n 个请求
+    void runClient(int n)
+    {
+        net::io_context ioc;
+        tcp::socket socket(ioc);
+        socket.connect({net::ip::make_address("127.0.0.1"), kBenchPort});
+
+        http::request<http::empty_body> req{http::verb::get, "/health", 11};
+        req.set(http::field::host, "127.0.0.1");
+        req.keep_alive(true);
+
+        beast::flat_buffer buffer;
+        for (int i = 0; i < n; ++i)
+        {
+            http::write(socket, req);
+            http::response<http::string_body> res;
+            http::read(socket, buffer, res);
+            benchmark::DoNotOptimize(res.body().size());
+        }
+
+        beast::error_code ec;
+        [[maybe_unused]] auto& _ = (socket.shutdown(tcp::socket::shutdown_both, ec), ec);
+    }
+
+    void runLoad(benchmark::State& state, HookServer::Config cfg)
+    {
+        Logger::instance().set_min_level(LogLevel::ERROR);
+
+        cfg.address = "127.0.0.1";
+        cfg.port = kBenchPort;
+        ServerHarness harness(std::move(cfg));
+
+        for (auto _ : state)
+        {
+            std::vector<std::thread> clients;
+            clients.reserve(kClients);
+            for (int c = 0; c < kClients; ++c)
+            {
+                clients.emplace_back(runClient, kRequestsPerClient);
+            }
+            for (auto& t : clients)
+            {
+                t.join();
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * kClients * kRequestsPerClient);
+        harness.server->stop();
+    }
+}
+
+// 共享模式：N 个线程 run 同一个 io_context
+static void BM_HookServer_SharedContext(benchmark::State& state)
+{
+    HookServer::Config cfg;
+    cfg.io_threads = static_cast<int>(state.range(0));
+    cfg.io_shards = 0;
+    runLoad(state, std::move(cfg));
+}
+
+// 分片模式：N 个 io_context，每个一个 SO_REUSEPORT Acceptor 与一个绑核线程
+static void BM_HookServer_Sharded(benchmark::State& state)
+{
+    HookServer::Config cfg;
+    cfg.io_shards = static_cast<int>(state.range(0));
+    runLoad(state, std::move(cfg));
+}
+
+BENCHMARK(BM_HookServer_SharedContext)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HookServer_Sharded)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
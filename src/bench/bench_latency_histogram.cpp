@@ -0,0 +1,80 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// Hook 阶段延迟直方图的记录成本：目标单次 record() < 20ns
+// 负载：单线程 / 多线程各自写本线程的直方图；StageTimer 额外包含两次 steady_clock::now()
+// 关注指标：每次记录的耗时；空 trace 的 StageTimer 应接近 0（不读时钟）
+//
+
+#include <benchmark/benchmark.h>
+
+#include "HookTrace.h"
+
+#include <cstdint>
+
+namespace
+{
+    // 模拟真实分布：数值跨越多个 2 的幂区间，避免始终命中同一个桶
+    uint64_t nextSample(uint64_t& state)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return 1000 + (state >> 44);
+    }
+}
+
+static void BM_Record(benchmark::State& state)
+{
+    auto& reg = LatencyHistogramRegistry::instance();
+    uint64_t seed = static_cast<uint64_t>(state.thread_index()) + 1;
+
+    for (auto _ : state)
+    {
+        reg.record(HookAction::Publish, HookStage::AuthCache, nextSample(seed));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_StageTimer(benchmark::State& state)
+{
+    HookTrace trace;
+    trace.reset(HookAction::Play, HookTrace::Clock::now());
+
+    for (auto _ : state)
+    {
+        StageTimer timer(&trace, HookStage::RegisterTask);
+        benchmark::DoNotOptimize(&timer);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_StageTimer_NullTrace(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        StageTimer timer(nullptr, HookStage::RegisterTask);
+        benchmark::DoNotOptimize(&timer);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_Snapshot(benchmark::State& state)
+{
+    auto& reg = LatencyHistogramRegistry::instance();
+    uint64_t seed = 1;
+    for (size_t s = 0; s < kHookStageCount; ++s)
+    {
+        reg.record(HookAction::Publish, static_cast<HookStage>(s), nextSample(seed));
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(reg.snapshot());
+    }
+}
+
+BENCHMARK(BM_Record)->ThreadRange(1, 8);
+BENCHMARK(BM_StageTimer)->ThreadRange(1, 8);
+BENCHMARK(BM_StageTimer_NullTrace);
+BENCHMARK(BM_Snapshot)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// /metrics 抓取成本对比：旧路径 collectAll() + dump(2) vs 新路径 exportPrometheus()（预渲染缓冲区）
+// 负载：注册 N 个与线上 Provider 规模相近的假组件（约 20 个字段，两层嵌套），刷新一次后反复抓取
+// 关注指标：每次抓取的耗时与 bytes_per_second；新路径在刷新线程已发布缓冲区时只有一次原子加载
+//
+
+#include <benchmark/benchmark.h>
+
+#include "MetricsCollector.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    class SyntheticProvider final : public IMetricsProvider
+    {
+    public:
+        explicit SyntheticProvider(int id) : _name("synthetic_" + std::to_string(id) + "_metrics")
+        {
+        }
+
+        [[nodiscard]] std::string_view metricsName() const noexcept override
+        {
+            return _name;
+        }
+
+        void refresh() noexcept override
+        {
+            ++_round;
+            updateSnapshot({
+                {"status", "running"},
+                {"submitted", _round * 1000},
+                {"completed", _round * 990},
+                {"failed", _round},
+                {"rejected", 0},
+                {"queue_depth", 12},
+                {
+                    "l1", {
+                        {"hits", _round * 800}, {"misses", _round * 200}, {"evictions", 5},
+                        {"entries", 4096}, {"bytes", 1 << 20}, {"hit_rate", 0.8}
+                    }
+                },
+                {
+                    "lag", {
+                        {"oldest_pending_ms", 1.25}, {"last_ms", 0.5}, {"max_ms", 12.0}
+                    }
+                }
+            });
+        }
+
+    private:
+        std::string _name;
+        uint64_t _round = 0;
+    };
+
+    void ensureProviders(int count)
+    {
+        static std::vector<std::shared_ptr<SyntheticProvider>> providers;
+        while (static_cast<int>(providers.size()) < count)
+        {
+            auto p = std::make_shared<SyntheticProvider>(static_cast<int>(providers.size()));
+            p->refresh();
+            MetricsCollector::instance().registerProvider(p);
+            providers.push_back(std::move(p));
+        }
+    }
+}
+
+// 旧 /metrics：每次抓取构建 DOM、拷贝所有快照并格式化
+static void BM_Scrape_JsonDump(benchmark::State& state)
+{
+    ensureProviders(static_cast<int>(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        auto body = MetricsCollector::instance().collectAll().dump(2);
+        bytes += body.size();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+// 新 /metrics（刷新线程未启动时）：只拼接各 Provider 预渲染的文本
+static void BM_Scrape_PrometheusConcat(benchmark::State& state)
+{
+    ensureProviders(static_cast<int>(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        auto body = MetricsCollector::instance().exportPrometheus();
+        bytes += body->size();
+        benchmark::DoNotOptimize(body->data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+// 新 /metrics（稳态）：刷新线程已发布缓冲区，抓取只是一次原子加载
+static void BM_Scrape_PrometheusCached(benchmark::State& state)
+{
+    ensureProviders(static_cast<int>(state.range(0)));
+    const auto before = MetricsCollector::instance().exportPrometheus();
+    MetricsCollector::instance().start(std::chrono::seconds(60), nullptr);
+    while (MetricsCollector::instance().exportPrometheus() == before)
+    {
+        std::this_thread::yield();
+    }
+
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        auto body = MetricsCollector::instance().exportPrometheus();
+        bytes += body->size();
+        benchmark::DoNotOptimize(body->data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    MetricsCollector::instance().stop();
+}
+
+BENCHMARK(BM_Scrape_JsonDump)->Arg(8)->Arg(32)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Scrape_PrometheusConcat)->Arg(8)->Arg(32)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Scrape_PrometheusCached)->Arg(8)->Arg(32)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
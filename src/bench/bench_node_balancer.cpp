@@ -0,0 +1,188 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// 推流节点选择策略：热路径开销 + 负载分布模拟
+// 模拟：8 个节点（weight 1,1,1,1,2,2,4,4），推流按泊松式到达 / 随机结束；每条流的观众数服从 Zipf 分布（少数热门流）
+//       观众随推流端落在同一节点，但只有在负载表刷新后才被调度器看到（每 refresh_every 次选择刷新一次，模拟 2s 周期）
+// 关注指标：max_over_mean = 最重节点 / 平均（加权策略按 weight 归一化），越接近 1 越均衡；
+//           cv = 变异系数；BM_HashChurn 的 moved_fraction = 增加一个节点后换了节点的流占比（理想值 1/(N+1)）
+//
+
+#include <benchmark/benchmark.h>
+
+#include "NodeBalancer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const std::vector<int> kWeights{1, 1, 1, 1, 2, 2, 4, 4};
+
+    std::vector<NodeEndpoint> makeNodes()
+    {
+        std::vector<NodeEndpoint> nodes;
+        for (size_t i = 0; i < kWeights.size(); ++i)
+        {
+            nodes.push_back({"10.0.1." + std::to_string(i + 1), 1935, kWeights[i]});
+        }
+        return nodes;
+    }
+
+    struct LiveStream
+    {
+        size_t node;
+        uint64_t players;
+    };
+
+    struct SimResult
+    {
+        double max_over_mean;
+        double cv;
+    };
+
+    SimResult simulate(BalanceStrategy strategy, int arrivals, int refresh_every, uint32_t seed)
+    {
+        const auto nodes = makeNodes();
+        NodeBalancer balancer(strategy, nodes);
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> uni(0.0, 1.0);
+        std::vector<LiveStream> live;
+        std::vector<uint64_t> truth(nodes.size(), 0); // Redis 中的真实负载
+
+        auto refresh = [&]
+        {
+            std::vector<NodeLoad> loads;
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                loads.push_back({nodes[i].host, nodes[i].port, 0, truth[i]});
+            }
+            balancer.updateLoads(loads);
+        };
+
+        for (int i = 0; i < arrivals; ++i)
+        {
+            // Zipf(s≈1.1) 近似：大多数流只有个位数观众，少数热门流上千
+            const auto players = static_cast<uint64_t>(std::pow(1.0 - uni(rng), -1.0 / 1.1) - 1.0);
+            const NodeEndpoint* node = balancer.select("live/stream_" + std::to_string(i));
+            const auto index = static_cast<size_t>(node - balancer.nodes().data());
+            live.push_back({index, std::min<uint64_t>(players, 5000)});
+            truth[index] += 1 + live.back().players;
+
+            // 稳态：在线流数量维持在 ~2000，随机结束一条
+            if (live.size() > 2000)
+            {
+                const size_t victim = rng() % live.size();
+                truth[live[victim].node] -= 1 + live[victim].players;
+                live[victim] = live.back();
+                live.pop_back();
+            }
+
+            if ((i + 1) % refresh_every == 0)refresh();
+        }
+
+        // 按 weight 归一化后比较（RoundRobin / LeastTasks 也用同一口径，体现忽略容量差异的代价）
+        std::vector<double> norm(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            norm[i] = static_cast<double>(truth[i]) / kWeights[i];
+        }
+        const double mean = std::accumulate(norm.begin(), norm.end(), 0.0) / static_cast<double>(norm.size());
+        double var = 0;
+        for (double v : norm)var += (v - mean) * (v - mean);
+        var /= static_cast<double>(norm.size());
+
+        return {*std::ranges::max_element(norm) / mean, std::sqrt(var) / mean};
+    }
+
+    const BalanceStrategy kStrategies[] = {
+        BalanceStrategy::RoundRobin, BalanceStrategy::LeastTasks, BalanceStrategy::Weighted,
+        BalanceStrategy::PowerOfTwo, BalanceStrategy::ConsistentHash
+    };
+}
+
+static void BM_Select(benchmark::State& state)
+{
+    static NodeBalancer* balancer = nullptr;
+    const auto strategy = kStrategies[state.range(0)];
+    if (state.thread_index() == 0)
+    {
+        balancer = new NodeBalancer(strategy, makeNodes());
+    }
+
+    const std::string key = "live/stream_" + std::to_string(state.thread_index());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(balancer->select(key));
+    }
+
+    if (state.thread_index() == 0)
+    {
+        delete balancer;
+        balancer = nullptr;
+    }
+    state.SetLabel(std::string(balanceStrategyName(strategy)));
+}
+
+static void BM_Simulate(benchmark::State& state)
+{
+    const auto strategy = kStrategies[state.range(0)];
+    const int refresh_every = static_cast<int>(state.range(1));
+
+    SimResult sum{0, 0};
+    uint32_t seed = 1;
+    for (auto _ : state)
+    {
+        const auto r = simulate(strategy, 20000, refresh_every, seed++);
+        sum.max_over_mean += r.max_over_mean;
+        sum.cv += r.cv;
+    }
+
+    const auto runs = static_cast<double>(state.iterations());
+    state.counters["max_over_mean"] = sum.max_over_mean / runs;
+    state.counters["cv"] = sum.cv / runs;
+    state.SetLabel(std::string(balanceStrategyName(strategy)));
+}
+
+// 稳态放置 4000 条流后增加第 9 个节点，统计换节点的流占比；Arg = 负载系数 * 100
+static void BM_HashChurn(benchmark::State& state)
+{
+    const double load_factor = static_cast<double>(state.range(0)) / 100.0;
+    constexpr int kStreams = 4000;
+
+    double moved_fraction = 0;
+    for (auto _ : state)
+    {
+        auto nodes = makeNodes();
+        NodeBalancer before(BalanceStrategy::ConsistentHash, nodes, load_factor);
+        std::vector<const NodeEndpoint*> placed;
+        for (int i = 0; i < kStreams; ++i)
+        {
+            placed.push_back(before.select("live/stream_" + std::to_string(i)));
+        }
+
+        nodes.push_back({"10.0.1.100", 1935, 1});
+        NodeBalancer after(BalanceStrategy::ConsistentHash, nodes, load_factor);
+        int moved = 0;
+        for (int i = 0; i < kStreams; ++i)
+        {
+            const NodeEndpoint* node = after.select("live/stream_" + std::to_string(i));
+            moved += node->host != placed[i]->host;
+        }
+        moved_fraction = static_cast<double>(moved) / kStreams;
+    }
+
+    // 新节点 weight=1，总权重 17：理想迁移比例 1/17
+    state.counters["moved_fraction"] = moved_fraction;
+    state.counters["ideal"] = 1.0 / 17.0;
+}
+
+BENCHMARK(BM_Select)->DenseRange(0, 4)->ThreadRange(1, 8);
+BENCHMARK(BM_Simulate)->ArgsProduct({{0, 1, 2, 3, 4}, {10, 200}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HashChurn)->Arg(125)->Arg(200)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
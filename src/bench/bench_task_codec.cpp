@@ -0,0 +1,140 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// Redis 任务记录的编解码成本：紧凑二进制（单个 "d" 字段）对照旧的 16 字段 hash
+// 旧格式按 HGETALL 的结果形态构造 unordered_map 再解析，包含逐字段分配与数字解析
+// 计数器 bytes_per_task 为写入 Redis 的 field 名 + value 总字节数
+//
+
+#include <benchmark/benchmark.h>
+
+#include "StreamTaskSerializer.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    StreamTask makeTask()
+    {
+        StreamTask task;
+        task.task_id = 1234567;
+        task.stream_name = "live/room_10086";
+        task.client_id = "player_7f3a9c21";
+        task.type = StreamType::PLAYER;
+        task.state = StreamState::ACTIVE;
+        task.protocol = StreamProtocol::HTTP_FLV;
+        task.server_ip = "10.0.3.17";
+        task.server_port = 8080;
+        task.start_time = std::chrono::system_clock::now();
+        task.last_active_time = task.start_time;
+        task.user_id = "u_20480";
+        task.auth_token = "0f8e2d1c9b7a6f5e";
+        task.transcoding_profile = "720p";
+        return task;
+    }
+
+    std::string toMsString(std::chrono::system_clock::time_point tp)
+    {
+        return std::to_string(
+            std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count());
+    }
+
+    std::unordered_map<std::string, std::string> encodeLegacy(const StreamTask& task)
+    {
+        return {
+            {"stream_name", task.stream_name},
+            {"client_id", task.client_id},
+            {"active", "1"},
+            {"type", toString(task.type)},
+            {"state", toString(task.state)},
+            {"protocol", toString(task.protocol)},
+            {"server_ip", task.server_ip},
+            {"server_port", std::to_string(task.server_port)},
+            {"start_time_ms", toMsString(task.start_time)},
+            {"last_active_time_ms", toMsString(task.last_active_time)},
+            {"user_id", task.user_id},
+            {"auth_token", task.auth_token},
+            {"region", task.region.value_or("")},
+            {"need_transcode", task.need_transcode ? "1" : "0"},
+            {"need_record", task.need_record ? "1" : "0"},
+            {"transcoding_profile", task.transcoding_profile}
+        };
+    }
+
+    size_t storedBytes(const std::unordered_map<std::string, std::string>& fields)
+    {
+        size_t bytes = 0;
+        for (const auto& [field, value] : fields)
+        {
+            bytes += field.size() + value.size();
+        }
+        return bytes;
+    }
+}
+
+static void BM_EncodeLegacyHash(benchmark::State& state)
+{
+    const StreamTask task = makeTask();
+    for (auto _ : state)
+    {
+        auto fields = encodeLegacy(task);
+        benchmark::DoNotOptimize(fields);
+    }
+    const auto fields = encodeLegacy(task);
+    state.counters["fields"] = static_cast<double>(fields.size());
+    state.counters["bytes_per_task"] = static_cast<double>(storedBytes(fields));
+}
+
+BENCHMARK(BM_EncodeLegacyHash);
+
+static void BM_DecodeLegacyHash(benchmark::State& state)
+{
+    const auto fields = encodeLegacy(makeTask());
+    for (auto _ : state)
+    {
+        // HGETALL 的回复每次都要落到新的 map 里
+        auto copy = fields;
+        auto task = StreamTaskSerializer::decodeLegacyHash(copy);
+        benchmark::DoNotOptimize(task);
+    }
+}
+
+BENCHMARK(BM_DecodeLegacyHash);
+
+static void BM_EncodeCompact(benchmark::State& state)
+{
+    const StreamTask task = makeTask();
+    for (auto _ : state)
+    {
+        auto blob = StreamTaskSerializer::encodeCompact(task);
+        benchmark::DoNotOptimize(blob);
+    }
+    // 明文字段 type / last_active_time_ms 与 "d"
+    const auto blob = StreamTaskSerializer::encodeCompact(task);
+    const std::unordered_map<std::string, std::string> fields{
+        {"type", toString(task.type)},
+        {"last_active_time_ms", toMsString(task.last_active_time)},
+        {"d", blob}
+    };
+    state.counters["fields"] = static_cast<double>(fields.size());
+    state.counters["bytes_per_task"] = static_cast<double>(storedBytes(fields));
+}
+
+BENCHMARK(BM_EncodeCompact);
+
+static void BM_DecodeCompact(benchmark::State& state)
+{
+    const auto blob = StreamTaskSerializer::encodeCompact(makeTask());
+    StreamTask task;
+    for (auto _ : state)
+    {
+        bool ok = StreamTaskSerializer::decodeCompact(blob, task);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(task);
+    }
+}
+
+BENCHMARK(BM_DecodeCompact);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,141 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// ThreadPool 提交吞吐对比：SharedQueue (std::queue + mutex) vs WorkStealing (注入队列 + Chase-Lev deque)
+// 以及 submit (packaged_task + future) vs post (InlineTask，无共享状态)
+// 负载：16 个 worker，1/4/16/64 个生产者线程并发提交空任务，度量提交侧吞吐
+// 队列写满时生产者让出 CPU 后重试，重试次数记入 rejected 计数器；alloc/task 取自 Stats::task_allocations
+//
+
+#include <benchmark/benchmark.h>
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    constexpr size_t kWorkers = 16;
+    constexpr size_t kQueueSize = 1 << 16;
+
+    std::unique_ptr<ThreadPool> g_pool;
+    std::atomic<uint64_t> g_executed{0};
+
+    template <ThreadPool::Mode M>
+    void setupPool(const benchmark::State&)
+    {
+        ThreadPool::Config cfg;
+        cfg.num_threads = kWorkers;
+        cfg.max_queue_size = kQueueSize;
+        cfg.log_exceptions = false;
+        cfg.mode = M;
+        g_pool = std::make_unique<ThreadPool>(cfg);
+        g_executed = 0;
+    }
+
+    void teardownPool(const benchmark::State&)
+    {
+        g_pool->stop_and_wait();
+        g_pool.reset();
+    }
+
+    template <bool Post>
+    void runSubmit(benchmark::State& state)
+    {
+        const auto job = []
+        {
+            g_executed.fetch_add(1, std::memory_order_relaxed);
+        };
+
+        uint64_t rejected = 0;
+        for (auto _ : state)
+        {
+            if constexpr (Post)
+            {
+                while (!g_pool->try_post(job))
+                {
+                    ++rejected;
+                    std::this_thread::yield();
+                }
+            }
+            else
+            {
+                while (true)
+                {
+                    try
+                    {
+                        auto f = g_pool->submit(job);
+                        benchmark::DoNotOptimize(f);
+                        break;
+                    }
+                    catch (const std::runtime_error&)
+                    {
+                        ++rejected;
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+        state.counters["rejected"] = benchmark::Counter(static_cast<double>(rejected), benchmark::Counter::kAvgThreads);
+        if (state.thread_index() == 0)
+        {
+            const auto stats = g_pool->get_stats();
+            state.counters["stolen"] = static_cast<double>(stats.stolen_tasks);
+            state.counters["alloc/task"] = stats.total_submitted > 0
+                                               ? static_cast<double>(stats.task_allocations) /
+                                               static_cast<double>(stats.total_submitted)
+                                               : 0.0;
+        }
+    }
+}
+
+static void BM_Submit_SharedQueue(benchmark::State& state)
+{
+    runSubmit<false>(state);
+}
+
+static void BM_Submit_WorkStealing(benchmark::State& state)
+{
+    runSubmit<false>(state);
+}
+
+static void BM_Post_SharedQueue(benchmark::State& state)
+{
+    runSubmit<true>(state);
+}
+
+static void BM_Post_WorkStealing(benchmark::State& state)
+{
+    runSubmit<true>(state);
+}
+
+BENCHMARK(BM_Submit_SharedQueue)
+    ->Setup(setupPool<ThreadPool::Mode::SharedQueue>)
+    ->Teardown(teardownPool)
+    ->Threads(1)->Threads(4)->Threads(16)->Threads(64)
+    ->UseRealTime();
+
+BENCHMARK(BM_Submit_WorkStealing)
+    ->Setup(setupPool<ThreadPool::Mode::WorkStealing>)
+    ->Teardown(teardownPool)
+    ->Threads(1)->Threads(4)->Threads(16)->Threads(64)
+    ->UseRealTime();
+
+BENCHMARK(BM_Post_SharedQueue)
+    ->Setup(setupPool<ThreadPool::Mode::SharedQueue>)
+    ->Teardown(teardownPool)
+    ->Threads(1)->Threads(4)->Threads(16)->Threads(64)
+    ->UseRealTime();
+
+BENCHMARK(BM_Post_WorkStealing)
+    ->Setup(setupPool<ThreadPool::Mode::WorkStealing>)
+    ->Teardown(teardownPool)
+    ->Threads(1)->Threads(4)->Threads(16)->Threads(64)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
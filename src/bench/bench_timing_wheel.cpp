@@ -0,0 +1,128 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// 超时跟踪成本：有序集合（与 task_timestamps ZSET 同构：按截止时间排序 + key 反查）与分层时间轮对比
+// 负载：N 个在线任务，随机 key 反复刷新截止时间（心跳）；Expire 基准每轮推进一个 tick 并补回到期的任务
+// 关注指标：每次 touch 的耗时随 N 的变化；时间轮应与 N 无关
+//
+
+#include <benchmark/benchmark.h>
+
+#include "TimingWheel.h"
+
+#include <chrono>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using Clock = TimingWheel::Clock;
+
+    // 跳表 / 红黑树一类的有序索引：touch = 删除旧 (score, key) + 插入新 (score, key)
+    class OrderedDeadlines
+    {
+    public:
+        void schedule(const std::string& key, int64_t deadline)
+        {
+            if (const auto it = _scores.find(key); it != _scores.end())
+            {
+                _ordered.erase({it->second, key});
+                it->second = deadline;
+            }
+            else
+            {
+                _scores.emplace(key, deadline);
+            }
+            _ordered.emplace(deadline, key);
+        }
+
+    private:
+        std::set<std::pair<int64_t, std::string>> _ordered;
+        std::unordered_map<std::string, int64_t> _scores;
+    };
+
+    std::vector<std::string> makeKeys(size_t n)
+    {
+        std::vector<std::string> keys;
+        keys.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            keys.push_back("task:live_" + std::to_string(i / 8) + ":client_" + std::to_string(i));
+        }
+        return keys;
+    }
+
+    void BM_OrderedSet_Touch(benchmark::State& state)
+    {
+        const auto keys = makeKeys(static_cast<size_t>(state.range(0)));
+        OrderedDeadlines index;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            index.schedule(keys[i], static_cast<int64_t>(60'000 + i));
+        }
+
+        std::mt19937 rng(7);
+        int64_t now = 0;
+        for (auto _ : state)
+        {
+            now += 1;
+            index.schedule(keys[rng() % keys.size()], now + 60'000);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_TimingWheel_Touch(benchmark::State& state)
+    {
+        const auto keys = makeKeys(static_cast<size_t>(state.range(0)));
+        const Clock::time_point start{};
+        TimingWheel wheel(TimingWheel::Config{}, start);
+        for (const auto& key : keys)
+        {
+            wheel.schedule(key, start + std::chrono::seconds(60));
+        }
+
+        std::mt19937 rng(7);
+        int64_t now_ms = 0;
+        for (auto _ : state)
+        {
+            now_ms += 1;
+            wheel.schedule(keys[rng() % keys.size()], start + std::chrono::milliseconds(now_ms + 60'000));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // 稳态：每个 tick 有 N / 60 个任务到期并被重新登记
+    void BM_TimingWheel_AdvanceTick(benchmark::State& state)
+    {
+        const auto keys = makeKeys(static_cast<size_t>(state.range(0)));
+        const Clock::time_point start{};
+        TimingWheel wheel(TimingWheel::Config{}, start);
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            wheel.schedule(keys[i], start + std::chrono::seconds(1 + static_cast<int64_t>(i % 60)));
+        }
+
+        int64_t second = 0;
+        size_t fired = 0;
+        for (auto _ : state)
+        {
+            ++second;
+            auto expired = wheel.advance(start + std::chrono::seconds(second));
+            fired += expired.size();
+            for (const auto& key : expired)
+            {
+                wheel.schedule(key, start + std::chrono::seconds(second + 60));
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(fired));
+    }
+}
+
+BENCHMARK(BM_OrderedSet_Touch)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_TimingWheel_Touch)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_TimingWheel_AdvanceTick)->Arg(1000)->Arg(100000);
+
+BENCHMARK_MAIN();
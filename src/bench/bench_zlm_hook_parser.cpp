@@ -0,0 +1,86 @@
+//
+// Created by wxx on 2026/10/16.
+//
+// Hook 请求体解析对比：json::parse + ZlmHookRequest::from_json vs ZlmHookRequestView::parse
+// 负载：ZLM 典型 on_play 请求体（仓库内无固定样本，取 ZLMediaKit 默认推送字段）
+//
+
+#include <benchmark/benchmark.h>
+
+#include "ZlmHookCommon.h"
+
+#include <string>
+
+namespace
+{
+    // 典型 on_play 请求体 (ZLMediaKit 实际推送字段)
+    const std::string kPlayBody = R"({
+        "mediaServerId": "your_server_id",
+        "app": "live",
+        "id": "140186529001776",
+        "ip": "10.0.0.12",
+        "params": "token=abc123&sg=1",
+        "port": 65284,
+        "schema": "rtmp",
+        "protocol": "rtmp",
+        "stream": "camera_01",
+        "vhost": "__defaultVhost__",
+        "originType": 0,
+        "originTypeStr": "unknown",
+        "originUrl": "",
+        "hook_index": 12
+    })";
+}
+
+// 旧路径：构建完整 DOM，再逐字段拷贝为 std::string / std::map
+static void BM_HookParse_FromJson(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto req = ZlmHookRequest::from_json(json::parse(kPlayBody));
+        benchmark::DoNotOptimize(req);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kPlayBody.size()));
+}
+
+BENCHMARK(BM_HookParse_FromJson);
+
+// 新路径：在请求体上零拷贝扫描
+static void BM_HookParse_View(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        ZlmHookRequestView view;
+        bool ok = ZlmHookRequestView::parse(kPlayBody, view);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(view);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kPlayBody.size()));
+}
+
+BENCHMARK(BM_HookParse_View);
+
+// 新路径 + 进入 ThreadPool 前的物化 (stream_key / client_id / token)，与业务实际开销对齐
+static void BM_HookParse_ViewMaterialize(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        ZlmHookRequestView view;
+        if (!ZlmHookRequestView::parse(kPlayBody, view))
+        {
+            state.SkipWithError("fast path rejected sample payload");
+            break;
+        }
+        auto key = view.stream_key();
+        std::string client_id(view.client_id);
+        std::string token(view.get_token());
+        benchmark::DoNotOptimize(key);
+        benchmark::DoNotOptimize(client_id);
+        benchmark::DoNotOptimize(token);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kPlayBody.size()));
+}
+
+BENCHMARK(BM_HookParse_ViewMaterialize);
+
+BENCHMARK_MAIN();
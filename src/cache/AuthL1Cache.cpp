@@ -0,0 +1,224 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "AuthL1Cache.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    // 链表节点 + 哈希索引槽位的粗略开销，避免大量短 key 时低估内存
+    constexpr size_t kEntryOverhead = 128;
+}
+
+AuthL1Cache::AuthL1Cache(const Config& config)
+    : _capacityBytes(config.capacity_bytes)
+{
+    const size_t shards = std::max<size_t>(1, config.num_shards);
+    _shards.reserve(shards);
+    for (size_t i = 0; i < shards; ++i)
+    {
+        _shards.push_back(std::make_unique<Shard>());
+    }
+
+    _shardCapacity = config.capacity_bytes / shards;
+    _protectedCapacity = static_cast<size_t>(static_cast<double>(_shardCapacity) *
+        std::clamp(config.protected_ratio, 0.0, 1.0));
+
+    LOG_INFO("[AuthL1Cache] Initialized | Capacity: " + std::to_string(config.capacity_bytes) +
+        " bytes | Shards: " + std::to_string(shards));
+}
+
+AuthL1Cache::Shard& AuthL1Cache::shardFor(std::string_view key) const
+{
+    return *_shards[std::hash<std::string_view>{}(key) % _shards.size()];
+}
+
+AuthL1Cache::Lookup AuthL1Cache::get(const std::string& key, StreamAuthData& out)
+{
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    const auto found = shard.index.find(key);
+    if (found == shard.index.end())
+    {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return Lookup::Miss;
+    }
+
+    auto it = found->second;
+    if (Clock::now() >= it->expires_at)
+    {
+        removeLocked(shard, it);
+        _expirations.fetch_add(1, std::memory_order_relaxed);
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return Lookup::Miss;
+    }
+
+    promoteLocked(shard, it);
+
+    out = it->data;
+    if (it->negative)
+    {
+        _negativeHits.fetch_add(1, std::memory_order_relaxed);
+        return Lookup::NegativeHit;
+    }
+
+    _hits.fetch_add(1, std::memory_order_relaxed);
+    return Lookup::Hit;
+}
+
+void AuthL1Cache::put(const std::string& key, const StreamAuthData& data, std::chrono::seconds ttl)
+{
+    insert(key, data, false, ttl);
+}
+
+void AuthL1Cache::putNegative(const std::string& key, const std::string& rejectedToken, std::chrono::seconds ttl)
+{
+    StreamAuthData data;
+    data.authToken = rejectedToken;
+    insert(key, std::move(data), true, ttl);
+}
+
+void AuthL1Cache::insert(const std::string& key, StreamAuthData data, bool negative, std::chrono::seconds ttl)
+{
+    if (ttl.count() <= 0 || _shardCapacity == 0)return;
+
+    const size_t charge = estimateCharge(key, data);
+    if (charge > _shardCapacity)[[unlikely]] return;
+
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    //覆盖写：先移除旧条目，新条目重新从 probation 开始
+    if (const auto found = shard.index.find(key); found != shard.index.end())
+    {
+        removeLocked(shard, found->second);
+    }
+
+    shard.probation.push_front(Entry{key, std::move(data), negative, Clock::now() + ttl, charge, false});
+    auto it = shard.probation.begin();
+    shard.index.emplace(it->key, it);
+    shard.probation_bytes += charge;
+
+    evictLocked(shard);
+}
+
+void AuthL1Cache::erase(const std::string& key)
+{
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (const auto found = shard.index.find(key); found != shard.index.end())
+    {
+        removeLocked(shard, found->second);
+    }
+}
+
+void AuthL1Cache::clear()
+{
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->probation.clear();
+        shard->protected_.clear();
+        shard->probation_bytes = 0;
+        shard->protected_bytes = 0;
+    }
+}
+
+void AuthL1Cache::removeLocked(Shard& shard, EntryList::iterator it)
+{
+    shard.index.erase(std::string_view(it->key));
+    if (it->is_protected)
+    {
+        shard.protected_bytes -= it->charge;
+        shard.protected_.erase(it);
+    }
+    else
+    {
+        shard.probation_bytes -= it->charge;
+        shard.probation.erase(it);
+    }
+}
+
+void AuthL1Cache::promoteLocked(Shard& shard, EntryList::iterator it)
+{
+    if (it->is_protected)
+    {
+        // 已在 protected 段：移到 MRU 位置
+        shard.protected_.splice(shard.protected_.begin(), shard.protected_, it);
+        return;
+    }
+
+    // probation 二次命中：晋升
+    shard.probation_bytes -= it->charge;
+    shard.protected_bytes += it->charge;
+    it->is_protected = true;
+    shard.protected_.splice(shard.protected_.begin(), shard.probation, it);
+
+    //protected 超配额：尾部降级回 probation 头部（仍有一次被再次晋升的机会）
+    while (shard.protected_bytes > _protectedCapacity && !shard.protected_.empty())
+    {
+        auto victim = std::prev(shard.protected_.end());
+        victim->is_protected = false;
+        shard.protected_bytes -= victim->charge;
+        shard.probation_bytes += victim->charge;
+        shard.probation.splice(shard.probation.begin(), shard.protected_, victim);
+    }
+}
+
+void AuthL1Cache::evictLocked(Shard& shard)
+{
+    while (shard.probation_bytes + shard.protected_bytes > _shardCapacity)
+    {
+        // probation 为空说明 protected 配额被设为 100%，此时退化为普通 LRU
+        auto& victims = shard.probation.empty() ? shard.protected_ : shard.probation;
+        if (victims.empty())break;
+
+        removeLocked(shard, std::prev(victims.end()));
+        _evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t AuthL1Cache::estimateCharge(const std::string& key, const StreamAuthData& data)
+{
+    size_t charge = kEntryOverhead + key.size() +
+        data.streamKey.size() + data.clientId.size() + data.authToken.size();
+    for (const auto& [k,v] : data.metadata)
+    {
+        charge += k.size() + v.size() + 64;
+    }
+    return charge;
+}
+
+AuthL1Cache::Stats AuthL1Cache::getStats() const
+{
+    Stats s{};
+    s.hits = _hits.load(std::memory_order_relaxed);
+    s.negative_hits = _negativeHits.load(std::memory_order_relaxed);
+    s.misses = _misses.load(std::memory_order_relaxed);
+    s.evictions = _evictions.load(std::memory_order_relaxed);
+    s.expirations = _expirations.load(std::memory_order_relaxed);
+    s.capacity_bytes = _capacityBytes;
+
+    for (const auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        s.entries += shard->index.size();
+        s.bytes += shard->probation_bytes + shard->protected_bytes;
+    }
+    return s;
+}
+
+void AuthL1Cache::resetStats()
+{
+    _hits = 0;
+    _negativeHits = 0;
+    _misses = 0;
+    _evictions = 0;
+    _expirations = 0;
+}
@@ -1,14 +1,33 @@
 #include "CacheManager.h"
 
+#include <cstdio>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include <future>
+#include <iterator>
 #include "ConfigLoader.h"
 #include "HookServer.h"
 #include "Logger.h"
 
 using json = nlohmann::json;
 
+namespace
+{
+    constexpr std::string_view kNegativeMarkerPrefix = "__EMPTY__:";
+
+    // FNV-1a：跨进程稳定，各网关对同一 Token 得到同一摘要；只用于比对，不做安全用途
+    uint64_t fnv1a(std::string_view data) noexcept
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for (const unsigned char c : data)
+        {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+}
+
 //单例实现
 CacheManager& CacheManager::instance()
 {
@@ -52,6 +71,7 @@ void CacheManager::init(const std::string& host, int port, int pool_size, const
         }
 
         _redis = std::move(redis_instance);
+        _options = opts;
 
         _io_running.store(true, std::memory_order_relaxed);
 
@@ -170,23 +190,30 @@ void CacheManager::setAuthResultByKey(const std::string& cacheKey, int result) c
 }
 
 //Auth Data
-std::optional<StreamAuthData> CacheManager::getAuthDataFromCache(const std::string& streamKey) const
+CachedAuthData CacheManager::getAuthDataFromCache(const std::string& streamKey, const std::string& authToken) const
 {
-    return getAuthDataFromCacheByKey(buildKey(streamKey, "data"));
+    return getAuthDataFromCacheByKey(buildKey(streamKey, "data"), authToken);
 }
 
-std::optional<StreamAuthData> CacheManager::getAuthDataFromCacheByKey(const std::string& customKey) const
+CachedAuthData CacheManager::getAuthDataFromCacheByKey(const std::string& customKey,
+                                                       const std::string& authToken) const
 {
     auto opt = getString(customKey);
-    if (!opt || *opt == "__EMPTY__")
+    if (!opt)
     {
         return std::nullopt;
     }
+    if (opt->starts_with("__EMPTY__"))
+    {
+        // 其它 Token 留下的负缓存视为未命中，交给 DB 裁决
+        if (isNegativeAuthMarkerFor(*opt, authToken))return std::optional<StreamAuthData>{};
+        return std::nullopt;
+    }
 
     try
     {
         auto j = json::parse(*opt);
-        return j.get<StreamAuthData>();
+        return std::optional<StreamAuthData>{j.get<StreamAuthData>()};
     }
     catch (const std::exception& e)
     {
@@ -214,10 +241,167 @@ void CacheManager::setAuthDataToCacheByKey(const std::string& key, const StreamA
     }
 }
 
-void CacheManager::setEmptyAuthDataToCache(const std::string& key, int ttl) const
+void CacheManager::setEmptyAuthDataToCache(const std::string& key, const std::string& rejectedToken, int ttl) const
 {
     if (ttl <= 0) ttl = _cacheTTL;
-    setString(key, "__EMPTY__", ttl);
+    setString(key, negativeAuthMarker(rejectedToken), ttl);
+}
+
+std::string CacheManager::negativeAuthMarker(std::string_view rejectedToken)
+{
+    char digest[17];
+    std::snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(fnv1a(rejectedToken)));
+
+    std::string marker;
+    marker.reserve(kNegativeMarkerPrefix.size() + 16);
+    marker.append(kNegativeMarkerPrefix).append(digest, 16);
+    return marker;
+}
+
+bool CacheManager::isNegativeAuthMarkerFor(std::string_view value, std::string_view authToken)
+{
+    return value == negativeAuthMarker(authToken);
+}
+
+std::vector<CachedAuthData> CacheManager::getAuthDataBatchFromCacheByKeys(
+    const std::vector<std::string>& keys, const std::vector<std::string>& authTokens) const
+{
+    std::vector<CachedAuthData> results(keys.size());
+    if (!_redis || keys.empty())return results;
+
+    std::vector<sw::redis::OptionalString> values;
+    values.reserve(keys.size());
+
+    try
+    {
+        _redis->mget(keys.begin(), keys.end(), std::back_inserter(values));
+    }
+    catch (const sw::redis::Error& e)
+    {
+        LOG_ERROR("[CacheManager ERROR] Redis MGET failed for " + std::to_string(keys.size()) + " keys: " + e.what());
+        return results;
+    }
+
+    for (size_t i = 0; i < values.size() && i < keys.size(); ++i)
+    {
+        if (!values[i])continue;
+        if (values[i]->starts_with("__EMPTY__"))
+        {
+            if (i < authTokens.size() && isNegativeAuthMarkerFor(*values[i], authTokens[i]))results[i].emplace();
+            continue;
+        }
+
+        try
+        {
+            results[i].emplace(json::parse(*values[i]).get<StreamAuthData>());
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("[CacheManager ERROR] Failed to parse StreamAuthData from key '" + keys[i] + "': " + e.what());
+        }
+    }
+    return results;
+}
+
+bool CacheManager::setAuthDataBatchToCacheByKeys(const std::vector<AuthCacheEntry>& entries) const
+{
+    if (!_redis)return false;
+    if (entries.empty())return true;
+
+    try
+    {
+        // 复用连接池中的连接，避免每个批次新建 TCP 连接
+        auto pipe = _redis->pipeline(false);
+        for (const auto& [key,data,ttl,rejectedToken] : entries)
+        {
+            //Safety:never allow permanent keys
+            const long long effective_ttl = ttl > 0 ? ttl : _cacheTTL;
+            pipe.setex(key, effective_ttl, data ? json(*data).dump() : negativeAuthMarker(rejectedToken));
+        }
+        pipe.exec();
+        return true;
+    }
+    catch (const sw::redis::Error& e)
+    {
+        LOG_ERROR("[CacheManager ERROR] Pipelined SETEX failed for " + std::to_string(entries.size()) +
+            " keys: " + e.what());
+        return false;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("[CacheManager ERROR] Unexpected exception in batch SETEX: " + std::string(e.what()));
+        return false;
+    }
+}
+
+//Lua Script
+bool CacheManager::loadScript(RedisScript& script) const
+{
+    if (!_redis)return false;
+
+    try
+    {
+        script._sha = _redis->script_load(script.source());
+        return true;
+    }
+    catch (const sw::redis::Error& e)
+    {
+        LOG_ERROR("[CacheManager ERROR] SCRIPT LOAD failed: " + std::string(e.what()));
+        return false;
+    }
+}
+
+long long CacheManager::evalScriptInt(const RedisScript& script, const std::vector<std::string>& keys,
+                                      const std::vector<std::string>& args) const
+{
+    if (!_redis)
+    {
+        throw std::runtime_error("CacheManager not initialized");
+    }
+
+    if (!script.sha().empty())
+    {
+        try
+        {
+            return _redis->evalsha<long long>(script.sha(), keys.begin(), keys.end(), args.begin(), args.end());
+        }
+        catch (const sw::redis::ReplyError& e)
+        {
+            if (!std::string_view(e.what()).starts_with("NOSCRIPT"))throw;
+            LOG_WARN("[CacheManager] NOSCRIPT for sha=" + script.sha() + ", falling back to EVAL");
+        }
+    }
+
+    return _redis->eval<long long>(script.source(), keys.begin(), keys.end(), args.begin(), args.end());
+}
+
+std::vector<std::string> CacheManager::evalScriptList(const RedisScript& script, const std::vector<std::string>& keys,
+                                                      const std::vector<std::string>& args) const
+{
+    if (!_redis)
+    {
+        throw std::runtime_error("CacheManager not initialized");
+    }
+
+    std::vector<std::string> result;
+    if (!script.sha().empty())
+    {
+        try
+        {
+            _redis->evalsha(script.sha(), keys.begin(), keys.end(), args.begin(), args.end(),
+                            std::back_inserter(result));
+            return result;
+        }
+        catch (const sw::redis::ReplyError& e)
+        {
+            if (!std::string_view(e.what()).starts_with("NOSCRIPT"))throw;
+            LOG_WARN("[CacheManager] NOSCRIPT for sha=" + script.sha() + ", falling back to EVAL");
+            result.clear();
+        }
+    }
+
+    _redis->eval(script.source(), keys.begin(), keys.end(), args.begin(), args.end(), std::back_inserter(result));
+    return result;
 }
 
 //Hash
@@ -254,6 +438,25 @@ std::unordered_map<std::string, std::string> CacheManager::hashGetAll(const std:
     }
 }
 
+std::vector<std::optional<std::string>> CacheManager::hashMGet(const std::string& key,
+                                                              const std::vector<std::string>& fields) const
+{
+    if (!_redis || fields.empty()) return std::vector<std::optional<std::string>>(fields.size());
+
+    try
+    {
+        std::vector<std::optional<std::string>> result;
+        result.reserve(fields.size());
+        _redis->hmget(key, fields.begin(), fields.end(), std::back_inserter(result));
+        return result;
+    }
+    catch (const sw::redis::Error& e)
+    {
+        LOG_ERROR("[CacheManager ERROR] HMGET failed for key '"+key+"': "+e.what());
+        return std::vector<std::optional<std::string>>(fields.size());
+    }
+}
+
 bool CacheManager::hashDel(const std::string& key, const std::string& field) const
 {
     if (!_redis) return false;
@@ -406,6 +609,40 @@ std::vector<std::string> CacheManager::zsetRangeByScore(const std::string& key,
     }
 }
 
+std::vector<std::string> CacheManager::zsetRangeByScore(const std::string& key, double min, double max,
+                                                        long long offset, long long count) const
+{
+    if (!_redis)
+    {
+        throw std::runtime_error("CacheManager not initialized");
+    }
+
+    std::vector<std::string> members;
+    members.reserve(static_cast<size_t>(count));
+    sw::redis::BoundedInterval<double> interval(min, max, sw::redis::BoundType::CLOSED);
+    sw::redis::LimitOptions limit;
+    limit.offset = offset;
+    limit.count = count;
+    _redis->zrangebyscore(key, interval, limit, std::back_inserter(members));
+    return members;
+}
+
+size_t CacheManager::zsetCount(const std::string& key, double min, double max) const
+{
+    if (!_redis) return 0;
+
+    try
+    {
+        const auto n = _redis->zcount(key, sw::redis::BoundedInterval<double>(min, max, sw::redis::BoundType::CLOSED));
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    catch (const sw::redis::Error& e)
+    {
+        LOG_ERROR("[CacheManager ERROR] ZCOUNT failed for key '" + key + "': " + e.what());
+        return 0;
+    }
+}
+
 bool CacheManager::zsetRem(const std::string& key, const std::string& member) const
 {
     if (!_redis) return false;
@@ -498,3 +735,45 @@ bool CacheManager::ping() const
         return false;
     }
 }
+
+bool CacheManager::enableKeyspaceEvents() const
+{
+    if (!_redis)return false;
+
+    try
+    {
+        // CONFIG GET 返回 [name, value]
+        const auto reply = _redis->command<std::vector<std::string>>("CONFIG", "GET", "notify-keyspace-events");
+        std::string flags = reply.size() >= 2 ? reply[1] : "";
+
+        // 'A' 是 "g$lshzxe" 的别名，已包含 x
+        const bool has_event = flags.find('E') != std::string::npos;
+        const bool has_expired = flags.find('x') != std::string::npos || flags.find('A') != std::string::npos;
+        if (has_event && has_expired)return true;
+
+        if (!has_event)flags += 'E';
+        if (!has_expired)flags += 'x';
+        _redis->command<std::string>("CONFIG", "SET", "notify-keyspace-events", flags);
+        LOG_INFO("CacheManager: notify-keyspace-events set to '" + flags + "'");
+        return true;
+    }
+    catch (const sw::redis::Error& e)
+    {
+        LOG_WARN("CacheManager: Cannot enable keyspace events: " + std::string(e.what()));
+        return false;
+    }
+}
+
+sw::redis::Subscriber CacheManager::createSubscriber(std::chrono::milliseconds socket_timeout) const
+{
+    if (!_redis)
+    {
+        throw std::runtime_error("CacheManager not initialized");
+    }
+
+    // 订阅者独占一条连接，不占用连接池
+    auto opts = _options;
+    opts.socket_timeout = socket_timeout;
+    sw::redis::Redis redis(opts);
+    return redis.subscriber();
+}
@@ -10,7 +10,7 @@ HookController::HookController(HookUseCase& use_case)
 {
 }
 
-void HookController::routeHook(const ZlmHookRequest& hook, ZlmHookCallback callback) const
+void HookController::routeHook(const ZlmHookRequestView& hook, ZlmHookCallback callback) const
 {
     switch (hook.action)
     {
@@ -39,7 +39,7 @@ void HookController::routeHook(const ZlmHookRequest& hook, ZlmHookCallback callb
     }
 }
 
-void HookController::handlePublish(const ZlmHookRequest& hook, ZlmHookCallback callback) const
+void HookController::handlePublish(const ZlmHookRequestView& hook, ZlmHookCallback callback) const
 {
     _use_case.processPublish(hook, [cb=std::move(callback)](const auto& dec)
     {
@@ -47,21 +47,22 @@ void HookController::handlePublish(const ZlmHookRequest& hook, ZlmHookCallback c
     });
 }
 
-void HookController::handlePlay(const ZlmHookRequest& hook, ZlmHookCallback callback) const
+void HookController::handlePlay(const ZlmHookRequestView& hook, ZlmHookCallback callback) const
 {
-    LOG_INFO("DEBUG: on_play hook content: vhost=" + hook.vhost + ", app=" + hook.app + ", stream=" + hook.stream);
+    LOG_DEBUG("on_play hook content: vhost=" + std::string(hook.vhost) + ", app=" + std::string(hook.app) +
+        ", stream=" + std::string(hook.stream));
     _use_case.processPlay(hook, [cb = std::move(callback)](const auto& dec)
     {
         cb(dec.to_response());
     });
 }
 
-void HookController::handlePublishDone(const ZlmHookRequest& hook, const ZlmHookCallback& callback) const
+void HookController::handlePublishDone(const ZlmHookRequestView& hook, const ZlmHookCallback& callback) const
 {
     callback(_use_case.processPublishDone(hook).to_response());
 }
 
-void HookController::handlePlayDone(const ZlmHookRequest& hook, const ZlmHookCallback& callback) const
+void HookController::handlePlayDone(const ZlmHookRequestView& hook, const ZlmHookCallback& callback) const
 {
     callback(_use_case.processPlayDone(hook).to_response());
 }
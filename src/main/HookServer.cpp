@@ -8,8 +8,11 @@
 #include "Logger.h"
 #include <nlohmann/json.hpp>
 #include <unordered_set>
+#include <pthread.h>
+#include <sched.h>
 
 #include "MetricsCollector.h"
+#include "ServerMetricsProvider.h"
 
 using json = nlohmann::json;
 
@@ -54,6 +57,48 @@ namespace
             return {http::status::internal_server_error, 4};
         }
     }
+
+#ifdef SO_REUSEPORT
+    using reuse_port_option = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+    // 进程允许使用的 CPU（taskset / cgroup cpuset 限定后不一定从 0 开始连续）；查询失败时退回 0..N-1
+    std::vector<int> allowedCpus()
+    {
+        std::vector<int> cpus;
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &mask))cpus.push_back(cpu);
+            }
+        }
+
+        if (cpus.empty())
+        {
+            for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+            {
+                cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        return cpus;
+    }
+
+    // 将线程绑定到指定 CPU（失败仅告警，不影响服务）
+    void pinThreadToCpu(std::thread& t, int cpu)
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+
+        if (const int rc = pthread_setaffinity_np(t.native_handle(), sizeof(cpu_set_t), &cpuset); rc != 0)
+        {
+            LOG_WARN("HookServer: Failed to pin shard thread to cpu " + std::to_string(cpu) +
+                " (errno=" + std::to_string(rc) + ")");
+        }
+    }
 }
 
 //HookSession
@@ -83,6 +128,8 @@ void HookSession::start()
 void HookSession::do_read()
 {
     _request = {};
+    _responded.store(false, std::memory_order_relaxed); // keep-alive 连接上的每个请求各自应答一次
+    if (_first_request)_read_started = HookTrace::Clock::now();
     http::async_read(_socket, _buffer, _request,
                      beast::bind_front_handler(&HookSession::on_read, shared_from_this()));
 }
@@ -104,6 +151,10 @@ void HookSession::on_read(const beast::error_code& ec, std::size_t bytes_transfe
     }
 
     LOG_DEBUG("Received " + std::to_string(bytes_transferred) + " bytes from hook client");
+    _bytes_in = bytes_transferred;
+    _received = HookTrace::Clock::now();
+    _read_elapsed = _first_request ? _received - _read_started : HookTrace::Clock::duration{};
+    _first_request = false;
 
     handle_request();
 }
@@ -116,51 +167,24 @@ void HookSession::handle_request()
 
     if (_request.method() == http::verb::get)
     {
-        // /metrics 端点
+        // /metrics 端点：Prometheus 文本格式，直接复用刷新线程预渲染的缓冲区
         if (path == "/metrics")
         {
-            auto& collector = MetricsCollector::instance();
-            nlohmann::json j = collector.collectAll();
-
-            _response = {};
-            _response.version(_request.version());
-            _response.result(http::status::ok);
-            _response.set(http::field::content_type, "application/json");
-            _response.set(http::field::server, "StreamGate/1.0");
-            _response.keep_alive(_request.keep_alive());
-            _response.body() = j.dump(2);
-            _response.prepare_payload();
-
-            return http::async_write(_socket, _response,
-                                     net::bind_executor(
-                                         _strand,
-                                         [self=shared_from_this(),ka=_response.keep_alive()](auto ec, auto bytes)
-                                         {
-                                             self->on_write(ka, ec, bytes);
-                                         }));
+            const auto text = MetricsCollector::instance().exportPrometheus();
+            return send_payload(PrometheusWriter::kContentType, *text);
+        }
+
+        // /metrics.json 端点：人工排查用的 JSON 视图
+        if (path == "/metrics.json")
+        {
+            return send_payload("application/json", MetricsCollector::instance().collectAll().dump(2));
         }
 
         // /health 端点
         if (path == "/health")
         {
             nlohmann::json j{{"status", "healthy"}, {"timestamp", std::time(nullptr)}};
-
-            _response = {};
-            _response.version(_request.version());
-            _response.result(http::status::ok);
-            _response.set(http::field::content_type, "application/json");
-            _response.set(http::field::server, "StreamGate/1.0");
-            _response.keep_alive(_request.keep_alive());
-            _response.body() = j.dump(2);
-            _response.prepare_payload();
-
-            return http::async_write(_socket, _response,
-                                     net::bind_executor(
-                                         _strand,
-                                         [self=shared_from_this(),ka=_response.keep_alive()](auto ec, auto bytes)
-                                         {
-                                             self->on_write(ka, ec, bytes);
-                                         }));
+            return send_payload("application/json", j.dump(2));
         }
 
         return send_response(404, 999, "Not found");
@@ -171,29 +195,54 @@ void HookSession::handle_request()
 
     HookAction action = map_path_to_action(path);
 
+    // 只统计 Hook 请求：写在当前 io 线程的槽位上；结果由产生应答的线程（io 线程或 ThreadPool worker）记录
+    _tracked_action = action;
+    ThreadLocalRegistry::instance().recordRequest(action, _bytes_in);
+
     if (action == HookAction::Unknown)
     {
+        complete_tracked(false);
         return send_response(404, 999, "Not found");
     }
 
+    _trace.reset(action, _received);
+    if (_read_elapsed != HookTrace::Clock::duration{})
+    {
+        _trace.record(HookStage::HttpRead, _read_elapsed);
+    }
+
     try
     {
-        auto j = json::parse(_request.body());
+        //快速路径：直接在请求体上做零拷贝扫描，视图字段指向 _request 的 body
+        ZlmHookRequestView hook;
 
-        auto hook_opt = ZlmHookRequest::from_json(j);
+        // 兜底路径：含转义 / JSON 编码 params 等情况，走完整 DOM 解析（owned 保证视图期间的存储）
+        std::optional<ZlmHookRequest> owned;
 
-        if (!hook_opt)
+        StageTimer parseTimer(&_trace, HookStage::JsonParse);
+        if (!ZlmHookRequestView::parse(_request.body(), hook))
         {
-            LOG_WARN("JSON parse failed for action: " + std::to_string(static_cast<int>(action)));
-            return send_response(400, 2, "Invalid hook format");
+            auto j = json::parse(_request.body());
+
+            owned = ZlmHookRequest::from_json(j);
+
+            if (!owned)
+            {
+                LOG_WARN("JSON parse failed for action: " + std::to_string(static_cast<int>(action)));
+                complete_tracked(false);
+                return send_response(400, 2, "Invalid hook format");
+            }
+
+            hook = owned->view();
         }
+        parseTimer.stop();
 
-        hook_opt->action = action;
+        hook.action = action;
+        hook.trace = &_trace;
 
-        _controller.routeHook(*hook_opt, [self=shared_from_this()](const ZlmHookResponse& resp)
+        _controller.routeHook(hook, [self=shared_from_this()](const ZlmHookResponse& resp)
         {
-            bool expected = false;
-            if (!self->_responded.compare_exchange_strong(expected, true))return;
+            if (!self->complete_tracked(resp.code == ZlmHookResult::SUCCESS))return;
 
             auto [h_status,b_code] = map_to_http(resp.code);
             net::post(self->_strand, [self,h=h_status,b=b_code,m=resp.message]
@@ -205,16 +254,30 @@ void HookSession::handle_request()
     catch (const json::exception& e)
     {
         LOG_WARN("JSON error: " + std::string(e.what()));
-        send_response(400, 2, "Protocol format error");
+        if (complete_tracked(false))
+        {
+            send_response(400, 2, "Protocol format error");
+        }
     }
     catch (const std::exception& e)
     {
         LOG_ERROR("Critical process error: " + std::string(e.what()));
+        // 回调已经应答过则不再重复写
+        if (!complete_tracked(false))return;
         auto [h_status,b_code] = map_to_http(ZlmHookResult::INTERNAL_ERROR);
         send_response(static_cast<int>(h_status), b_code, "Internal service error");
     }
 }
 
+bool HookSession::complete_tracked(bool ok)
+{
+    bool expected = false;
+    if (!_responded.compare_exchange_strong(expected, true))return false;
+
+    ThreadLocalRegistry::instance().recordResult(_tracked_action.value_or(HookAction::Unknown), ok);
+    return true;
+}
+
 void HookSession::send_response(int http_status, int business_code, const std::string& message)
 {
     _response = {};
@@ -236,6 +299,30 @@ void HookSession::send_response(int http_status, int business_code, const std::s
     }
 
     _response.prepare_payload();
+    _write_started = HookTrace::Clock::now();
+
+    http::async_write(
+        _socket,
+        _response,
+        net::bind_executor(
+            _strand,
+            [self=shared_from_this(),keep_alive=_response.keep_alive()](const beast::error_code& ec, std::size_t bytes)
+            {
+                self->on_write(keep_alive, ec, bytes);
+            }));
+}
+
+void HookSession::send_payload(std::string_view content_type, std::string_view body)
+{
+    _response = {};
+    _response.version(_request.version());
+    _response.result(http::status::ok);
+    _response.set(http::field::content_type, beast::string_view(content_type.data(), content_type.size()));
+    _response.set(http::field::server, "StreamGate/1.0");
+    _response.keep_alive(_request.keep_alive());
+    _response.body().assign(body);
+    _response.prepare_payload();
+    _write_started = HookTrace::Clock::now();
 
     http::async_write(
         _socket,
@@ -258,7 +345,17 @@ void HookSession::on_write(bool keep_alive, const beast::error_code& ec, std::si
         return;
     }
 
-    (void)bytes_transferred;
+    if (_tracked_action)
+    {
+        ThreadLocalRegistry::instance().recordBytesOut(*_tracked_action, bytes_transferred);
+        if (*_tracked_action != HookAction::Unknown)
+        {
+            const auto now = HookTrace::Clock::now();
+            _trace.record(HookStage::ResponseWrite, now - _write_started);
+            _trace.record(HookStage::Total, now - _received);
+        }
+        _tracked_action.reset();
+    }
 
     if (keep_alive)
     {
@@ -280,13 +377,25 @@ void HookSession::on_write(bool keep_alive, const beast::error_code& ec, std::si
 
 //HookListener
 
-HookListener::HookListener(net::io_context& ioc, const tcp::endpoint& endpoint, HookController& controller)
+HookListener::HookListener(net::io_context& ioc, const tcp::endpoint& endpoint, HookController& controller,
+                           bool reuse_port, bool single_threaded)
     : _ioc(ioc),
       _acceptor(net::make_strand(ioc)),
-      _controller(controller)
+      _controller(controller),
+      _single_threaded(single_threaded)
 {
     _acceptor.open(endpoint.protocol());
     _acceptor.set_option(net::socket_base::reuse_address(true));
+
+    if (reuse_port)
+    {
+#ifdef SO_REUSEPORT
+        _acceptor.set_option(reuse_port_option(true));
+#else
+        throw std::runtime_error("SO_REUSEPORT is not supported on this platform");
+#endif
+    }
+
     _acceptor.bind(endpoint);
     _acceptor.listen();
 }
@@ -310,7 +419,13 @@ void HookListener::stop()
 
 void HookListener::do_accept()
 {
-    _acceptor.async_accept(net::make_strand(_ioc),
+    // 单线程分片：会话直接落在本分片的 io_context 上，无需 strand 串行化
+    // 共享模式：每个会话一个 strand，防止多线程并发驱动同一 socket
+    auto session_executor = _single_threaded
+                                ? net::any_io_executor(_ioc.get_executor())
+                                : net::any_io_executor(net::make_strand(_ioc));
+
+    _acceptor.async_accept(session_executor,
                            [self=shared_from_this()](const beast::error_code& ec, tcp::socket socket)
                            {
                                if (ec == net::error::operation_aborted)return;
@@ -355,17 +470,14 @@ bool HookServer::start()
     try
     {
         tcp::endpoint ep(net::ip::make_address(_config.address), _config.port);
-        _listener = std::make_shared<HookListener>(_ioc, ep, _controller);
-
-        _listener->start();
 
-        _work_guard.emplace(net::make_work_guard(_ioc));
-        for (int i = 0; i < _config.io_threads; ++i)
+        if (isSharded())
         {
-            _worker_threads.emplace_back([this]
-            {
-                _ioc.run();
-            });
+            startSharded(ep);
+        }
+        else
+        {
+            startShared(ep);
         }
 
         LOG_INFO("HookServer: started successfully on port " + std::to_string(_config.port));
@@ -373,13 +485,73 @@ bool HookServer::start()
     }
     catch (const std::exception& e)
     {
-        _running.store(false, std::memory_order_relaxed);
         LOG_ERROR("HookServer: failed to start: " + std::string(e.what()));
 
+        // 回收已启动的分片/线程，保证失败后可以重新 start()
+        stop();
+        _running.store(false, std::memory_order_relaxed);
+
         return false;
     }
 }
 
+void HookServer::startShared(const tcp::endpoint& ep)
+{
+    _listener = std::make_shared<HookListener>(_ioc, ep, _controller);
+
+    _listener->start();
+
+    _work_guard.emplace(net::make_work_guard(_ioc));
+    for (int i = 0; i < _config.io_threads; ++i)
+    {
+        _worker_threads.emplace_back([this]
+        {
+            ScopedWorkerStats stats_slot;
+            _ioc.run();
+        });
+    }
+
+    LOG_INFO("HookServer: Shared io_context mode with " + std::to_string(_config.io_threads) + " threads");
+}
+
+void HookServer::startSharded(const tcp::endpoint& ep)
+{
+    _shards.reserve(_config.io_shards);
+
+    //先全部绑定端口再启动线程：任何一个分片 bind 失败都不会留下半启动状态
+    for (int i = 0; i < _config.io_shards; ++i)
+    {
+        auto shard = std::make_unique<IoShard>();
+        shard->listener = std::make_shared<HookListener>(shard->ioc, ep, _controller, true, true);
+        _shards.push_back(std::move(shard));
+    }
+
+    // 分片按顺序轮流分到允许的 CPU 上，不会绑到掩码之外的核心
+    const std::vector<int> cpus = _config.pin_shard_threads ? allowedCpus() : std::vector<int>{};
+
+    for (size_t i = 0; i < _shards.size(); ++i)
+    {
+        auto& shard = *_shards[i];
+
+        shard.listener->start();
+        shard.work_guard.emplace(net::make_work_guard(shard.ioc));
+        shard.thread = std::thread([&shard]
+        {
+            ScopedWorkerStats stats_slot;
+            shard.ioc.run();
+        });
+
+        if (!cpus.empty())
+        {
+            pinThreadToCpu(shard.thread, cpus[i % cpus.size()]);
+        }
+    }
+
+    LOG_INFO("HookServer: Sharded mode with " + std::to_string(_shards.size()) +
+        " io_context shards (SO_REUSEPORT" + (!cpus.empty() ? ", pinned to " + std::to_string(cpus.size()) +
+            " allowed cpus)" : ")"));
+}
+
 void HookServer::stop()
 {
     if (!_running.exchange(false))
@@ -412,5 +584,30 @@ void HookServer::stop()
 
     _worker_threads.clear();
 
+    //分片模式：先关闭所有 Acceptor，停止接收新连接，再逐个释放 work guard 并等待存量会话结束
+    for (auto& shard : _shards)
+    {
+        if (shard->listener)
+        {
+            shard->listener->stop();
+            shard->listener.reset();
+        }
+    }
+
+    for (auto& shard : _shards)
+    {
+        shard->work_guard.reset();
+        if (shard->thread.joinable())
+        {
+            shard->thread.join();
+        }
+    }
+
+    if (!_shards.empty())
+    {
+        LOG_INFO("HookServer: " + std::to_string(_shards.size()) + " io shards joined.");
+        _shards.clear();
+    }
+
     LOG_INFO("HookServer: All worker threads joined. Shutdown complete.");
 }
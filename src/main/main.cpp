@@ -19,19 +19,35 @@
 #include "HookServer.h"
 #include "HybridAuthRepository.h"
 #include "RedisStreamStateManager.h"
+#include "InMemoryStreamStateManager.h"
+#include "WriteBehindStreamStateManager.h"
+#include "StateMetricsProvider.h"
 #include "MetricsCollector.h"
 #include "ServerMetricsProvider.h"
 #include "SchedulerMetricsProvider.h"
 #include "CacheMetricsProvider.h"
 #include "DatabaseMetricsProvider.h"
+#include "LifecycleMetricsProvider.h"
+#include "AuthMetricsProvider.h"
+#include "NodeHealthMetricsProvider.h"
+#include "NodeHealthProber.h"
+#include "LifecycleExecutor.h"
 #include "MetricsRegistry.h"
 #include "HealthChecker.h"
+#include "ConfigWatcher.h"
+#include "TaskExpiryListener.h"
 
 // 强制链接所有Provider
 extern "C" void ForceLink_ServerMetricsProvider();
 extern "C" void ForceLink_SchedulerMetricsProvider();
 extern "C" void ForceLink_CacheMetricsProvider();
 extern "C" void ForceLink_DatabaseMetricsProvider();
+extern "C" void ForceLink_LifecycleMetricsProvider();
+extern "C" void ForceLink_AuthMetricsProvider();
+extern "C" void ForceLink_LoggerMetricsProvider();
+extern "C" void ForceLink_LatencyMetricsProvider();
+extern "C" void ForceLink_NodeHealthMetricsProvider();
+extern "C" void ForceLink_StateMetricsProvider();
 
 // 全局退出信号上下文
 struct ShutdownContext
@@ -39,6 +55,7 @@ struct ShutdownContext
     std::atomic<bool> running{true};
     std::condition_variable cv;
     std::mutex mtx;
+    std::atomic<ConfigWatcher*> config_watcher{nullptr};
 } g_ctx;
 
 //信号处理
@@ -49,12 +66,27 @@ void signalHandler(int sig)
     g_ctx.cv.notify_all();
 }
 
+// SIGHUP：只写 eventfd，解析与替换在 ConfigWatcher 线程完成
+void reloadSignalHandler(int)
+{
+    if (auto* watcher = g_ctx.config_watcher.load())
+    {
+        watcher->requestReload();
+    }
+}
+
 int main(int argc, char* argv[])
 {
     ForceLink_ServerMetricsProvider();
     ForceLink_SchedulerMetricsProvider();
     ForceLink_CacheMetricsProvider();
     ForceLink_DatabaseMetricsProvider();
+    ForceLink_LifecycleMetricsProvider();
+    ForceLink_AuthMetricsProvider();
+    ForceLink_LoggerMetricsProvider();
+    ForceLink_LatencyMetricsProvider();
+    ForceLink_NodeHealthMetricsProvider();
+    ForceLink_StateMetricsProvider();
 
     //加载配置
     const std::string ini_path = "config/config.ini";
@@ -66,9 +98,15 @@ int main(int argc, char* argv[])
         std::unique_ptr<HookServer> server;
         std::unique_ptr<HookController> controller;
         std::unique_ptr<HookUseCase> use_case;
+        std::unique_ptr<LifecycleExecutor> lifecycle;
+        std::unique_ptr<NodeHealthProber> node_prober; // 须晚于 scheduler 析构
         std::unique_ptr<StreamTaskScheduler> scheduler;
+        std::unique_ptr<ConfigWatcher> config_watcher; // 回调引用 scheduler / node_prober，须最先析构
+        std::unique_ptr<TaskExpiryListener> expiry_listener; // 回调引用 scheduler / lifecycle
         std::unique_ptr<AuthManager> auth_manager;
-        std::unique_ptr<RedisStreamStateManager> state_manager;
+        std::unique_ptr<IStreamStateManager> state_store; // 启用写回时被 state_manager 引用，须晚于其析构
+        std::unique_ptr<IStreamStateManager> state_manager;
+        const WriteBehindStreamStateManager* write_behind_view = nullptr;
         std::unique_ptr<DBManager> db_manager;
         // ================================================================
         // Configuration & Logger
@@ -91,6 +129,11 @@ int main(int argc, char* argv[])
         log_cfg.log_to_console = ConfigLoader::instance().getBool("LOG_TO_CONSOLE", true);
         log_cfg.log_to_file = ConfigLoader::instance().getBool("LOG_TO_FILE", false);
         log_cfg.log_file_path = ConfigLoader::instance().getString("LOG_FILE_PATH", "streamgate.log");
+        log_cfg.async = ConfigLoader::instance().getBool("LOG_ASYNC", false);
+        log_cfg.async_ring_capacity = static_cast<size_t>(ConfigLoader::instance().getInt("LOG_ASYNC_RING_SIZE", 1024));
+        log_cfg.overflow_policy = ConfigLoader::instance().getString("LOG_OVERFLOW_POLICY", "drop") == "block"
+                                      ? LogOverflowPolicy::Block
+                                      : LogOverflowPolicy::Drop;
         Logger::instance().set_config(log_cfg);
 
         // Register signal handlers
@@ -140,17 +183,84 @@ int main(int argc, char* argv[])
         // ================================================================
         // Thread pool for async operations
         int pool_size = ConfigLoader::instance().getInt("THREAD_POOL_SIZE", 4);
-        ThreadPool task_pool(pool_size);
+        ThreadPool::Config pool_cfg;
+        pool_cfg.num_threads = static_cast<size_t>(pool_size);
+        pool_cfg.max_queue_size = static_cast<size_t>(ConfigLoader::instance().getInt("THREAD_POOL_QUEUE_SIZE", 1000));
+        pool_cfg.mode = ConfigLoader::instance().getString("THREAD_POOL_MODE", "shared") == "work_stealing"
+                            ? ThreadPool::Mode::WorkStealing
+                            : ThreadPool::Mode::SharedQueue;
+        // 鉴权回调在 worker 上产生应答，worker 需要自己的指标槽位
+        pool_cfg.on_thread_start = [] { ThreadLocalRegistry::instance().bindCurrentThread(); };
+        pool_cfg.on_thread_exit = [] { ThreadLocalRegistry::instance().unbindCurrentThread(); };
+        ThreadPool task_pool(pool_cfg);
         LOG_INFO("ThreadPool initialized with " + std::to_string(pool_size) + " workers");
 
         // Stream state management
-        state_manager = std::make_unique<RedisStreamStateManager>(
-            CacheManager::instance());
+        // redis：多网关共享状态（默认）；memory：单实例部署，状态在进程内，可选快照 + journal 持久化
+        const std::string state_backend = ConfigLoader::instance().getString("STATE_BACKEND", "redis");
+        if (state_backend == "memory")
+        {
+            InMemoryStreamStateManager::Config state_cfg;
+            state_cfg.data_dir = ConfigLoader::instance().getString("STATE_MEMORY_DIR", "data/state");
+            state_cfg.shards = static_cast<size_t>(std::max(
+                1, ConfigLoader::instance().getInt("STATE_MEMORY_SHARDS", 16)));
+            state_cfg.snapshot_interval = std::chrono::seconds(
+                std::max(1, ConfigLoader::instance().getInt("STATE_SNAPSHOT_INTERVAL_SEC", 60)));
+            state_cfg.fsync = ConfigLoader::instance().getBool("STATE_JOURNAL_FSYNC", false);
+            state_manager = std::make_unique<InMemoryStreamStateManager>(state_cfg);
+            LOG_INFO("StateManager: in-memory backend, data_dir=" + state_cfg.data_dir);
+        }
+        else
+        {
+            if (state_backend != "redis")
+            {
+                LOG_WARN("Unknown STATE_BACKEND '" + state_backend + "', falling back to redis");
+            }
+            auto redis_state = std::make_unique<RedisStreamStateManager>(CacheManager::instance());
+            // 在线人数本地聚合：计数读取不再访问 Redis；0 表示每次直接读取
+            if (const int refresh_ms = ConfigLoader::instance().getInt("STATE_PLAYER_COUNT_REFRESH_MS", 1000);
+                refresh_ms > 0)
+            {
+                redis_state->enablePlayerCountCache(std::chrono::milliseconds(refresh_ms));
+            }
+            state_store = std::move(redis_state);
+
+            // 写回（需显式开启）：播放端注册 / 心跳 / 注销不再在 worker 上等待 Redis，由后台线程合并后成批写入
+            if (ConfigLoader::instance().getBool("STATE_WRITE_BEHIND_ENABLED", false))
+            {
+                WriteBehindStreamStateManager::Config wb_cfg;
+                wb_cfg.flush_interval = std::chrono::milliseconds(
+                    std::max(1, ConfigLoader::instance().getInt("STATE_FLUSH_INTERVAL_MS", 20)));
+                wb_cfg.flush_batch = static_cast<size_t>(std::max(
+                    1, ConfigLoader::instance().getInt("STATE_FLUSH_BATCH", 512)));
+                wb_cfg.max_pending = static_cast<size_t>(std::max(
+                    1, ConfigLoader::instance().getInt("STATE_MAX_PENDING", 65536)));
+                auto write_behind = std::make_unique<WriteBehindStreamStateManager>(*state_store, wb_cfg);
+                write_behind_view = write_behind.get();
+                state_manager = std::move(write_behind);
+                LOG_INFO("StateManager: write-behind enabled, flush every " +
+                    std::to_string(wb_cfg.flush_interval.count()) + "ms or " +
+                    std::to_string(wb_cfg.flush_batch) + " ops");
+            }
+            else
+            {
+                state_manager = std::move(state_store);
+            }
+        }
 
         // Authentication
+        HybridAuthRepository::Config repo_cfg;
+        repo_cfg.l1_capacity_bytes = static_cast<size_t>(
+            ConfigLoader::instance().getInt("AUTH_L1_CAPACITY_MB", 16)) * 1024 * 1024;
+        repo_cfg.l1_shards = ConfigLoader::instance().getInt("AUTH_L1_SHARDS", 16);
+        repo_cfg.l1_ttl = std::chrono::seconds(ConfigLoader::instance().getInt("AUTH_L1_TTL_SECONDS", 10));
+
         auto auth_repo = std::make_unique<HybridAuthRepository>(
             *db_manager,
-            CacheManager::instance());
+            CacheManager::instance(),
+            repo_cfg);
+        // 所有权随后移交 AuthManager，这里保留观察者指针供监控使用
+        const HybridAuthRepository* auth_repo_view = auth_repo.get();
 
         AuthManager::Config auth_cfg;
         auth_cfg.timeout = std::chrono::milliseconds(
@@ -185,6 +295,65 @@ int main(int argc, char* argv[])
         scheduler_cfg.task_timeout = std::chrono::seconds(
             ConfigLoader::instance().getInt("SCHEDULER_TIMEOUT_SEC", 60)
         );
+        scheduler_cfg.cleanup_page_size = static_cast<size_t>(std::max(
+            1, ConfigLoader::instance().getInt("SCHEDULER_CLEANUP_PAGE_SIZE", 256)));
+        scheduler_cfg.cleanup_time_budget = std::chrono::milliseconds(
+            ConfigLoader::instance().getInt("SCHEDULER_CLEANUP_BUDGET_MS", 500)
+        );
+        // 键空间通知：task hash 的 TTL 过期由 Redis 推送，ZSet 扫描退为低频对账；仅 redis 后端可用
+        bool keyspace_expiry = ConfigLoader::instance().getBool("SCHEDULER_KEYSPACE_EXPIRY_ENABLED", false);
+        if (keyspace_expiry && state_backend == "memory")
+        {
+            LOG_WARN("SCHEDULER_KEYSPACE_EXPIRY_ENABLED requires STATE_BACKEND=redis, ignored");
+            keyspace_expiry = false;
+        }
+        // 进程内时间轮：本实例登记的任务按 tick 精度到期，全量扫描只做兜底，默认间隔随之放宽
+        const bool expiry_wheel = ConfigLoader::instance().getBool("SCHEDULER_EXPIRY_WHEEL_ENABLED", !keyspace_expiry);
+        if (expiry_wheel)
+        {
+            scheduler_cfg.expiry_tick = std::chrono::milliseconds(
+                std::max(1, ConfigLoader::instance().getInt("SCHEDULER_EXPIRY_TICK_MS", 1000)));
+            state_manager->enableLocalExpiry(scheduler_cfg.task_timeout, scheduler_cfg.expiry_tick);
+        }
+        scheduler_cfg.cleanup_interval = std::chrono::seconds(
+            ConfigLoader::instance().getInt("SCHEDULER_SWEEP_INTERVAL_SEC",
+                                            keyspace_expiry ? 600 : expiry_wheel ? 300 : 30)
+        );
+        // 集群级配置优先于全局默认
+        auto load_strategy = [](const std::string& key, const std::string& fallback)
+        {
+            const auto name = ConfigLoader::instance().getString(key, fallback);
+            if (const auto strategy = parseBalanceStrategy(name))return *strategy;
+            LOG_WARN("Unknown " + key + " '" + name + "', using least_tasks");
+            return BalanceStrategy::LeastTasks;
+        };
+        const auto default_strategy = ConfigLoader::instance().getString("SCHEDULER_BALANCE_STRATEGY", "least_tasks");
+        scheduler_cfg.rtmp_srt_strategy = load_strategy("SCHEDULER_BALANCE_STRATEGY_RTMP_SRT", default_strategy);
+        scheduler_cfg.http_hls_strategy = load_strategy("SCHEDULER_BALANCE_STRATEGY_HTTP_HLS", default_strategy);
+        scheduler_cfg.hash_load_factor =
+            ConfigLoader::instance().getInt("SCHEDULER_HASH_LOAD_FACTOR_PCT", 125) / 100.0;
+        scheduler_cfg.load_refresh_interval = std::chrono::milliseconds(
+            ConfigLoader::instance().getInt("SCHEDULER_LOAD_REFRESH_MS", 2000)
+        );
+
+        // Node health probing：先于调度器启动，首轮探测前所有节点视为健康
+        if (ConfigLoader::instance().getBool("NODE_PROBE_ENABLED", true))
+        {
+            NodeHealthProber::Config probe_cfg;
+            probe_cfg.interval = std::chrono::milliseconds(
+                ConfigLoader::instance().getInt("NODE_PROBE_INTERVAL_MS", 2000));
+            probe_cfg.timeout = std::chrono::milliseconds(
+                ConfigLoader::instance().getInt("NODE_PROBE_TIMEOUT_MS", 500));
+            probe_cfg.http_path = ConfigLoader::instance().getString("NODE_PROBE_HTTP_PATH", "");
+            probe_cfg.http_port = ConfigLoader::instance().getInt("NODE_PROBE_HTTP_PORT", 0);
+            probe_cfg.failure_threshold = static_cast<uint32_t>(
+                ConfigLoader::instance().getInt("NODE_PROBE_FAILURE_THRESHOLD", 3));
+            probe_cfg.base_ejection = std::chrono::milliseconds(
+                ConfigLoader::instance().getInt("NODE_EJECTION_BASE_MS", 10000));
+
+            node_prober = std::make_unique<NodeHealthProber>(node_cfg, probe_cfg);
+            node_prober->start();
+        }
 
         scheduler = std::make_unique<StreamTaskScheduler>(
             *auth_manager,
@@ -192,9 +361,60 @@ int main(int argc, char* argv[])
             std::move(node_cfg),
             scheduler_cfg);
 
+        scheduler->setNodeHealth(node_prober.get());
         scheduler->start();
         LOG_INFO("StreamTaskScheduler started");
 
+        // Lifecycle lane: Done 类 Hook 的状态清理从 I/O 线程卸载到这里（按 stream 保序）
+        LifecycleExecutor::Config lifecycle_cfg;
+        lifecycle_cfg.num_lanes = ConfigLoader::instance().getInt("LIFECYCLE_LANES", 2);
+        lifecycle_cfg.max_queue_per_lane = ConfigLoader::instance().getInt("LIFECYCLE_QUEUE_SIZE", 10000);
+        lifecycle = std::make_unique<LifecycleExecutor>(lifecycle_cfg);
+
+        // 过期通知与 Done 事件走同一条 lane，同一条流上的清理保持顺序；监听线程只负责投递
+        if (keyspace_expiry)
+        {
+            expiry_listener = std::make_unique<TaskExpiryListener>(
+                CacheManager::instance(),
+                TaskExpiryListener::postToLifecycle(
+                    *lifecycle, [&scheduler](const std::string& stream, const std::string& client)
+                    {
+                        scheduler->onTaskExpired(stream, client);
+                    }));
+            expiry_listener->start();
+            LOG_INFO("Keyspace expiry enabled, reconciliation sweep every " +
+                std::to_string(scheduler_cfg.cleanup_interval.count()) + "s");
+        }
+
+        // Hot reload：config.ini 与 nodes.json 被改写（inotify）或收到 SIGHUP 时重新加载
+        if (ConfigLoader::instance().getBool("CONFIG_WATCH_ENABLED", true))
+        {
+            config_watcher = std::make_unique<ConfigWatcher>(std::chrono::milliseconds(
+                ConfigLoader::instance().getInt("CONFIG_WATCH_DEBOUNCE_MS", 200)));
+
+            config_watcher->watch(ini_path, []
+            {
+                if (!ConfigLoader::instance().reload())return;
+                // 大部分配置只在启动时读取；日志级别可以在运行时生效
+                Logger::instance().set_min_level(static_cast<LogLevel>(
+                    ConfigLoader::instance().getInt("LOG_LEVEL", 1)));
+                LOG_INFO("config.ini reloaded, version=" + std::to_string(ConfigLoader::instance().version()));
+            });
+
+            config_watcher->watch(nodes_json_path, [&, node_opts]
+            {
+                // 解析或校验失败会抛出，ConfigWatcher 记录后保持旧节点表
+                const auto nodes = NodeConfig::fromJsonFile(nodes_json_path, node_opts);
+                // 先更新探测器：调度器切换后立即能拿到对应版本的健康掩码
+                if (node_prober)node_prober->updateNodes(nodes);
+                scheduler->updateNodes(nodes);
+            });
+
+            config_watcher->start();
+            g_ctx.config_watcher = config_watcher.get();
+            std::signal(SIGHUP, reloadSignalHandler);
+        }
+
         // ================================================================
         // Monitoring System
         // ================================================================
@@ -225,6 +445,30 @@ int main(int argc, char* argv[])
                 dp->setDB(db_manager.get());
                 LOG_INFO("  -> Injected db into DatabaseMetricsProvider");
             }
+            // LifecycleMetricsProvider需要lifecycle executor
+            else if (auto* lp = dynamic_cast<LifecycleMetricsProvider*>(provider.get()))
+            {
+                lp->setExecutor(lifecycle.get());
+                LOG_INFO("  -> Injected lifecycle executor into LifecycleMetricsProvider");
+            }
+            // AuthMetricsProvider需要auth repository
+            else if (auto* ap = dynamic_cast<AuthMetricsProvider*>(provider.get()))
+            {
+                ap->setRepository(auth_repo_view);
+                LOG_INFO("  -> Injected auth repository into AuthMetricsProvider");
+            }
+            // NodeHealthMetricsProvider需要prober（未启用时保持 nullptr）
+            else if (auto* np = dynamic_cast<NodeHealthMetricsProvider*>(provider.get()))
+            {
+                np->setProber(node_prober.get());
+                LOG_INFO("  -> Injected node prober into NodeHealthMetricsProvider");
+            }
+            // StateMetricsProvider需要写回层（未启用时保持 nullptr）
+            else if (auto* stp = dynamic_cast<StateMetricsProvider*>(provider.get()))
+            {
+                stp->setManager(write_behind_view);
+                LOG_INFO("  -> Injected write-behind state manager into StateMetricsProvider");
+            }
             // ServerMetricsProvider不需要依赖（使用Thread-Local）
         }
 
@@ -237,12 +481,8 @@ int main(int argc, char* argv[])
         LOG_INFO("All providers registered to MetricsCollector");
 
         //启动刷新线程
-        metricsCollector.start(
-            std::chrono::seconds(1),
-            [](const nlohmann::json& report)
-            {
-            }
-        );
+        // 不需要周期性 JSON 报告：/metrics 读预渲染文本，/metrics.json 按需构建
+        metricsCollector.start(std::chrono::seconds(1), nullptr);
 
         // 创建健康检查器
         auto healthChecker = std::make_shared<HealthChecker>(
@@ -258,7 +498,7 @@ int main(int argc, char* argv[])
         // ================================================================
 
         // Business logic layer
-        use_case = std::make_unique<HookUseCase>(*scheduler);
+        use_case = std::make_unique<HookUseCase>(*scheduler, lifecycle.get());
 
         // Routing layer
         controller = std::make_unique<HookController>(*use_case);
@@ -268,6 +508,8 @@ int main(int argc, char* argv[])
         server_cfg.address = ConfigLoader::instance().getString("SERVER_ADDRESS", "0.0.0.0");
         server_cfg.port = ConfigLoader::instance().getInt("SERVER_PORT", 8080);
         server_cfg.io_threads = ConfigLoader::instance().getInt("SERVER_IO_THREADS", 2);
+        server_cfg.io_shards = ConfigLoader::instance().getInt("SERVER_IO_SHARDS", 0);
+        server_cfg.pin_shard_threads = ConfigLoader::instance().getBool("SERVER_PIN_SHARD_THREADS", true);
 
         server = std::make_unique<HookServer>(server_cfg, *controller);
         server->start();
@@ -296,17 +538,44 @@ int main(int argc, char* argv[])
         LOG_INFO("Monitoring system stopped");
 
         // Stop in reverse order of initialization
+        if (config_watcher)
+        {
+            std::signal(SIGHUP, SIG_IGN);
+            g_ctx.config_watcher = nullptr;
+            config_watcher->stop();
+            config_watcher.reset();
+        }
+
         server->stop();
         server.reset();
 
         controller.reset();
         use_case.reset();
 
+        // 停止投递过期通知，之后再排空执行器
+        if (expiry_listener)
+        {
+            expiry_listener->stop();
+            expiry_listener.reset();
+        }
+
+        // 先排空尚未执行的 Done 清理事件，它们依赖 scheduler 与 state_manager
+        lifecycle->stop_and_wait();
+        lifecycle.reset();
+
         scheduler->stop();
         scheduler.reset();
 
+        if (node_prober)
+        {
+            node_prober->stop();
+            node_prober.reset();
+        }
+
         auth_manager.reset();
+        // 写回层析构时把剩余变更写入 Redis，之后才能释放后端
         state_manager.reset();
+        state_store.reset();
 
         task_pool.stop_and_wait();
         task_pool.reset_stats();
@@ -315,6 +584,7 @@ int main(int argc, char* argv[])
         db_manager.reset();
 
         LOG_INFO("=== StreamGate Service Exited Cleanly ===");
+        Logger::instance().stop_async();
     }
     catch (const std::exception& e)
     {
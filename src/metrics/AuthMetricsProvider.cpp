@@ -0,0 +1,60 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "AuthMetricsProvider.h"
+#include "HybridAuthRepository.h"
+
+REGISTER_METRICS(AuthMetricsProvider)
+
+void AuthMetricsProvider::refresh() noexcept
+{
+    //哨兵检查：仓储未注入
+    if (!_repo)
+    {
+        updateSnapshot({{"status", "not_initialized"}});
+        return;
+    }
+
+    const auto s = _repo->getStats();
+
+    updateSnapshot({
+        {"status", "running"},
+        {"validation_failures", s.validation_failures},
+        {
+            "l1", {
+                {"hits", s.l1_hits},
+                {"negative_hits", s.l1_negative_hits},
+                {"misses", s.l1_misses},
+                {"evictions", s.l1_evictions},
+                {"expirations", s.l1_expirations},
+                {"entries", s.l1_entries},
+                {"bytes", s.l1_bytes},
+                {"capacity_bytes", s.l1_capacity_bytes},
+                {"hit_rate", s.l1_hit_rate}
+            }
+        },
+        {
+            "redis", {
+                {"hits", s.cache_hits},
+                {"misses", s.cache_misses},
+                {"hit_rate", s.cache_hit_rate}
+            }
+        },
+        {
+            "db", {
+                {"hits", s.db_hits},
+                {"misses", s.db_misses},
+                {"errors", s.db_errors},
+                {"queries", s.db_flight_leaders},
+                {"coalesced_waiters", s.db_coalesced_waiters},
+                {"serialized_waiters", s.db_serialized_waiters},
+                {"waiting", s.db_waiting},
+                {"in_flight", s.db_in_flight}
+            }
+        }
+    });
+}
+
+extern "C" void ForceLink_AuthMetricsProvider()
+{
+}
@@ -0,0 +1,208 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::string_view hookStageLabel(HookStage stage) noexcept
+{
+    switch (stage)
+    {
+    case HookStage::HttpRead: return "http_read";
+    case HookStage::JsonParse: return "json_parse";
+    case HookStage::QueueWait: return "queue_wait";
+    case HookStage::AuthCache: return "auth_cache";
+    case HookStage::AuthDb: return "auth_db";
+    case HookStage::RegisterTask: return "register_task";
+    case HookStage::ResponseWrite: return "response_write";
+    case HookStage::Total: return "total";
+    }
+    return "unknown";
+}
+
+// --- LatencyHistogramData 实现 ---
+uint64_t LatencyHistogramData::percentile(double q) const noexcept
+{
+    if (count == 0 || buckets.empty())return 0;
+
+    // 排名从 1 开始：p50 of {a,b} 取 a
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            return LatencyBuckets::lowerBound(i) + LatencyBuckets::width(i) / 2;
+        }
+    }
+    return LatencyBuckets::lowerBound(buckets.size() - 1);
+}
+
+void LatencyHistogramData::add(const LatencyHistogramData& other)
+{
+    if (other.count == 0)return;
+    if (buckets.empty())buckets.assign(LatencyBuckets::kBucketCount, 0);
+
+    count += other.count;
+    sum_ns += other.sum_ns;
+    for (size_t i = 0; i < other.buckets.size(); ++i)
+    {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+void LatencyHistogramData::subtract(const LatencyHistogramData& base)
+{
+    if (base.count == 0 || buckets.empty())return;
+
+    count -= std::min(count, base.count);
+    sum_ns -= std::min(sum_ns, base.sum_ns);
+    for (size_t i = 0; i < base.buckets.size(); ++i)
+    {
+        buckets[i] -= std::min(buckets[i], base.buckets[i]);
+    }
+}
+
+// --- LatencyHistogramRegistry 实现 ---
+void LatencyHistogramRegistry::Cell::mergeInto(LatencyHistogramData& out) const
+{
+    const uint64_t n = count.load(std::memory_order_relaxed);
+    if (n == 0)return;
+    if (out.buckets.empty())out.buckets.assign(LatencyBuckets::kBucketCount, 0);
+
+    // 与写者并发时各字段可能差一两个样本，分位数对此不敏感；count 以桶之和为准，保证自洽
+    uint64_t total = 0;
+    for (size_t i = 0; i < LatencyBuckets::kBucketCount; ++i)
+    {
+        const uint64_t c = buckets[i].load(std::memory_order_relaxed);
+        out.buckets[i] += c;
+        total += c;
+    }
+    out.count += total;
+    out.sum_ns += sum_ns.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 线程局部句柄：首次记录时注册，线程退出时归并并注销
+ */
+struct LatencyThreadHandle
+{
+    LatencyHistogramRegistry::ThreadHistograms* histograms = nullptr;
+
+    ~LatencyThreadHandle()
+    {
+        if (histograms)
+        {
+            LatencyHistogramRegistry::instance().detach(histograms);
+            delete histograms;
+        }
+    }
+};
+
+namespace
+{
+    thread_local LatencyThreadHandle tls_latency;
+}
+
+LatencyHistogramRegistry& LatencyHistogramRegistry::instance()
+{
+    static LatencyHistogramRegistry reg;
+    return reg;
+}
+
+LatencyHistogramRegistry::ThreadHistograms* LatencyHistogramRegistry::local() noexcept
+{
+    if (tls_latency.histograms)[[likely]]
+    {
+        return tls_latency.histograms;
+    }
+
+    try
+    {
+        auto* histograms = new ThreadHistograms();
+        attach(histograms);
+        tls_latency.histograms = histograms;
+        return histograms;
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void LatencyHistogramRegistry::attach(ThreadHistograms* histograms)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _threads.push_back(histograms);
+}
+
+void LatencyHistogramRegistry::detach(ThreadHistograms* histograms)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t i = 0; i < LatencySnapshot::kCells; ++i)
+    {
+        if (const Cell* cell = histograms->cells[i].load(std::memory_order_acquire))
+        {
+            cell->mergeInto(_retired.cells[i]);
+        }
+    }
+    std::erase(_threads, histograms);
+}
+
+void LatencyHistogramRegistry::record(HookAction action, HookStage stage, uint64_t nanos) noexcept
+{
+    ThreadHistograms* histograms = local();
+    if (!histograms)[[unlikely]]
+    {
+        return;
+    }
+
+    const size_t index = LatencySnapshot::cellIndex(action, stage);
+    Cell* cell = histograms->cells[index].load(std::memory_order_relaxed);
+    if (!cell)[[unlikely]]
+    {
+        try
+        {
+            histograms->owned[index] = std::make_unique<Cell>();
+        }
+        catch (...)
+        {
+            return;
+        }
+        cell = histograms->owned[index].get();
+        // release：汇总线程看到指针时必须看到已初始化的桶
+        histograms->cells[index].store(cell, std::memory_order_release);
+    }
+
+    // 单写者：普通 load + store 即可，不需要 lock 前缀
+    auto& bucket = cell->buckets[LatencyBuckets::indexOf(nanos)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    cell->sum_ns.store(cell->sum_ns.load(std::memory_order_relaxed) + nanos, std::memory_order_relaxed);
+    cell->count.store(cell->count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+LatencySnapshot LatencyHistogramRegistry::snapshot() const
+{
+    LatencySnapshot out;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t i = 0; i < LatencySnapshot::kCells; ++i)
+    {
+        out.cells[i].add(_retired.cells[i]);
+    }
+
+    for (const ThreadHistograms* histograms : _threads)
+    {
+        for (size_t i = 0; i < LatencySnapshot::kCells; ++i)
+        {
+            if (const Cell* cell = histograms->cells[i].load(std::memory_order_acquire))
+            {
+                cell->mergeInto(out.cells[i]);
+            }
+        }
+    }
+    return out;
+}
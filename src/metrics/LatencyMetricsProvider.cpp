@@ -0,0 +1,114 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "LatencyMetricsProvider.h"
+#include "PrometheusWriter.h"
+
+REGISTER_METRICS(LatencyMetricsProvider)
+
+namespace
+{
+    constexpr std::string_view kMetricName = "streamgate_hook_stage_latency_seconds";
+
+    struct Quantile
+    {
+        double q;
+        std::string_view label; // Prometheus quantile 标签
+        const char* json_key;
+    };
+
+    constexpr Quantile kQuantiles[] = {
+        {0.5, "0.5", "p50_us"},
+        {0.9, "0.9", "p90_us"},
+        {0.99, "0.99", "p99_us"},
+        {0.999, "0.999", "p999_us"},
+    };
+}
+
+LatencyMetricsProvider::LatencyMetricsProvider(std::chrono::seconds window)
+    : _window(window),
+      _nextTakenAt(std::chrono::steady_clock::now())
+{
+}
+
+void LatencyMetricsProvider::refresh() noexcept
+{
+    auto current = LatencyHistogramRegistry::instance().snapshot();
+
+    std::string exposition;
+    exposition.reserve(4096);
+    PrometheusWriter::appendType(exposition, kMetricName, "summary");
+
+    const std::string sum_name = std::string(kMetricName) + "_sum";
+    const std::string count_name = std::string(kMetricName) + "_count";
+
+    nlohmann::json actions = nlohmann::json::object();
+    std::string labels;
+
+    for (size_t a = 0; a < kHookActionCount; ++a)
+    {
+        const auto action = static_cast<HookAction>(a);
+        nlohmann::json stages = nlohmann::json::object();
+
+        for (size_t s = 0; s < kHookStageCount; ++s)
+        {
+            const auto stage = static_cast<HookStage>(s);
+            const auto& total = current.at(action, stage);
+            if (total.count == 0)continue;
+
+            // 窗口增量：当前 - 窗口起点
+            LatencyHistogramData window = total;
+            window.subtract(_base.at(action, stage));
+
+            labels.assign("action=\"");
+            labels.append(hookActionLabel(action));
+            labels.append("\",stage=\"");
+            labels.append(hookStageLabel(stage));
+            labels.push_back('"');
+            const size_t base_len = labels.size();
+
+            nlohmann::json stage_json = {{"count", window.count}};
+            for (const auto& [q, q_label, json_key] : kQuantiles)
+            {
+                const uint64_t ns = window.percentile(q);
+
+                labels.resize(base_len);
+                labels.append(",quantile=\"");
+                labels.append(q_label);
+                labels.push_back('"');
+                PrometheusWriter::appendSample(exposition, kMetricName, static_cast<double>(ns) / 1e9, labels);
+
+                stage_json[json_key] = static_cast<double>(ns) / 1e3;
+            }
+
+            labels.resize(base_len);
+            PrometheusWriter::appendSample(exposition, sum_name, static_cast<double>(total.sum_ns) / 1e9, labels);
+            PrometheusWriter::appendSample(exposition, count_name, total.count, labels);
+
+            stages[std::string(hookStageLabel(stage))] = std::move(stage_json);
+        }
+
+        if (!stages.empty())
+        {
+            actions[std::string(hookActionLabel(action))] = std::move(stages);
+        }
+    }
+
+    // 窗口轮转：_next 满一个窗口后成为新的起点
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _nextTakenAt >= _window)
+    {
+        _base = std::move(_next);
+        _next = std::move(current);
+        _nextTakenAt = now;
+    }
+
+    updateSnapshot({
+                       {"window_seconds", std::chrono::duration<double>(_window).count()},
+                       {"actions", std::move(actions)}
+                   }, std::move(exposition));
+}
+
+extern "C" void ForceLink_LatencyMetricsProvider()
+{
+}
@@ -0,0 +1,40 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "LifecycleMetricsProvider.h"
+#include "LifecycleExecutor.h"
+
+REGISTER_METRICS(LifecycleMetricsProvider)
+
+void LifecycleMetricsProvider::refresh() noexcept
+{
+    //哨兵检查：执行器未注入
+    if (!_executor)
+    {
+        updateSnapshot({{"status", "not_initialized"}});
+        return;
+    }
+
+    const auto s = _executor->get_stats();
+
+    updateSnapshot({
+        {"status", _executor->is_stopped() ? "stopped" : "running"},
+        {"lanes", s.num_lanes},
+        {"queue_depth", s.queue_depth},
+        {"submitted", s.total_submitted},
+        {"completed", s.completed_tasks},
+        {"failed", s.failed_tasks},
+        {"rejected", s.rejected_tasks},
+        {
+            "lag", {
+                {"oldest_pending_ms", static_cast<double>(s.oldest_pending_us) / 1000.0},
+                {"last_ms", static_cast<double>(s.last_lag_us) / 1000.0},
+                {"max_ms", static_cast<double>(s.max_lag_us) / 1000.0}
+            }
+        }
+    });
+}
+
+extern "C" void ForceLink_LifecycleMetricsProvider()
+{
+}
@@ -0,0 +1,34 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "LoggerMetricsProvider.h"
+#include "Logger.h"
+
+REGISTER_METRICS(LoggerMetricsProvider)
+
+void LoggerMetricsProvider::refresh() noexcept
+{
+    const auto s = Logger::instance().get_async_stats();
+
+    if (!s.enabled)
+    {
+        updateSnapshot({{"mode", "sync"}});
+        return;
+    }
+
+    updateSnapshot({
+        {"mode", "async"},
+        {"enqueued", s.enqueued},
+        {"written", s.written},
+        {"pending", s.enqueued > s.written ? s.enqueued - s.written : 0},
+        {"dropped", s.dropped},
+        {"truncated", s.truncated},
+        {"blocked", s.blocked},
+        {"write_errors", s.write_errors},
+        {"active_threads", s.active_threads}
+    });
+}
+
+extern "C" void ForceLink_LoggerMetricsProvider()
+{
+}
@@ -57,6 +57,44 @@ nlohmann::json MetricsCollector::collectAll() const
     return root;
 }
 
+std::string MetricsCollector::renderExposition() const
+{
+    std::shared_lock lock(_mutex);
+
+    std::vector<std::shared_ptr<const MetricsSnapshot>> snapshots;
+    snapshots.reserve(_providers.size());
+
+    size_t total = 64;
+    for (const auto& p : _providers)
+    {
+        auto snap = p->exportSnapshot();
+        total += snap->exposition.size();
+        snapshots.push_back(std::move(snap));
+    }
+
+    std::string out;
+    out.reserve(total);
+    for (const auto& snap : snapshots)
+    {
+        out.append(snap->exposition);
+    }
+
+    // 抓取方可据此判断快照是否陈旧
+    const auto now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    PrometheusWriter::appendType(out, "streamgate_metrics_refresh_timestamp_seconds", "gauge");
+    PrometheusWriter::appendSample(out, "streamgate_metrics_refresh_timestamp_seconds", now);
+    return out;
+}
+
+std::shared_ptr<const std::string> MetricsCollector::exportPrometheus() const
+{
+    if (auto cached = _exposition.load(std::memory_order_acquire))
+    {
+        return cached;
+    }
+    return std::make_shared<const std::string>(renderExposition());
+}
+
 MetricsCollector& MetricsCollector::instance()
 {
     static MetricsCollector inst;
@@ -87,10 +125,12 @@ void MetricsCollector::start(std::chrono::milliseconds interval,
 
             }
             // --- A. 执行任务 ---
-            nlohmann::json report = collectAll();
+            // Prometheus 文本只在这里拼接一次，/metrics 抓取时直接复用
+            _exposition.store(std::make_shared<const std::string>(renderExposition()), std::memory_order_release);
+
             if (exp)
             {
-                exp(report);
+                exp(collectAll());
             }
 
             // --- B. 计算下一次触发点 (零漂移) ---
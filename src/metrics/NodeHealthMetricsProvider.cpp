@@ -0,0 +1,72 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "NodeHealthMetricsProvider.h"
+#include "NodeHealthProber.h"
+#include "PrometheusWriter.h"
+
+REGISTER_METRICS(NodeHealthMetricsProvider)
+
+void NodeHealthMetricsProvider::refresh() noexcept
+{
+    //哨兵检查：探测器未注入（未启用探测）
+    if (!_prober)
+    {
+        updateSnapshot({{"status", "disabled"}});
+        return;
+    }
+
+    const auto snap = _prober->snapshot();
+
+    // 四个指标族各自成段：同一指标的样本在 exposition 中必须连续
+    std::string up, latency, failures, ejections;
+    PrometheusWriter::appendType(up, "streamgate_node_up", "gauge");
+    PrometheusWriter::appendType(latency, "streamgate_node_probe_latency_ms", "gauge");
+    PrometheusWriter::appendType(failures, "streamgate_node_probe_failures_total", "counter");
+    PrometheusWriter::appendType(ejections, "streamgate_node_ejections_total", "counter");
+
+    nlohmann::json nodes = nlohmann::json::object();
+    size_t healthy = 0;
+    std::string labels;
+
+    for (const auto& node : snap->nodes)
+    {
+        const auto category = NodeConfig::categoryName(node.category);
+        const auto endpoint = node.endpoint.toString();
+        const bool is_up = node.state == NodeHealthState::Healthy;
+        healthy += is_up ? 1 : 0;
+
+        labels.assign("category=\"");
+        PrometheusWriter::appendLabelValue(labels, category);
+        labels.append("\",node=\"");
+        PrometheusWriter::appendLabelValue(labels, endpoint);
+        labels.push_back('"');
+
+        PrometheusWriter::appendSample(up, "streamgate_node_up", uint64_t{is_up ? 1u : 0u}, labels);
+        PrometheusWriter::appendSample(latency, "streamgate_node_probe_latency_ms", node.ewma_ms, labels);
+        PrometheusWriter::appendSample(failures, "streamgate_node_probe_failures_total", node.failures, labels);
+        PrometheusWriter::appendSample(ejections, "streamgate_node_ejections_total", node.ejections, labels);
+
+        nodes[std::string(category) + "/" + endpoint] = {
+            {"state", nodeHealthStateName(node.state)},
+            {"latency_ewma_ms", node.ewma_ms},
+            {"consecutive_failures", node.consecutive_failures},
+            {"probes", node.probes},
+            {"failures", node.failures},
+            {"ejections", node.ejections},
+            {"last_error", node.last_error}
+        };
+    }
+
+    updateSnapshot({
+                       {"status", "running"},
+                       {"round", snap->round},
+                       {"healthy", healthy},
+                       {"total", snap->nodes.size()},
+                       {"nodes", std::move(nodes)}
+                   }, up + latency + failures + ejections);
+}
+
+extern "C" void ForceLink_NodeHealthMetricsProvider()
+{
+}
@@ -0,0 +1,168 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "PrometheusWriter.h"
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+    constexpr bool isNameChar(char c, bool first) noexcept
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' ||
+            (!first && c >= '0' && c <= '9');
+    }
+}
+
+void PrometheusWriter::appendName(std::string& out, std::string_view name)
+{
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        const char c = name[i];
+        out.push_back(isNameChar(c, out.empty() && i == 0) ? c : '_');
+    }
+}
+
+void PrometheusWriter::appendLabelValue(std::string& out, std::string_view value)
+{
+    for (const char c : value)
+    {
+        switch (c)
+        {
+        case '\\': out.append("\\\\");
+            break;
+        case '"': out.append("\\\"");
+            break;
+        case '\n': out.append("\\n");
+            break;
+        default: out.push_back(c);
+        }
+    }
+}
+
+std::string PrometheusWriter::metricPrefix(std::string_view component)
+{
+    constexpr std::string_view kSuffix = "_metrics";
+    if (component.ends_with(kSuffix))
+    {
+        component.remove_suffix(kSuffix.size());
+    }
+
+    std::string prefix = "streamgate_";
+    appendName(prefix, component);
+    return prefix;
+}
+
+void PrometheusWriter::appendType(std::string& out, std::string_view name, std::string_view type)
+{
+    out.append("# TYPE ");
+    out.append(name);
+    out.push_back(' ');
+    out.append(type);
+    out.push_back('\n');
+}
+
+void PrometheusWriter::appendSample(std::string& out, std::string_view name, uint64_t value, std::string_view labels)
+{
+    char buf[24];
+    auto [p, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+
+    out.append(name);
+    if (!labels.empty())
+    {
+        out.push_back('{');
+        out.append(labels);
+        out.push_back('}');
+    }
+    out.push_back(' ');
+    out.append(buf, p);
+    out.push_back('\n');
+}
+
+void PrometheusWriter::appendSample(std::string& out, std::string_view name, double value, std::string_view labels)
+{
+    out.append(name);
+    if (!labels.empty())
+    {
+        out.push_back('{');
+        out.append(labels);
+        out.push_back('}');
+    }
+    out.push_back(' ');
+
+    if (std::isnan(value))
+    {
+        out.append("NaN");
+    }
+    else if (std::isinf(value))
+    {
+        out.append(value > 0 ? "+Inf" : "-Inf");
+    }
+    else
+    {
+        char buf[32];
+        auto [p, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+        out.append(buf, p);
+    }
+    out.push_back('\n');
+}
+
+void PrometheusWriter::appendJson(std::string& out, std::string_view prefix, const nlohmann::json& j)
+{
+    std::string name(prefix);
+    appendJsonImpl(out, name, j);
+}
+
+void PrometheusWriter::appendJsonImpl(std::string& out, std::string& name, const nlohmann::json& j)
+{
+    switch (j.type())
+    {
+    case nlohmann::json::value_t::object:
+        for (const auto& [key, value] : j.items())
+        {
+            const size_t restore = name.size();
+            name.push_back('_');
+            appendName(name, key);
+            appendJsonImpl(out, name, value);
+            name.resize(restore);
+        }
+        break;
+    case nlohmann::json::value_t::number_unsigned:
+        appendSample(out, name, j.get<uint64_t>());
+        break;
+    case nlohmann::json::value_t::number_integer:
+        {
+            const auto v = j.get<int64_t>();
+            if (v >= 0)
+            {
+                appendSample(out, name, static_cast<uint64_t>(v));
+            }
+            else
+            {
+                appendSample(out, name, static_cast<double>(v));
+            }
+        }
+        break;
+    case nlohmann::json::value_t::number_float:
+        appendSample(out, name, j.get<double>());
+        break;
+    case nlohmann::json::value_t::boolean:
+        appendSample(out, name, uint64_t{j.get<bool>() ? 1u : 0u});
+        break;
+    case nlohmann::json::value_t::string:
+        {
+            std::string labels = "value=\"";
+            appendLabelValue(labels, j.get_ref<const std::string&>());
+            labels.push_back('"');
+
+            const size_t restore = name.size();
+            name.append("_info");
+            appendSample(out, name, uint64_t{1}, labels);
+            name.resize(restore);
+        }
+        break;
+    default:
+        // 数组 / null / binary 没有稳定的样本语义，忽略
+        break;
+    }
+}
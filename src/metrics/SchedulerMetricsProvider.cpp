@@ -40,6 +40,8 @@ void SchedulerMetricsProvider::refresh() noexcept
         {"failed_play", m.total_play_req - m.success_play},
         {"auth_failures", m.auth_failures},
         {"tasks_cleaned", m.tasks_cleaned},
+        {"timeout_backlog", m.timeout_backlog},
+        {"keyspace_expired", m.keyspace_expired},
         {"timestamp_ms", m.last_update_ms}
     });
 }
@@ -3,42 +3,86 @@
 //
 #include "ServerMetricsProvider.h"
 #include "MetricsRegistry.h"
-#include <charconv>
 
 //静态注册宏：包含 ForceLink 锚点
 REGISTER_METRICS(ServerMetricsProvider)
 
-// --- WorkerStatsSlot 实现 ---
-void WorkerStatsSlot::update(uint64_t t, uint64_t s, uint64_t f) noexcept
+namespace
 {
-    seq.fetch_add(1, std::memory_order_release);
+    // 当前线程认领的槽位；nullptr 表示未认领（走共享路径）
+    thread_local WorkerStatsSlot* tls_slot = nullptr;
+    thread_local size_t tls_slot_id = ThreadLocalRegistry::kMaxWorkers;
+}
+
+// --- ActionStatsGroup 实现 ---
+void ActionStatsGroup::add(const ActionCounters& delta) noexcept
+{
+    // 单写者：seq 奇数期间读者会重试
+    const uint64_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
     std::atomic_thread_fence(std::memory_order_release);
 
-    total_requests = t;
-    success_requests = s;
-    failed_requests = f;
+    requests.store(requests.load(std::memory_order_relaxed) + delta.requests, std::memory_order_relaxed);
+    success.store(success.load(std::memory_order_relaxed) + delta.success, std::memory_order_relaxed);
+    failed.store(failed.load(std::memory_order_relaxed) + delta.failed, std::memory_order_relaxed);
+    bytes_in.store(bytes_in.load(std::memory_order_relaxed) + delta.bytes_in, std::memory_order_relaxed);
+    bytes_out.store(bytes_out.load(std::memory_order_relaxed) + delta.bytes_out, std::memory_order_relaxed);
 
-    std::atomic_thread_fence(std::memory_order_release);
-    seq.fetch_add(1, std::memory_order_release);
+    seq.store(s + 2, std::memory_order_release);
 }
 
-void WorkerStatsSlot::read(uint64_t& t, uint64_t& s, uint64_t& f) const noexcept
+void ActionStatsGroup::fetchAdd(const ActionCounters& delta) noexcept
 {
+    requests.fetch_add(delta.requests, std::memory_order_relaxed);
+    success.fetch_add(delta.success, std::memory_order_relaxed);
+    failed.fetch_add(delta.failed, std::memory_order_relaxed);
+    bytes_in.fetch_add(delta.bytes_in, std::memory_order_relaxed);
+    bytes_out.fetch_add(delta.bytes_out, std::memory_order_relaxed);
+}
+
+ActionCounters ActionStatsGroup::read() const noexcept
+{
+    ActionCounters c;
     uint64_t s1, s2;
     do
     {
         s1 = seq.load(std::memory_order_acquire);
 
-        std::atomic_thread_fence(std::memory_order_acquire);
-
-        t = total_requests;
-        s = success_requests;
-        f = failed_requests;
+        c.requests = requests.load(std::memory_order_relaxed);
+        c.success = success.load(std::memory_order_relaxed);
+        c.failed = failed.load(std::memory_order_relaxed);
+        c.bytes_in = bytes_in.load(std::memory_order_relaxed);
+        c.bytes_out = bytes_out.load(std::memory_order_relaxed);
 
         std::atomic_thread_fence(std::memory_order_acquire);
-        s2 = seq.load(std::memory_order_acquire);
+        s2 = seq.load(std::memory_order_relaxed);
     }
     while ((s1 & 1) || s1 != s2);
+    return c;
+}
+
+void ActionStatsGroup::reset() noexcept
+{
+    const uint64_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    requests.store(0, std::memory_order_relaxed);
+    success.store(0, std::memory_order_relaxed);
+    failed.store(0, std::memory_order_relaxed);
+    bytes_in.store(0, std::memory_order_relaxed);
+    bytes_out.store(0, std::memory_order_relaxed);
+
+    seq.store(s + 2, std::memory_order_release);
+}
+
+// --- WorkerStatsSlot 实现 ---
+void WorkerStatsSlot::reset() noexcept
+{
+    for (auto& group : actions)
+    {
+        group.reset();
+    }
 }
 
 // --- ThreadLocalRegistry 实现 ---
@@ -50,24 +94,17 @@ ThreadLocalRegistry& ThreadLocalRegistry::instance()
 
 std::optional<size_t> ThreadLocalRegistry::acquireSlot()
 {
+    std::lock_guard<std::mutex> lock(_membership_mutex);
     for (size_t m = 0; m < 2; ++m)
     {
-        uint64_t mask = _active_mask->load(std::memory_order_relaxed);
-        for (size_t i = 0; i < 64; ++i)
-        {
-            if (!(mask & (1ULL << i)))
-            {
-                // 尝试抢占
-                if (!(_active_mask[m].fetch_or(1ULL << i, std::memory_order_acq_rel) & (1ULL << i)))
-                {
-                    size_t id = m * 64 + i;
-                    _slots[id].update(0, 0, 0); // 复用前清空
-                    return id;
-                }
-                // 抢占失败说明并发了，继续搜索
-                mask = _active_mask[m].load(std::memory_order_relaxed);
-            }
-        }
+        const uint64_t mask = _active_mask[m].load(std::memory_order_relaxed);
+        if (mask == ~uint64_t{0})continue;
+
+        const auto i = static_cast<size_t>(__builtin_ctzll(~mask));
+        const size_t id = m * 64 + i;
+        _slots[id].reset(); // 复用前清空（归还时已清零，这里兜底）
+        _active_mask[m].fetch_or(1ULL << i, std::memory_order_release);
+        return id;
     }
     return std::nullopt;
 }
@@ -76,91 +113,175 @@ void ThreadLocalRegistry::releaseSlot(size_t id)
 {
     if (id >= kMaxWorkers)return;
 
-    uint64_t t, s, f, ht, hs, hf;
-    _slots[id].read(t, s, f);
-
-    //物理归零
-    _slots[id].update(0, 0, 0);
+    std::lock_guard<std::mutex> lock(_membership_mutex);
 
-    //归并历史
-    _historical_stats.read(ht, hs, hf);
-    _historical_stats.update(ht + t, hs + s, hf + f);
+    //归并历史后物理归零：两步都在锁内，汇总方不会看到重复或缺失
+    for (size_t a = 0; a < kHookActionCount; ++a)
+    {
+        _historical_stats.actions[a].fetchAdd(_slots[id].actions[a].read());
+    }
+    _slots[id].reset();
 
-    //内存屏障确保归零后再释放标志位
-    std::atomic_thread_fence(std::memory_order_seq_cst);
     _active_mask[id / 64].fetch_and(~(1ULL << (id % 64)), std::memory_order_release);
 }
 
-void ThreadLocalRegistry::aggregate(uint64_t& t, uint64_t& s, uint64_t& f) const noexcept
+bool ThreadLocalRegistry::bindCurrentThread()
 {
-    uint64_t tt = 0, ts = 0, tf = 0;
-    _historical_stats.read(tt, ts, tf);
+    if (tls_slot)return true;
+
+    const auto id = acquireSlot();
+    if (!id)return false;
+
+    tls_slot_id = *id;
+    tls_slot = &_slots[*id];
+    return true;
+}
+
+void ThreadLocalRegistry::unbindCurrentThread()
+{
+    if (!tls_slot)return;
+
+    releaseSlot(tls_slot_id);
+    tls_slot = nullptr;
+    tls_slot_id = kMaxWorkers;
+}
+
+void ThreadLocalRegistry::record(HookAction action, const ActionCounters& delta) noexcept
+{
+    const auto index = std::min(static_cast<size_t>(action), kHookActionCount - 1);
+    if (tls_slot)[[likely]]
+    {
+        tls_slot->actions[index].add(delta);
+    }
+    else
+    {
+        _shared_stats.actions[index].fetchAdd(delta);
+    }
+}
+
+void ThreadLocalRegistry::recordRequest(HookAction action, uint64_t bytes_in) noexcept
+{
+    record(action, ActionCounters{.requests = 1, .bytes_in = bytes_in});
+}
+
+void ThreadLocalRegistry::recordResult(HookAction action, bool ok) noexcept
+{
+    record(action, ok ? ActionCounters{.success = 1} : ActionCounters{.failed = 1});
+}
+
+void ThreadLocalRegistry::recordBytesOut(HookAction action, uint64_t bytes_out) noexcept
+{
+    record(action, ActionCounters{.bytes_out = bytes_out});
+}
+
+void ThreadLocalRegistry::aggregate(Snapshot& out) const noexcept
+{
+    out = {};
+
+    std::lock_guard<std::mutex> lock(_membership_mutex);
+    for (size_t a = 0; a < kHookActionCount; ++a)
+    {
+        out[a] += _historical_stats.actions[a].read();
+        out[a] += _shared_stats.actions[a].read();
+    }
 
     for (size_t m = 0; m < 2; ++m)
     {
         uint64_t mask = _active_mask[m].load(std::memory_order_acquire);
         while (mask)
         {
-            int i = __builtin_ctzll(mask);
-            uint64_t st, ss, sf;
-            _slots[m * 64 + i].read(st, ss, sf);
-            tt += st;
-            ts += ss;
-            tf += sf;
-            mask &= ~(1ULL << i);
+            const int i = __builtin_ctzll(mask);
+            const auto& slot = _slots[m * 64 + static_cast<size_t>(i)];
+            for (size_t a = 0; a < kHookActionCount; ++a)
+            {
+                out[a] += slot.actions[a].read();
+            }
+            mask &= mask - 1;
         }
     }
-    t = tt;
-    s = ts;
-    f = tf;
+}
+
+void ThreadLocalRegistry::aggregate(uint64_t& t, uint64_t& s, uint64_t& f) const noexcept
+{
+    Snapshot snap;
+    aggregate(snap);
+
+    ActionCounters total;
+    for (const auto& c : snap)
+    {
+        total += c;
+    }
+    t = total.requests;
+    s = total.success;
+    f = total.failed;
 }
 
 // --- ServerMetricsProvider 实现 ---
 void ServerMetricsProvider::refresh() noexcept
 {
-    uint64_t t, s, f;
-    ThreadLocalRegistry::instance().aggregate(t, s, f);
+    ThreadLocalRegistry::Snapshot snap;
+    ThreadLocalRegistry::instance().aggregate(snap);
 
-    //预分配缓冲区：thread_local 规避堆分配与多线程竞争
-    static constexpr size_t kBufferSize = 1024;
-    thread_local char buffer[kBufferSize];
+    ActionCounters total;
+    for (const auto& c : snap)
+    {
+        total += c;
+    }
 
-    //每次进入重置指针
-    char* ptr = buffer;
-    char* const end = buffer + kBufferSize;
+    // 按照 Prometheus 标准文本格式写入
+    // 指标名带上网关前缀，方便在 Grafana 中直接检索；显式声明 counter 以便 rate() 正确处理重启归零
+    std::string exposition;
+    exposition.reserve(2048);
 
-    //定义辅助 Lambda：保持偏执的零分配与类型安全
-    // 这里的 noexcept 保证了整体 refresh 的异常安全性
-    auto append_metric = [&](std::string_view name, uint64_t value)noexcept
+    auto append_counter = [&exposition](std::string_view name, uint64_t value)
     {
-        // 偏执检查：名称长度 + 数字最大长度(20) + 符号位(2)
-        if (ptr + name.size() + 22 >= end)[[unlikely]]
-        {
-            return;
-        }
+        PrometheusWriter::appendType(exposition, name, "counter");
+        PrometheusWriter::appendSample(exposition, name, value);
+    };
 
-        // 写入指标名
-        ptr = std::copy_n(name.data(), name.size(), ptr);
-        *ptr++ = ' ';
+    append_counter("streamgate_requests_total", total.requests);
+    append_counter("streamgate_requests_success", total.success);
+    append_counter("streamgate_requests_failed", total.failed);
 
-        // 使用 <charconv> 实现 0 分配转换，end - 1 为 '\n' 留坑
-        auto [p,ec] = std::to_chars(ptr, end - 1, value);
-        if (ec == std::errc{})[[likely]]
+    // 按 HookAction 拆分：streamgate_hook_<field>_total{action="publish"}
+    nlohmann::json actions = nlohmann::json::object();
+    auto append_by_action = [&](std::string_view name, uint64_t ActionCounters::* field)
+    {
+        PrometheusWriter::appendType(exposition, name, "counter");
+        for (size_t a = 0; a < kHookActionCount; ++a)
         {
-            ptr = p;
-            *ptr++ = '\n';
+            std::string label = "action=\"";
+            label.append(hookActionLabel(static_cast<HookAction>(a)));
+            label.push_back('"');
+            PrometheusWriter::appendSample(exposition, name, snap[a].*field, label);
         }
     };
 
-    // 4. 按照 Prometheus 标准文本格式写入
-    // 指标名带上网关前缀，方便在 Grafana 中直接检索
-    append_metric("streamgate_requests_total", t);
-    append_metric("streamgate_requests_success", s);
-    append_metric("streamgate_requests_failed", f);
+    append_by_action("streamgate_hook_requests_total", &ActionCounters::requests);
+    append_by_action("streamgate_hook_success_total", &ActionCounters::success);
+    append_by_action("streamgate_hook_failed_total", &ActionCounters::failed);
+    append_by_action("streamgate_hook_received_bytes_total", &ActionCounters::bytes_in);
+    append_by_action("streamgate_hook_sent_bytes_total", &ActionCounters::bytes_out);
+
+    for (size_t a = 0; a < kHookActionCount; ++a)
+    {
+        const auto& c = snap[a];
+        actions[std::string(hookActionLabel(static_cast<HookAction>(a)))] = {
+            {"requests", c.requests},
+            {"success", c.success},
+            {"failed", c.failed},
+            {"bytes_in", c.bytes_in},
+            {"bytes_out", c.bytes_out}
+        };
+    }
 
-    //发布快照：通过 string_view 传递，不涉及字符串拷贝
-    // 注意：updateSnapshot 内部若需跨线程则由其自行决定是否拷贝
-    updateSnapshot(std::string_view(buffer, static_cast<size_t>(ptr - buffer)));
+    //发布快照：JSON 视图与文本同时切换
+    updateSnapshot({
+                       {"requests_total", total.requests},
+                       {"requests_success", total.success},
+                       {"requests_failed", total.failed},
+                       {"actions", std::move(actions)}
+                   }, std::move(exposition));
 }
 
 extern "C" void ForceLink_ServerMetricsProvider()
@@ -0,0 +1,49 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "StateMetricsProvider.h"
+#include "WriteBehindStreamStateManager.h"
+
+REGISTER_METRICS(StateMetricsProvider)
+
+void StateMetricsProvider::refresh() noexcept
+{
+    //哨兵检查：未启用写回
+    if (!_manager)
+    {
+        updateSnapshot({{"status", "disabled"}});
+        return;
+    }
+
+    const auto s = _manager->stats();
+
+    updateSnapshot({
+        {"status", "running"},
+        {"pending", s.pending},
+        {"cached", s.cached},
+        {"batches", s.batches},
+        {"flushed_ops", s.flushed_ops},
+        {"coalesced_ops", s.coalesced_ops},
+        {"flush_errors", s.flush_errors},
+        {"backpressure_waits", s.backpressure_waits},
+        {"rejected", s.rejected},
+        {"sync_fallbacks", s.sync_fallbacks},
+        {
+            "batch_size", {
+                {"last", s.last_batch_size},
+                {"max", s.max_batch_size},
+                {"avg", s.batches ? static_cast<double>(s.flushed_ops) / static_cast<double>(s.batches) : 0.0}
+            }
+        },
+        {
+            "flush_lag", {
+                {"last_ms", static_cast<double>(s.last_flush_lag_us) / 1000.0},
+                {"max_ms", static_cast<double>(s.max_flush_lag_us) / 1000.0}
+            }
+        }
+    });
+}
+
+extern "C" void ForceLink_StateMetricsProvider()
+{
+}
@@ -3,6 +3,11 @@
 //
 #include "HybridAuthRepository.h"
 #include "Logger.h"
+#include "HookTrace.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
 
 namespace
 {
@@ -33,11 +38,26 @@ namespace
 }
 
 HybridAuthRepository::HybridAuthRepository(DBManager& dbManager, CacheManager& cacheManager)
+    : HybridAuthRepository(dbManager, cacheManager, Config{})
+{
+}
+
+HybridAuthRepository::HybridAuthRepository(DBManager& dbManager, CacheManager& cacheManager, const Config& config)
     : _dbManager(dbManager),
       _cacheManager(cacheManager),
-      _cacheTTL(cacheManager.getTTL())
+      _cacheTTL(cacheManager.getTTL()),
+      _l1TTL(std::min(config.l1_ttl, std::chrono::seconds(cacheManager.getTTL())))
 {
-    LOG_INFO("[HybridAuthRepository] Initialized | CacheTTL: " + std::to_string(_cacheTTL) + "s");
+    if (config.l1_capacity_bytes > 0 && _l1TTL.count() > 0)
+    {
+        AuthL1Cache::Config l1_cfg;
+        l1_cfg.capacity_bytes = config.l1_capacity_bytes;
+        l1_cfg.num_shards = config.l1_shards;
+        _l1 = std::make_unique<AuthL1Cache>(l1_cfg);
+    }
+
+    LOG_INFO("[HybridAuthRepository] Initialized | CacheTTL: " + std::to_string(_cacheTTL) + "s" +
+        " | L1: " + (_l1 ? std::to_string(_l1TTL.count()) + "s" : std::string("disabled")));
 }
 
 std::optional<StreamAuthData> HybridAuthRepository::getAuthData(const std::string& streamKey,
@@ -50,27 +70,85 @@ std::optional<StreamAuthData> HybridAuthRepository::getAuthData(const std::strin
     //计算一次 cacheKey
     const std::string cacheKey = buildCacheKey(streamKey, clientId);
 
+    // AuthCache 阶段覆盖 L1 + Redis；命中时随 return 结束，未命中在进入 DB 路径前结束
+    StageTimer cacheTimer(HookTrace::current(), HookStage::AuthCache);
+
+    // Step 0: L1 Path (进程内，无网络往返)
+    if (_l1)
+    {
+        StreamAuthData l1Data;
+        switch (_l1->get(cacheKey, l1Data))
+        {
+        case AuthL1Cache::Lookup::Hit:
+            if (l1Data.authToken == authToken && l1Data.clientId == clientId)
+            {
+                LOG_DEBUG("[HybridAuthRepository] L1 HIT | Key: " + cacheKey);
+                return l1Data;
+            }
+
+            // 与 Redis 路径保持一致的不匹配处理
+            ++_validationFailures;
+            LOG_WARN("[HybridAuthRepository] L1 validation mismatch | Stream: " + streamKey);
+            invalidateCache(cacheKey);
+            return std::nullopt;
+
+        case AuthL1Cache::Lookup::NegativeHit:
+            // 仅当同一 Token 近期已被判定不存在时才短路，换 Token 重试照常查询
+            if (l1Data.authToken == authToken)
+            {
+                LOG_DEBUG("[HybridAuthRepository] L1 NEGATIVE HIT | Key: " + cacheKey);
+                return std::nullopt;
+            }
+            break;
+
+        case AuthL1Cache::Lookup::Miss:
+            break;
+        }
+    }
+
     // Step 1: Cache Path (修正统计口径)
-    if (auto cacheData = tryGetFromCache(cacheKey))
+    if (auto cached = tryGetFromCache(cacheKey, authToken))
     {
         ++_cacheHits; // 只要缓存里有，就是物理命中
 
+        if (!cached->has_value())
+        {
+            // 同一 Token 的 Redis 负缓存：回填 L1 并直接拒绝，不穿透到 DB；其它 Token 留下的负缓存按未命中处理
+            LOG_DEBUG("[HybridAuthRepository] Cache NEGATIVE HIT | Key: " + cacheKey);
+            rememberNegative(cacheKey, authToken);
+            return std::nullopt;
+        }
+
+        const auto& cacheData = *cached;
         if (cacheData->authToken == authToken && cacheData->clientId == clientId)
         {
             LOG_DEBUG("[HybridAuthRepository] Cache HIT | Key: " + cacheKey);
+            if (_l1)_l1->put(cacheKey, *cacheData, _l1TTL);
             return cacheData;
         }
 
         // 逻辑不匹配：Token 错或 ClientId 错
         ++_validationFailures;
         LOG_WARN("[HybridAuthRepository] Cache validation mismatch | Stream: " + streamKey);
-        bestEffort(_cacheManager.keyDel(cacheKey), cacheKey);
+        invalidateCache(cacheKey);
         return std::nullopt;
     }
 
     ++_cacheMisses;
+    cacheTimer.stop();
+
+    // Step 2: DB Path (Single-Flight：同一 cacheKey 的 DB 查询在进程内串行，相同 Token 的并发请求复用结果)
+    return _dbFlight.execute(cacheKey, authToken, [&]
+    {
+        return loadFromDatabase(streamKey, clientId, authToken, cacheKey);
+    });
+}
 
-    // Step 2: DB Path (增加熔断式负缓存)
+std::optional<StreamAuthData> HybridAuthRepository::loadFromDatabase(const std::string& streamKey,
+                                                                     const std::string& clientId,
+                                                                     const std::string& authToken,
+                                                                     const std::string& cacheKey)
+{
     auto dbResult = queryDatabase(streamKey, clientId, authToken, cacheKey);
 
     if (!dbResult)
@@ -100,7 +178,11 @@ std::optional<StreamAuthData> HybridAuthRepository::queryDatabase(const std::str
 {
     try
     {
-        auto dbResult = getAuthDataFromDB(streamKey, clientId, authToken);
+        std::optional<StreamAuthData> dbResult;
+        {
+            StageTimer timer(HookTrace::current(), HookStage::AuthDb);
+            dbResult = getAuthDataFromDB(streamKey, clientId, authToken);
+        }
 
         if (dbResult.has_value())
         {
@@ -110,7 +192,7 @@ std::optional<StreamAuthData> HybridAuthRepository::queryDatabase(const std::str
 
         ++_dbMisses;
         LOG_WARN("[HybridAuthRepository] Identity not found in DB | Stream: " + streamKey);
-        cacheNegativeResult(cacheKey, NEGATIVE_CACHE_TTL);
+        cacheNegativeResult(cacheKey, authToken, NEGATIVE_CACHE_TTL);
         return std::nullopt;
     }
     catch (const std::exception& e)
@@ -119,7 +201,7 @@ std::optional<StreamAuthData> HybridAuthRepository::queryDatabase(const std::str
         LOG_ERROR("[HybridAuthRepository] DB Error: " + std::string(e.what()));
 
         //抗雪崩策略：DB 挂了也写极短负缓存，保护 DB 不被瞬时打死
-        cacheNegativeResult(cacheKey, TRANSIENT_DB_ERROR_TTL); // 使用短TTL
+        cacheNegativeResult(cacheKey, authToken, TRANSIENT_DB_ERROR_TTL); // 使用短TTL
         return std::nullopt;
     }
 }
@@ -132,8 +214,7 @@ std::optional<StreamAuthData> HybridAuthRepository::getAuthDataFromDB(const std:
     ConnectionGuard conn(_dbManager);
     if (!conn)
     {
-        LOG_WARN("[AuthRepo] DB连接获取失败 (可能池已满或DB宕机): stream=" + streamKey);
-        return std::nullopt;
+        throw std::runtime_error("DB连接获取失败 (可能池已满或DB宕机): stream=" + streamKey);
     }
 
     const std::string sql = "SELECT client_id, is_active FROM stream_auth "
@@ -146,6 +227,7 @@ std::optional<StreamAuthData> HybridAuthRepository::getAuthDataFromDB(const std:
         pstmt->setString(2, clientId);
         pstmt->setString(3, authToken);
 
+        ++_dbRoundTrips;
         const auto res = pstmt->executeQuery();
         if (!res->next())
         {
@@ -163,11 +245,245 @@ std::optional<StreamAuthData> HybridAuthRepository::getAuthDataFromDB(const std:
     }
     catch (sql::SQLException& e)
     {
-        LOG_ERROR("[AuthRepo] SQL执行异常: " + std::string(e.what()) + " [Code: " + std::to_string(e.getErrorCode()) + "]");
-        return std::nullopt;
+        throw std::runtime_error("SQL执行异常: " + std::string(e.what()) +
+            " [Code: " + std::to_string(e.getErrorCode()) + "]");
     }
 }
 
+std::vector<std::optional<StreamAuthData>> HybridAuthRepository::getAuthDataBatch(
+    const std::vector<AuthRequest>& requests)
+{
+    std::vector<std::optional<StreamAuthData>> results(requests.size());
+    if (requests.empty())return results;
+
+    LOG_INFO("[HybridAuthRepository] Batch request: size=" + std::to_string(requests.size()));
+
+    std::vector<std::string> cacheKeys;
+    cacheKeys.reserve(requests.size());
+    for (const auto& req : requests)
+    {
+        cacheKeys.push_back(buildCacheKey(req.streamKey, req.clientId));
+    }
+
+    // Step 0: L1 Path (与单条路径语义一致)
+    std::vector<size_t> cachePending;
+    cachePending.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const auto& req = requests[i];
+        StreamAuthData l1Data;
+        const auto lookup = _l1 ? _l1->get(cacheKeys[i], l1Data) : AuthL1Cache::Lookup::Miss;
+
+        if (lookup == AuthL1Cache::Lookup::Hit)
+        {
+            if (l1Data.authToken == req.authToken && l1Data.clientId == req.clientId)
+            {
+                results[i] = std::move(l1Data);
+            }
+            else
+            {
+                ++_validationFailures;
+                invalidateCache(cacheKeys[i]);
+            }
+            continue;
+        }
+
+        if (lookup == AuthL1Cache::Lookup::NegativeHit && l1Data.authToken == req.authToken)
+        {
+            continue;
+        }
+
+        cachePending.push_back(i);
+    }
+
+    if (cachePending.empty())return results;
+
+    // Step 1: Cache Path —— 一次 MGET
+    std::vector<std::string> mgetKeys;
+    std::vector<std::string> mgetTokens;
+    mgetKeys.reserve(cachePending.size());
+    mgetTokens.reserve(cachePending.size());
+    for (const size_t i : cachePending)
+    {
+        mgetKeys.push_back(cacheKeys[i]);
+        mgetTokens.push_back(requests[i].authToken);
+    }
+
+    ++_redisRoundTrips;
+    const auto cached = _cacheManager.getAuthDataBatchFromCacheByKeys(mgetKeys, mgetTokens);
+
+    std::vector<size_t> dbPending;
+    for (size_t j = 0; j < cachePending.size(); ++j)
+    {
+        const size_t i = cachePending[j];
+        const auto& req = requests[i];
+
+        if (!cached[j])
+        {
+            ++_cacheMisses;
+            dbPending.push_back(i);
+            continue;
+        }
+
+        ++_cacheHits;
+        if (!cached[j]->has_value())
+        {
+            rememberNegative(cacheKeys[i], req.authToken);
+            continue;
+        }
+
+        const auto& cacheData = *cached[j];
+        if (cacheData->authToken == req.authToken && cacheData->clientId == req.clientId)
+        {
+            if (_l1)_l1->put(cacheKeys[i], *cacheData, _l1TTL);
+            results[i] = cacheData;
+        }
+        else
+        {
+            ++_validationFailures;
+            invalidateCache(cacheKeys[i]);
+        }
+    }
+
+    if (dbPending.empty())return results;
+
+    // Step 2: DB Path —— 分块 IN 查询
+    std::vector<AuthCacheEntry> writes;
+    writes.reserve(dbPending.size());
+
+    try
+    {
+        const auto rows = queryDatabaseBatch(requests, dbPending);
+
+        for (size_t j = 0; j < dbPending.size(); ++j)
+        {
+            const size_t i = dbPending[j];
+            const auto& req = requests[i];
+
+            if (!rows[j])
+            {
+                ++_dbMisses;
+                if (_l1)_l1->putNegative(cacheKeys[i], req.authToken,
+                                         std::min(_l1TTL, std::chrono::seconds(NEGATIVE_CACHE_TTL)));
+                writes.push_back({cacheKeys[i], std::nullopt, NEGATIVE_CACHE_TTL, req.authToken});
+                continue;
+            }
+
+            ++_dbHits;
+            if (!validateAuthData(*rows[j], req.streamKey, req.clientId, req.authToken))
+            {
+                ++_validationFailures;
+                continue;
+            }
+
+            if (_l1)_l1->put(cacheKeys[i], *rows[j], _l1TTL);
+            writes.push_back({cacheKeys[i], rows[j], _cacheTTL});
+            results[i] = rows[j];
+        }
+    }
+    catch (const std::exception& e)
+    {
+        ++_dbErrors;
+        LOG_ERROR("[HybridAuthRepository] Batch DB Error: " + std::string(e.what()));
+
+        //抗雪崩策略：整批写入短期负缓存
+        writes.clear();
+        for (const size_t i : dbPending)
+        {
+            if (_l1)_l1->putNegative(cacheKeys[i], requests[i].authToken,
+                                     std::min(_l1TTL, std::chrono::seconds(TRANSIENT_DB_ERROR_TTL)));
+            writes.push_back({cacheKeys[i], std::nullopt, TRANSIENT_DB_ERROR_TTL, requests[i].authToken});
+        }
+    }
+
+    // Step 3: 一次 Pipeline 回写
+    if (!writes.empty())
+    {
+        ++_redisRoundTrips;
+        bestEffort(_cacheManager.setAuthDataBatchToCacheByKeys(writes), "batch", "PipelinedWriteBack");
+    }
+
+    return results;
+}
+
+std::vector<std::optional<StreamAuthData>> HybridAuthRepository::queryDatabaseBatch(
+    const std::vector<AuthRequest>& requests, const std::vector<size_t>& indices) const
+{
+    ConnectionGuard conn(_dbManager);
+    if (!conn)
+    {
+        throw std::runtime_error("DB连接获取失败 (可能池已满或DB宕机)");
+    }
+
+    // (stream_key, client_id, auth_token) 三元组 -> 结果；用不可见分隔符拼接，避免字段内容产生歧义
+    const auto tupleKey = [](std::string_view sk, std::string_view cid, std::string_view tk)
+    {
+        std::string key;
+        key.reserve(sk.size() + cid.size() + tk.size() + 2);
+        key.append(sk).append(1, '\x1f').append(cid).append(1, '\x1f').append(tk);
+        return key;
+    };
+
+    std::unordered_map<std::string, StreamAuthData> found;
+
+    for (size_t begin = 0; begin < indices.size(); begin += kBatchQueryChunk)
+    {
+        const size_t end = std::min(begin + kBatchQueryChunk, indices.size());
+
+        std::string sql = "SELECT stream_key, client_id, auth_token, is_active FROM stream_auth "
+            "WHERE (stream_key, client_id, auth_token) IN (";
+        sql.reserve(sql.size() + (end - begin) * 8);
+        for (size_t k = begin; k < end; ++k)
+        {
+            sql += (k == begin) ? "(?,?,?)" : ",(?,?,?)";
+        }
+        sql += ')';
+
+        try
+        {
+            auto pstmt = conn->prepareStatement(sql);
+            int param = 1;
+            for (size_t k = begin; k < end; ++k)
+            {
+                const auto& req = requests[indices[k]];
+                pstmt->setString(param++, req.streamKey);
+                pstmt->setString(param++, req.clientId);
+                pstmt->setString(param++, req.authToken);
+            }
+
+            ++_dbRoundTrips;
+            const auto res = pstmt->executeQuery();
+            while (res->next())
+            {
+                StreamAuthData data;
+                data.streamKey = res->getString("stream_key");
+                data.clientId = res->getString("client_id");
+                data.authToken = res->getString("auth_token");
+                data.isAuthorized = res->getBoolean("is_active");
+
+                auto key = tupleKey(data.streamKey, data.clientId, data.authToken);
+                found.emplace(std::move(key), std::move(data));
+            }
+        }
+        catch (sql::SQLException& e)
+        {
+            throw std::runtime_error("SQL执行异常: " + std::string(e.what()) +
+                " [Code: " + std::to_string(e.getErrorCode()) + "]");
+        }
+    }
+
+    std::vector<std::optional<StreamAuthData>> rows(indices.size());
+    for (size_t j = 0; j < indices.size(); ++j)
+    {
+        const auto& req = requests[indices[j]];
+        if (const auto it = found.find(tupleKey(req.streamKey, req.clientId, req.authToken)); it != found.end())
+        {
+            rows[j] = it->second;
+        }
+    }
+    return rows;
+}
+
 bool HybridAuthRepository::validateAuthData(const StreamAuthData& data, std::string_view expectedStreamKey,
                                             std::string_view expectedClientId, std::string_view expectedToken)
 {
@@ -195,11 +511,12 @@ std::string HybridAuthRepository::buildCacheKey(const std::string& streamKey, co
     return key;
 }
 
-std::optional<StreamAuthData> HybridAuthRepository::tryGetFromCache(const std::string& cacheKey) const
+CachedAuthData HybridAuthRepository::tryGetFromCache(const std::string& cacheKey, const std::string& authToken) const
 {
+    ++_redisRoundTrips;
     try
     {
-        return _cacheManager.getAuthDataFromCacheByKey(cacheKey);
+        return _cacheManager.getAuthDataFromCacheByKey(cacheKey, authToken);
     }
     catch (const std::exception& e)
     {
@@ -215,6 +532,9 @@ std::optional<StreamAuthData> HybridAuthRepository::tryGetFromCache(const std::s
 
 void HybridAuthRepository::cacheAuthData(const std::string& cacheKey, const StreamAuthData& data) const
 {
+    if (_l1)_l1->put(cacheKey, data, _l1TTL);
+
+    ++_redisRoundTrips;
     try
     {
         _cacheManager.setAuthDataToCacheByKey(cacheKey, data, _cacheTTL);
@@ -225,17 +545,34 @@ void HybridAuthRepository::cacheAuthData(const std::string& cacheKey, const Stre
     }
 }
 
-void HybridAuthRepository::cacheNegativeResult(const std::string& cacheKey, int ttl) const
+void HybridAuthRepository::cacheNegativeResult(const std::string& cacheKey, const std::string& authToken,
+                                               int ttl) const
 {
+    if (_l1)_l1->putNegative(cacheKey, authToken, std::min(_l1TTL, std::chrono::seconds(ttl)));
+
+    ++_redisRoundTrips;
     try
     {
-        _cacheManager.setEmptyAuthDataToCache(cacheKey, ttl);
+        _cacheManager.setEmptyAuthDataToCache(cacheKey, authToken, ttl);
     }
     catch (...)
     {
     }
 }
 
+void HybridAuthRepository::rememberNegative(const std::string& cacheKey, const std::string& authToken) const
+{
+    // Redis 中负缓存的剩余 TTL 未知（可能是 DB 异常时写入的短 TTL），按最短的一档回填 L1，避免拉长拒绝窗口
+    if (_l1)_l1->putNegative(cacheKey, authToken, std::min(_l1TTL, std::chrono::seconds(TRANSIENT_DB_ERROR_TTL)));
+}
+
+void HybridAuthRepository::invalidateCache(const std::string& cacheKey) const
+{
+    if (_l1)_l1->erase(cacheKey);
+    ++_redisRoundTrips;
+    bestEffort(_cacheManager.keyDel(cacheKey), cacheKey);
+}
+
 HybridAuthRepository::Stats HybridAuthRepository::getStats() const
 {
     Stats s{};
@@ -248,6 +585,33 @@ HybridAuthRepository::Stats HybridAuthRepository::getStats() const
 
     const uint64_t total = s.cache_hits + s.cache_misses;
     s.cache_hit_rate = (total > 0) ? (static_cast<double>(s.cache_hits) / static_cast<double>(total)) : 0.0;
+
+    const auto flight = _dbFlight.getStats();
+    s.db_flight_leaders = flight.leaders;
+    s.db_coalesced_waiters = flight.coalesced_waiters;
+    s.db_serialized_waiters = flight.serialized_waiters;
+    s.db_waiting = flight.waiting;
+    s.db_in_flight = flight.in_flight;
+    s.redis_round_trips = _redisRoundTrips.load();
+    s.db_round_trips = _dbRoundTrips.load();
+
+    if (_l1)
+    {
+        const auto l1 = _l1->getStats();
+        s.l1_hits = l1.hits;
+        s.l1_negative_hits = l1.negative_hits;
+        s.l1_misses = l1.misses;
+        s.l1_evictions = l1.evictions;
+        s.l1_expirations = l1.expirations;
+        s.l1_entries = l1.entries;
+        s.l1_bytes = l1.bytes;
+        s.l1_capacity_bytes = l1.capacity_bytes;
+
+        const uint64_t l1_total = l1.hits + l1.negative_hits + l1.misses;
+        s.l1_hit_rate = (l1_total > 0)
+                            ? (static_cast<double>(l1.hits + l1.negative_hits) / static_cast<double>(l1_total))
+                            : 0.0;
+    }
     return s;
 }
 
@@ -259,6 +623,10 @@ void HybridAuthRepository::resetStats()
     _dbMisses = 0;
     _dbErrors = 0;
     _validationFailures = 0;
+    _redisRoundTrips = 0;
+    _dbRoundTrips = 0;
+    _dbFlight.resetStats();
+    if (_l1)_l1->resetStats();
 }
 
 bool HybridAuthRepository::isHealthy()
@@ -0,0 +1,1011 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "InMemoryStreamStateManager.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using SystemClock = std::chrono::system_clock;
+
+    // journal / 快照文件头
+    constexpr std::string_view kMagic = "SGSTATE1";
+    constexpr std::string_view kSnapshotFile = "state.snapshot";
+    constexpr std::string_view kJournalPrefix = "state.journal.";
+    // 缓冲区超过该大小时由写入线程直接写出，不等后台线程
+    constexpr size_t kJournalBufferLimit = 1024 * 1024;
+    // 时间轮 key 中 stream 与 client 的分隔符（流名来自 ZLM 的 app/stream，不会包含控制字符）
+    constexpr char kKeySeparator = '\x1f';
+
+    enum class Op : uint8_t
+    {
+        Register = 1,
+        Touch = 2,
+        Deregister = 3,
+        DeregisterAll = 4
+    };
+
+    int64_t toMs(SystemClock::time_point tp)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+    }
+
+    SystemClock::time_point fromMs(int64_t ms)
+    {
+        return SystemClock::time_point(std::chrono::milliseconds{ms});
+    }
+
+    // FNV-1a：只用于发现 journal 尾部的半条记录 / 损坏，不做安全用途
+    uint32_t checksum(std::string_view data)
+    {
+        uint32_t h = 2166136261u;
+        for (const char c : data)
+        {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    std::string expiryKey(const std::string& stream_name, const std::string& client_id)
+    {
+        std::string key;
+        key.reserve(stream_name.size() + client_id.size() + 1);
+        key.append(stream_name).push_back(kKeySeparator);
+        key.append(client_id);
+        return key;
+    }
+
+    /**
+     * @brief 记录格式：[u32 payload 长度][u32 校验和][payload]，payload = [u8 op][字段...]
+     * * 整数按主机字节序（小端）定长写入，字符串为 u32 长度 + 字节
+     */
+    class RecordWriter
+    {
+    public:
+        explicit RecordWriter(Op op)
+        {
+            _buf.resize(8);
+            _buf.push_back(static_cast<char>(op));
+        }
+
+        RecordWriter& u8(uint8_t v)
+        {
+            _buf.push_back(static_cast<char>(v));
+            return *this;
+        }
+
+        RecordWriter& i64(int64_t v)
+        {
+            char raw[sizeof(v)];
+            std::memcpy(raw, &v, sizeof(v));
+            _buf.append(raw, sizeof(v));
+            return *this;
+        }
+
+        RecordWriter& str(std::string_view s)
+        {
+            const auto len = static_cast<uint32_t>(s.size());
+            char raw[sizeof(len)];
+            std::memcpy(raw, &len, sizeof(len));
+            _buf.append(raw, sizeof(len)).append(s);
+            return *this;
+        }
+
+        RecordWriter& task(const StreamTask& t)
+        {
+            i64(static_cast<int64_t>(t.task_id)).str(t.stream_name).str(t.client_id);
+            u8(static_cast<uint8_t>(t.type)).u8(static_cast<uint8_t>(t.state)).u8(static_cast<uint8_t>(t.protocol));
+            str(t.server_ip).i64(t.server_port);
+            i64(toMs(t.start_time)).i64(toMs(t.last_active_time));
+            str(t.user_id).str(t.auth_token);
+            u8(t.region ? 1 : 0).str(t.region.value_or(""));
+            u8(t.need_transcode ? 1 : 0).u8(t.need_record ? 1 : 0).str(t.transcoding_profile);
+            return *this;
+        }
+
+        std::string finish()
+        {
+            const auto len = static_cast<uint32_t>(_buf.size() - 8);
+            const uint32_t sum = checksum(std::string_view(_buf).substr(8));
+            std::memcpy(_buf.data(), &len, sizeof(len));
+            std::memcpy(_buf.data() + 4, &sum, sizeof(sum));
+            return std::move(_buf);
+        }
+
+    private:
+        std::string _buf;
+    };
+
+    class RecordReader
+    {
+    public:
+        explicit RecordReader(std::string_view payload) : _data(payload)
+        {
+        }
+
+        bool u8(uint8_t& v)
+        {
+            if (_pos + 1 > _data.size())return false;
+            v = static_cast<uint8_t>(_data[_pos++]);
+            return true;
+        }
+
+        bool i64(int64_t& v)
+        {
+            if (_pos + sizeof(v) > _data.size())return false;
+            std::memcpy(&v, _data.data() + _pos, sizeof(v));
+            _pos += sizeof(v);
+            return true;
+        }
+
+        bool str(std::string& s)
+        {
+            uint32_t len = 0;
+            if (_pos + sizeof(len) > _data.size())return false;
+            std::memcpy(&len, _data.data() + _pos, sizeof(len));
+            _pos += sizeof(len);
+            if (_pos + len > _data.size())return false;
+            s.assign(_data.data() + _pos, len);
+            _pos += len;
+            return true;
+        }
+
+        bool task(StreamTask& t)
+        {
+            int64_t id = 0, port = 0, start_ms = 0, last_ms = 0;
+            uint8_t type = 0, state = 0, protocol = 0, has_region = 0, transcode = 0, record = 0;
+            std::string region;
+            if (!i64(id) || !str(t.stream_name) || !str(t.client_id) || !u8(type) || !u8(state) || !u8(protocol) ||
+                !str(t.server_ip) || !i64(port) || !i64(start_ms) || !i64(last_ms) || !str(t.user_id) ||
+                !str(t.auth_token) || !u8(has_region) || !str(region) || !u8(transcode) || !u8(record) ||
+                !str(t.transcoding_profile))
+            {
+                return false;
+            }
+
+            t.task_id = static_cast<uint64_t>(id);
+            t.type = static_cast<StreamType>(type);
+            t.state = static_cast<StreamState>(state);
+            t.protocol = static_cast<StreamProtocol>(protocol);
+            t.server_port = static_cast<int>(port);
+            t.start_time = fromMs(start_ms);
+            t.last_active_time = fromMs(last_ms);
+            if (has_region)t.region = std::move(region);
+            t.need_transcode = transcode != 0;
+            t.need_record = record != 0;
+            return true;
+        }
+
+    private:
+        std::string_view _data;
+        size_t _pos = 0;
+    };
+
+    bool writeAll(int fd, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t n = ::write(fd, data, size);
+            if (n < 0)
+            {
+                if (errno == EINTR)continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+InMemoryStreamStateManager::InMemoryStreamStateManager()
+    : InMemoryStreamStateManager(Config{})
+{
+}
+
+InMemoryStreamStateManager::InMemoryStreamStateManager(const Config& config)
+    : _config(config),
+      _shards(std::make_unique<Shard[]>(std::max<size_t>(config.shards, 1))),
+      _shardCount(std::max<size_t>(config.shards, 1))
+{
+    if (_config.data_dir.empty())return;
+
+    recover();
+    _persister = std::jthread([this](const std::stop_token& stoken)
+    {
+        persistLoop(stoken);
+    });
+}
+
+InMemoryStreamStateManager::~InMemoryStreamStateManager()
+{
+    if (_persister.joinable())
+    {
+        _persister.request_stop();
+        _wakeCondition.notify_all();
+        _persister.join();
+    }
+
+    if (_config.data_dir.empty())return;
+
+    // 停机快照：下次启动只需加载快照
+    (void)snapshot();
+    std::lock_guard<std::mutex> lock(_journalMutex);
+    (void)writeJournalLocked();
+    if (_journalFd >= 0)
+    {
+        ::close(_journalFd);
+        _journalFd = -1;
+    }
+}
+
+InMemoryStreamStateManager::Shard& InMemoryStreamStateManager::shardFor(const std::string& stream_name) const
+{
+    return _shards[std::hash<std::string>{}(stream_name) % _shardCount];
+}
+
+// 任务生命周期
+bool InMemoryStreamStateManager::registerTask(const StreamTask& task)
+{
+    assert(!task.stream_name.empty());
+    assert(!task.client_id.empty());
+
+    StreamTask stored = task;
+    stored.last_active_time = SystemClock::now();
+
+    Shard& shard = shardFor(task.stream_name);
+    {
+        std::unique_lock lock(shard.mutex);
+        if (task.type == StreamType::PUBLISHER)
+        {
+            if (const auto it = shard.streams.find(task.stream_name);
+                it != shard.streams.end() && !it->second.publisher.empty() && it->second.publisher != task.client_id)
+            {
+                LOG_WARN("registerTask: Stream " + task.stream_name +
+                    " already has a different publisher, rejected client: " + task.client_id);
+                return false;
+            }
+        }
+
+        applyRegister(shard, stored);
+        appendJournal(RecordWriter(Op::Register).task(stored).finish());
+    }
+
+    armExpiry(stored.stream_name, stored.client_id, stored.last_active_time);
+    return true;
+}
+
+bool InMemoryStreamStateManager::deregisterTask(const std::string& stream_name, const std::string& client_id)
+{
+    Shard& shard = shardFor(stream_name);
+    {
+        std::unique_lock lock(shard.mutex);
+        if (applyDeregister(shard, stream_name, client_id))
+        {
+            appendJournal(RecordWriter(Op::Deregister).str(stream_name).str(client_id).finish());
+        }
+    }
+    cancelExpiry(stream_name, client_id);
+    return true;
+}
+
+void InMemoryStreamStateManager::deregisterAllMembers(const std::string& stream_name)
+{
+    std::vector<std::string> clients;
+    Shard& shard = shardFor(stream_name);
+    {
+        std::unique_lock lock(shard.mutex);
+        const auto it = shard.streams.find(stream_name);
+        if (it == shard.streams.end())return;
+
+        clients.reserve(it->second.members.size());
+        for (const auto& [client_id, task] : it->second.members)
+        {
+            clients.push_back(client_id);
+        }
+        applyDeregisterAll(shard, stream_name);
+        appendJournal(RecordWriter(Op::DeregisterAll).str(stream_name).finish());
+    }
+
+    for (const auto& client_id : clients)
+    {
+        cancelExpiry(stream_name, client_id);
+    }
+    LOG_INFO("Cleanup: Stream " + stream_name + " all members cleared.");
+}
+
+bool InMemoryStreamStateManager::touchTask(const std::string& stream_name, const std::string& client_id) const
+{
+    const auto now = SystemClock::now();
+    Shard& shard = shardFor(stream_name);
+    {
+        std::unique_lock lock(shard.mutex);
+        if (!applyTouch(shard, stream_name, client_id, toMs(now)))return false;
+        appendJournal(RecordWriter(Op::Touch).str(stream_name).str(client_id).i64(toMs(now)).finish());
+    }
+
+    armExpiry(stream_name, client_id, now);
+    return true;
+}
+
+// 查询接口
+std::vector<std::string> InMemoryStreamStateManager::getStreamClientIds(const std::string& stream_name) const
+{
+    const Shard& shard = shardFor(stream_name);
+    std::shared_lock lock(shard.mutex);
+    const auto it = shard.streams.find(stream_name);
+    if (it == shard.streams.end())return {};
+
+    std::vector<std::string> ids;
+    ids.reserve(it->second.members.size());
+    for (const auto& [client_id, task] : it->second.members)
+    {
+        ids.push_back(client_id);
+    }
+    return ids;
+}
+
+std::optional<StreamTask> InMemoryStreamStateManager::getTask(const std::string& stream_name,
+                                                              const std::string& client_id) const
+{
+    const Shard& shard = shardFor(stream_name);
+    std::shared_lock lock(shard.mutex);
+    const auto it = shard.streams.find(stream_name);
+    if (it == shard.streams.end())return std::nullopt;
+
+    const auto member = it->second.members.find(client_id);
+    if (member == it->second.members.end())return std::nullopt;
+    return member->second;
+}
+
+std::optional<StreamTask> InMemoryStreamStateManager::getPublisherTask(const std::string& stream_name) const
+{
+    const Shard& shard = shardFor(stream_name);
+    std::shared_lock lock(shard.mutex);
+    const auto it = shard.streams.find(stream_name);
+    if (it == shard.streams.end() || it->second.publisher.empty())return std::nullopt;
+
+    const auto member = it->second.members.find(it->second.publisher);
+    if (member == it->second.members.end())return std::nullopt;
+    return member->second;
+}
+
+std::optional<PublisherLocation> InMemoryStreamStateManager::getPublisherLocation(
+    const std::string& stream_name) const
+{
+    const Shard& shard = shardFor(stream_name);
+    std::shared_lock lock(shard.mutex);
+    const auto it = shard.streams.find(stream_name);
+    if (it == shard.streams.end() || it->second.publisher.empty())return std::nullopt;
+
+    const auto member = it->second.members.find(it->second.publisher);
+    if (member == it->second.members.end())return std::nullopt;
+    return PublisherLocation{member->second.client_id, member->second.server_ip, member->second.server_port};
+}
+
+std::vector<StreamTask> InMemoryStreamStateManager::getAllPublisherTasks() const
+{
+    std::vector<StreamTask> tasks;
+    for (size_t i = 0; i < _shardCount; ++i)
+    {
+        const Shard& shard = _shards[i];
+        std::shared_lock lock(shard.mutex);
+        for (const auto& [name, entry] : shard.streams)
+        {
+            if (entry.publisher.empty())continue;
+            if (const auto it = entry.members.find(entry.publisher); it != entry.members.end())
+            {
+                tasks.push_back(it->second);
+            }
+        }
+    }
+    return tasks;
+}
+
+size_t InMemoryStreamStateManager::getActivePublisherCount() const
+{
+    return static_cast<size_t>(std::max<int64_t>(_publishers.load(std::memory_order_relaxed), 0));
+}
+
+size_t InMemoryStreamStateManager::getActivePlayerCount() const
+{
+    return static_cast<size_t>(std::max<int64_t>(_players.load(std::memory_order_relaxed), 0));
+}
+
+size_t InMemoryStreamStateManager::getPlayerCount(const std::string& stream_name) const
+{
+    const Shard& shard = shardFor(stream_name);
+    std::shared_lock lock(shard.mutex);
+    const auto it = shard.streams.find(stream_name);
+    if (it == shard.streams.end())return 0;
+
+    const auto& entry = it->second;
+    const bool has_publisher = !entry.publisher.empty() && entry.members.contains(entry.publisher);
+    return entry.members.size() - (has_publisher ? 1 : 0);
+}
+
+std::vector<NodeLoad> InMemoryStreamStateManager::getNodeLoads() const
+{
+    std::unordered_map<std::string, NodeLoad> by_node;
+    for (size_t i = 0; i < _shardCount; ++i)
+    {
+        const Shard& shard = _shards[i];
+        std::shared_lock lock(shard.mutex);
+        for (const auto& [name, entry] : shard.streams)
+        {
+            if (entry.publisher.empty())continue;
+            const auto it = entry.members.find(entry.publisher);
+            if (it == entry.members.end())continue;
+
+            const StreamTask& pub = it->second;
+            auto& load = by_node[pub.server_ip + ":" + std::to_string(pub.server_port)];
+            load.host = pub.server_ip;
+            load.port = pub.server_port;
+            ++load.publishers;
+            // 成员表包含推流端自身
+            load.players += entry.members.size() - 1;
+        }
+    }
+
+    std::vector<NodeLoad> loads;
+    loads.reserve(by_node.size());
+    for (auto& [key, load] : by_node)
+    {
+        loads.push_back(std::move(load));
+    }
+    return loads;
+}
+
+// 超时回收
+TimeoutScanResult InMemoryStreamStateManager::scanTimeoutTasks(std::chrono::milliseconds timeout,
+                                                               const TimeoutScanOptions& options)
+{
+    const auto started = std::chrono::steady_clock::now();
+    const auto cutoff = SystemClock::now() - timeout;
+    TimeoutScanResult result;
+
+    for (size_t i = 0; i < _shardCount; ++i)
+    {
+        Shard& shard = _shards[i];
+        const size_t first_expired = result.expired.size();
+        {
+            std::unique_lock lock(shard.mutex);
+            for (auto it = shard.streams.begin(); it != shard.streams.end();)
+            {
+                StreamEntry& entry = it->second;
+                std::vector<std::string> expired_clients;
+                for (const auto& [client_id, task] : entry.members)
+                {
+                    if (task.last_active_time <= cutoff)expired_clients.push_back(client_id);
+                }
+
+                for (const auto& client_id : expired_clients)
+                {
+                    result.expired.push_back(entry.members.at(client_id));
+                    eraseMember(entry, client_id);
+                    appendJournal(RecordWriter(Op::Deregister).str(it->first).str(client_id).finish());
+                }
+
+                it = entry.members.empty() ? shard.streams.erase(it) : std::next(it);
+            }
+        }
+
+        for (size_t k = first_expired; k < result.expired.size(); ++k)
+        {
+            cancelExpiry(result.expired[k].stream_name, result.expired[k].client_id);
+        }
+        ++result.pages;
+
+        if (i + 1 < _shardCount && std::chrono::steady_clock::now() - started >= options.time_budget)
+        {
+            for (size_t j = i + 1; j < _shardCount; ++j)
+            {
+                std::shared_lock lock(_shards[j].mutex);
+                for (const auto& [name, entry] : _shards[j].streams)
+                {
+                    result.backlog += static_cast<size_t>(std::ranges::count_if(entry.members, [&](const auto& m)
+                    {
+                        return m.second.last_active_time <= cutoff;
+                    }));
+                }
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+void InMemoryStreamStateManager::enableLocalExpiry(std::chrono::milliseconds timeout, std::chrono::milliseconds tick)
+{
+    TimingWheel::Config cfg;
+    cfg.tick = tick;
+    _expiryTimeout = timeout;
+    _expiryWheel = std::make_unique<TimingWheel>(cfg);
+
+    // 恢复出来的任务按原有活跃时间登记
+    for (size_t i = 0; i < _shardCount; ++i)
+    {
+        std::shared_lock lock(_shards[i].mutex);
+        for (const auto& [name, entry] : _shards[i].streams)
+        {
+            for (const auto& [client_id, task] : entry.members)
+            {
+                armExpiry(name, client_id, task.last_active_time);
+            }
+        }
+    }
+}
+
+TimeoutScanResult InMemoryStreamStateManager::expireDueTasks(std::chrono::milliseconds timeout)
+{
+    TimeoutScanResult result;
+    if (!_expiryWheel)return result;
+
+    const auto due = _expiryWheel->advance(std::chrono::steady_clock::now());
+    if (due.empty())return result;
+
+    const auto cutoff = SystemClock::now() - timeout;
+    for (const auto& key : due)
+    {
+        const auto sep = key.find(kKeySeparator);
+        if (sep == std::string::npos)continue;
+        const std::string stream_name = key.substr(0, sep);
+        const std::string client_id = key.substr(sep + 1);
+
+        std::optional<SystemClock::time_point> refreshed;
+        Shard& shard = shardFor(stream_name);
+        {
+            std::unique_lock lock(shard.mutex);
+            const auto it = shard.streams.find(stream_name);
+            if (it == shard.streams.end())continue;
+            const auto member = it->second.members.find(client_id);
+            if (member == it->second.members.end())continue;
+
+            if (member->second.last_active_time > cutoff)
+            {
+                refreshed = member->second.last_active_time;
+            }
+            else
+            {
+                result.expired.push_back(applyDeregister(shard, stream_name, client_id).value());
+                appendJournal(RecordWriter(Op::Deregister).str(stream_name).str(client_id).finish());
+            }
+        }
+
+        if (refreshed)armExpiry(stream_name, client_id, *refreshed);
+    }
+    result.pages = 1;
+    return result;
+}
+
+void InMemoryStreamStateManager::armExpiry(const std::string& stream_name, const std::string& client_id,
+                                           SystemClock::time_point last_active) const
+{
+    if (!_expiryWheel)return;
+    const auto remaining = last_active + _expiryTimeout - SystemClock::now();
+    _expiryWheel->schedule(expiryKey(stream_name, client_id),
+                           std::chrono::steady_clock::now() +
+                           std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining));
+}
+
+void InMemoryStreamStateManager::cancelExpiry(const std::string& stream_name, const std::string& client_id) const
+{
+    if (_expiryWheel)
+    {
+        (void)_expiryWheel->cancel(expiryKey(stream_name, client_id));
+    }
+}
+
+// 状态变更（调用方持有分片写锁）
+void InMemoryStreamStateManager::applyRegister(Shard& shard, const StreamTask& task)
+{
+    StreamEntry& entry = shard.streams[task.stream_name];
+    // 同 client 重连：先按旧类型撤销计数，语义与 Redis 注册脚本的 cleanup_old 一致
+    eraseMember(entry, task.client_id);
+
+    if (task.type == StreamType::PUBLISHER)
+    {
+        if (entry.publisher.empty())
+        {
+            _publishers.fetch_add(1, std::memory_order_relaxed);
+        }
+        entry.publisher = task.client_id;
+    }
+    else
+    {
+        _players.fetch_add(1, std::memory_order_relaxed);
+    }
+    entry.members.insert_or_assign(task.client_id, task);
+}
+
+bool InMemoryStreamStateManager::applyTouch(Shard& shard, const std::string& stream_name,
+                                            const std::string& client_id, int64_t last_ms) const
+{
+    const auto it = shard.streams.find(stream_name);
+    if (it == shard.streams.end())return false;
+    const auto member = it->second.members.find(client_id);
+    if (member == it->second.members.end())return false;
+
+    member->second.last_active_time = fromMs(last_ms);
+    return true;
+}
+
+std::optional<StreamTask> InMemoryStreamStateManager::applyDeregister(Shard& shard, const std::string& stream_name,
+                                                                      const std::string& client_id)
+{
+    const auto it = shard.streams.find(stream_name);
+    if (it == shard.streams.end())return std::nullopt;
+    const auto member = it->second.members.find(client_id);
+    if (member == it->second.members.end())return std::nullopt;
+
+    StreamTask removed = member->second;
+    eraseMember(it->second, client_id);
+    if (it->second.members.empty())
+    {
+        shard.streams.erase(it);
+    }
+    return removed;
+}
+
+size_t InMemoryStreamStateManager::applyDeregisterAll(Shard& shard, const std::string& stream_name)
+{
+    const auto it = shard.streams.find(stream_name);
+    if (it == shard.streams.end())return 0;
+
+    const size_t count = it->second.members.size();
+    const auto players = std::ranges::count_if(it->second.members, [](const auto& m)
+    {
+        return m.second.type == StreamType::PLAYER;
+    });
+    _players.fetch_sub(players, std::memory_order_relaxed);
+    if (!it->second.publisher.empty())
+    {
+        _publishers.fetch_sub(1, std::memory_order_relaxed);
+    }
+    shard.streams.erase(it);
+    return count;
+}
+
+void InMemoryStreamStateManager::eraseMember(StreamEntry& entry, const std::string& client_id)
+{
+    const auto it = entry.members.find(client_id);
+    if (it == entry.members.end())return;
+
+    if (it->second.type == StreamType::PLAYER)
+    {
+        _players.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (entry.publisher == client_id)
+    {
+        entry.publisher.clear();
+        _publishers.fetch_sub(1, std::memory_order_relaxed);
+    }
+    entry.members.erase(it);
+}
+
+// 持久化
+std::string InMemoryStreamStateManager::journalPath(uint64_t generation) const
+{
+    return (fs::path(_config.data_dir) / (std::string(kJournalPrefix) + std::to_string(generation))).string();
+}
+
+/**
+ * @brief 启动恢复：加载快照（记录其覆盖到的 journal 代数 G），再按代数升序重放 G 之后的 journal
+ * * 快照是模糊的（逐分片拷贝期间仍有写入），但其后的变更都在更新代数的 journal 中，
+ * * 且每条记录都是幂等的绝对状态，重放后每个任务的最终状态由它的最后一条记录决定。
+ */
+void InMemoryStreamStateManager::recover()
+{
+    const auto started = std::chrono::steady_clock::now();
+    std::error_code ec;
+    fs::create_directories(_config.data_dir, ec);
+    if (ec)
+    {
+        LOG_ERROR("InMemoryStreamStateManager: 无法创建数据目录 " + _config.data_dir + ": " + ec.message());
+    }
+
+    uint64_t covered = 0;
+    const auto snapshot_path = (fs::path(_config.data_dir) / kSnapshotFile).string();
+    if (fs::exists(snapshot_path, ec))
+    {
+        (void)replayFile(snapshot_path, true, &covered);
+    }
+
+    std::vector<uint64_t> generations;
+    for (const auto& file : fs::directory_iterator(_config.data_dir, ec))
+    {
+        const std::string name = file.path().filename().string();
+        if (!name.starts_with(kJournalPrefix))continue;
+
+        uint64_t gen = 0;
+        const char* first = name.data() + kJournalPrefix.size();
+        if (const auto [ptr, err] = std::from_chars(first, name.data() + name.size(), gen);
+            err == std::errc{} && ptr == name.data() + name.size())
+        {
+            generations.push_back(gen);
+        }
+    }
+    std::ranges::sort(generations);
+
+    uint64_t last_generation = covered;
+    for (const uint64_t gen : generations)
+    {
+        if (gen > covered)
+        {
+            (void)replayFile(journalPath(gen), false, nullptr);
+        }
+        last_generation = std::max(last_generation, gen);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_journalMutex);
+        openJournal(last_generation + 1);
+    }
+
+    for (size_t i = 0; i < _shardCount; ++i)
+    {
+        for (const auto& [name, entry] : _shards[i].streams)
+        {
+            _recoveredTasks += entry.members.size();
+        }
+    }
+    _recoveryMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count());
+
+    LOG_INFO("InMemoryStreamStateManager: 恢复 " + std::to_string(_recoveredTasks) + " 个任务, 耗时 " +
+        std::to_string(_recoveryMs) + "ms, journal 代数=" + std::to_string(last_generation + 1));
+}
+
+bool InMemoryStreamStateManager::replayFile(const std::string& path, bool is_snapshot, uint64_t* covered_generation)
+{
+    std::ifstream in(path, std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t pos = kMagic.size();
+    if (data.size() < pos || std::string_view(data).substr(0, pos) != kMagic)
+    {
+        LOG_WARN("InMemoryStreamStateManager: 忽略无法识别的文件 " + path);
+        return false;
+    }
+
+    if (is_snapshot)
+    {
+        uint64_t covered = 0;
+        if (data.size() < pos + sizeof(covered))return false;
+        std::memcpy(&covered, data.data() + pos, sizeof(covered));
+        pos += sizeof(covered);
+        if (covered_generation)*covered_generation = covered;
+    }
+
+    size_t records = 0;
+    while (pos < data.size())
+    {
+        uint32_t len = 0;
+        uint32_t sum = 0;
+        if (pos + 8 > data.size())break;
+        std::memcpy(&len, data.data() + pos, sizeof(len));
+        std::memcpy(&sum, data.data() + pos + 4, sizeof(sum));
+        if (pos + 8 + len > data.size())break;
+
+        const std::string_view payload(data.data() + pos + 8, len);
+        if (checksum(payload) != sum || !applyRecord(payload))
+        {
+            LOG_WARN("InMemoryStreamStateManager: " + path + " 在偏移 " + std::to_string(pos) + " 处记录损坏，停止重放");
+            return false;
+        }
+        pos += 8 + len;
+        ++records;
+    }
+
+    if (pos < data.size())
+    {
+        // 崩溃时写了一半的尾部记录
+        LOG_WARN("InMemoryStreamStateManager: " + path + " 尾部有 " + std::to_string(data.size() - pos) +
+            " 字节不完整记录，已忽略");
+    }
+    LOG_DEBUG("InMemoryStreamStateManager: 重放 " + path + ", 记录数=" + std::to_string(records));
+    return true;
+}
+
+bool InMemoryStreamStateManager::applyRecord(std::string_view payload)
+{
+    RecordReader reader(payload);
+    uint8_t op = 0;
+    if (!reader.u8(op))return false;
+
+    switch (static_cast<Op>(op))
+    {
+    case Op::Register:
+        {
+            StreamTask task;
+            if (!reader.task(task))return false;
+            applyRegister(shardFor(task.stream_name), task);
+            return true;
+        }
+    case Op::Touch:
+        {
+            std::string stream_name, client_id;
+            int64_t last_ms = 0;
+            if (!reader.str(stream_name) || !reader.str(client_id) || !reader.i64(last_ms))return false;
+            (void)applyTouch(shardFor(stream_name), stream_name, client_id, last_ms);
+            return true;
+        }
+    case Op::Deregister:
+        {
+            std::string stream_name, client_id;
+            if (!reader.str(stream_name) || !reader.str(client_id))return false;
+            (void)applyDeregister(shardFor(stream_name), stream_name, client_id);
+            return true;
+        }
+    case Op::DeregisterAll:
+        {
+            std::string stream_name;
+            if (!reader.str(stream_name))return false;
+            (void)applyDeregisterAll(shardFor(stream_name), stream_name);
+            return true;
+        }
+    }
+    return false;
+}
+
+void InMemoryStreamStateManager::appendJournal(const std::string& record) const
+{
+    if (_config.data_dir.empty())return;
+
+    std::lock_guard<std::mutex> lock(_journalMutex);
+    _journalBuffer += record;
+    if (_journalBuffer.size() >= kJournalBufferLimit)
+    {
+        (void)writeJournalLocked();
+    }
+}
+
+void InMemoryStreamStateManager::openJournal(uint64_t generation)
+{
+    if (_journalFd >= 0)
+    {
+        ::close(_journalFd);
+    }
+
+    const std::string path = journalPath(generation);
+    _journalFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    _journalGeneration = generation;
+    _journalBytes.store(0, std::memory_order_relaxed);
+    if (_journalFd < 0 || !writeAll(_journalFd, kMagic.data(), kMagic.size()))
+    {
+        _writeErrors.fetch_add(1, std::memory_order_relaxed);
+        LOG_ERROR("InMemoryStreamStateManager: 无法打开 journal " + path + ": " + std::strerror(errno));
+    }
+}
+
+bool InMemoryStreamStateManager::writeJournalLocked() const
+{
+    if (_journalBuffer.empty())return true;
+
+    bool ok = _journalFd >= 0 && writeAll(_journalFd, _journalBuffer.data(), _journalBuffer.size());
+    if (ok && _config.fsync)
+    {
+        ok = ::fdatasync(_journalFd) == 0;
+    }
+
+    if (ok)
+    {
+        _journalBytes.fetch_add(_journalBuffer.size(), std::memory_order_relaxed);
+    }
+    else
+    {
+        // 写失败的记录不重试：内存状态仍然正确，下一次快照会覆盖这段缺口
+        _writeErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+    _journalBuffer.clear();
+    return ok;
+}
+
+void InMemoryStreamStateManager::persistLoop(const std::stop_token& stoken)
+{
+    auto last_snapshot = std::chrono::steady_clock::now();
+    while (!stoken.stop_requested())
+    {
+        {
+            std::unique_lock lock(_wakeMutex);
+            _wakeCondition.wait_for(lock, stoken, _config.journal_flush_interval, [] { return false; });
+        }
+        if (stoken.stop_requested())break;
+
+        {
+            std::lock_guard<std::mutex> lock(_journalMutex);
+            (void)writeJournalLocked();
+        }
+
+        if (std::chrono::steady_clock::now() - last_snapshot >= _config.snapshot_interval ||
+            _journalBytes.load(std::memory_order_relaxed) >= _config.snapshot_journal_bytes)
+        {
+            (void)snapshot();
+            last_snapshot = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+/**
+ * @brief 快照：切换到新一代 journal -> 逐分片拷贝写入临时文件 -> fsync + rename -> 删除已覆盖的 journal
+ * * 写快照失败时保留旧快照与全部 journal，恢复结果不受影响。
+ */
+bool InMemoryStreamStateManager::snapshot()
+{
+    if (_config.data_dir.empty())return false;
+
+    std::lock_guard<std::mutex> snapshot_lock(_snapshotMutex);
+    uint64_t covered;
+    {
+        std::lock_guard<std::mutex> lock(_journalMutex);
+        (void)writeJournalLocked();
+        covered = _journalGeneration;
+        openJournal(covered + 1);
+    }
+
+    std::string data(kMagic);
+    data.append(reinterpret_cast<const char*>(&covered), sizeof(covered));
+    for (size_t i = 0; i < _shardCount; ++i)
+    {
+        std::shared_lock lock(_shards[i].mutex);
+        for (const auto& [name, entry] : _shards[i].streams)
+        {
+            for (const auto& [client_id, task] : entry.members)
+            {
+                data += RecordWriter(Op::Register).task(task).finish();
+            }
+        }
+    }
+
+    const auto final_path = (fs::path(_config.data_dir) / kSnapshotFile).string();
+    const std::string tmp_path = final_path + ".tmp";
+    const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    const bool ok = fd >= 0 && writeAll(fd, data.data(), data.size()) && ::fsync(fd) == 0;
+    if (fd >= 0)::close(fd);
+    if (!ok || ::rename(tmp_path.c_str(), final_path.c_str()) != 0)
+    {
+        _writeErrors.fetch_add(1, std::memory_order_relaxed);
+        LOG_ERROR("InMemoryStreamStateManager: 快照写入失败: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    std::error_code ec;
+    for (const auto& file : fs::directory_iterator(_config.data_dir, ec))
+    {
+        const std::string name = file.path().filename().string();
+        uint64_t gen = 0;
+        if (name.starts_with(kJournalPrefix) &&
+            std::from_chars(name.data() + kJournalPrefix.size(), name.data() + name.size(), gen).ec == std::errc{} &&
+            gen <= covered)
+        {
+            fs::remove(file.path(), ec);
+        }
+    }
+
+    _snapshots.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+InMemoryStreamStateManager::PersistenceStats InMemoryStreamStateManager::persistenceStats() const
+{
+    PersistenceStats s{};
+    s.recovered_tasks = _recoveredTasks;
+    s.recovery_ms = _recoveryMs;
+    s.journal_bytes = _journalBytes.load(std::memory_order_relaxed);
+    s.snapshots = _snapshots.load(std::memory_order_relaxed);
+    s.write_errors = _writeErrors.load(std::memory_order_relaxed);
+    return s;
+}
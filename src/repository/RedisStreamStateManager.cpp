@@ -3,15 +3,20 @@
 //
 #include "RedisStreamStateManager.h"
 #include "StreamTask.h"
+#include "StreamTaskSerializer.h"
 #include "Logger.h"
 #include <cassert>
 #include <chrono>
 #include <string_view>
 #include <unordered_map>
+#include <algorithm>
 #include <array>
+#include <charconv>
+#include <condition_variable>
+#include <mutex>
 #include <optional>
 
-// 时间戳合理性范围（2020-01-01 至 2038-01-01 UTC）
+// 时间戳合理性范围（2020-01-01 至 2038-01-01 UTC），与 StreamTaskSerializer 一致
 static constexpr int64_t MIN_REASONABLE_MS = 1577836800000LL; // 2020-01-01 00:00:00 UTC
 static constexpr int64_t MAX_REASONABLE_MS = 2145916800000LL; // 2038-01-01 00:00:00 UTC
 
@@ -33,142 +38,267 @@ namespace
     }
 }
 
-// 序列化 / 反序列化
-static std::unordered_map<std::string, std::string> serializeTask(const StreamTask& task)
-{
-    auto to_ms_str = [](const std::chrono::system_clock::time_point tp)
-    {
-        return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count());
-    };
+/**
+ * registerTask 原子注册脚本
+ * KEYS: [1] task:<stream>:<client>  [2] pub:<stream>  [3] stream:members:<stream>
+ *       [4] active_pubs  [5] global_players:<shard>  [6] task_timestamps
+ * ARGV: [1] type (publisher/player)  [2] client_id  [3] stream_name  [4] ttl_sec  [5] now_ms
+ *       [6..] 任务 hash 的 field/value 对
+ * 返回: 1 注册成功；0 推流位已被其它 client 占用（未做任何写入）
+ */
+static constexpr auto REGISTER_TASK_LUA = R"lua(
+local task_key, pub_key, members_key = KEYS[1], KEYS[2], KEYS[3]
+local active_key, global_key, ts_key = KEYS[4], KEYS[5], KEYS[6]
+local kind, client, stream = ARGV[1], ARGV[2], ARGV[3]
+
+-- 清理同 client 的旧状态（重连幂等），语义与 deregisterTask 一致
+local function cleanup_old()
+    local old_type = redis.call('HGET', task_key, 'type')
+    if not old_type then
+        redis.call('ZREM', ts_key, task_key)
+        return
+    end
+    redis.call('DEL', task_key)
+    redis.call('SREM', members_key, client)
+    if old_type == 'publisher' then
+        redis.call('DEL', pub_key)
+        redis.call('SREM', active_key, stream)
+    elseif old_type == 'player' then
+        redis.call('HINCRBY', global_key, 'total', -1)
+    end
+end
+
+if kind == 'publisher' then
+    local holder = redis.call('HMGET', pub_key, 'active', 'client_id')
+    if holder[1] == '1' then
+        if holder[2] and holder[2] ~= client then
+            return 0
+        end
+        cleanup_old()
+    end
+elseif redis.call('EXISTS', task_key) == 1 then
+    cleanup_old()
+end
+
+local fields = {}
+for i = 6, #ARGV do
+    fields[#fields + 1] = ARGV[i]
+end
+
+redis.call('HSET', task_key, unpack(fields))
+redis.call('EXPIRE', task_key, tonumber(ARGV[4]))
+
+if kind == 'publisher' then
+    redis.call('HSET', pub_key, unpack(fields))
+    redis.call('SADD', members_key, client)
+    redis.call('SADD', active_key, stream)
+elseif redis.call('SADD', members_key, client) == 1 then
+    redis.call('HINCRBY', global_key, 'total', 1)
+end
+
+redis.call('ZADD', ts_key, ARGV[5], task_key)
+return 1
+)lua";
 
-    return {
-        {"stream_name", task.stream_name},
-        {"client_id", task.client_id},
-        {"active", "1"},
-        {"type", toString(task.type)},
-        {"state", toString(task.state)},
-        {"protocol", toString(task.protocol)},
-        {"server_ip", task.server_ip},
-        {"server_port", std::to_string(task.server_port)},
-        {"start_time_ms", to_ms_str(task.start_time)},
-        {"last_active_time_ms", to_ms_str(task.last_active_time)},
-        {"user_id", task.user_id},
-        {"auth_token", task.auth_token},
-        {"region", task.region.value_or("")},
-        {"need_transcode", task.need_transcode ? "1" : "0"},
-        {"need_record", task.need_record ? "1" : "0"},
-        {"transcoding_profile", task.transcoding_profile}
-    };
-}
+/**
+ * 超时扫描单页提交脚本（每页 1 次往返）
+ * KEYS: [1] task_timestamps  [2] active_pubs  [3..] 待过期的 (task key, global_players:<shard>) 对
+ * ARGV: [1] cutoff_ms  [2..] 预检查发现已刷新的 (task_key, last_active_ms) 对，用 ZADD XX 修正分数
+ * 返回: 每个实际过期的任务 4 个元素 type, stream_name, client_id, last_active_ms
+ * * ZREM 成功者获得该任务的清理权（多实例并发扫描互斥）；脚本内再次比较 last_active_time_ms，
+ * * 覆盖预检查之后到达的心跳。pub:/stream:members: 键由 task key 推导，与其它全局键一样假定非 Cluster 部署。
+ * * hash 已按 TTL 删除（过期通知丢失或未启用）时由 key 解析流名，按推流位持有者推断类型，与过期通知脚本一致。
+ */
+static constexpr auto TIMEOUT_COMMIT_LUA = R"lua(
+local ts_key, active_key = KEYS[1], KEYS[2]
+local cutoff = tonumber(ARGV[1])
+local out = {}
+
+for i = 3, #KEYS, 2 do
+    local task_key, global_key = KEYS[i], KEYS[i + 1]
+    if redis.call('ZREM', ts_key, task_key) == 1 then
+        local f = redis.call('HMGET', task_key, 'last_active_time_ms', 'type', 'stream_name', 'client_id')
+        local last = tonumber(f[1])
+        if last and last > cutoff then
+            redis.call('ZADD', ts_key, last, task_key)
+        elseif f[2] then
+            -- 紧凑格式不保存 stream_name / client_id 明文，由 key 解析；旧格式 hash 仍直接读取
+            local kind, stream, client = f[2], f[3], f[4]
+            if not (stream and client) then
+                stream, client = string.match(task_key, '^task:(.+):([^:]+)$')
+            end
+            redis.call('DEL', task_key)
+            redis.call('SREM', 'stream:members:' .. stream, client)
+            if kind == 'publisher' then
+                -- 推流位可能已被同名流的新推流端占用，只释放自己持有的
+                local pub_key = 'pub:' .. stream
+                if redis.call('HGET', pub_key, 'client_id') == client then
+                    redis.call('DEL', pub_key)
+                    redis.call('SREM', active_key, stream)
+                end
+            elseif kind == 'player' then
+                redis.call('HINCRBY', global_key, 'total', -1)
+            end
+            out[#out + 1] = kind
+            out[#out + 1] = stream
+            out[#out + 1] = client
+            out[#out + 1] = f[1] or '0'
+        elseif redis.call('EXISTS', task_key) == 0 then
+            local stream, client = string.match(task_key, '^task:(.+):([^:]+)$')
+            if stream then
+                local members_key, pub_key = 'stream:members:' .. stream, 'pub:' .. stream
+                local kind
+                if redis.call('HGET', pub_key, 'client_id') == client then
+                    redis.call('DEL', pub_key)
+                    redis.call('SREM', active_key, stream)
+                    redis.call('SREM', members_key, client)
+                    kind = 'publisher'
+                elseif redis.call('SREM', members_key, client) == 1 then
+                    redis.call('HINCRBY', global_key, 'total', -1)
+                    kind = 'player'
+                end
+                if kind then
+                    out[#out + 1] = kind
+                    out[#out + 1] = stream
+                    out[#out + 1] = client
+                    out[#out + 1] = '0'
+                end
+            end
+        end
+    end
+end
+
+for i = 2, #ARGV, 2 do
+    redis.call('ZADD', ts_key, 'XX', ARGV[i + 1], ARGV[i])
+end
+return out
+)lua";
 
-template <typename MapType>
-static std::optional<StreamTask> deserializeTask(const MapType& fields)
+/**
+ * 过期通知清理脚本（1 次往返）
+ * KEYS: [1] task:<stream>:<client>  [2] pub:<stream>  [3] stream:members:<stream>
+ *       [4] active_pubs  [5] global_players:<shard>  [6] task_timestamps
+ * ARGV: [1] stream_name  [2] client_id
+ * 返回: 2 推流端已清理；1 播放端已清理；0 任务已重新注册 / 已被其它实例或超时扫描清理
+ * * 任务 hash 已不存在，推流位仍由该 client 持有即为推流端，否则按播放端从成员集合移除
+ */
+static constexpr auto EXPIRED_TASK_LUA = R"lua(
+local task_key, pub_key, members_key = KEYS[1], KEYS[2], KEYS[3]
+local active_key, global_key, ts_key = KEYS[4], KEYS[5], KEYS[6]
+local stream, client = ARGV[1], ARGV[2]
+
+if redis.call('EXISTS', task_key) == 1 then
+    return 0
+end
+if redis.call('ZREM', ts_key, task_key) == 0 then
+    return 0
+end
+
+if redis.call('HGET', pub_key, 'client_id') == client then
+    redis.call('DEL', pub_key)
+    redis.call('SREM', active_key, stream)
+    redis.call('SREM', members_key, client)
+    return 2
+end
+if redis.call('SREM', members_key, client) == 1 then
+    redis.call('HINCRBY', global_key, 'total', -1)
+    return 1
+end
+return 0
+)lua";
+
+// 序列化：任务整体编码为单个 "d" 字段（StreamTaskSerializer::encodeCompact）；
+// Lua 脚本与 touch 需要直接读写的字段保留为独立的明文字段
+static std::vector<std::pair<std::string, std::string>> serializeTask(const StreamTask& task)
 {
-    for (constexpr std::array required{"stream_name", "client_id", "type", "start_time_ms", "last_active_time_ms"};
-         const auto& key : required)
-    {
-        if (!fields.contains(key))
-        {
-            return std::nullopt;
-        }
-    }
-
-    StreamTask task;
-    task.stream_name = fields.at("stream_name");
-    task.client_id = fields.at("client_id");
+    const auto last_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        task.last_active_time.time_since_epoch()).count();
 
-    const auto& type_str = fields.at("type");
-    if (type_str != "publisher" && type_str != "player")
+    std::vector<std::pair<std::string, std::string>> fields{
+        {"type", toString(task.type)},
+        {"last_active_time_ms", std::to_string(last_ms)},
+        {"d", StreamTaskSerializer::encodeCompact(task)}
+    };
+    // 推流位 pub:<stream> 与任务 hash 写入同一组字段：注册 / 过期脚本按 client_id 判断持有者，负载表读取节点地址
+    if (task.type == StreamType::PUBLISHER)
     {
-        return std::nullopt;
+        fields.emplace_back("active", "1");
+        fields.emplace_back("client_id", task.client_id);
+        fields.emplace_back("server_ip", task.server_ip);
+        fields.emplace_back("server_port", std::to_string(task.server_port));
     }
-    task.type = parseType(type_str);
+    return fields;
+}
 
-    if (auto it = fields.find("state"); it != fields.end())
-    {
-        task.state = parseState(it->second);
-    }
-    else
+// 构造函数
+RedisStreamStateManager::RedisStreamStateManager(CacheManager& cacheMgr)
+    : _cacheManager(cacheMgr),
+      _registerScript(REGISTER_TASK_LUA),
+      _timeoutCommitScript(TIMEOUT_COMMIT_LUA),
+      _expiredTaskScript(EXPIRED_TASK_LUA)
+{
+    // 预加载失败不致命：evalScriptInt / evalScriptList 会直接走 EVAL
+    if (!_cacheManager.loadScript(_registerScript))
     {
-        task.state = StreamState::INITIALIZING;
+        LOG_WARN("RedisStreamStateManager: registerTask script preload failed, will fall back to EVAL");
     }
-
-    if (auto it = fields.find("protocol"); it != fields.end())
+    if (!_cacheManager.loadScript(_timeoutCommitScript))
     {
-        task.protocol = parseProtocol(it->second);
+        LOG_WARN("RedisStreamStateManager: timeout commit script preload failed, will fall back to EVAL");
     }
-    else
+    if (!_cacheManager.loadScript(_expiredTaskScript))
     {
-        task.protocol = StreamProtocol::Unknown;
+        LOG_WARN("RedisStreamStateManager: expired task script preload failed, will fall back to EVAL");
     }
+}
 
-    if (auto it = fields.find("server_ip"); it != fields.end())
+RedisStreamStateManager::~RedisStreamStateManager()
+{
+    if (_countRefresher.joinable())
     {
-        task.server_ip = it->second;
+        _countRefresher.request_stop();
+        _countRefresher.join();
     }
+}
 
-    task.server_port = 0;
-
-    if (auto it = fields.find("server_port"); it != fields.end())
-    {
-        try
-        {
-            task.server_port = std::stoi(it->second);
-        }
-        catch (...)
-        {
-        }
-    }
+void RedisStreamStateManager::enablePlayerCountCache(std::chrono::milliseconds refresh_interval)
+{
+    if (_countRefresher.joinable())return;
 
+    // 先同步加载一次，启动后的第一次读取就是本地快照
     try
     {
-        const int64_t start_ms = std::stoll(fields.at("start_time_ms"));
-        const int64_t last_ms = std::stoll(fields.at("last_active_time_ms"));
-
-        if (start_ms < MIN_REASONABLE_MS || start_ms > MAX_REASONABLE_MS ||
-            last_ms < MIN_REASONABLE_MS || last_ms > MAX_REASONABLE_MS)
-        {
-            return std::nullopt;
-        }
-
-        task.start_time = std::chrono::system_clock::time_point(std::chrono::milliseconds{start_ms});
-        task.last_active_time = std::chrono::system_clock::time_point(std::chrono::milliseconds{last_ms});
-    }
-    catch (...)
-    {
-        return std::nullopt;
-    }
-
-    if (auto it = fields.find("user_id"); it != fields.end())
-    {
-        task.user_id = it->second;
-    }
-
-    if (auto it = fields.find("auth_token"); it != fields.end())
-    {
-        task.auth_token = it->second;
+        _playerCounts.store(loadPlayerCounts(true), std::memory_order_release);
     }
-
-    if (auto it = fields.find("region"); it != fields.end() && !it->second.empty())
+    catch (const std::exception& err)
     {
-        task.region = it->second;
+        LOG_WARN("RedisStreamStateManager: initial player count load failed: " + std::string(err.what()));
+        _playerCounts.store(std::make_shared<const PlayerCounts>(), std::memory_order_release);
     }
 
-    task.need_transcode = (fields.contains("need_transcode") && fields.at("need_transcode") == "1");
-    task.need_record = (fields.contains("need_record") && fields.at("need_record") == "1");
-
-    if (auto it = fields.find("transcoding_profile"); it != fields.end())
+    _countRefresher = std::jthread([this, refresh_interval](const std::stop_token& stoken)
     {
-        task.transcoding_profile = it->second;
-    }
-
-    return task;
-}
+        std::mutex mutex;
+        std::condition_variable_any cv;
+        while (!stoken.stop_requested())
+        {
+            {
+                std::unique_lock lock(mutex);
+                cv.wait_for(lock, stoken, refresh_interval, [] { return false; });
+            }
+            if (stoken.stop_requested())break;
 
-// 构造函数
-RedisStreamStateManager::RedisStreamStateManager(CacheManager& cacheMgr)
-    : _cacheManager(cacheMgr)
-{
+            try
+            {
+                _playerCounts.store(loadPlayerCounts(true), std::memory_order_release);
+            }
+            catch (const std::exception& err)
+            {
+                // 保留上一份快照
+                LOG_WARN("RedisStreamStateManager: player count refresh failed: " + std::string(err.what()));
+            }
+        }
+    });
 }
 
 /**
@@ -176,7 +306,7 @@ RedisStreamStateManager::RedisStreamStateManager(CacheManager& cacheMgr)
  */
 std::vector<std::string> RedisStreamStateManager::getStreamClientIds(const std::string& stream_name) const
 {
-    const std::string member_key = "stream:members:" + stream_name;
+    const std::string member_key = buildStreamMembersKey(stream_name);
 
     try
     {
@@ -197,97 +327,130 @@ bool RedisStreamStateManager::registerTask(const StreamTask& task)
 
     const std::string task_key = buildTaskKey(task.stream_name, task.client_id);
 
-    if (task.type == StreamType::PUBLISHER)
+    const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    if (now_ms < MIN_REASONABLE_MS || now_ms > MAX_REASONABLE_MS)
     {
-        auto existing_pub = getPublisherTask(task.stream_name);
-        if (existing_pub && existing_pub->client_id != task.client_id)
+        LOG_ERROR("registerTask: Invalid timestamp: " + std::to_string(now_ms));
+        return false;
+    }
+
+    std::vector<std::string> keys;
+    std::vector<std::string> args;
+    buildRegisterCall(task, now_ms, keys, args);
+
+    try
+    {
+        if (_cacheManager.evalScriptInt(_registerScript, keys, args) != 1)
         {
             LOG_WARN("registerTask: Stream " + task.stream_name +
-                " already has a different publisher: " + existing_pub->client_id);
+                " already has a different publisher, rejected client: " + task.client_id);
             return false;
         }
-
-        if (existing_pub && existing_pub->client_id == task.client_id)
-        {
-            LOG_INFO("registerTask: Cleaning old state for reconnecting publisher: " + task.client_id);
-            deregisterTask(task.stream_name, task.client_id);
-        }
     }
-    else
+    catch (const std::exception& err)
     {
-        if (_cacheManager.keyExists(task_key))
-        {
-            LOG_INFO("registerTask: Cleaning old player state: " + task.client_id);
-            deregisterTask(task.stream_name, task.client_id);
-        }
+        // 脚本在服务端原子执行：失败即未产生任何写入，无需手工回滚
+        LOG_ERROR("registerTask: script failed for task_key=" + task_key + " error=" + err.what());
+        return false;
     }
 
-    // // 幂等：先清理旧状态（关键修复：允许同 client_id 重连）
-    // if (_cacheManager.keyExists(task_key))
-    // {
-    //     deregisterTask(task.stream_name, task.client_id);
-    // }
+    armExpiry(task_key);
 
-    if (!_cacheManager.hashSet(task_key, serializeTask(task)))
-    {
-        LOG_ERROR("registerTask: hashSet failed for task_key=" + task_key);
-        return false;
-    }
+    LOG_INFO("registerTask: Successfully registered - stream=" + task.stream_name +
+        ", client=" + task.client_id + ", type=" + toString(task.type));
 
-    if (!_cacheManager.keyExpire(task_key, TASK_TTL_SEC))
-    {
-        LOG_ERROR("registerTask: keyExpire failed, rolling back");
-        bestEffort(_cacheManager.keyDel(task_key), "keyDel", task_key);
-        return false;
-    }
+    return true;
+}
 
-    bool index_ok = false;
-    if (task.type == StreamType::PUBLISHER)
-    {
-        index_ok = registerPublisherIndices(task);
-    }
-    else
-    {
-        index_ok = registerPlayerIndices(task);
-    }
+void RedisStreamStateManager::buildRegisterCall(const StreamTask& task, int64_t now_ms,
+                                                std::vector<std::string>& keys, std::vector<std::string>& args)
+{
+    keys = {
+        buildTaskKey(task.stream_name, task.client_id),
+        buildPublisherKey(task.stream_name),
+        buildStreamMembersKey(task.stream_name),
+        buildActivePublishersKey(),
+        buildPlayerCountShardKey(task.client_id),
+        buildTaskTimestampZSetKey()
+    };
+
+    const auto fields = serializeTask(task);
 
-    if (!index_ok)
+    args.clear();
+    args.reserve(5 + fields.size() * 2);
+    args.push_back(toString(task.type));
+    args.push_back(task.client_id);
+    args.push_back(task.stream_name);
+    args.push_back(std::to_string(TASK_TTL_SEC));
+    args.push_back(std::to_string(now_ms));
+    for (const auto& [field,value] : fields)
     {
-        LOG_ERROR("registerTask: index registration failed, rolling back");
-        deregisterTask(task.stream_name, task.client_id); //回滚
-        return false;
+        args.push_back(field);
+        args.push_back(value);
     }
+}
+
+size_t RedisStreamStateManager::registerTasksBatch(const std::vector<StreamTask>& tasks, std::vector<bool>* results)
+{
+    if (results)results->assign(tasks.size(), false);
+    if (tasks.empty())return 0;
 
-    //保证 ZSet 写入失败也回滚
     const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()).count();
 
-    LOG_INFO("DEBUG: now_ms value = " + std::to_string(now_ms));
-    LOG_INFO("DEBUG: now_ms as double = " + std::to_string(static_cast<double>(now_ms)));
-    LOG_INFO("DEBUG: task_key = " + task_key);
-    LOG_INFO("DEBUG: MIN_REASONABLE_MS = " + std::to_string(MIN_REASONABLE_MS));
-    LOG_INFO("DEBUG: MAX_REASONABLE_MS = " + std::to_string(MAX_REASONABLE_MS));
-
     if (now_ms < MIN_REASONABLE_MS || now_ms > MAX_REASONABLE_MS)
     {
-        LOG_ERROR("registerTask: Invalid timestamp: " + std::to_string(now_ms));
-        deregisterTask(task.stream_name, task.client_id);
-        return false;
+        LOG_ERROR("registerTasksBatch: Invalid timestamp: " + std::to_string(now_ms));
+        return 0;
     }
 
-    LOG_INFO("DEBUG: About to call zsetAdd...");
+    // Pipeline 只保存迭代器区间，参数须在 exec 之前一直有效
+    std::vector<std::vector<std::string>> keys(tasks.size());
+    std::vector<std::vector<std::string>> args(tasks.size());
+    size_t registered = 0;
 
-    if (!_cacheManager.zsetAdd(buildTaskTimestampZSetKey(), static_cast<double>(now_ms), task_key))
+    try
     {
-        LOG_ERROR("registerTask: zsetAdd failed, rolling back");
-        deregisterTask(task.stream_name, task.client_id);
-        return false;
-    }
+        auto pipe = _cacheManager.createPipeline();
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            buildRegisterCall(tasks[i], now_ms, keys[i], args[i]);
+            if (_registerScript.sha().empty())
+            {
+                pipe.eval(_registerScript.source(), keys[i].begin(), keys[i].end(), args[i].begin(), args[i].end());
+            }
+            else
+            {
+                pipe.evalsha(_registerScript.sha(), keys[i].begin(), keys[i].end(), args[i].begin(), args[i].end());
+            }
+        }
 
-    LOG_INFO("registerTask: Successfully registered - stream=" + task.stream_name +
-        ", client=" + task.client_id + ", type=" + toString(task.type));
+        auto replies = pipe.exec();
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            if (replies.get<long long>(i) == 1)
+            {
+                armExpiry(keys[i][0]);
+                ++registered;
+                if (results)(*results)[i] = true;
+            }
+            else
+            {
+                LOG_WARN("registerTasksBatch: Stream " + tasks[i].stream_name +
+                    " already has a different publisher, rejected client: " + tasks[i].client_id);
+            }
+        }
+    }
+    catch (const sw::redis::Error& err)
+    {
+        LOG_WARN("registerTasksBatch: pipeline failed (" + std::string(err.what()) +
+            "), falling back to per-task registration");
+        registered = IStreamStateManager::registerTasksBatch(tasks, results);
+    }
 
-    return true;
+    return registered;
 }
 
 bool RedisStreamStateManager::deregisterTask(const std::string& stream_name, const std::string& client_id)
@@ -297,6 +460,7 @@ bool RedisStreamStateManager::deregisterTask(const std::string& stream_name, con
     {
         const std::string task_key = buildTaskKey(stream_name, client_id);
         (void)_cacheManager.zsetRem(buildTaskTimestampZSetKey(), task_key);
+        if (_expiryWheel)_expiryWheel->cancel(task_key);
         return true;
     }
 
@@ -311,29 +475,42 @@ bool RedisStreamStateManager::deregisterTask(const std::string& stream_name, con
 std::optional<StreamTask> RedisStreamStateManager::getTask(const std::string& stream_name,
                                                            const std::string& client_id) const
 {
-    return getTaskByKey(buildTaskKey(stream_name, client_id));
+    return loadTask(buildTaskKey(stream_name, client_id), stream_name, client_id);
 }
 
 std::optional<StreamTask> RedisStreamStateManager::getPublisherTask(const std::string& stream_name) const
 {
-    const std::string pub_key = buildPublisherKey(stream_name);
+    return loadTask(buildPublisherKey(stream_name), stream_name, {});
+}
+
+std::optional<PublisherLocation> RedisStreamStateManager::getPublisherLocation(const std::string& stream_name) const
+{
+    // 推流位的明文字段在新旧两种记录格式中都存在
+    static const std::vector<std::string> kFields{"active", "client_id", "server_ip", "server_port"};
 
-    const auto fields = _cacheManager.hashGetAll(pub_key);
-    if (fields.empty() || !fields.contains("active") || fields.at("active") != "1")
+    const auto values = _cacheManager.hashMGet(buildPublisherKey(stream_name), kFields);
+    if (!values[0] || *values[0] != "1" || !values[1] || !values[2] || !values[3])
     {
         return std::nullopt;
     }
 
-    return deserializeTask(fields);
+    PublisherLocation location{*values[1], *values[2], 0};
+    const auto& port_str = *values[3];
+    if (std::from_chars(port_str.data(), port_str.data() + port_str.size(), location.port).ec != std::errc{})
+    {
+        return std::nullopt;
+    }
+    return location;
 }
 
 std::vector<StreamTask> RedisStreamStateManager::getPlayerTasks(const std::string& stream_name) const
 {
     std::vector<StreamTask> tasks;
-    const std::string player_set_key = buildPlayerSetKey(stream_name);
-    for (const auto client_ids = _cacheManager.setMembers(player_set_key); const auto& id : client_ids)
+    const std::string member_key = buildStreamMembersKey(stream_name);
+    for (const auto client_ids = _cacheManager.setMembers(member_key); const auto& id : client_ids)
     {
-        if (auto task = getTask(stream_name, id))
+        // 成员集合包含推流端自身
+        if (auto task = getTask(stream_name, id); task && task->type == StreamType::PLAYER)
         {
             tasks.push_back(*task);
         }
@@ -382,6 +559,7 @@ bool RedisStreamStateManager::touchTask(const std::string& stream_name, const st
             return false;
         }
 
+        armExpiry(task_key);
         return true;
     }
     catch (const sw::redis::Error& err)
@@ -391,142 +569,431 @@ bool RedisStreamStateManager::touchTask(const std::string& stream_name, const st
     }
 }
 
-//分布式超时扫描（实现 Double-Check 乐观锁，防止误杀）
-std::vector<StreamTask> RedisStreamStateManager::scanTimeoutTasks(std::chrono::milliseconds timeout)
+size_t RedisStreamStateManager::touchTasksBatch(const std::vector<TaskIdentifier>& tasks,
+                                                std::vector<bool>* results) const
 {
-    const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
-    const auto cutoff = static_cast<double>(now_ms - timeout.count());
+    if (results)results->assign(tasks.size(), false);
+    if (tasks.empty())return 0;
 
     const std::string zset_key = buildTaskTimestampZSetKey();
-    const auto candidate_keys = _cacheManager.zsetRangeByScore(zset_key, 0, cutoff);
+    const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const std::string now_str = std::to_string(now_ms);
 
-    std::vector<StreamTask> expired_tasks;
+    std::vector<std::string> task_keys;
+    task_keys.reserve(tasks.size());
+    for (const auto& task : tasks)
+    {
+        task_keys.push_back(buildTaskKey(task.streamName, task.clientId));
+    }
 
-    for (const auto& task_key : candidate_keys)
+    try
     {
-        if (!_cacheManager.zsetRem(zset_key, task_key))
+        auto pipe = _cacheManager.createPipeline();
+        for (const auto& task_key : task_keys)
         {
-            continue;
+            pipe.hset(task_key, "last_active_time_ms", now_str)
+                .expire(task_key, std::chrono::seconds(TASK_TTL_SEC))
+                .zadd(zset_key, task_key, static_cast<double>(now_ms));
         }
+        auto replies = pipe.exec();
 
-        auto task_opt = getTaskByKey(task_key);
-        if (!task_opt)
+        // HSET 新建了字段说明 hash 原本不存在：任务已过期或已注销，这次写入只留下残留
+        std::vector<std::string> orphans;
+        size_t touched = 0;
+        for (size_t i = 0; i < task_keys.size(); ++i)
         {
-            continue;
+            if (replies.get<long long>(i * 3) == 0)
+            {
+                armExpiry(task_keys[i]);
+                ++touched;
+                if (results)(*results)[i] = true;
+            }
+            else
+            {
+                orphans.push_back(task_keys[i]);
+            }
         }
 
-        const auto last_active_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            task_opt->last_active_time.time_since_epoch()
-        ).count();
+        if (!orphans.empty())
+        {
+            auto cleanup = _cacheManager.createPipeline();
+            for (const auto& key : orphans)
+            {
+                cleanup.del(key).zrem(zset_key, key);
+            }
+            cleanup.exec();
+        }
+        return touched;
+    }
+    catch (const sw::redis::Error& err)
+    {
+        LOG_ERROR("touchTasksBatch pipeline failed: " + std::string(err.what()));
+        return 0;
+    }
+}
 
-        if (now_ms - last_active_ms < timeout.count())
+/**
+ * @brief 提交一批超时候选：Pipeline HGET last_active_time_ms 预检查 + 单个 Lua 脚本（共 2 次往返）
+ * @param refreshed 非空时输出预检查发现仍活跃的 (task_key, last_active_ms)
+ * @throws std::exception Redis 故障；未提交的候选仍留在 ZSet 中
+ */
+void RedisStreamStateManager::commitTimeoutCandidates(const std::vector<std::string>& candidates, int64_t cutoff_ms,
+                                                      std::vector<StreamTask>& expired,
+                                                      std::vector<std::pair<std::string, int64_t>>* refreshed) const
+{
+    std::vector<std::string> keys = {buildTaskTimestampZSetKey(), buildActivePublishersKey()};
+    std::vector<std::string> args = {std::to_string(cutoff_ms)};
+
+    // 预检查只读 last_active_time_ms：心跳只更新 hash 时 ZSet 分数可能滞后，这类任务只修正分数
+    auto pipe = _cacheManager.createPipeline();
+    for (const auto& task_key : candidates)
+    {
+        pipe.hget(task_key, "last_active_time_ms");
+    }
+    auto replies = pipe.exec();
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        const auto last = replies.get<sw::redis::OptionalString>(i);
+        int64_t last_ms = 0;
+        if (last && std::from_chars(last->data(), last->data() + last->size(), last_ms).ec == std::errc{} &&
+            last_ms > cutoff_ms)
         {
-            bestEffort(_cacheManager.zsetAdd(zset_key, static_cast<double>(last_active_ms), task_key), "zsetRollback",
-                       task_key);
+            args.push_back(candidates[i]);
+            args.push_back(*last);
+            if (refreshed)refreshed->emplace_back(candidates[i], last_ms);
             continue;
         }
+        // hash 已过期或字段损坏也交给脚本：ZREM 并清理过期任务遗留的推流位 / 成员索引
+        // 计数分片由 key 中的 client_id 决定（task:<stream>:<client>，与注册时一致）
+        keys.push_back(candidates[i]);
+        keys.push_back(buildPlayerCountShardKey(candidates[i].substr(candidates[i].rfind(':') + 1)));
+    }
 
-        // 确认真正过期
-        deregisterTask(task_opt->stream_name, task_opt->client_id);
-        expired_tasks.push_back(std::move(*task_opt));
+    const auto committed = _cacheManager.evalScriptList(_timeoutCommitScript, keys, args);
+    for (size_t i = 0; i + 3 < committed.size(); i += 4)
+    {
+        StreamTask task;
+        task.type = parseType(committed[i]);
+        task.stream_name = committed[i + 1];
+        task.client_id = committed[i + 2];
+        int64_t last_ms = 0;
+        (void)std::from_chars(committed[i + 3].data(), committed[i + 3].data() + committed[i + 3].size(), last_ms);
+        task.last_active_time = std::chrono::system_clock::time_point(std::chrono::milliseconds{last_ms});
+        expired.push_back(std::move(task));
     }
-    return expired_tasks;
-}
 
-// 统计信息
-size_t RedisStreamStateManager::getActivePublisherCount() const
-{
-    return _cacheManager.setCard(buildActivePublishersKey());
+    if (_expiryWheel)
+    {
+        // 其它实例回收的任务也要从本地时间轮摘除
+        for (size_t i = 2; i < keys.size(); i += 2)
+        {
+            _expiryWheel->cancel(keys[i]);
+        }
+    }
 }
 
-size_t RedisStreamStateManager::getActivePlayerCount() const
+//分布式超时扫描（实现 Double-Check 乐观锁，防止误杀）
+TimeoutScanResult RedisStreamStateManager::scanTimeoutTasks(std::chrono::milliseconds timeout,
+                                                            const TimeoutScanOptions& options)
 {
-    auto fields = _cacheManager.hashGetAll(buildGlobalPlayerCountKey());
-    if (auto it = fields.find("total"); it != fields.end())
+    const auto started = std::chrono::steady_clock::now();
+    const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    const int64_t cutoff_ms = now_ms - timeout.count();
+    const auto cutoff = static_cast<double>(cutoff_ms);
+    const auto page_size = static_cast<long long>(std::max<size_t>(options.page_size, 1));
+    const std::string zset_key = buildTaskTimestampZSetKey();
+
+    TimeoutScanResult result;
+
+    while (true)
     {
+        // 每页处理完的成员要么被移出 ZSet，要么分数被修正到 cutoff 之后，因此始终从 offset 0 取下一页
+        std::vector<std::string> candidates;
         try
         {
-            auto val = std::stoull(it->second);
-            return static_cast<size_t>(val);
+            candidates = _cacheManager.zsetRangeByScore(zset_key, 0, cutoff, 0, page_size);
+            if (candidates.empty())break;
+
+            commitTimeoutCandidates(candidates, cutoff_ms, result.expired, nullptr);
         }
-        catch (...)
+        catch (const std::exception& err)
         {
+            // 本页未提交的候选仍留在 ZSet 中，下一轮重试
+            LOG_ERROR("scanTimeoutTasks: page failed: " + std::string(err.what()));
+            break;
         }
-    }
 
-    return 0;
+        ++result.pages;
+        if (candidates.size() < static_cast<size_t>(page_size))break;
+
+        if (std::chrono::steady_clock::now() - started >= options.time_budget)
+        {
+            result.backlog = _cacheManager.zsetCount(zset_key, 0, cutoff);
+            if (result.backlog > 0)
+            {
+                LOG_WARN("scanTimeoutTasks: time budget exhausted after " + std::to_string(result.pages) +
+                    " pages, backlog=" + std::to_string(result.backlog));
+            }
+            break;
+        }
+    }
+    return result;
 }
 
-size_t RedisStreamStateManager::getPlayerCount(const std::string& stream_name) const
+void RedisStreamStateManager::enableLocalExpiry(std::chrono::milliseconds timeout, std::chrono::milliseconds tick)
 {
-    return _cacheManager.setCard(buildPlayerSetKey(stream_name));
+    TimingWheel::Config cfg;
+    cfg.tick = tick;
+    _expiryTimeout = timeout;
+    _expiryWheel = std::make_unique<TimingWheel>(cfg);
 }
 
-// 健康检查
-bool RedisStreamStateManager::isHealthy() const
+void RedisStreamStateManager::armExpiry(const std::string& task_key) const
 {
-    return _cacheManager.ping();
+    if (_expiryWheel)
+    {
+        _expiryWheel->schedule(task_key, std::chrono::steady_clock::now() + _expiryTimeout);
+    }
 }
 
-//索引管理（明确 pub_key 存储逻辑） 唯一宿主
-bool RedisStreamStateManager::registerPublisherIndices(const StreamTask& task) const
+TimeoutScanResult RedisStreamStateManager::expireDueTasks(std::chrono::milliseconds timeout)
 {
-    const std::string pub_lock_key = buildPublisherKey(task.stream_name);
-    const std::string member_index_key = "stream:members:" + task.stream_name;
-    const std::string active_pub_key = buildActivePublishersKey();
+    TimeoutScanResult result;
+    if (!_expiryWheel)return result;
+
+    const auto due = _expiryWheel->advance(std::chrono::steady_clock::now());
+    if (due.empty())return result;
 
-    //唯一性校验：确保推流位没被别人抢占
-    if (const auto current_task_opt = getTaskByKey(pub_lock_key))
+    const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    const int64_t cutoff_ms = now_ms - timeout.count();
+
+    constexpr size_t kBatch = 256;
+    for (size_t begin = 0; begin < due.size(); begin += kBatch)
     {
-        if (current_task_opt->client_id != task.client_id)
+        const std::vector<std::string> batch(due.begin() + static_cast<std::ptrdiff_t>(begin),
+                                             due.begin() + static_cast<std::ptrdiff_t>(std::min(due.size(), begin + kBatch)));
+        std::vector<std::pair<std::string, int64_t>> refreshed;
+        try
         {
-            LOG_WARN("Conflict: Stream " + task.stream_name + " already has a publisher");
-            return false;
+            commitTimeoutCandidates(batch, cutoff_ms, result.expired, &refreshed);
+        }
+        catch (const std::exception& err)
+        {
+            // 交还给时间轮，下一个 tick 重试；期间全量扫描同样可以回收
+            LOG_ERROR("expireDueTasks: commit failed: " + std::string(err.what()));
+            for (const auto& key : batch)
+            {
+                _expiryWheel->schedule(key, std::chrono::steady_clock::now());
+            }
+            continue;
+        }
+        ++result.pages;
+
+        // 由其它实例续期的任务：按剩余时间重新登记
+        for (const auto& [key, last_ms] : refreshed)
+        {
+            _expiryWheel->schedule(key, std::chrono::steady_clock::now() +
+                                   std::chrono::milliseconds(last_ms - cutoff_ms));
         }
     }
+    return result;
+}
+
+std::optional<StreamTask> RedisStreamStateManager::reclaimExpiredTask(const std::string& stream_name,
+                                                                     const std::string& client_id)
+{
+    const std::string task_key = buildTaskKey(stream_name, client_id);
+    const std::vector<std::string> keys = {
+        task_key,
+        buildPublisherKey(stream_name),
+        buildStreamMembersKey(stream_name),
+        buildActivePublishersKey(),
+        buildPlayerCountShardKey(client_id),
+        buildTaskTimestampZSetKey()
+    };
 
-    //写入推流详情与索引
+    long long kind = 0;
     try
     {
-        auto pipe = _cacheManager.createPipeline();
+        kind = _cacheManager.evalScriptInt(_expiredTaskScript, keys, {stream_name, client_id});
+    }
+    catch (const std::exception& err)
+    {
+        // ZSet 条目仍在，留给对账扫描
+        LOG_ERROR("reclaimExpiredTask: script failed for " + task_key + ": " + err.what());
+        return std::nullopt;
+    }
+    if (kind == 0)return std::nullopt;
+
+    if (_expiryWheel)_expiryWheel->cancel(task_key);
+
+    StreamTask task;
+    task.stream_name = stream_name;
+    task.client_id = client_id;
+    task.type = kind == 2 ? StreamType::PUBLISHER : StreamType::PLAYER;
+    task.state = StreamState::CLOSED;
+    return task;
+}
 
-        auto task_data = serializeTask(task);
+// 统计信息
+size_t RedisStreamStateManager::getActivePublisherCount() const
+{
+    return _cacheManager.setCard(buildActivePublishersKey());
+}
 
-        pipe.hset(pub_lock_key, task_data.begin(), task_data.end());
-        pipe.sadd(member_index_key, task.client_id);
-        pipe.sadd(active_pub_key, task.stream_name);
+size_t RedisStreamStateManager::getActivePlayerCount() const
+{
+    if (const auto counts = _playerCounts.load(std::memory_order_acquire))return counts->total;
 
-        pipe.exec();
+    try
+    {
+        return loadPlayerCounts(false)->total;
+    }
+    catch (const std::exception& err)
+    {
+        LOG_ERROR("getActivePlayerCount failed: " + std::string(err.what()));
+        return 0;
+    }
+}
+
+size_t RedisStreamStateManager::getPlayerCount(const std::string& stream_name) const
+{
+    if (const auto counts = _playerCounts.load(std::memory_order_acquire))
+    {
+        const auto it = counts->per_stream.find(stream_name);
+        return it == counts->per_stream.end() ? 0 : it->second;
+    }
+
+    try
+    {
+        auto pipe = _cacheManager.createPipeline();
+        pipe.scard(buildStreamMembersKey(stream_name)).exists(buildPublisherKey(stream_name));
+        auto replies = pipe.exec();
+        const auto members = replies.get<long long>(0);
+        const auto has_publisher = replies.get<long long>(1) > 0;
+        // 成员集合包含推流端自身
+        return static_cast<size_t>(std::max<long long>(members - (has_publisher ? 1 : 0), 0));
     }
     catch (const sw::redis::Error& err)
     {
-        LOG_ERROR("registerPublisherIndices pipeline failed: " + std::string(err.what()));
-        return false;
+        LOG_ERROR("getPlayerCount failed for stream=" + stream_name + " error=" + err.what());
+        return 0;
     }
-    return true;
 }
 
-//注册播放者索引：定死“寄生者”语义
-bool RedisStreamStateManager::registerPlayerIndices(const StreamTask& task) const
+std::shared_ptr<const RedisStreamStateManager::PlayerCounts> RedisStreamStateManager::loadPlayerCounts(
+    bool with_streams) const
 {
-    const std::string member_index_key = "stream:members:" + task.stream_name;
-    const std::string global_key = buildGlobalPlayerCountKey();
+    // 读取方求和：单个 key 可能为负（滚动升级期间旧版本的加一与新版本的减一落在不同 key 上），总和才有意义
+    std::vector<std::string> streams;
+    if (with_streams)
+    {
+        streams = _cacheManager.setMembers(buildActivePublishersKey());
+    }
 
-    if (_cacheManager.setAdd(member_index_key, task.client_id))
+    auto pipe = _cacheManager.createPipeline();
+    // 升级前的单 key 计数器：旧版本网关仍在写入时也计入总和，滚动升级期间总数保持正确
+    pipe.hget("global_players", "total");
+    for (size_t i = 0; i < PLAYER_COUNTER_SHARDS; ++i)
     {
-        bestEffort(_cacheManager.hashIncrBy(global_key, "total", 1), "hincrby", global_key);
-        return true;
+        pipe.hget(buildPlayerCountShardKey(i), "total");
+    }
+    for (const auto& name : streams)
+    {
+        pipe.scard(buildStreamMembersKey(name));
     }
+    auto replies = pipe.exec();
 
-    return false;
+    auto counts = std::make_shared<PlayerCounts>();
+    int64_t total = 0;
+    for (size_t i = 0; i <= PLAYER_COUNTER_SHARDS; ++i)
+    {
+        const auto value = replies.get<sw::redis::OptionalString>(i);
+        int64_t n = 0;
+        if (value && std::from_chars(value->data(), value->data() + value->size(), n).ec == std::errc{})
+        {
+            total += n;
+        }
+    }
+    counts->total = static_cast<size_t>(std::max<int64_t>(total, 0));
+
+    counts->per_stream.reserve(streams.size());
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        // 成员集合包含推流端自身
+        const auto members = replies.get<long long>(PLAYER_COUNTER_SHARDS + 1 + i);
+        counts->per_stream.emplace(streams[i], members > 1 ? static_cast<size_t>(members - 1) : 0);
+    }
+    return counts;
+}
+
+std::vector<NodeLoad> RedisStreamStateManager::getNodeLoads() const
+{
+    const auto streams = _cacheManager.setMembers(buildActivePublishersKey());
+    if (streams.empty())return {};
+
+    static const std::array<std::string, 3> kPubFields{"active", "server_ip", "server_port"};
+
+    auto pipe = _cacheManager.createPipeline();
+    for (const auto& name : streams)
+    {
+        pipe.hmget(buildPublisherKey(name), kPubFields.begin(), kPubFields.end())
+            .scard(buildStreamMembersKey(name));
+    }
+    auto replies = pipe.exec();
+
+    std::unordered_map<std::string, NodeLoad> by_node;
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        const auto values = replies.get<std::vector<sw::redis::OptionalString>>(i * 2);
+        const auto members = replies.get<long long>(i * 2 + 1);
+
+        // active_pubs 与 pub:<stream> 之间可能短暂不一致（推流刚结束），跳过即可
+        if (values.size() != kPubFields.size() || !values[0] || *values[0] != "1" || !values[1] || !values[2])
+        {
+            continue;
+        }
+
+        int port = 0;
+        const auto& port_str = *values[2];
+        if (std::from_chars(port_str.data(), port_str.data() + port_str.size(), port).ec != std::errc{})
+        {
+            continue;
+        }
+
+        auto& load = by_node[*values[1] + ":" + port_str];
+        load.host = *values[1];
+        load.port = port;
+        ++load.publishers;
+        // 成员集合包含推流端自身
+        load.players += members > 1 ? static_cast<uint64_t>(members - 1) : 0;
+    }
+
+    std::vector<NodeLoad> loads;
+    loads.reserve(by_node.size());
+    for (auto& [key, load] : by_node)
+    {
+        loads.push_back(std::move(load));
+    }
+    return loads;
+}
+
+// 健康检查
+bool RedisStreamStateManager::isHealthy() const
+{
+    return _cacheManager.ping();
 }
 
 //联动清理原子入口
 void RedisStreamStateManager::deregisterAllMembers(const std::string& stream_name)
 {
-    const std::string member_key = "stream:members:" + stream_name;
+    const std::string member_key = buildStreamMembersKey(stream_name);
     auto clientIds = getStreamClientIds(stream_name);
 
     if (clientIds.empty())
@@ -536,13 +1003,30 @@ void RedisStreamStateManager::deregisterAllMembers(const std::string& stream_nam
     }
 
     std::vector<TaskIdentifier> tasks;
-    for (const auto& cid : clientIds)
+    try
     {
-        if (const auto task_opt = getTask(stream_name, cid))
+        // 只需要 type 决定清理哪些索引：一次 Pipeline 取代逐个 HGETALL
+        auto pipe = _cacheManager.createPipeline();
+        for (const auto& cid : clientIds)
+        {
+            pipe.hget(buildTaskKey(stream_name, cid), "type");
+        }
+        auto replies = pipe.exec();
+
+        for (size_t i = 0; i < clientIds.size(); ++i)
         {
-            tasks.push_back({stream_name, cid, task_opt->type});
+            const auto type = replies.get<sw::redis::OptionalString>(i);
+            if (type && (*type == "publisher" || *type == "player"))
+            {
+                tasks.push_back({stream_name, clientIds[i], parseType(*type)});
+            }
         }
     }
+    catch (const sw::redis::Error& err)
+    {
+        LOG_ERROR("deregisterAllMembers: type lookup failed for stream=" + stream_name + " error=" + err.what());
+        return;
+    }
 
     deregisterTasksBatch(tasks);
 
@@ -555,7 +1039,6 @@ size_t RedisStreamStateManager::deregisterTasksBatch(const std::vector<TaskIdent
 {
     if (tasks.empty())return 0;
 
-    const std::string global_key = buildGlobalPlayerCountKey();
     const std::string active_pub_key = buildActivePublishersKey();
 
     try
@@ -565,14 +1048,15 @@ size_t RedisStreamStateManager::deregisterTasksBatch(const std::vector<TaskIdent
         for (const auto& task : tasks)
         {
             std::string detail_key = buildTaskKey(task.streamName, task.clientId);
-            std::string member_key = "stream:members:" + task.streamName;
+            std::string member_key = buildStreamMembersKey(task.streamName);
 
+            if (_expiryWheel)_expiryWheel->cancel(detail_key);
             pipe.del(detail_key);
             pipe.srem(member_key, task.clientId);
 
             if (task.type == StreamType::PLAYER)
             {
-                pipe.hincrby(global_key, "total", -1);
+                pipe.hincrby(buildPlayerCountShardKey(task.clientId), "total", -1);
             }
             else if (task.type == StreamType::PUBLISHER)
             {
@@ -592,36 +1076,6 @@ size_t RedisStreamStateManager::deregisterTasksBatch(const std::vector<TaskIdent
     return tasks.size();
 }
 
-void RedisStreamStateManager::deregisterPublisherIndices(const std::string& stream_name) const
-{
-    const auto pub_key = buildPublisherKey(stream_name);
-
-    bestEffort(_cacheManager.setRem(buildActivePublishersKey(), stream_name), "setRem", stream_name);
-
-    bestEffort(_cacheManager.keyDel(pub_key), "keyDel", pub_key);
-}
-
-void RedisStreamStateManager::deregisterPlayerIndices(const std::string& stream_name,
-                                                      const std::string& client_id) const
-{
-    const std::string player_set_key = buildPlayerSetKey(stream_name);
-    const std::string global_key = buildGlobalPlayerCountKey();
-
-    if (_cacheManager.setRem(player_set_key, client_id))
-    {
-        long long new_val = _cacheManager.hashIncrBy(global_key, "total", -1);
-
-        if (new_val < 0)
-        {
-            bestEffort(_cacheManager.hashSet(global_key, {{"total", "0"}}), "resetNegativeCounter", global_key);
-        }
-    }
-    else
-    {
-        LOG_DEBUG("Player "+client_id+" not in set, skipping decrement");
-    }
-}
-
 // Key 构造器
 std::string RedisStreamStateManager::buildTaskKey(const std::string& stream_name, const std::string& client_id)
 {
@@ -633,9 +1087,9 @@ std::string RedisStreamStateManager::buildPublisherKey(const std::string& stream
     return "pub:" + stream_name;
 }
 
-std::string RedisStreamStateManager::buildPlayerSetKey(const std::string& stream_name)
+std::string RedisStreamStateManager::buildStreamMembersKey(const std::string& stream_name)
 {
-    return "players:" + stream_name;
+    return "stream:members:" + stream_name;
 }
 
 std::string RedisStreamStateManager::buildStreamMetaKey(const std::string& stream_name)
@@ -648,9 +1102,20 @@ std::string RedisStreamStateManager::buildActivePublishersKey()
     return "active_pubs";
 }
 
-std::string RedisStreamStateManager::buildGlobalPlayerCountKey()
+std::string RedisStreamStateManager::buildPlayerCountShardKey(const std::string& client_id)
 {
-    return "global_players";
+    // FNV-1a：跨进程 / 跨编译器稳定（std::hash 不保证），各网关对同一 client 选择同一分片
+    uint32_t hash = 2166136261u;
+    for (const unsigned char c : client_id)
+    {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return buildPlayerCountShardKey(hash % PLAYER_COUNTER_SHARDS);
+}
+
+std::string RedisStreamStateManager::buildPlayerCountShardKey(size_t shard)
+{
+    return "global_players:" + std::to_string(shard);
 }
 
 std::string RedisStreamStateManager::buildTaskTimestampZSetKey()
@@ -659,13 +1124,57 @@ std::string RedisStreamStateManager::buildTaskTimestampZSetKey()
 }
 
 // 任务加载
-std::optional<StreamTask> RedisStreamStateManager::getTaskByKey(const std::string& task_key) const
+std::optional<StreamTask> RedisStreamStateManager::loadTask(const std::string& key, const std::string& stream_name,
+                                                            const std::string& client_id) const
 {
-    auto fields = _cacheManager.hashGetAll(task_key);
-    if (fields.empty())
+    static const std::vector<std::string> kFields{"d", "last_active_time_ms", "client_id", "active"};
+
+    const auto values = _cacheManager.hashMGet(key, kFields);
+    const auto& blob = values[0];
+    const auto& last_str = values[1];
+    if (!last_str)
+    {
+        return std::nullopt;
+    }
+    // 推流位在注销时整体删除；active 只在旧格式 / 推流位中出现
+    if (values[3] && *values[3] != "1")
+    {
+        return std::nullopt;
+    }
+
+    if (!blob)
     {
+        // 升级前写入的 16 字段 hash：按旧格式读取，TTL 内自然过期或在下次注册时被覆盖
+        return StreamTaskSerializer::decodeLegacyHash(_cacheManager.hashGetAll(key));
+    }
+
+    StreamTask task;
+    if (!StreamTaskSerializer::decodeCompact(*blob, task))
+    {
+        LOG_WARN("loadTask: undecodable task record, key=" + key);
         return std::nullopt;
     }
 
-    return deserializeTask(fields);
+    int64_t last_ms = 0;
+    if (std::from_chars(last_str->data(), last_str->data() + last_str->size(), last_ms).ec != std::errc{} ||
+        last_ms < MIN_REASONABLE_MS || last_ms > MAX_REASONABLE_MS)
+    {
+        return std::nullopt;
+    }
+    task.last_active_time = std::chrono::system_clock::time_point(std::chrono::milliseconds{last_ms});
+
+    task.stream_name = stream_name;
+    if (!client_id.empty())
+    {
+        task.client_id = client_id;
+    }
+    else if (values[2])
+    {
+        task.client_id = *values[2];
+    }
+    else
+    {
+        return std::nullopt;
+    }
+    return task;
 }
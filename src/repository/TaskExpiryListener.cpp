@@ -0,0 +1,146 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "TaskExpiryListener.h"
+#include "CacheManager.h"
+#include "LifecycleExecutor.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+    constexpr std::string_view kTaskPrefix = "task:";
+    constexpr auto kExpiredPattern = "__keyevent@*__:expired";
+}
+
+TaskExpiryListener::TaskExpiryListener(CacheManager& cacheMgr, Handler handler)
+    : TaskExpiryListener(cacheMgr, std::move(handler), Config{})
+{
+}
+
+TaskExpiryListener::TaskExpiryListener(CacheManager& cacheMgr, Handler handler, const Config& config)
+    : _cacheManager(cacheMgr),
+      _handler(std::move(handler)),
+      _config(config)
+{
+}
+
+TaskExpiryListener::~TaskExpiryListener()
+{
+    stop();
+}
+
+void TaskExpiryListener::start()
+{
+    if (_worker.joinable())return;
+    _worker = std::jthread([this](const std::stop_token& stoken) { run(stoken); });
+    LOG_INFO("TaskExpiryListener: 已启动, 订阅 " + std::string(kExpiredPattern));
+}
+
+void TaskExpiryListener::stop()
+{
+    if (!_worker.joinable())return;
+    // consume() 最多阻塞 poll_timeout
+    _worker.request_stop();
+    _worker.join();
+}
+
+bool TaskExpiryListener::parseTaskKey(std::string_view key, std::string& stream_name, std::string& client_id)
+{
+    if (!key.starts_with(kTaskPrefix))return false;
+    key.remove_prefix(kTaskPrefix.size());
+
+    const auto sep = key.rfind(':');
+    if (sep == std::string_view::npos || sep == 0 || sep + 1 == key.size())return false;
+
+    stream_name.assign(key.substr(0, sep));
+    client_id.assign(key.substr(sep + 1));
+    return true;
+}
+
+TaskExpiryListener::Handler TaskExpiryListener::postToLifecycle(LifecycleExecutor& lifecycle, Handler on_expired)
+{
+    return [&lifecycle, on_expired = std::move(on_expired)](const std::string& stream_name,
+                                                            const std::string& client_id)
+    {
+        if (!lifecycle.submit(stream_name, [on_expired, stream_name, client_id]
+        {
+            on_expired(stream_name, client_id);
+        }))
+        {
+            LOG_WARN("TaskExpiryListener: lifecycle 拒绝投递 " + stream_name + "/" + client_id + "，留给对账扫描");
+        }
+    };
+}
+
+void TaskExpiryListener::dispatch(const std::string& key)
+{
+    std::string stream_name;
+    std::string client_id;
+    if (!parseTaskKey(key, stream_name, client_id))return;
+
+    _events.fetch_add(1, std::memory_order_relaxed);
+    try
+    {
+        _handler(stream_name, client_id);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("TaskExpiryListener: 处理 " + key + " 失败: " + e.what());
+    }
+}
+
+void TaskExpiryListener::run(const std::stop_token& stoken)
+{
+    std::mutex sleep_mutex;
+    std::condition_variable_any sleep_cv;
+    auto backoff = std::chrono::milliseconds(100);
+
+    while (!stoken.stop_requested())
+    {
+        try
+        {
+            // Redis 重启后 CONFIG SET 的修改会丢失，每次建连都确认一次
+            if (!_cacheManager.enableKeyspaceEvents())
+            {
+                LOG_WARN("TaskExpiryListener: 无法确认 notify-keyspace-events 含 Ex, 依赖服务端预先配置");
+            }
+
+            auto subscriber = _cacheManager.createSubscriber(_config.poll_timeout);
+            subscriber.on_pmessage([this](const std::string& /*pattern*/, const std::string& /*channel*/,
+                                          const std::string& key)
+            {
+                dispatch(key);
+            });
+            subscriber.psubscribe(kExpiredPattern);
+            LOG_INFO("TaskExpiryListener: 订阅连接已建立");
+            backoff = std::chrono::milliseconds(100);
+
+            while (!stoken.stop_requested())
+            {
+                try
+                {
+                    subscriber.consume();
+                }
+                catch (const sw::redis::TimeoutError&)
+                {
+                    // 空闲超时，回到循环检查停止标志
+                }
+            }
+            return;
+        }
+        catch (const std::exception& e)
+        {
+            // 非超时错误后订阅连接不可再用，重建
+            LOG_WARN("TaskExpiryListener: 订阅连接异常, " + std::to_string(backoff.count()) + "ms 后重连: " +
+                e.what());
+        }
+
+        std::unique_lock lock(sleep_mutex);
+        sleep_cv.wait_for(lock, stoken, backoff, [] { return false; });
+        backoff = std::min(backoff * 2, _config.max_backoff);
+    }
+}
@@ -0,0 +1,668 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "WriteBehindStreamStateManager.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    using SteadyClock = std::chrono::steady_clock;
+
+    void updateMax(std::atomic<uint64_t>& target, uint64_t value)
+    {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+WriteBehindStreamStateManager::WriteBehindStreamStateManager(IStreamStateManager& backend, const Config& config)
+    : _backend(backend),
+      _config(config),
+      _shards(std::make_unique<Shard[]>(std::max<size_t>(config.shards, 1))),
+      _shardCount(std::max<size_t>(config.shards, 1))
+{
+    _flusher = std::jthread([this](const std::stop_token& stoken)
+    {
+        flushLoop(stoken);
+    });
+}
+
+WriteBehindStreamStateManager::~WriteBehindStreamStateManager()
+{
+    stop();
+}
+
+void WriteBehindStreamStateManager::stop()
+{
+    if (_stopped.exchange(true))return;
+
+    if (_flusher.joinable())
+    {
+        _flusher.request_stop();
+        _wakeCondition.notify_all();
+        _flusher.join();
+    }
+
+    // 排空：后端故障时失败的操作会重新排队，只再试一轮，避免停机卡死
+    std::lock_guard<std::mutex> lock(_flushMutex);
+    for (int round = 0; round < 2 && _pending.load(std::memory_order_relaxed) > 0; ++round)
+    {
+        (void)flushPending();
+    }
+    if (const auto left = _pending.load(std::memory_order_relaxed); left > 0)
+    {
+        LOG_ERROR("WriteBehindStreamStateManager: " + std::to_string(left) + " pending ops dropped at shutdown");
+    }
+    _capacityCondition.notify_all();
+}
+
+WriteBehindStreamStateManager::Shard& WriteBehindStreamStateManager::shardFor(const std::string& stream_name) const
+{
+    return _shards[std::hash<std::string>{}(stream_name) % _shardCount];
+}
+
+// 任务生命周期
+bool WriteBehindStreamStateManager::registerTask(const StreamTask& task)
+{
+    assert(!task.stream_name.empty());
+    assert(!task.client_id.empty());
+
+    if (task.type == StreamType::PUBLISHER || _stopped.load(std::memory_order_relaxed))
+    {
+        return registerSync(task);
+    }
+
+    if (!waitForCapacity())return false;
+
+    Shard& shard = shardFor(task.stream_name);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto& clients = shard.streams[task.stream_name];
+        auto [it, inserted] = clients.try_emplace(task.client_id);
+        if (inserted)_cached.fetch_add(1, std::memory_order_relaxed);
+
+        CachedTask& entry = it->second;
+        entry.task = task;
+        entry.task.last_active_time = std::chrono::system_clock::now();
+        entry.removed = false;
+        markDirty(shard, entry, PendingOp::Register);
+    }
+    return true;
+}
+
+/**
+ * @brief 推流端：先落盘同一条流的待写变更（例如本实例刚注销的旧推流端），再同步抢占推流位
+ */
+bool WriteBehindStreamStateManager::registerSync(const StreamTask& task)
+{
+    std::lock_guard<std::mutex> flush_lock(_flushMutex);
+    flushStream(task.stream_name);
+
+    if (!_backend.registerTask(task))return false;
+
+    // 缓存干净的项：之后的心跳走本地合并
+    Shard& shard = shardFor(task.stream_name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& clients = shard.streams[task.stream_name];
+    auto [it, inserted] = clients.try_emplace(task.client_id);
+    if (inserted)_cached.fetch_add(1, std::memory_order_relaxed);
+    it->second.task = task;
+    it->second.removed = false;
+    it->second.persisted = true;
+    return true;
+}
+
+bool WriteBehindStreamStateManager::deregisterTask(const std::string& stream_name, const std::string& client_id)
+{
+    if (!_stopped.load(std::memory_order_relaxed))
+    {
+        Shard& shard = shardFor(stream_name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (const auto s = shard.streams.find(stream_name); s != shard.streams.end())
+        {
+            if (const auto it = s->second.find(client_id); it != s->second.end())
+            {
+                CachedTask& entry = it->second;
+                if (entry.removed)return true;
+
+                if (entry.persisted)
+                {
+                    entry.removed = true;
+                    markDirty(shard, entry, PendingOp::Deregister);
+                    return true;
+                }
+
+                // 注册尚未到达后端：本地抵消，不能再发注销（Redis 注销按次递减播放计数，会永久少计）
+                _coalescedOps.fetch_add(1, std::memory_order_relaxed);
+                if (entry.pending != PendingOp::None)_pending.fetch_sub(1, std::memory_order_relaxed);
+                entry.pending = PendingOp::None;
+                if (entry.inflight)
+                {
+                    // 在途的是上一次注销，等它的结果再删
+                    entry.removed = true;
+                    return true;
+                }
+                s->second.erase(it);
+                _cached.fetch_sub(1, std::memory_order_relaxed);
+                if (s->second.empty())shard.streams.erase(s);
+                return true;
+            }
+        }
+    }
+
+    // 未缓存：没有待写或在途的操作，直接透传即可保持顺序
+    _syncFallbacks.fetch_add(1, std::memory_order_relaxed);
+    return _backend.deregisterTask(stream_name, client_id);
+}
+
+/**
+ * @brief 整流注销：丢弃本地该流的全部缓存（含未落盘的注册 / 注销），再由后端按其成员表清理
+ * * 持有 _flushMutex，保证在途批次先完成；之后新到的注册照常排队，不受影响。
+ */
+void WriteBehindStreamStateManager::deregisterAllMembers(const std::string& stream_name)
+{
+    std::lock_guard<std::mutex> flush_lock(_flushMutex);
+    {
+        Shard& shard = shardFor(stream_name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (const auto s = shard.streams.find(stream_name); s != shard.streams.end())
+        {
+            for (const auto& [client_id, entry] : s->second)
+            {
+                if (entry.pending != PendingOp::None)_pending.fetch_sub(1, std::memory_order_relaxed);
+            }
+            _cached.fetch_sub(static_cast<int64_t>(s->second.size()), std::memory_order_relaxed);
+            shard.streams.erase(s);
+        }
+    }
+    _backend.deregisterAllMembers(stream_name);
+}
+
+bool WriteBehindStreamStateManager::touchTask(const std::string& stream_name, const std::string& client_id) const
+{
+    if (!_stopped.load(std::memory_order_relaxed))
+    {
+        if (!waitForCapacity())return false;
+
+        Shard& shard = shardFor(stream_name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (const auto s = shard.streams.find(stream_name); s != shard.streams.end())
+        {
+            if (const auto it = s->second.find(client_id); it != s->second.end())
+            {
+                if (it->second.removed)return false;
+                it->second.task.last_active_time = std::chrono::system_clock::now();
+                markDirty(shard, it->second, PendingOp::Touch);
+                return true;
+            }
+        }
+    }
+
+    // 其它实例或重启前登记的任务：同步刷新
+    _syncFallbacks.fetch_add(1, std::memory_order_relaxed);
+    return _backend.touchTask(stream_name, client_id);
+}
+
+/**
+ * @brief 合并规则：注册吸收之后的心跳；注销覆盖一切；注销后的重新注册以注册为准（注册脚本会先清理旧状态）
+ */
+void WriteBehindStreamStateManager::markDirty(Shard& shard, CachedTask& entry, PendingOp op) const
+{
+    if (entry.pending == PendingOp::None)
+    {
+        entry.pending = op;
+        entry.since = SteadyClock::now();
+        shard.dirty.emplace_back(entry.task.stream_name, entry.task.client_id);
+        if (_pending.fetch_add(1, std::memory_order_relaxed) + 1 == static_cast<int64_t>(_config.flush_batch))
+        {
+            _wakeCondition.notify_one();
+        }
+        return;
+    }
+
+    _coalescedOps.fetch_add(1, std::memory_order_relaxed);
+    if (op == PendingOp::Touch && entry.pending == PendingOp::Register)return;
+    entry.pending = op;
+}
+
+bool WriteBehindStreamStateManager::waitForCapacity() const
+{
+    if (_pending.load(std::memory_order_relaxed) < static_cast<int64_t>(_config.max_pending))return true;
+
+    _backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+    _wakeCondition.notify_one();
+
+    std::unique_lock lock(_wakeMutex);
+    if (_capacityCondition.wait_for(lock, _config.backpressure_timeout, [this]
+    {
+        return _pending.load(std::memory_order_relaxed) < static_cast<int64_t>(_config.max_pending) ||
+            _stopped.load(std::memory_order_relaxed);
+    }))
+    {
+        return true;
+    }
+
+    _rejected.fetch_add(1, std::memory_order_relaxed);
+    LOG_WARN("WriteBehindStreamStateManager: pending queue full for " +
+        std::to_string(_config.backpressure_timeout.count()) + "ms, write rejected");
+    return false;
+}
+
+// 查询接口：本地未落盘的变更优先
+std::vector<std::string> WriteBehindStreamStateManager::getStreamClientIds(const std::string& stream_name) const
+{
+    auto ids = _backend.getStreamClientIds(stream_name);
+
+    Shard& shard = shardFor(stream_name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto s = shard.streams.find(stream_name);
+    if (s == shard.streams.end())return ids;
+
+    for (const auto& [client_id, entry] : s->second)
+    {
+        if (entry.removed)
+        {
+            std::erase(ids, client_id);
+        }
+        else if (entry.pending == PendingOp::Register && std::ranges::find(ids, client_id) == ids.end())
+        {
+            ids.push_back(client_id);
+        }
+    }
+    return ids;
+}
+
+std::optional<StreamTask> WriteBehindStreamStateManager::getTask(const std::string& stream_name,
+                                                                 const std::string& client_id) const
+{
+    {
+        Shard& shard = shardFor(stream_name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (const auto s = shard.streams.find(stream_name); s != shard.streams.end())
+        {
+            if (const auto it = s->second.find(client_id); it != s->second.end())
+            {
+                if (it->second.removed)return std::nullopt;
+                if (it->second.pending != PendingOp::None)return it->second.task;
+            }
+        }
+    }
+    return _backend.getTask(stream_name, client_id);
+}
+
+bool WriteBehindStreamStateManager::publisherRemovedLocally(const std::string& stream_name) const
+{
+    // 推流端注册是同步的，本地只可能领先一个尚未落盘的注销
+    Shard& shard = shardFor(stream_name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto s = shard.streams.find(stream_name);
+    if (s == shard.streams.end())return false;
+    return std::ranges::any_of(s->second, [](const auto& kv)
+    {
+        return kv.second.removed && kv.second.task.type == StreamType::PUBLISHER;
+    });
+}
+
+std::optional<StreamTask> WriteBehindStreamStateManager::getPublisherTask(const std::string& stream_name) const
+{
+    if (publisherRemovedLocally(stream_name))return std::nullopt;
+    return _backend.getPublisherTask(stream_name);
+}
+
+std::optional<PublisherLocation> WriteBehindStreamStateManager::getPublisherLocation(
+    const std::string& stream_name) const
+{
+    if (publisherRemovedLocally(stream_name))return std::nullopt;
+    return _backend.getPublisherLocation(stream_name);
+}
+
+std::vector<StreamTask> WriteBehindStreamStateManager::getAllPublisherTasks() const
+{
+    return _backend.getAllPublisherTasks();
+}
+
+size_t WriteBehindStreamStateManager::getActivePublisherCount() const
+{
+    return _backend.getActivePublisherCount();
+}
+
+size_t WriteBehindStreamStateManager::getActivePlayerCount() const
+{
+    return _backend.getActivePlayerCount();
+}
+
+size_t WriteBehindStreamStateManager::getPlayerCount(const std::string& stream_name) const
+{
+    return _backend.getPlayerCount(stream_name);
+}
+
+std::vector<NodeLoad> WriteBehindStreamStateManager::getNodeLoads() const
+{
+    return _backend.getNodeLoads();
+}
+
+bool WriteBehindStreamStateManager::isHealthy() const
+{
+    return _backend.isHealthy();
+}
+
+// 超时回收：后端是权威状态，回收后同步剔除本地缓存
+TimeoutScanResult WriteBehindStreamStateManager::scanTimeoutTasks(std::chrono::milliseconds timeout,
+                                                                  const TimeoutScanOptions& options)
+{
+    auto result = _backend.scanTimeoutTasks(timeout, options);
+    evictExpired(result.expired);
+    return result;
+}
+
+void WriteBehindStreamStateManager::enableLocalExpiry(std::chrono::milliseconds timeout,
+                                                      std::chrono::milliseconds tick)
+{
+    _backend.enableLocalExpiry(timeout, tick);
+}
+
+TimeoutScanResult WriteBehindStreamStateManager::expireDueTasks(std::chrono::milliseconds timeout)
+{
+    auto result = _backend.expireDueTasks(timeout);
+    evictExpired(result.expired);
+    return result;
+}
+
+std::optional<StreamTask> WriteBehindStreamStateManager::reclaimExpiredTask(const std::string& stream_name,
+                                                                           const std::string& client_id)
+{
+    auto task = _backend.reclaimExpiredTask(stream_name, client_id);
+    if (task)evictExpired({*task});
+    return task;
+}
+
+/**
+ * @brief 已被后端回收的任务：丢弃本地缓存与待写心跳；本地已重新注册或已注销的保留
+ */
+void WriteBehindStreamStateManager::evictExpired(const std::vector<StreamTask>& expired)
+{
+    for (const auto& task : expired)
+    {
+        Shard& shard = shardFor(task.stream_name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto s = shard.streams.find(task.stream_name);
+        if (s == shard.streams.end())continue;
+        const auto it = s->second.find(task.client_id);
+        if (it == s->second.end() || it->second.removed || it->second.pending == PendingOp::Register)continue;
+
+        if (it->second.pending != PendingOp::None)_pending.fetch_sub(1, std::memory_order_relaxed);
+        s->second.erase(it);
+        _cached.fetch_sub(1, std::memory_order_relaxed);
+        if (s->second.empty())shard.streams.erase(s);
+    }
+}
+
+// 后台刷新
+void WriteBehindStreamStateManager::flushLoop(const std::stop_token& stoken)
+{
+    bool backoff = false;
+    while (!stoken.stop_requested())
+    {
+        {
+            // 上一轮有写入失败（重新排队的操作仍计入 pending）时睡满一个周期，避免对故障后端空转重试
+            std::unique_lock lock(_wakeMutex);
+            _wakeCondition.wait_for(lock, stoken, _config.flush_interval, [this, backoff]
+            {
+                return !backoff &&
+                    _pending.load(std::memory_order_relaxed) >= static_cast<int64_t>(_config.flush_batch);
+            });
+        }
+        if (stoken.stop_requested())break;
+
+        {
+            std::lock_guard<std::mutex> lock(_flushMutex);
+            const uint64_t errors = _flushErrors.load(std::memory_order_relaxed);
+            (void)flushPending();
+            backoff = _flushErrors.load(std::memory_order_relaxed) != errors;
+            evictIfOverCapacity();
+        }
+        _capacityCondition.notify_all();
+    }
+}
+
+size_t WriteBehindStreamStateManager::flushPending()
+{
+    std::vector<FlushItem> items;
+    for (size_t i = 0; i < _shardCount; ++i)
+    {
+        collect(_shards[i], items, nullptr);
+    }
+    if (items.empty())return 0;
+
+    const size_t count = items.size();
+    writeItems(items);
+    return count;
+}
+
+void WriteBehindStreamStateManager::flushStream(const std::string& stream_name)
+{
+    std::vector<FlushItem> items;
+    collect(shardFor(stream_name), items, &stream_name);
+    if (!items.empty())writeItems(items);
+}
+
+/**
+ * @brief 取出分片中的待写操作；缓存项保留到写入结果返回（注销项此时才删除）
+ */
+void WriteBehindStreamStateManager::collect(Shard& shard, std::vector<FlushItem>& items,
+                                            const std::string* only_stream)
+{
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::vector<std::pair<std::string, std::string>> keep;
+    for (auto& key : shard.dirty)
+    {
+        if (only_stream && key.first != *only_stream)
+        {
+            keep.push_back(std::move(key));
+            continue;
+        }
+
+        // 整流注销 / 超时剔除可能已删掉缓存项，或同一 key 重复登记过
+        const auto s = shard.streams.find(key.first);
+        if (s == shard.streams.end())continue;
+        const auto it = s->second.find(key.second);
+        if (it == s->second.end() || it->second.pending == PendingOp::None)continue;
+
+        CachedTask& entry = it->second;
+        items.push_back(FlushItem{entry.pending, entry.task, entry.since, entry.persisted});
+        if (entry.pending == PendingOp::Register)entry.persisted = true;
+        if (entry.pending == PendingOp::Deregister)entry.persisted = false;
+        entry.pending = PendingOp::None;
+        entry.inflight = true;
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+    shard.dirty.swap(keep);
+}
+
+/**
+ * @brief 按类型分组，每组按 flush_batch 切成 Pipeline 批次写入后端
+ */
+void WriteBehindStreamStateManager::writeItems(std::vector<FlushItem>& items)
+{
+    const size_t batch = std::max<size_t>(_config.flush_batch, 1);
+    std::vector<const FlushItem*> registers, touches, deregisters;
+    for (const auto& item : items)
+    {
+        switch (item.op)
+        {
+        case PendingOp::Register: registers.push_back(&item);
+            break;
+        case PendingOp::Touch: touches.push_back(&item);
+            break;
+        case PendingOp::Deregister: deregisters.push_back(&item);
+            break;
+        case PendingOp::None: break;
+        }
+    }
+
+    std::vector<bool> results;
+    for (size_t begin = 0; begin < registers.size(); begin += batch)
+    {
+        const size_t end = std::min(begin + batch, registers.size());
+        std::vector<StreamTask> tasks;
+        tasks.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i)tasks.push_back(registers[i]->task);
+
+        (void)_backend.registerTasksBatch(tasks, &results);
+        for (size_t i = begin; i < end; ++i)settle(*registers[i], results[i - begin]);
+    }
+
+    for (size_t begin = 0; begin < touches.size(); begin += batch)
+    {
+        const size_t end = std::min(begin + batch, touches.size());
+        std::vector<TaskIdentifier> ids;
+        ids.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            ids.push_back({touches[i]->task.stream_name, touches[i]->task.client_id, touches[i]->task.type});
+        }
+
+        (void)_backend.touchTasksBatch(ids, &results);
+        for (size_t i = begin; i < end; ++i)settle(*touches[i], results[i - begin]);
+    }
+
+    for (size_t begin = 0; begin < deregisters.size(); begin += batch)
+    {
+        const size_t end = std::min(begin + batch, deregisters.size());
+        std::vector<TaskIdentifier> ids;
+        ids.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            ids.push_back({
+                deregisters[i]->task.stream_name, deregisters[i]->task.client_id, deregisters[i]->task.type
+            });
+        }
+
+        // Pipeline 整体成功或整体失败
+        const bool ok = _backend.deregisterTasksBatch(ids) == ids.size();
+        for (size_t i = begin; i < end; ++i)settle(*deregisters[i], ok);
+    }
+
+    const auto now = SteadyClock::now();
+    uint64_t lag_us = 0;
+    for (const auto& item : items)
+    {
+        lag_us = std::max(lag_us, static_cast<uint64_t>(
+                              std::chrono::duration_cast<std::chrono::microseconds>(now - item.since).count()));
+    }
+
+    _batches.fetch_add(1, std::memory_order_relaxed);
+    _flushedOps.fetch_add(items.size(), std::memory_order_relaxed);
+    _lastBatchSize.store(items.size(), std::memory_order_relaxed);
+    updateMax(_maxBatchSize, items.size());
+    _lastFlushLagUs.store(lag_us, std::memory_order_relaxed);
+    updateMax(_maxFlushLagUs, lag_us);
+}
+
+/**
+ * @brief 处理单个操作的写入结果
+ * * 注册 / 注销失败视为后端故障，重新排队（同一 key 至多一项，内存仍有界）；
+ * * 注册失败期间到达的心跳升级为注册，到达的注销与之抵消；
+ * * 心跳失败说明任务已在后端过期或被其它实例注销，剔除缓存，之后由同步路径返回 false。
+ */
+void WriteBehindStreamStateManager::settle(const FlushItem& item, bool ok)
+{
+    Shard& shard = shardFor(item.task.stream_name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto s = shard.streams.find(item.task.stream_name);
+    if (s == shard.streams.end())return;
+    const auto it = s->second.find(item.task.client_id);
+    if (it == s->second.end())return;
+    CachedTask& entry = it->second;
+    entry.inflight = false;
+
+    if (!ok && item.op != PendingOp::Touch)
+    {
+        _flushErrors.fetch_add(1, std::memory_order_relaxed);
+        entry.persisted = item.prior_persisted;
+        if (entry.pending == PendingOp::None)
+        {
+            entry.pending = item.op;
+            entry.since = item.since;
+            shard.dirty.emplace_back(item.task.stream_name, item.task.client_id);
+            _pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (item.op == PendingOp::Register && entry.pending == PendingOp::Touch)
+        {
+            entry.pending = PendingOp::Register;
+            entry.since = item.since;
+        }
+        else if (item.op == PendingOp::Register && entry.pending == PendingOp::Deregister && !entry.persisted)
+        {
+            _pending.fetch_sub(1, std::memory_order_relaxed);
+            s->second.erase(it);
+            _cached.fetch_sub(1, std::memory_order_relaxed);
+            if (s->second.empty())shard.streams.erase(s);
+        }
+        return;
+    }
+
+    // 写入期间本地又有新变更：保留，等下一轮
+    if (entry.pending != PendingOp::None)return;
+
+    const bool drop = item.op == PendingOp::Deregister ? entry.removed : !ok;
+    if (!drop)return;
+
+    s->second.erase(it);
+    _cached.fetch_sub(1, std::memory_order_relaxed);
+    if (s->second.empty())shard.streams.erase(s);
+}
+
+/**
+ * @brief 已落盘的缓存项超过上限时逐分片淘汰，只淘汰没有待写操作的项
+ */
+void WriteBehindStreamStateManager::evictIfOverCapacity()
+{
+    int64_t excess = _cached.load(std::memory_order_relaxed) - static_cast<int64_t>(_config.max_cached_tasks);
+    for (size_t i = 0; i < _shardCount && excess > 0; ++i)
+    {
+        Shard& shard = _shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto s = shard.streams.begin(); s != shard.streams.end() && excess > 0;)
+        {
+            for (auto it = s->second.begin(); it != s->second.end() && excess > 0;)
+            {
+                if (it->second.pending == PendingOp::None && !it->second.removed)
+                {
+                    it = s->second.erase(it);
+                    _cached.fetch_sub(1, std::memory_order_relaxed);
+                    --excess;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            s = s->second.empty() ? shard.streams.erase(s) : std::next(s);
+        }
+    }
+}
+
+WriteBehindStreamStateManager::Stats WriteBehindStreamStateManager::stats() const
+{
+    Stats s{};
+    s.pending = static_cast<uint64_t>(std::max<int64_t>(_pending.load(std::memory_order_relaxed), 0));
+    s.cached = static_cast<uint64_t>(std::max<int64_t>(_cached.load(std::memory_order_relaxed), 0));
+    s.batches = _batches.load(std::memory_order_relaxed);
+    s.flushed_ops = _flushedOps.load(std::memory_order_relaxed);
+    s.coalesced_ops = _coalescedOps.load(std::memory_order_relaxed);
+    s.last_batch_size = _lastBatchSize.load(std::memory_order_relaxed);
+    s.max_batch_size = _maxBatchSize.load(std::memory_order_relaxed);
+    s.last_flush_lag_us = _lastFlushLagUs.load(std::memory_order_relaxed);
+    s.max_flush_lag_us = _maxFlushLagUs.load(std::memory_order_relaxed);
+    s.flush_errors = _flushErrors.load(std::memory_order_relaxed);
+    s.backpressure_waits = _backpressureWaits.load(std::memory_order_relaxed);
+    s.rejected = _rejected.load(std::memory_order_relaxed);
+    s.sync_fallbacks = _syncFallbacks.load(std::memory_order_relaxed);
+    return s;
+}
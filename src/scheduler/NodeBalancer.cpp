@@ -0,0 +1,277 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "NodeBalancer.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    // FNV-1a：跨进程 / 跨版本稳定（多个网关实例必须对同一 key 给出同一节点，不能用 std::hash）
+    uint64_t fnv1a(std::string_view data, uint64_t h = 14695981039346656037ULL) noexcept
+    {
+        for (const char c : data)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // SplitMix64 终结器：把 key 与节点哈希混合成均匀分布的 64 位值
+    uint64_t mix(uint64_t x) noexcept
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+}
+
+std::optional<BalanceStrategy> parseBalanceStrategy(std::string_view name) noexcept
+{
+    if (name == "round_robin")return BalanceStrategy::RoundRobin;
+    if (name == "least_tasks")return BalanceStrategy::LeastTasks;
+    if (name == "weighted")return BalanceStrategy::Weighted;
+    if (name == "p2c" || name == "power_of_two")return BalanceStrategy::PowerOfTwo;
+    if (name == "consistent_hash")return BalanceStrategy::ConsistentHash;
+    return std::nullopt;
+}
+
+std::string_view balanceStrategyName(BalanceStrategy strategy) noexcept
+{
+    switch (strategy)
+    {
+    case BalanceStrategy::RoundRobin: return "round_robin";
+    case BalanceStrategy::LeastTasks: return "least_tasks";
+    case BalanceStrategy::Weighted: return "weighted";
+    case BalanceStrategy::PowerOfTwo: return "p2c";
+    case BalanceStrategy::ConsistentHash: return "consistent_hash";
+    }
+    return "unknown";
+}
+
+NodeBalancer::NodeBalancer(BalanceStrategy strategy, std::vector<NodeEndpoint> nodes, double load_factor)
+    : _strategy(strategy),
+      _nodes(std::move(nodes)),
+      _loadFactor(load_factor > 1.0 ? load_factor : 1.0),
+      _slots(std::make_unique<Slot[]>(_nodes.size()))
+{
+    _nodeHashes.reserve(_nodes.size());
+    for (const auto& node : _nodes)
+    {
+        _nodeHashes.push_back(fnv1a(node.toString()));
+        _totalWeight += static_cast<uint64_t>(std::max(node.weight, 1));
+    }
+}
+
+bool NodeBalancer::lighter(size_t a, uint64_t la, size_t b, uint64_t lb) const noexcept
+{
+    if (_strategy == BalanceStrategy::LeastTasks)
+    {
+        return la < lb;
+    }
+
+    // (la + 1) / wa < (lb + 1) / wb：+1 表示"再分配一个之后"，空载时大权重节点优先
+    const auto wa = static_cast<uint64_t>(std::max(_nodes[a].weight, 1));
+    const auto wb = static_cast<uint64_t>(std::max(_nodes[b].weight, 1));
+    return (la + 1) * wb < (lb + 1) * wa;
+}
+
+size_t NodeBalancer::nextRoundRobin(const std::vector<uint8_t>* eligible) noexcept
+{
+    const size_t n = _nodes.size();
+    const size_t start = _cursor.fetch_add(1, std::memory_order_relaxed) % n;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t candidate = start + i < n ? start + i : start + i - n;
+        if (usable(eligible, candidate))return candidate;
+    }
+    return start;
+}
+
+size_t NodeBalancer::scanLightest(const std::vector<uint8_t>* eligible) noexcept
+{
+    const size_t n = _nodes.size();
+    const size_t start = _cursor.fetch_add(1, std::memory_order_relaxed) % n;
+
+    size_t best = n;
+    uint64_t best_load = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t candidate = start + i < n ? start + i : start + i - n;
+        if (!usable(eligible, candidate))continue;
+
+        const uint64_t load = _slots[candidate].load.load(std::memory_order_relaxed);
+        if (best == n || lighter(candidate, load, best, best_load))
+        {
+            best = candidate;
+            best_load = load;
+        }
+    }
+    return best < n ? best : start;
+}
+
+size_t NodeBalancer::pickTwo(const std::vector<uint8_t>* eligible, size_t usable_count) const noexcept
+{
+    // 把第 rank 个可用节点映射回下标；全部可用时就是 rank 本身
+    auto nth = [&](size_t rank)
+    {
+        if (usable_count == _nodes.size())return rank;
+        for (size_t i = 0; i < _nodes.size(); ++i)
+        {
+            if (usable(eligible, i) && rank-- == 0)return i;
+        }
+        return size_t{0};
+    };
+
+    if (usable_count == 1)return nth(0);
+
+    // 线程局部引擎：无锁，且各线程的随机序列互不相关
+    thread_local std::minstd_rand gen(std::random_device{}());
+    const size_t ra = gen() % usable_count;
+    size_t rb = gen() % (usable_count - 1);
+    if (rb >= ra)++rb;
+
+    const size_t a = nth(ra);
+    const size_t b = nth(rb);
+
+    const uint64_t la = _slots[a].load.load(std::memory_order_relaxed);
+    const uint64_t lb = _slots[b].load.load(std::memory_order_relaxed);
+    return lighter(b, lb, a, la) ? b : a;
+}
+
+size_t NodeBalancer::pickByHash(std::string_view key, const std::vector<uint8_t>* eligible) const noexcept
+{
+    const size_t n = _nodes.size();
+    const uint64_t key_hash = fnv1a(key);
+
+    // 分配后的总负载；上限按 weight 缩放：cap_i = c * (total + 1) * w_i / W
+    // 被剔除节点的负载与权重都不计入，其份额由剩余节点按 weight 分摊
+    uint64_t total = 1;
+    uint64_t total_weight = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!usable(eligible, i))continue;
+        total += _slots[i].load.load(std::memory_order_relaxed);
+        total_weight += static_cast<uint64_t>(std::max(_nodes[i].weight, 1));
+    }
+    if (total_weight == 0)total_weight = _totalWeight;
+    const double per_weight = _loadFactor * static_cast<double>(total) / static_cast<double>(total_weight);
+
+    // 加权 rendezvous：score = -w / ln(u)，u ∈ (0,1) 由 (key, node) 唯一决定；
+    // 在未超上限的节点中取最高分，等价于按排名顺延。sum(cap) >= c * total > 现有负载，因此至少有一个节点可选
+    size_t best = n;
+    double best_score = 0;
+    size_t fallback = 0;
+    double fallback_score = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!usable(eligible, i))continue;
+
+        const uint64_t h = mix(key_hash ^ _nodeHashes[i]);
+        const double u = (static_cast<double>(h >> 11) + 0.5) * 0x1.0p-53;
+        const auto weight = static_cast<double>(std::max(_nodes[i].weight, 1));
+        const double score = -weight / std::log(u);
+
+        if (score > fallback_score)
+        {
+            fallback = i;
+            fallback_score = score;
+        }
+
+        const auto load = static_cast<double>(_slots[i].load.load(std::memory_order_relaxed));
+        if (load + 1 <= std::ceil(per_weight * weight) && score > best_score)
+        {
+            best = i;
+            best_score = score;
+        }
+    }
+
+    // 并发刷新导致全部超限时仍回到首选节点
+    return best < n ? best : fallback;
+}
+
+const NodeEndpoint* NodeBalancer::select(std::string_view key, const std::vector<uint8_t>* eligible) noexcept
+{
+    if (_nodes.empty())return nullptr;
+
+    size_t usable_count = _nodes.size();
+    if (eligible != nullptr)
+    {
+        usable_count = 0;
+        for (size_t i = 0; i < _nodes.size(); ++i)
+        {
+            usable_count += usable(eligible, i) ? 1 : 0;
+        }
+        // 全部被剔除：探测本身可能出了问题（网关侧网络抖动），宁可照常分配也不拒绝推流
+        if (usable_count == 0)
+        {
+            eligible = nullptr;
+            usable_count = _nodes.size();
+        }
+    }
+
+    size_t index;
+    switch (_strategy)
+    {
+    case BalanceStrategy::ConsistentHash:
+        index = key.empty() ? scanLightest(eligible) : pickByHash(key, eligible);
+        break;
+    case BalanceStrategy::LeastTasks:
+    case BalanceStrategy::Weighted:
+        index = scanLightest(eligible);
+        break;
+    case BalanceStrategy::PowerOfTwo:
+        index = pickTwo(eligible, usable_count);
+        break;
+    case BalanceStrategy::RoundRobin:
+    default:
+        index = nextRoundRobin(eligible);
+        break;
+    }
+
+    _slots[index].load.fetch_add(1, std::memory_order_relaxed);
+    return &_nodes[index];
+}
+
+void NodeBalancer::release(const NodeEndpoint* node) noexcept
+{
+    const auto it = std::ranges::find_if(_nodes, [node](const NodeEndpoint& n) { return &n == node; });
+    if (it == _nodes.end())return;
+
+    // 刷新线程可能已用快照覆盖计数（快照里没有这次分配），饱和到 0 而不是回绕
+    auto& load = _slots[static_cast<size_t>(it - _nodes.begin())].load;
+    uint64_t current = load.load(std::memory_order_relaxed);
+    while (current > 0 && !load.compare_exchange_weak(current, current - 1, std::memory_order_relaxed))
+    {
+    }
+}
+
+void NodeBalancer::updateLoads(const std::vector<NodeLoad>& loads)
+{
+    for (size_t i = 0; i < _nodes.size(); ++i)
+    {
+        uint64_t total = 0;
+        for (const auto& l : loads)
+        {
+            if (l.port == _nodes[i].port && l.host == _nodes[i].host)
+            {
+                total += l.publishers + l.players;
+            }
+        }
+        // 读取快照之后才完成的分配会在下一轮刷新中补上
+        _slots[i].load.store(total, std::memory_order_relaxed);
+    }
+}
+
+std::vector<uint64_t> NodeBalancer::loads() const
+{
+    std::vector<uint64_t> out(_nodes.size());
+    for (size_t i = 0; i < _nodes.size(); ++i)
+    {
+        out[i] = _slots[i].load.load(std::memory_order_relaxed);
+    }
+    return out;
+}
@@ -4,17 +4,50 @@
 #include "StreamTaskScheduler.h"
 #include "Logger.h"
 #include "EnumToString.h"
+#include "HookTrace.h"
 #include <thread>
 #include <chrono>
+#include <algorithm>
 #include <set>
 #include <utility>
 
 StreamTaskScheduler::StreamTaskScheduler(AuthManager& authMgr, IStreamStateManager& stateMgr, const NodeConfig& nodeCfg,
                                          Config cfg)
-    : _authManager(authMgr), _stateManager(stateMgr), _node_config(nodeCfg), _config(cfg)
+    : _authManager(authMgr), _stateManager(stateMgr), _config(cfg),
+      _topology(std::make_shared<NodeTopology>(nodeCfg, cfg))
 {
 }
 
+StreamTaskScheduler::NodeTopology::NodeTopology(const NodeConfig& nodes, const Config& cfg)
+    : fingerprint(nodes.fingerprint()),
+      rtmp(cfg.rtmp_srt_strategy, nodes.rtmp_srt, cfg.hash_load_factor),
+      http(cfg.http_hls_strategy, nodes.http_hls, cfg.hash_load_factor)
+{
+}
+
+void StreamTaskScheduler::updateNodes(const NodeConfig& nodes)
+{
+    auto next = std::make_shared<NodeTopology>(nodes, _config);
+    const auto previous = _topology.load(std::memory_order_acquire);
+
+    // 沿用旧负载表：下一轮刷新之前，新节点表不会把所有流都压到"看起来空闲"的老节点上
+    for (const auto& [from, to] : {std::pair{&previous->rtmp, &next->rtmp}, std::pair{&previous->http, &next->http}})
+    {
+        const auto loads = from->loads();
+        std::vector<NodeLoad> carried;
+        carried.reserve(loads.size());
+        for (size_t i = 0; i < loads.size(); ++i)
+        {
+            carried.push_back({from->nodes()[i].host, from->nodes()[i].port, loads[i], 0});
+        }
+        to->updateLoads(carried);
+    }
+
+    _topology.store(std::move(next), std::memory_order_release);
+    LOG_INFO("Scheduler: 节点表已更新, rtmp_srt=" + std::to_string(nodes.rtmp_srt.size()) +
+        " http_hls=" + std::to_string(nodes.http_hls.size()));
+}
+
 StreamTaskScheduler::~StreamTaskScheduler()
 {
     stop();
@@ -25,6 +58,15 @@ void StreamTaskScheduler::start()
     if (_running.exchange(true))return;
     _cleanup_thread = std::thread(&StreamTaskScheduler::timeoutCleanupThread, this);
     LOG_INFO("Scheduler: 清理线程已启动");
+
+    if (_config.rtmp_srt_strategy != BalanceStrategy::RoundRobin ||
+        _config.http_hls_strategy != BalanceStrategy::RoundRobin)
+    {
+        _load_refresh_thread = std::thread(&StreamTaskScheduler::loadRefreshThread, this);
+        LOG_INFO("Scheduler: 负载表刷新线程已启动, rtmp_srt=" +
+            std::string(balanceStrategyName(_config.rtmp_srt_strategy)) + " http_hls=" +
+            std::string(balanceStrategyName(_config.http_hls_strategy)));
+    }
 }
 
 void StreamTaskScheduler::stop()
@@ -36,12 +78,14 @@ void StreamTaskScheduler::stop()
     }
 
     if (_cleanup_thread.joinable())_cleanup_thread.join();
+    if (_load_refresh_thread.joinable())_load_refresh_thread.join();
     LOG_INFO("Scheduler: 已停止");
 }
 
 //推流逻辑
 void StreamTaskScheduler::onPublish(const std::string& stream_name, const std::string& client_id,
-                                    const std::string& auth_token, StreamProtocol protocol, SchedulerCallback callback)
+                                    const std::string& auth_token, StreamProtocol protocol, SchedulerCallback callback,
+                                    HookTrace* trace)
 {
     _totalPublishReq.fetch_add(1, std::memory_order_relaxed);
     if (!validateRequest(stream_name, client_id, auth_token, callback))return;
@@ -60,30 +104,42 @@ void StreamTaskScheduler::onPublish(const std::string& stream_name, const std::s
                     return;
                 }
 
-                auto [ip,port] = selectBestNode(protocol);
-                auto task = createTask(stream_name, client_id, auth_token, StreamType::PUBLISHER, protocol, ip, port);
+                // 注册被拒绝或抛出异常时，node 析构撤销本次计入的负载
+                auto node = selectBestNode(protocol, stream_name);
+                auto task = createTask(stream_name, client_id, auth_token, StreamType::PUBLISHER, protocol,
+                                       node.host(), node.port());
 
-                LOG_INFO("DEBUG: About to register task - stream: " + stream_name +
+                LOG_DEBUG("About to register task - stream: " + stream_name +
                     ", client: " + client_id +
                     ", task_id: " + std::to_string(task.task_id));
 
-                if (auto existing = _stateManager.getPublisherTask(stream_name))
+                // 原子化注册：由 StateManager 处理 "已存在" 冲突
+                bool registered;
                 {
-                    LOG_WARN("DEBUG: Publisher already exists! stream: " + stream_name +
-                        ", existing client: " + existing->client_id +
-                        ", existing task_id: " + std::to_string(existing->task_id));
+                    StageTimer timer(HookTrace::current(), HookStage::RegisterTask);
+                    registered = _stateManager.registerTask(task);
                 }
 
-                // 原子化注册：由 StateManager 处理 "已存在" 冲突
-                if (!_stateManager.registerTask(task))
+                if (!registered)
                 {
-                    LOG_ERROR("DEBUG: registerTask() returned false! stream: " + stream_name);
+                    // 仅在冲突时才去查现有推流者，成功路径不再多一次 Redis 往返
+                    if (auto existing = _stateManager.getPublisherTask(stream_name))
+                    {
+                        LOG_WARN("Publisher already exists! stream: " + stream_name +
+                            ", existing client: " + existing->client_id +
+                            ", existing task_id: " + std::to_string(existing->task_id));
+                    }
+                    else
+                    {
+                        LOG_WARN("registerTask() rejected stream: " + stream_name);
+                    }
 
                     if (callback)
                         callback({SchedulerResult::Error::ALREADY_PUBLISHING, std::nullopt, "该流已在推送中"});
                     return;
                 }
 
+                node.commit();
                 _successPub.fetch_add(1, std::memory_order_relaxed);
                 if (callback)
                     callback({SchedulerResult::Error::SUCCESS, task, "推流授权成功"});
@@ -100,16 +156,14 @@ void StreamTaskScheduler::onPublish(const std::string& stream_name, const std::s
                 if (callback)
                     callback({SchedulerResult::Error::INTERNAL_ERROR, std::nullopt, "Unknown error"});
             }
-        });
+        }, trace);
 }
 
 void StreamTaskScheduler::onPublishDone(const std::string& stream_name, const std::string& client_id) const
 {
     LOG_INFO("Scheduler: 收到推流结束回调 [Stream: " + stream_name + ", Client: " + client_id + "]");
 
-    auto task_opt = _stateManager.getTask(stream_name, client_id);
-
-    if (task_opt && task_opt->type == StreamType::PUBLISHER)
+    if (const auto pub = _stateManager.getPublisherLocation(stream_name); pub && pub->client_id == client_id)
     {
         LOG_INFO("Scheduler: 身份确认，执行联动清理...");
         _stateManager.deregisterAllMembers(stream_name);
@@ -122,7 +176,8 @@ void StreamTaskScheduler::onPublishDone(const std::string& stream_name, const st
 
 //播放逻辑
 void StreamTaskScheduler::onPlay(const std::string& stream_name, const std::string& client_id,
-                                 const std::string& auth_token, StreamProtocol protocol, SchedulerCallback callback)
+                                 const std::string& auth_token, StreamProtocol protocol, SchedulerCallback callback,
+                                 HookTrace* trace)
 {
     _totalPlayReq.fetch_add(1, std::memory_order_relaxed);
     if (!validateRequest(stream_name, client_id, auth_token, callback))return;
@@ -141,8 +196,24 @@ void StreamTaskScheduler::onPlay(const std::string& stream_name, const std::stri
                     return;
                 }
 
-                //反查推流端是否存在
-                auto pub = _stateManager.getPublisherTask(stream_name);
+                // 计时覆盖反查推流端 + 注册播放端，须在调用 callback 前结束
+                std::optional<PublisherLocation> pub;
+                std::optional<StreamTask> task;
+                bool registered = false;
+                {
+                    StageTimer timer(HookTrace::current(), HookStage::RegisterTask);
+
+                    //反查推流端是否存在（只读节点地址，不加载完整任务）
+                    pub = _stateManager.getPublisherLocation(stream_name);
+                    if (pub)
+                    {
+                        // 强行绑定到推流端所在的边缘节点 IP/Port
+                        task = createTask(stream_name, client_id, auth_token, StreamType::PLAYER, protocol,
+                                          pub->host, pub->port);
+                        registered = _stateManager.registerTask(*task);
+                    }
+                }
+
                 if (!pub)
                 {
                     if (callback)
@@ -150,11 +221,7 @@ void StreamTaskScheduler::onPlay(const std::string& stream_name, const std::stri
                     return;
                 }
 
-                // 强行绑定到推流端所在的边缘节点 IP/Port
-                auto task = createTask(stream_name, client_id, auth_token, StreamType::PLAYER, protocol, pub->server_ip,
-                                       pub->server_port);
-
-                if (!_stateManager.registerTask(task))
+                if (!registered)
                 {
                     if (callback)
                         callback({SchedulerResult::Error::STATE_STORE_ERROR, std::nullopt, "状态注册失败"});
@@ -177,7 +244,7 @@ void StreamTaskScheduler::onPlay(const std::string& stream_name, const std::stri
                 if (callback)
                     callback({SchedulerResult::Error::INTERNAL_ERROR, std::nullopt, "Unknown error"});
             }
-        });
+        }, trace);
 }
 
 void StreamTaskScheduler::onPlayDone(const std::string& stream_name, const std::string& client_id) const
@@ -187,63 +254,87 @@ void StreamTaskScheduler::onPlayDone(const std::string& stream_name, const std::
 }
 
 //辅助方法
-std::pair<std::string, int> StreamTaskScheduler::selectBestNode(StreamProtocol protocol)
+StreamTaskScheduler::NodeReservation StreamTaskScheduler::selectBestNode(StreamProtocol protocol,
+                                                                         const std::string& stream_name)
 {
-    const std::vector<NodeEndpoint>* nodes = nullptr;
-
     // 根据协议路由到不同的集群（RTMP/SRT vs HTTP/HLS）
-    if (protocol == StreamProtocol::RTMP || protocol == StreamProtocol::SRT)
-    {
-        nodes = &_node_config.rtmp_srt;
-    }
-    else
+    const bool rtmp = protocol == StreamProtocol::RTMP || protocol == StreamProtocol::SRT;
+    // 持有本次使用的节点表：热加载替换后旧表在最后一个读者结束时释放
+    const auto topology = _topology.load(std::memory_order_acquire);
+    NodeBalancer& balancer = rtmp ? topology->rtmp : topology->http;
+
+    // 健康快照是不可变对象，持有 shared_ptr 期间探测线程发布新快照也不影响本次读取
+    // 热加载期间两者可能短暂对应不同版本的 nodes.json，此时掩码下标无意义，不做过滤
+    std::shared_ptr<const NodeHealthSnapshot> health;
+    const std::vector<uint8_t>* eligible = nullptr;
+    if (_nodeHealth)
     {
-        nodes = &_node_config.http_hls;
+        health = _nodeHealth->snapshot();
+        if (health->topology == topology->fingerprint)
+        {
+            eligible = health->eligibleFor(rtmp ? NodeConfig::Category::RTMP_SRT : NodeConfig::Category::HTTP_HLS);
+        }
     }
 
-    if (!nodes || nodes->empty())return {"127.0.0.1", 1935};
+    // 只读进程内负载表，不访问 Redis
+    // stream_name 作为一致性哈希的放置键：同一流重连落回同一节点
+    const NodeEndpoint* node = balancer.select(stream_name, eligible);
+    return {topology, &balancer, node};
+}
+
+void StreamTaskScheduler::loadRefreshThread()
+{
+    while (_running.load())
+    {
+        try
+        {
+            const auto loads = _stateManager.getNodeLoads();
+            const auto topology = _topology.load(std::memory_order_acquire);
+            topology->rtmp.updateLoads(loads);
+            topology->http.updateLoads(loads);
+        }
+        catch (const std::exception& e)
+        {
+            // 保留上一轮的负载表，本地分配计数继续生效
+            LOG_WARN("Scheduler: 负载表刷新失败: " + std::string(e.what()));
+        }
 
-    // 简单的 Round-Robin 负载均衡
-    const auto& node = (*nodes)[_nodeIndex.fetch_add(1, std::memory_order_relaxed) % nodes->size()];
-    return {node.host, node.port};
+        std::unique_lock<std::mutex> lock(_cleanup_mutex);
+        if (_cleanup_cv.wait_for(lock, _config.load_refresh_interval, [this] { return !_running.load(); }))
+        {
+            break;
+        }
+    }
 }
 
 //辅助方法
 void StreamTaskScheduler::timeoutCleanupThread()
 {
+    using Clock = std::chrono::steady_clock;
+    const bool use_wheel = _config.expiry_tick.count() > 0;
+    auto next_sweep = Clock::now();
+    bool has_backlog = false;
+
     while (_running.load())
     {
         try
         {
-            //调用对齐后的毫秒级扫描接口
-            auto expired = _stateManager.scanTimeoutTasks(_config.task_timeout);
-
-            if (!expired.empty())
+            // 事件驱动：时间轮每个 tick 只交出已到期的任务，没有到期项时不访问存储
+            if (use_wheel)
             {
-                std::vector<TaskIdentifier> targets;
-                std::set<std::string> publisher_died_streams; //记录哪些流的主播挂了
-
-                for (const auto& t : expired)
-                {
-                    targets.push_back({t.stream_name, t.client_id, t.type});
-                    _tasksCleaned.fetch_add(1, std::memory_order_relaxed);
-
-                    if (t.type == StreamType::PUBLISHER)
-                    {
-                        publisher_died_streams.insert(t.stream_name);
-                    }
-                }
-
-                //高性能批量注销
-                _stateManager.deregisterTasksBatch(targets);
+                handleExpiredTasks(_stateManager.expireDueTasks(_config.task_timeout));
+            }
 
-                //联动清理：如果主播超时，清理该流所有成员
-                for (const auto& stream : publisher_died_streams)
-                {
-                    LOG_WARN("Scheduler: 主播超时 [" + stream + "]. 执行全员清场...");
-                    _stateManager.deregisterAllMembers(stream);
-                }
-                LOG_INFO("Scheduler: 自动回收了 " + std::to_string(targets.size()) + " 条超时任务");
+            // 全量扫描：兜底回收其它实例 / 进程重启前登记的任务
+            if (has_backlog || Clock::now() >= next_sweep)
+            {
+                //分页扫描：返回的任务已在存储侧注销，这里只负责统计与联动清场
+                const auto scan = _stateManager.scanTimeoutTasks(_config.task_timeout,
+                                                                 {_config.cleanup_page_size, _config.cleanup_time_budget});
+                _timeoutBacklog.store(scan.backlog, std::memory_order_relaxed);
+                has_backlog = scan.backlog > 0;
+                next_sweep = Clock::now() + _config.cleanup_interval;
+                handleExpiredTasks(scan);
             }
         }
         catch (const std::exception& e)
@@ -251,15 +342,70 @@ void StreamTaskScheduler::timeoutCleanupThread()
             LOG_ERROR("Scheduler: 清理任务循环异常: " + std::string(e.what()));
         }
 
-        // 使用 condition_variable 优雅休眠，支持即时唤醒停止
+        // 使用 condition_variable 优雅休眠，支持即时唤醒停止；有积压时只让出一个预算周期
+        auto pause = has_backlog
+                         ? _config.cleanup_time_budget
+                         : std::chrono::duration_cast<std::chrono::milliseconds>(next_sweep - Clock::now());
+        if (use_wheel)
+        {
+            pause = std::min(pause, _config.expiry_tick);
+        }
+        pause = std::max(pause, std::chrono::milliseconds(1));
+
         std::unique_lock<std::mutex> lock(_cleanup_mutex);
-        if (_cleanup_cv.wait_for(lock, _config.cleanup_interval, [this] { return !_running.load(); }))
+        if (_cleanup_cv.wait_for(lock, pause, [this] { return !_running.load(); }))
         {
             break;
         }
     }
 }
 
+void StreamTaskScheduler::handleExpiredTasks(const TimeoutScanResult& scan)
+{
+    if (scan.expired.empty())return;
+
+    std::set<std::string> publisher_died_streams; //记录哪些流的主播挂了
+    for (const auto& t : scan.expired)
+    {
+        if (t.type == StreamType::PUBLISHER)
+        {
+            publisher_died_streams.insert(t.stream_name);
+        }
+    }
+    _tasksCleaned.fetch_add(scan.expired.size(), std::memory_order_relaxed);
+
+    //联动清理：如果主播超时，清理该流所有成员
+    for (const auto& stream : publisher_died_streams)
+    {
+        LOG_WARN("Scheduler: 主播超时 [" + stream + "]. 执行全员清场...");
+        _stateManager.deregisterAllMembers(stream);
+    }
+    LOG_INFO("Scheduler: 自动回收了 " + std::to_string(scan.expired.size()) + " 条超时任务（" +
+        std::to_string(scan.pages) + " 批）");
+}
+
+void StreamTaskScheduler::onTaskExpired(const std::string& stream_name, const std::string& client_id)
+{
+    try
+    {
+        const auto task = _stateManager.reclaimExpiredTask(stream_name, client_id);
+        if (!task)return;
+
+        _keyspaceExpired.fetch_add(1, std::memory_order_relaxed);
+        _tasksCleaned.fetch_add(1, std::memory_order_relaxed);
+        if (task->type == StreamType::PUBLISHER)
+        {
+            LOG_WARN("Scheduler: 主播过期 [" + stream_name + "]. 执行全员清场...");
+            _stateManager.deregisterAllMembers(stream_name);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        // 索引留给对账扫描回收
+        LOG_ERROR("Scheduler: 处理过期通知失败 [" + stream_name + "/" + client_id + "]: " + e.what());
+    }
+}
+
 bool StreamTaskScheduler::validateRequest(const std::string& stream_name, const std::string& client_id,
                                           const std::string& auth_token, const SchedulerCallback& callback)
 {
@@ -308,6 +454,8 @@ StreamTaskScheduler::Metrics StreamTaskScheduler::getMetrics() const
     m.success_play = _successPlay.load(std::memory_order_relaxed);
     m.auth_failures = _authFail.load(std::memory_order_relaxed);
     m.tasks_cleaned = _tasksCleaned.load(std::memory_order_relaxed);
+    m.timeout_backlog = _timeoutBacklog.load(std::memory_order_relaxed);
+    m.keyspace_expired = _keyspaceExpired.load(std::memory_order_relaxed);
 
     return m;
 }
@@ -8,7 +8,7 @@ echo ""
 
 # 1. 获取当前metrics
 echo "1. 当前metrics内容:"
-curl -s http://localhost:9000/metrics | jq .
+curl -s http://localhost:9000/metrics.json | jq .
 echo ""
 
 # 2. 等待刷新
@@ -18,7 +18,7 @@ echo ""
 
 # 3. 再次获取
 echo "3. 刷新后的metrics:"
-curl -s http://localhost:9000/metrics | jq .
+curl -s http://localhost:9000/metrics.json | jq .
 echo ""
 
 # 4. 发送一些请求来触发统计
@@ -39,7 +39,7 @@ echo ""
 
 # 6. 检查是否有数据
 echo "6. 发送请求后的metrics:"
-METRICS=$(curl -s http://localhost:9000/metrics)
+METRICS=$(curl -s http://localhost:9000/metrics.json)
 echo "$METRICS" | jq .
 echo ""
 
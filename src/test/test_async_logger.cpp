@@ -0,0 +1,192 @@
+//
+// Unit test for AsyncLogBackend
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "AsyncLogBackend.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class AsyncLogBackendTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        _path = (std::filesystem::temp_directory_path() /
+            ("streamgate_async_log_" + std::to_string(::getpid()) + "_" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".log")).string();
+        std::filesystem::remove(_path);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(_path);
+    }
+
+    [[nodiscard]] AsyncLogBackend::Config makeConfig(size_t ring, LogOverflowPolicy policy) const
+    {
+        AsyncLogBackend::Config cfg;
+        cfg.ring_capacity = ring;
+        cfg.overflow_policy = policy;
+        cfg.to_console = false;
+        cfg.file_path = _path;
+        return cfg;
+    }
+
+    [[nodiscard]] std::vector<std::string> readLines() const
+    {
+        std::vector<std::string> lines;
+        std::ifstream in(_path);
+        for (std::string line; std::getline(in, line);)
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::string _path;
+};
+
+// 多线程写入，flush 后全部落盘，且同一线程内的顺序保持不变
+TEST_F(AsyncLogBackendTest, MultiThread_ShouldWriteEveryRecordInOrder)
+{
+    AsyncLogBackend backend(makeConfig(64, LogOverflowPolicy::Block));
+
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 2000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t)
+    {
+        producers.emplace_back([&backend, t]
+        {
+            for (int i = 0; i < kPerThread; ++i)
+            {
+                ASSERT_TRUE(backend.enqueue(LogLevel::INFO,
+                    "t" + std::to_string(t) + " seq=" + std::to_string(i), __FILE__, __LINE__));
+            }
+        });
+    }
+    for (auto& p : producers)p.join();
+    backend.flush();
+
+    const auto stats = backend.getStats();
+    EXPECT_EQ(stats.enqueued, static_cast<uint64_t>(kThreads * kPerThread));
+    EXPECT_EQ(stats.written, stats.enqueued);
+    EXPECT_EQ(stats.dropped, 0u);
+
+    const auto lines = readLines();
+    ASSERT_EQ(lines.size(), static_cast<size_t>(kThreads * kPerThread));
+
+    std::vector<int> next(kThreads, 0);
+    for (const auto& line : lines)
+    {
+        ASSERT_NE(line.find("[INFO ]"), std::string::npos) << line;
+        const auto pos = line.find("]t");
+        ASSERT_NE(pos, std::string::npos) << line;
+        const int t = line[pos + 2] - '0';
+        const int seq = std::stoi(line.substr(line.find("seq=") + 4));
+        ASSERT_EQ(seq, next[t]) << line;
+        ++next[t];
+    }
+}
+
+// Drop 策略：写满即丢弃并计数，写出 + 丢弃 == 提交总数
+TEST_F(AsyncLogBackendTest, DropPolicy_ShouldAccountForEveryRecord)
+{
+    auto cfg = makeConfig(4, LogOverflowPolicy::Drop);
+    cfg.flush_interval = std::chrono::milliseconds(500);
+    AsyncLogBackend backend(cfg);
+
+    constexpr int kTotal = 5000;
+    for (int i = 0; i < kTotal; ++i)
+    {
+        ASSERT_TRUE(backend.enqueue(LogLevel::WARNING, "burst " + std::to_string(i), __FILE__, __LINE__));
+    }
+    backend.flush();
+
+    const auto stats = backend.getStats();
+    EXPECT_EQ(stats.written + stats.dropped, static_cast<uint64_t>(kTotal));
+    EXPECT_EQ(stats.written, stats.enqueued);
+    EXPECT_EQ(stats.blocked, 0u);
+    EXPECT_EQ(readLines().size(), stats.written);
+}
+
+// Block 策略：缓冲区再小也不丢
+TEST_F(AsyncLogBackendTest, BlockPolicy_ShouldNeverDrop)
+{
+    AsyncLogBackend backend(makeConfig(2, LogOverflowPolicy::Block));
+
+    constexpr int kTotal = 3000;
+    for (int i = 0; i < kTotal; ++i)
+    {
+        ASSERT_TRUE(backend.enqueue(LogLevel::ERROR, "must keep " + std::to_string(i), __FILE__, __LINE__));
+    }
+    backend.stop();
+
+    const auto stats = backend.getStats();
+    EXPECT_FALSE(stats.enabled);
+    EXPECT_EQ(stats.dropped, 0u);
+    EXPECT_EQ(stats.written, static_cast<uint64_t>(kTotal));
+    EXPECT_EQ(readLines().size(), static_cast<size_t>(kTotal));
+
+    // 停止后拒绝入队，由调用方退回同步输出
+    EXPECT_FALSE(backend.enqueue(LogLevel::INFO, "late", __FILE__, __LINE__));
+}
+
+// 与 stop() 并发入队：返回 true 的记录必须写出（或计入丢弃），返回 false 的由调用方同步输出
+TEST_F(AsyncLogBackendTest, EnqueueDuringStop_ShouldNotLoseAcceptedRecords)
+{
+    for (int round = 0; round < 20; ++round)
+    {
+        auto cfg = makeConfig(1024, LogOverflowPolicy::Drop);
+        cfg.file_path.clear();
+        AsyncLogBackend backend(cfg);
+
+        constexpr int kThreads = 4;
+        std::atomic<uint64_t> accepted{0};
+        std::vector<std::thread> producers;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            producers.emplace_back([&backend, &accepted]
+            {
+                while (backend.enqueue(LogLevel::INFO, "racing", __FILE__, __LINE__))
+                {
+                    accepted.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        backend.stop();
+        for (auto& p : producers)p.join();
+
+        const auto stats = backend.getStats();
+        ASSERT_EQ(stats.written + stats.dropped, accepted.load()) << "round " << round;
+        ASSERT_EQ(stats.enqueued, stats.written) << "round " << round;
+    }
+}
+
+// 超长消息截断并标注
+TEST_F(AsyncLogBackendTest, LongMessage_ShouldBeTruncated)
+{
+    AsyncLogBackend backend(makeConfig(16, LogOverflowPolicy::Drop));
+    backend.enqueue(LogLevel::INFO, std::string(AsyncLogBackend::kTextCapacity * 2, 'x'), __FILE__, __LINE__);
+    backend.enqueue(LogLevel::INFO, "short", __FILE__, __LINE__);
+    backend.flush();
+
+    EXPECT_EQ(backend.getStats().truncated, 1u);
+    const auto lines = readLines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].find(std::string(AsyncLogBackend::kTextCapacity, 'x') + "...[truncated]"), std::string::npos);
+    EXPECT_EQ(lines[0].find(std::string(AsyncLogBackend::kTextCapacity + 1, 'x')), std::string::npos);
+    EXPECT_TRUE(lines[1].ends_with("]short"));
+}
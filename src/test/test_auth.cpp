@@ -343,6 +343,19 @@ std::atomic<bool> StreamGateIntegrationTest::initialized_{false};
 
 // ---------------------- Test Cases ----------------------
 
+// 负缓存标记只匹配被拒绝的那个 Token；旧版不带摘要的标记不匹配任何 Token
+TEST(AuthNegativeCacheTest, Marker_ShouldOnlyMatchRejectedToken)
+{
+    const auto marker = CacheManager::negativeAuthMarker("wrong_token");
+
+    EXPECT_TRUE(CacheManager::isNegativeAuthMarkerFor(marker, "wrong_token"));
+    EXPECT_FALSE(CacheManager::isNegativeAuthMarkerFor(marker, "valid_token"));
+    EXPECT_FALSE(CacheManager::isNegativeAuthMarkerFor(marker, ""));
+    EXPECT_FALSE(CacheManager::isNegativeAuthMarkerFor("__EMPTY__", "wrong_token"));
+    EXPECT_EQ(marker.find("wrong_token"), std::string::npos);
+    EXPECT_EQ(marker, CacheManager::negativeAuthMarker("wrong_token"));
+}
+
 TEST_F(StreamGateIntegrationTest, ValidPublish_ShouldSucceed)
 {
     auto [status, body] = send_hook_request(
@@ -362,6 +375,20 @@ TEST_F(StreamGateIntegrationTest, InvalidToken_ShouldReject)
         body.find("\"code\":1") != std::string::npos);
 }
 
+// 错误 Token 写下的负缓存不能拒掉同一 stream/client 的合法 Token
+TEST_F(StreamGateIntegrationTest, WrongTokenThenValidToken_ShouldSucceed)
+{
+    auto [bad_status, bad_body] = send_hook_request(
+        "on_publish", "live", test_stream_, test_client_, "wrong_token");
+    EXPECT_EQ(bad_status, 200);
+    EXPECT_TRUE(bad_body.find("\"code\":0") == std::string::npos);
+
+    auto [status, body] = send_hook_request(
+        "on_publish", "live", test_stream_, test_client_, test_token_);
+    EXPECT_EQ(status, 200);
+    EXPECT_TRUE(body.find("\"code\":0") != std::string::npos) << body;
+}
+
 TEST_F(StreamGateIntegrationTest, InvalidStream_ShouldReject)
 {
     auto [status, body] = send_hook_request(
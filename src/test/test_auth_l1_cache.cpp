@@ -0,0 +1,114 @@
+//
+// Unit test for AuthL1Cache (in-process SLRU auth cache)
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "AuthL1Cache.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace
+{
+    StreamAuthData makeData(const std::string& stream, const std::string& client, const std::string& token)
+    {
+        StreamAuthData d;
+        d.streamKey = stream;
+        d.clientId = client;
+        d.authToken = token;
+        d.isAuthorized = true;
+        return d;
+    }
+
+    AuthL1Cache::Config singleShard(size_t bytes)
+    {
+        AuthL1Cache::Config cfg;
+        cfg.capacity_bytes = bytes;
+        cfg.num_shards = 1;
+        return cfg;
+    }
+}
+
+TEST(AuthL1CacheTest, PositiveAndNegative_ShouldBeDistinguished)
+{
+    AuthL1Cache cache(AuthL1Cache::Config{});
+    StreamAuthData out;
+
+    EXPECT_EQ(cache.get("auth_data:live/a:c1", out), AuthL1Cache::Lookup::Miss);
+
+    cache.put("auth_data:live/a:c1", makeData("live/a", "c1", "t1"), std::chrono::seconds(10));
+    ASSERT_EQ(cache.get("auth_data:live/a:c1", out), AuthL1Cache::Lookup::Hit);
+    EXPECT_EQ(out.authToken, "t1");
+
+    cache.putNegative("auth_data:live/b:c1", "bad", std::chrono::seconds(10));
+    ASSERT_EQ(cache.get("auth_data:live/b:c1", out), AuthL1Cache::Lookup::NegativeHit);
+    EXPECT_EQ(out.authToken, "bad");
+
+    const auto stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.negative_hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+}
+
+TEST(AuthL1CacheTest, ExpiredEntry_ShouldMiss)
+{
+    AuthL1Cache cache(AuthL1Cache::Config{});
+    StreamAuthData out;
+
+    cache.put("k", makeData("s", "c", "t"), std::chrono::seconds(1));
+    ASSERT_EQ(cache.get("k", out), AuthL1Cache::Lookup::Hit);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_EQ(cache.get("k", out), AuthL1Cache::Lookup::Miss);
+
+    const auto stats = cache.getStats();
+    EXPECT_EQ(stats.expirations, 1u);
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+}
+
+// 字节预算必须被遵守，且被再次访问过的热点 key 不应被一次性扫描流量冲掉
+TEST(AuthL1CacheTest, ScanTraffic_ShouldNotEvictHotKey)
+{
+    AuthL1Cache cache(singleShard(8 * 1024));
+    StreamAuthData out;
+
+    cache.put("hot", makeData("s", "c", "t"), std::chrono::seconds(60));
+    ASSERT_EQ(cache.get("hot", out), AuthL1Cache::Lookup::Hit); // 晋升到 protected
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        const auto key = "scan_" + std::to_string(i);
+        cache.put(key, makeData(key, "c", "t"), std::chrono::seconds(60));
+    }
+
+    const auto stats = cache.getStats();
+    EXPECT_LE(stats.bytes, stats.capacity_bytes);
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_EQ(cache.get("hot", out), AuthL1Cache::Lookup::Hit);
+    EXPECT_EQ(cache.get("scan_0", out), AuthL1Cache::Lookup::Miss);
+}
+
+TEST(AuthL1CacheTest, OverwriteAndErase_ShouldKeepAccounting)
+{
+    AuthL1Cache cache(singleShard(64 * 1024));
+    StreamAuthData out;
+
+    cache.putNegative("k", "bad", std::chrono::seconds(10));
+    cache.put("k", makeData("s", "c", "good"), std::chrono::seconds(10));
+    ASSERT_EQ(cache.get("k", out), AuthL1Cache::Lookup::Hit);
+    EXPECT_EQ(out.authToken, "good");
+    EXPECT_EQ(cache.getStats().entries, 1u);
+
+    cache.erase("k");
+    EXPECT_EQ(cache.get("k", out), AuthL1Cache::Lookup::Miss);
+
+    const auto stats = cache.getStats();
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+}
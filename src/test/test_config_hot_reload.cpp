@@ -0,0 +1,217 @@
+//
+// Unit test for ConfigLoader snapshots / ConfigWatcher
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "ConfigLoader.h"
+#include "ConfigWatcher.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    class TempDir
+    {
+    public:
+        TempDir()
+        {
+            _path = fs::temp_directory_path() / ("streamgate_cfg_" + std::to_string(::getpid()) + "_" +
+                std::to_string(_counter++));
+            fs::create_directories(_path);
+        }
+
+        ~TempDir()
+        {
+            std::error_code ec;
+            fs::remove_all(_path, ec);
+        }
+
+        [[nodiscard]] std::string file(const std::string& name) const
+        {
+            return (_path / name).string();
+        }
+
+    private:
+        static inline std::atomic<int> _counter{0};
+        fs::path _path;
+    };
+
+    void writeFile(const std::string& path, const std::string& content)
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << content;
+    }
+
+    // 以 rename 方式原子替换（部署工具 / 编辑器的常见做法）
+    void replaceFile(const std::string& path, const std::string& content)
+    {
+        const std::string tmp = path + ".tmp";
+        writeFile(tmp, content);
+        fs::rename(tmp, path);
+    }
+
+    ConfigLoader::LoadOptions iniOnly()
+    {
+        ConfigLoader::LoadOptions opts;
+        opts.override_from_environment = false;
+        return opts;
+    }
+
+    template <typename Pred>
+    bool waitUntil(Pred pred, std::chrono::milliseconds timeout = std::chrono::milliseconds(3000))
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!pred())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+}
+
+// 预解析的类型化值与旧 getter 语义一致
+TEST(ConfigLoaderTest, TypedGetters_ShouldMatchLegacySemantics)
+{
+    TempDir dir;
+    const auto ini = dir.file("config.ini");
+    writeFile(ini, "PORT=8080\nRATIO=0.75\nFLAG=yes\nNAME=\"gate\"\nBAD_INT=abc\n");
+
+    auto& cfg = ConfigLoader::instance();
+    ASSERT_TRUE(cfg.load(ini, "", iniOnly()));
+
+    EXPECT_EQ(cfg.getInt("PORT"), 8080);
+    EXPECT_EQ(cfg.getInt("PORT", 1), 8080);
+    EXPECT_DOUBLE_EQ(cfg.getDouble("RATIO"), 0.75);
+    EXPECT_TRUE(cfg.getBool("FLAG"));
+    EXPECT_EQ(cfg.getString("NAME"), "gate");
+    EXPECT_EQ(cfg.getInt("BAD_INT", 7), 7);
+    EXPECT_EQ(cfg.getInt("MISSING", 3), 3);
+    EXPECT_TRUE(cfg.has("PORT"));
+    EXPECT_FALSE(cfg.has("MISSING"));
+    EXPECT_THROW((void)cfg.getInt("BAD_INT"), std::invalid_argument);
+    EXPECT_THROW((void)cfg.getString("MISSING"), ConfigException);
+
+    cfg.set("PORT", "9090");
+    EXPECT_EQ(cfg.getInt("PORT"), 9090);
+}
+
+// 重载失败保持旧快照；成功后所有读线程都能看到新值
+TEST(ConfigLoaderTest, Reload_ShouldPublishNewSnapshotToReaders)
+{
+    TempDir dir;
+    const auto ini = dir.file("config.ini");
+    writeFile(ini, "LEVEL=1\n");
+
+    auto& cfg = ConfigLoader::instance();
+    ASSERT_TRUE(cfg.load(ini, "", iniOnly()));
+    const auto old_snapshot = cfg.snapshot();
+    const uint64_t v1 = cfg.version();
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> observed_new{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back([&]
+        {
+            bool seen = false;
+            while (!stop.load())
+            {
+                const int level = cfg.getInt("LEVEL", -1);
+                ASSERT_TRUE(level == 1 || level == 2);
+                // 新值出现后不会再读回旧值
+                if (seen)
+                {
+                    ASSERT_EQ(level, 2);
+                }
+                if (level == 2 && !seen)
+                {
+                    seen = true;
+                    observed_new.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    fs::remove(ini);
+    EXPECT_FALSE(cfg.reload());
+    EXPECT_EQ(cfg.version(), v1);
+    EXPECT_EQ(cfg.getInt("LEVEL", -1), 1);
+
+    writeFile(ini, "LEVEL=2\n");
+    EXPECT_TRUE(cfg.reload());
+    EXPECT_GT(cfg.version(), v1);
+
+    EXPECT_TRUE(waitUntil([&] { return observed_new.load() == 4; }));
+    stop = true;
+    for (auto& t : readers)t.join();
+
+    // 旧快照仍可安全访问且内容不变
+    ASSERT_NE(old_snapshot->find("LEVEL"), nullptr);
+    EXPECT_EQ(old_snapshot->find("LEVEL")->text, "1");
+}
+
+// inotify：原地改写与 rename 替换都会触发；无关文件不触发
+TEST(ConfigWatcherTest, FileChange_ShouldTriggerCallback)
+{
+    TempDir dir;
+    const auto watched = dir.file("nodes.json");
+    writeFile(watched, "{}");
+
+    std::atomic<int> calls{0};
+    ConfigWatcher watcher(std::chrono::milliseconds(20));
+    watcher.watch(watched, [&] { calls.fetch_add(1); });
+    watcher.start();
+
+    writeFile(dir.file("other.json"), "{}");
+    writeFile(watched, "{\"a\":1}");
+    ASSERT_TRUE(waitUntil([&] { return calls.load() == 1; }));
+
+    replaceFile(watched, "{\"a\":2}");
+    ASSERT_TRUE(waitUntil([&] { return calls.load() == 2; }));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(calls.load(), 2);
+    EXPECT_EQ(watcher.reloadCount(), 2u);
+    watcher.stop();
+}
+
+// requestReload（SIGHUP 路径）触发全部回调；回调抛异常不影响后续重载
+TEST(ConfigWatcherTest, RequestReload_ShouldFireAllCallbacks)
+{
+    TempDir dir;
+    std::atomic<int> a{0};
+    std::atomic<int> failing{0};
+
+    ConfigWatcher watcher;
+    watcher.watch(dir.file("a.ini"), [&] { a.fetch_add(1); });
+    watcher.watch(dir.file("b.json"), [&]
+    {
+        failing.fetch_add(1);
+        throw std::runtime_error("parse error");
+    });
+    watcher.start();
+
+    watcher.requestReload();
+    ASSERT_TRUE(waitUntil([&] { return a.load() == 1 && failing.load() == 1; }));
+
+    watcher.requestReload();
+    ASSERT_TRUE(waitUntil([&] { return a.load() == 2 && failing.load() == 2; }));
+    EXPECT_EQ(watcher.reloadCount(), 2u);
+
+    watcher.stop();
+    watcher.stop();
+}
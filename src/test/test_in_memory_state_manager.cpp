@@ -0,0 +1,291 @@
+//
+// Unit test for InMemoryStreamStateManager
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "InMemoryStreamStateManager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    namespace fs = std::filesystem;
+    using namespace std::chrono_literals;
+
+    class TempDir
+    {
+    public:
+        TempDir()
+        {
+            _path = fs::temp_directory_path() / ("streamgate_state_" + std::to_string(::getpid()) + "_" +
+                std::to_string(_counter++));
+            fs::create_directories(_path);
+        }
+
+        ~TempDir()
+        {
+            std::error_code ec;
+            fs::remove_all(_path, ec);
+        }
+
+        [[nodiscard]] const fs::path& path() const
+        {
+            return _path;
+        }
+
+    private:
+        static inline std::atomic<int> _counter{0};
+        fs::path _path;
+    };
+
+    StreamTask makeTask(const std::string& stream, const std::string& client, StreamType type,
+                        const std::string& ip = "10.0.0.1", int port = 1935)
+    {
+        StreamTask task;
+        task.stream_name = stream;
+        task.client_id = client;
+        task.type = type;
+        task.state = StreamState::ACTIVE;
+        task.protocol = StreamProtocol::RTMP;
+        task.server_ip = ip;
+        task.server_port = port;
+        task.start_time = std::chrono::system_clock::now();
+        task.user_id = "user_" + client;
+        return task;
+    }
+
+    InMemoryStreamStateManager::Config persistentConfig(const fs::path& dir)
+    {
+        InMemoryStreamStateManager::Config cfg;
+        cfg.shards = 4;
+        cfg.data_dir = dir.string();
+        cfg.journal_flush_interval = 5ms;
+        cfg.snapshot_interval = std::chrono::hours(1); // 测试中手动触发快照
+        return cfg;
+    }
+
+    // 等后台线程把 journal 缓冲写出
+    void waitForJournal(const InMemoryStreamStateManager& mgr, uint64_t min_journal_bytes)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + 2s;
+        while (mgr.persistenceStats().journal_bytes < min_journal_bytes &&
+            std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(5ms);
+        }
+        std::this_thread::sleep_for(20ms);
+    }
+
+    // 拷走数据目录：相当于在此刻崩溃（不走析构里的停机快照）
+    void copyDir(const fs::path& from, const fs::path& to)
+    {
+        fs::copy(from, to, fs::copy_options::recursive | fs::copy_options::overwrite_existing);
+    }
+
+    std::vector<std::string> sorted(std::vector<std::string> v)
+    {
+        std::ranges::sort(v);
+        return v;
+    }
+
+    fs::path latestJournal(const fs::path& dir)
+    {
+        fs::path latest;
+        for (const auto& file : fs::directory_iterator(dir))
+        {
+            if (file.path().filename().string().starts_with("state.journal.") &&
+                (latest.empty() || file.path().filename().string() > latest.filename().string()))
+            {
+                latest = file.path();
+            }
+        }
+        return latest;
+    }
+}
+
+// 推流位冲突拒绝，同 client 重复注册幂等，计数随之变化
+TEST(InMemoryStreamStateManagerTest, Register_ShouldEnforcePublisherSlotAndCount)
+{
+    InMemoryStreamStateManager mgr;
+
+    EXPECT_TRUE(mgr.registerTask(makeTask("live", "pub1", StreamType::PUBLISHER)));
+    EXPECT_FALSE(mgr.registerTask(makeTask("live", "pub2", StreamType::PUBLISHER)));
+    EXPECT_TRUE(mgr.registerTask(makeTask("live", "pub1", StreamType::PUBLISHER)));
+    EXPECT_TRUE(mgr.registerTask(makeTask("live", "p1", StreamType::PLAYER)));
+    EXPECT_TRUE(mgr.registerTask(makeTask("live", "p2", StreamType::PLAYER)));
+    EXPECT_TRUE(mgr.registerTask(makeTask("live", "p2", StreamType::PLAYER)));
+
+    EXPECT_EQ(mgr.getActivePublisherCount(), 1u);
+    EXPECT_EQ(mgr.getActivePlayerCount(), 2u);
+    EXPECT_EQ(mgr.getPlayerCount("live"), 2u);
+    EXPECT_EQ(mgr.getPlayerCount("other"), 0u);
+    EXPECT_EQ(sorted(mgr.getStreamClientIds("live")), (std::vector<std::string>{"p1", "p2", "pub1"}));
+
+    const auto pub = mgr.getPublisherTask("live");
+    ASSERT_TRUE(pub.has_value());
+    EXPECT_EQ(pub->client_id, "pub1");
+    const auto location = mgr.getPublisherLocation("live");
+    ASSERT_TRUE(location.has_value());
+    EXPECT_EQ(location->client_id, "pub1");
+    EXPECT_EQ(location->host, pub->server_ip);
+    EXPECT_EQ(location->port, pub->server_port);
+
+    EXPECT_TRUE(mgr.deregisterTask("live", "pub1"));
+    EXPECT_FALSE(mgr.getPublisherTask("live").has_value());
+    EXPECT_FALSE(mgr.getPublisherLocation("live").has_value());
+    EXPECT_EQ(mgr.getActivePublisherCount(), 0u);
+    EXPECT_EQ(mgr.getPlayerCount("live"), 2u);
+    EXPECT_TRUE(mgr.registerTask(makeTask("live", "pub2", StreamType::PUBLISHER)));
+
+    mgr.deregisterAllMembers("live");
+    EXPECT_EQ(mgr.getActivePublisherCount(), 0u);
+    EXPECT_EQ(mgr.getActivePlayerCount(), 0u);
+    EXPECT_TRUE(mgr.getStreamClientIds("live").empty());
+    EXPECT_FALSE(mgr.touchTask("live", "p1"));
+}
+
+TEST(InMemoryStreamStateManagerTest, GetNodeLoads_ShouldAggregateByPublisherNode)
+{
+    InMemoryStreamStateManager mgr;
+    mgr.registerTask(makeTask("a", "pa", StreamType::PUBLISHER, "10.0.0.1", 1935));
+    mgr.registerTask(makeTask("b", "pb", StreamType::PUBLISHER, "10.0.0.1", 1935));
+    mgr.registerTask(makeTask("c", "pc", StreamType::PUBLISHER, "10.0.0.2", 1935));
+    mgr.registerTask(makeTask("a", "x1", StreamType::PLAYER));
+    mgr.registerTask(makeTask("a", "x2", StreamType::PLAYER));
+    mgr.registerTask(makeTask("c", "x3", StreamType::PLAYER));
+
+    auto loads = mgr.getNodeLoads();
+    std::ranges::sort(loads, {}, &NodeLoad::host);
+    ASSERT_EQ(loads.size(), 2u);
+    EXPECT_EQ(loads[0].host, "10.0.0.1");
+    EXPECT_EQ(loads[0].publishers, 2u);
+    EXPECT_EQ(loads[0].players, 2u);
+    EXPECT_EQ(loads[1].publishers, 1u);
+    EXPECT_EQ(loads[1].players, 1u);
+    EXPECT_EQ(mgr.getAllPublisherTasks().size(), 3u);
+}
+
+// 扫描返回的任务已注销；未超时的任务保留
+TEST(InMemoryStreamStateManagerTest, ScanTimeout_ShouldReturnDeregisteredTasks)
+{
+    InMemoryStreamStateManager mgr;
+    mgr.registerTask(makeTask("live", "pub", StreamType::PUBLISHER));
+    mgr.registerTask(makeTask("live", "p1", StreamType::PLAYER));
+
+    EXPECT_TRUE(mgr.scanTimeoutTasks(std::chrono::hours(1), TimeoutScanOptions{}).expired.empty());
+
+    std::this_thread::sleep_for(5ms);
+    const auto result = mgr.scanTimeoutTasks(0ms, TimeoutScanOptions{});
+    EXPECT_EQ(result.expired.size(), 2u);
+    EXPECT_EQ(result.backlog, 0u);
+    EXPECT_EQ(mgr.getActivePublisherCount(), 0u);
+    EXPECT_EQ(mgr.getActivePlayerCount(), 0u);
+    EXPECT_FALSE(mgr.getTask("live", "p1").has_value());
+}
+
+TEST(InMemoryStreamStateManagerTest, ExpireDueTasks_ShouldSkipRefreshedTasks)
+{
+    InMemoryStreamStateManager mgr;
+    mgr.enableLocalExpiry(30ms, 5ms);
+    mgr.registerTask(makeTask("live", "idle", StreamType::PLAYER));
+    mgr.registerTask(makeTask("live", "busy", StreamType::PLAYER));
+
+    std::vector<std::string> expired;
+    const auto deadline = std::chrono::steady_clock::now() + 200ms;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        EXPECT_TRUE(mgr.touchTask("live", "busy"));
+        for (const auto& task : mgr.expireDueTasks(30ms).expired)
+        {
+            expired.push_back(task.client_id);
+        }
+        std::this_thread::sleep_for(5ms);
+    }
+
+    EXPECT_EQ(expired, (std::vector<std::string>{"idle"}));
+    EXPECT_TRUE(mgr.getTask("live", "busy").has_value());
+    EXPECT_EQ(mgr.getActivePlayerCount(), 1u);
+}
+
+// 快照 + 其后的 journal 重放：崩溃前最后写出的状态全部恢复
+TEST(InMemoryStreamStateManagerTest, Recover_ShouldReplaySnapshotAndJournal)
+{
+    TempDir live;
+    TempDir crashed;
+    {
+        InMemoryStreamStateManager mgr(persistentConfig(live.path()));
+        mgr.registerTask(makeTask("a", "pa", StreamType::PUBLISHER));
+        mgr.registerTask(makeTask("a", "x1", StreamType::PLAYER));
+        mgr.registerTask(makeTask("a", "x2", StreamType::PLAYER));
+        mgr.registerTask(makeTask("b", "pb", StreamType::PUBLISHER, "10.0.0.2", 1936));
+        ASSERT_TRUE(mgr.snapshot());
+
+        // 快照之后的变更只在 journal 中
+        mgr.deregisterTask("a", "x1");
+        mgr.deregisterAllMembers("b");
+        mgr.registerTask(makeTask("c", "pc", StreamType::PUBLISHER));
+        ASSERT_TRUE(mgr.touchTask("a", "x2"));
+        const auto touched = mgr.getTask("a", "x2")->last_active_time;
+
+        waitForJournal(mgr, 1);
+        copyDir(live.path(), crashed.path());
+
+        InMemoryStreamStateManager recovered(persistentConfig(crashed.path()));
+        EXPECT_EQ(recovered.persistenceStats().recovered_tasks, 3u);
+        EXPECT_EQ(recovered.getActivePublisherCount(), 2u);
+        EXPECT_EQ(recovered.getActivePlayerCount(), 1u);
+        EXPECT_EQ(sorted(recovered.getStreamClientIds("a")), (std::vector<std::string>{"pa", "x2"}));
+        EXPECT_TRUE(recovered.getStreamClientIds("b").empty());
+        ASSERT_TRUE(recovered.getPublisherTask("c").has_value());
+
+        const auto x2 = recovered.getTask("a", "x2");
+        ASSERT_TRUE(x2.has_value());
+        EXPECT_EQ(x2->user_id, "user_x2");
+        EXPECT_EQ(x2->protocol, StreamProtocol::RTMP);
+        EXPECT_EQ(std::chrono::duration_cast<std::chrono::milliseconds>(x2->last_active_time.time_since_epoch()),
+                  std::chrono::duration_cast<std::chrono::milliseconds>(touched.time_since_epoch()));
+    }
+
+    // 正常停机后只剩快照
+    InMemoryStreamStateManager reopened(persistentConfig(live.path()));
+    EXPECT_EQ(reopened.getActivePublisherCount(), 2u);
+    EXPECT_EQ(reopened.getActivePlayerCount(), 1u);
+}
+
+// 崩溃时写了一半的尾部记录被忽略，之前的记录照常恢复
+TEST(InMemoryStreamStateManagerTest, Recover_ShouldIgnoreTornJournalTail)
+{
+    TempDir live;
+    TempDir crashed;
+    {
+        InMemoryStreamStateManager mgr(persistentConfig(live.path()));
+        mgr.registerTask(makeTask("a", "pa", StreamType::PUBLISHER));
+        mgr.registerTask(makeTask("a", "x1", StreamType::PLAYER));
+        waitForJournal(mgr, 1);
+        copyDir(live.path(), crashed.path());
+    }
+
+    const fs::path journal = latestJournal(crashed.path());
+    ASSERT_FALSE(journal.empty());
+    {
+        std::ofstream out(journal, std::ios::binary | std::ios::app);
+        out.write("\x40\x00\x00\x00\x12\x34", 6);
+    }
+
+    InMemoryStreamStateManager recovered(persistentConfig(crashed.path()));
+    EXPECT_EQ(recovered.getActivePublisherCount(), 1u);
+    EXPECT_EQ(recovered.getActivePlayerCount(), 1u);
+
+    // 恢复后继续写入新一代 journal，不受旧文件尾部影响
+    EXPECT_TRUE(recovered.registerTask(makeTask("a", "x2", StreamType::PLAYER)));
+    EXPECT_NE(latestJournal(crashed.path()), journal);
+}
@@ -0,0 +1,162 @@
+//
+// Unit test for LatencyHistogramRegistry / HookTrace / LatencyMetricsProvider
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "HookTrace.h"
+#include "LatencyMetricsProvider.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    uint64_t countOf(HookAction action, HookStage stage)
+    {
+        return LatencyHistogramRegistry::instance().snapshot().at(action, stage).count;
+    }
+}
+
+// 分桶：下界单调、值落在自身桶内，相对误差不超过 1/32
+TEST(LatencyHistogramTest, Buckets_ShouldBoundRelativeError)
+{
+    for (uint64_t v : {0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 123456ull, 987654321ull, (1ull << 35) + 7})
+    {
+        const size_t index = LatencyBuckets::indexOf(v);
+        ASSERT_LT(index, LatencyBuckets::kBucketCount);
+        EXPECT_LE(LatencyBuckets::lowerBound(index), v);
+        EXPECT_GT(LatencyBuckets::lowerBound(index) + LatencyBuckets::width(index), v);
+        EXPECT_LE(static_cast<double>(LatencyBuckets::width(index)),
+                  static_cast<double>(std::max<uint64_t>(v, 32)) / 32.0 + 1e-9);
+    }
+
+    for (size_t i = 1; i < LatencyBuckets::kBucketCount; ++i)
+    {
+        ASSERT_EQ(LatencyBuckets::lowerBound(i), LatencyBuckets::lowerBound(i - 1) + LatencyBuckets::width(i - 1));
+    }
+
+    // 超出量程计入最后一个桶
+    EXPECT_EQ(LatencyBuckets::indexOf(~uint64_t{0}), LatencyBuckets::kBucketCount - 1);
+}
+
+// 均匀分布 1us..100us：分位数误差在桶宽一半以内
+TEST(LatencyHistogramTest, Percentile_ShouldMatchUniformDistribution)
+{
+    LatencyHistogramData data;
+    data.buckets.assign(LatencyBuckets::kBucketCount, 0);
+    for (uint64_t v = 1000; v <= 100000; ++v)
+    {
+        ++data.buckets[LatencyBuckets::indexOf(v)];
+        ++data.count;
+        data.sum_ns += v;
+    }
+
+    for (double q : {0.5, 0.9, 0.99, 0.999})
+    {
+        const double expected = 1000.0 + q * 99000.0;
+        EXPECT_NEAR(static_cast<double>(data.percentile(q)), expected, expected / 32.0) << "q=" << q;
+    }
+
+    // 窗口增量：减去自身得到空窗口
+    LatencyHistogramData window = data;
+    window.subtract(data);
+    EXPECT_EQ(window.count, 0u);
+    EXPECT_EQ(window.percentile(0.99), 0u);
+}
+
+// 多线程并发记录 + 并发汇总；线程退出后计数并入历史，不丢不重
+TEST(LatencyHistogramTest, ConcurrentRecord_ShouldSurviveThreadExit)
+{
+    auto& reg = LatencyHistogramRegistry::instance();
+    const uint64_t before = countOf(HookAction::StreamNotFound, HookStage::AuthDb);
+
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 20000;
+
+    std::atomic<bool> done{false};
+    std::thread reader([&reg, &done]
+    {
+        uint64_t last = 0;
+        while (!done.load())
+        {
+            const uint64_t now = reg.snapshot().at(HookAction::StreamNotFound, HookStage::AuthDb).count;
+            EXPECT_GE(now, last); // 汇总值单调不回退
+            last = now;
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; ++t)
+    {
+        writers.emplace_back([&reg, t]
+        {
+            for (int i = 0; i < kPerThread; ++i)
+            {
+                reg.record(HookAction::StreamNotFound, HookStage::AuthDb, static_cast<uint64_t>(1000 + t * 100 + i));
+            }
+        });
+    }
+    for (auto& w : writers)w.join();
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(countOf(HookAction::StreamNotFound, HookStage::AuthDb) - before,
+              static_cast<uint64_t>(kThreads * kPerThread));
+}
+
+// StageTimer：空 trace 不记录；非空 trace 按 trace 的 action 记录一次，stop 后析构不重复记录
+TEST(LatencyHistogramTest, StageTimer_ShouldRecordOncePerTrace)
+{
+    const uint64_t before = countOf(HookAction::PlayDone, HookStage::RegisterTask);
+
+    {
+        StageTimer timer(nullptr, HookStage::RegisterTask);
+    }
+    EXPECT_EQ(countOf(HookAction::PlayDone, HookStage::RegisterTask), before);
+
+    HookTrace trace;
+    trace.reset(HookAction::PlayDone, HookTrace::Clock::now());
+    {
+        StageTimer timer(&trace, HookStage::RegisterTask);
+        timer.stop();
+    }
+    EXPECT_EQ(countOf(HookAction::PlayDone, HookStage::RegisterTask), before + 1);
+
+    // Scope 只在作用域内暴露 current()
+    EXPECT_EQ(HookTrace::current(), nullptr);
+    {
+        HookTrace::Scope scope(&trace);
+        EXPECT_EQ(HookTrace::current(), &trace);
+    }
+    EXPECT_EQ(HookTrace::current(), nullptr);
+}
+
+// Provider：以 summary 导出出现过样本的 (action, stage)
+TEST(LatencyHistogramTest, Provider_ShouldExportSummary)
+{
+    auto& reg = LatencyHistogramRegistry::instance();
+    for (int i = 0; i < 100; ++i)
+    {
+        reg.record(HookAction::PublishDone, HookStage::JsonParse, 2000);
+    }
+
+    LatencyMetricsProvider provider;
+    provider.refresh();
+    const auto snap = provider.exportSnapshot();
+    ASSERT_TRUE(snap);
+
+    const std::string& text = snap->exposition;
+    EXPECT_NE(text.find("# TYPE streamgate_hook_stage_latency_seconds summary"), std::string::npos);
+    EXPECT_NE(text.find(R"(streamgate_hook_stage_latency_seconds{action="publish_done",stage="json_parse",quantile="0.99"})"),
+              std::string::npos);
+    EXPECT_NE(text.find(R"(streamgate_hook_stage_latency_seconds_count{action="publish_done",stage="json_parse"})"),
+              std::string::npos);
+
+    const auto& stage = snap->json["actions"]["publish_done"]["json_parse"];
+    EXPECT_GE(stage["count"].get<uint64_t>(), 100u);
+    EXPECT_NEAR(stage["p50_us"].get<double>(), 2.0, 2.0 / 32.0);
+}
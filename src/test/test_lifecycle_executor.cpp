@@ -0,0 +1,108 @@
+//
+// Unit test for LifecycleExecutor
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "LifecycleExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 同一 ordering_key 的事件必须按提交顺序执行
+TEST(LifecycleExecutorTest, SameKey_ShouldPreserveOrder)
+{
+    LifecycleExecutor executor({4, 0});
+
+    constexpr int kStreams = 8;
+    constexpr int kEventsPerStream = 500;
+
+    std::mutex mtx;
+    std::unordered_map<std::string, std::vector<int>> observed;
+
+    for (int i = 0; i < kEventsPerStream; ++i)
+    {
+        for (int s = 0; s < kStreams; ++s)
+        {
+            std::string key = "live/stream_" + std::to_string(s);
+            ASSERT_TRUE(executor.submit(key, [&mtx, &observed, key, i]
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                observed[key].push_back(i);
+            }));
+        }
+    }
+
+    executor.stop_and_wait();
+
+    ASSERT_EQ(observed.size(), static_cast<size_t>(kStreams));
+    for (const auto& [key, seq] : observed)
+    {
+        ASSERT_EQ(seq.size(), static_cast<size_t>(kEventsPerStream)) << key;
+        for (int i = 0; i < kEventsPerStream; ++i)
+        {
+            EXPECT_EQ(seq[i], i) << key;
+        }
+    }
+}
+
+// 停机时必须排空已入队事件，停机后拒绝新事件
+TEST(LifecycleExecutorTest, StopAndWait_ShouldDrainThenReject)
+{
+    LifecycleExecutor executor({2, 0});
+    std::atomic<int> done{0};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_TRUE(executor.submit("key_" + std::to_string(i % 7), [&done]
+        {
+            done.fetch_add(1, std::memory_order_relaxed);
+        }));
+    }
+
+    executor.stop_and_wait();
+    EXPECT_EQ(done.load(), 1000);
+
+    LifecycleExecutor::Task late = [&done] { done.fetch_add(1); };
+    EXPECT_FALSE(executor.submit("key_0", std::move(late)));
+    // 拒绝时 task 不会被移走，调用方可以同步兜底
+    ASSERT_TRUE(late);
+
+    const auto stats = executor.get_stats();
+    EXPECT_EQ(stats.completed_tasks, 1000u);
+    EXPECT_EQ(stats.rejected_tasks, 1u);
+    EXPECT_EQ(stats.queue_depth, 0u);
+}
+
+// Lane 满时应拒绝并计数，而不是无限堆积
+TEST(LifecycleExecutorTest, FullLane_ShouldReject)
+{
+    LifecycleExecutor executor({1, 2});
+    std::atomic<bool> release{false};
+
+    // 第一个事件阻塞 Lane 线程，后续事件只能堆积
+    ASSERT_TRUE(executor.submit("k", [&release]
+    {
+        while (!release.load())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_TRUE(executor.submit("k", [] {}));
+    EXPECT_TRUE(executor.submit("k", [] {}));
+    EXPECT_FALSE(executor.submit("k", [] {}));
+
+    release.store(true);
+    executor.stop_and_wait();
+
+    const auto stats = executor.get_stats();
+    EXPECT_EQ(stats.completed_tasks, 3u);
+    EXPECT_EQ(stats.rejected_tasks, 1u);
+}
@@ -46,9 +46,9 @@ else
     exit 1
 fi
 
-# 测试1: /metrics 端点响应
-test_case "测试 /metrics 端点"
-METRICS=$(curl -s http://localhost:9000/metrics)
+# 测试1: /metrics.json 端点响应
+test_case "测试 /metrics.json 端点"
+METRICS=$(curl -s http://localhost:9000/metrics.json)
 if [ $? -eq 0 ]; then
     echo "响应成功"
     echo "$METRICS" | jq . 2>/dev/null
@@ -58,7 +58,7 @@ if [ $? -eq 0 ]; then
         fail "响应格式不正确"
     fi
 else
-    fail "无法连接到 /metrics 端点"
+    fail "无法连接到 /metrics.json 端点"
 fi
 
 # 测试2: /health 端点响应
@@ -89,7 +89,7 @@ sleep 2
 
 # 测试4: 验证server_metrics是否有数据
 test_case "验证 server_metrics 是否有数据"
-METRICS=$(curl -s http://localhost:9000/metrics)
+METRICS=$(curl -s http://localhost:9000/metrics.json)
 SERVER_METRICS=$(echo "$METRICS" | jq -r '.components.server_metrics')
 echo "server_metrics: $SERVER_METRICS"
 
@@ -180,9 +180,9 @@ fi
 # 测试9: 快照一致性
 test_case "快照一致性测试"
 echo "快速连续获取3次metrics，检查是否一致..."
-M1=$(curl -s http://localhost:9000/metrics | jq -r '.timestamp')
-M2=$(curl -s http://localhost:9000/metrics | jq -r '.timestamp')
-M3=$(curl -s http://localhost:9000/metrics | jq -r '.timestamp')
+M1=$(curl -s http://localhost:9000/metrics.json | jq -r '.timestamp')
+M2=$(curl -s http://localhost:9000/metrics.json | jq -r '.timestamp')
+M3=$(curl -s http://localhost:9000/metrics.json | jq -r '.timestamp')
 
 echo "时间戳1: $M1"
 echo "时间戳2: $M2"
@@ -198,7 +198,7 @@ fi
 
 # 测试10: 验证Provider名称排序
 test_case "验证Provider按名称排序"
-PROVIDERS=$(curl -s http://localhost:9000/metrics | jq -r '.components | keys | .[]')
+PROVIDERS=$(curl -s http://localhost:9000/metrics.json | jq -r '.components | keys | .[]')
 echo "Provider顺序:"
 echo "$PROVIDERS"
 
@@ -215,6 +215,19 @@ else
     pass
 fi
 
+# 测试11: Prometheus 文本格式
+test_case "验证 /metrics Prometheus 文本格式"
+CONTENT_TYPE=$(curl -s -o /dev/null -w '%{content_type}' http://localhost:9000/metrics)
+PROM=$(curl -s http://localhost:9000/metrics)
+echo "Content-Type: $CONTENT_TYPE"
+echo "$PROM" | head -10
+
+if [[ "$CONTENT_TYPE" == text/plain* ]] && echo "$PROM" | grep -q '^streamgate_requests_total [0-9]'; then
+    pass
+else
+    fail "/metrics 不是 Prometheus 文本格式或缺少 streamgate_requests_total"
+fi
+
 # 总结
 echo "========================================="
 echo "测试总结"
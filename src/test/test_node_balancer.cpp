@@ -0,0 +1,206 @@
+//
+// Unit test for NodeBalancer
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "NodeBalancer.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::vector<NodeEndpoint> makeNodes(std::initializer_list<int> weights)
+    {
+        std::vector<NodeEndpoint> nodes;
+        int i = 0;
+        for (int w : weights)
+        {
+            nodes.push_back({"10.0.0." + std::to_string(++i), 1935, w});
+        }
+        return nodes;
+    }
+
+    size_t indexOf(const NodeBalancer& balancer, const NodeEndpoint* node)
+    {
+        return static_cast<size_t>(node - balancer.nodes().data());
+    }
+}
+
+TEST(NodeBalancerTest, ParseStrategy_ShouldAcceptConfigNames)
+{
+    EXPECT_EQ(parseBalanceStrategy("round_robin"), BalanceStrategy::RoundRobin);
+    EXPECT_EQ(parseBalanceStrategy("least_tasks"), BalanceStrategy::LeastTasks);
+    EXPECT_EQ(parseBalanceStrategy("weighted"), BalanceStrategy::Weighted);
+    EXPECT_EQ(parseBalanceStrategy("p2c"), BalanceStrategy::PowerOfTwo);
+    EXPECT_FALSE(parseBalanceStrategy("random").has_value());
+    EXPECT_EQ(balanceStrategyName(BalanceStrategy::PowerOfTwo), "p2c");
+}
+
+TEST(NodeBalancerTest, EmptyCluster_ShouldReturnNull)
+{
+    NodeBalancer balancer(BalanceStrategy::LeastTasks, {});
+    EXPECT_EQ(balancer.select(), nullptr);
+}
+
+// 注册失败时撤销分配；不会减到 0 以下（刷新可能已覆盖计数），外来指针忽略
+TEST(NodeBalancerTest, Release_ShouldUndoSelect)
+{
+    NodeBalancer balancer(BalanceStrategy::LeastTasks, makeNodes({1, 1}));
+    const NodeEndpoint* first = balancer.select();
+    const NodeEndpoint* second = balancer.select();
+    ASSERT_NE(first, second);
+    EXPECT_EQ(balancer.loads(), (std::vector<uint64_t>{1, 1}));
+
+    balancer.release(first);
+    EXPECT_EQ(balancer.select(), first);
+    balancer.release(first);
+
+    balancer.updateLoads({});
+    balancer.release(second);
+    const NodeEndpoint foreign{"10.0.0.1", 1935, 1};
+    balancer.release(&foreign);
+    balancer.release(nullptr);
+    EXPECT_EQ(balancer.loads(), (std::vector<uint64_t>{0, 0}));
+}
+
+// 刷新后的负载表决定选择；本地分配计数在两次刷新之间累加
+TEST(NodeBalancerTest, LeastTasks_ShouldFillLightestNodeFirst)
+{
+    NodeBalancer balancer(BalanceStrategy::LeastTasks, makeNodes({1, 1, 1}));
+    balancer.updateLoads({
+        {"10.0.0.1", 1935, 2, 10}, // 12
+        {"10.0.0.2", 1935, 1, 2}, // 3
+        {"10.0.0.9", 1935, 5, 50}, // 不在本集群，忽略
+    });
+
+    // 节点 3 空载，先收 3 个任务后与节点 2 持平
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(indexOf(balancer, balancer.select()), 2u);
+    }
+    EXPECT_EQ(balancer.loads(), (std::vector<uint64_t>{12, 3, 3}));
+
+    // 持平后在二者之间交替，不会碰负载最高的节点
+    for (int i = 0; i < 8; ++i)
+    {
+        EXPECT_NE(indexOf(balancer, balancer.select()), 0u);
+    }
+    EXPECT_EQ(balancer.loads(), (std::vector<uint64_t>{12, 7, 7}));
+
+    // 再次刷新覆盖本地计数
+    balancer.updateLoads({});
+    EXPECT_EQ(balancer.loads(), (std::vector<uint64_t>{0, 0, 0}));
+}
+
+// 加权：稳态下分配比例与 weight 一致
+TEST(NodeBalancerTest, Weighted_ShouldFollowWeights)
+{
+    NodeBalancer balancer(BalanceStrategy::Weighted, makeNodes({1, 2, 5}));
+    for (int i = 0; i < 800; ++i)
+    {
+        ASSERT_NE(balancer.select(), nullptr);
+    }
+    EXPECT_EQ(balancer.loads(), (std::vector<uint64_t>{100, 200, 500}));
+}
+
+// P2C：永远不会选中两个候选里更重的那个，因此最重的节点在只有两个节点时不会再被选
+TEST(NodeBalancerTest, PowerOfTwo_ShouldAvoidOverloadedNode)
+{
+    NodeBalancer balancer(BalanceStrategy::PowerOfTwo, makeNodes({1, 1}));
+    balancer.updateLoads({{"10.0.0.1", 1935, 0, 100}});
+
+    for (int i = 0; i < 50; ++i)
+    {
+        EXPECT_EQ(indexOf(balancer, balancer.select()), 1u);
+    }
+
+    // 多节点时最大负载与平均负载之差有界
+    NodeBalancer wide(BalanceStrategy::PowerOfTwo, makeNodes({1, 1, 1, 1, 1, 1, 1, 1}));
+    for (int i = 0; i < 8000; ++i)
+    {
+        (void)wide.select();
+    }
+    const auto loads = wide.loads();
+    EXPECT_LE(*std::ranges::max_element(loads), 1000u + 50u);
+}
+
+// 并发 select：分配计数不丢
+TEST(NodeBalancerTest, ConcurrentSelect_ShouldCountEveryAssignment)
+{
+    NodeBalancer balancer(BalanceStrategy::LeastTasks, makeNodes({1, 1, 1, 1}));
+
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t)
+    {
+        threads.emplace_back([&balancer]
+        {
+            for (int i = 0; i < kPerThread; ++i)(void)balancer.select();
+        });
+    }
+    for (auto& t : threads)t.join();
+
+    uint64_t total = 0;
+    for (uint64_t l : balancer.loads())total += l;
+    EXPECT_EQ(total, static_cast<uint64_t>(kThreads * kPerThread));
+}
+
+// 一致性哈希：同一 key 稳定落在同一节点；增加一个节点只迁移约 1/N 的 key
+TEST(NodeBalancerTest, ConsistentHash_ShouldBeStableAndMoveOneOverN)
+{
+    constexpr int kKeys = 4000;
+    auto nodes = makeNodes({1, 1, 1, 1, 1, 1, 1, 1});
+
+    // 负载系数放得很大，只看纯哈希的放置
+    NodeBalancer before(BalanceStrategy::ConsistentHash, nodes, 1e9);
+    std::vector<std::string> placed;
+    for (int i = 0; i < kKeys; ++i)
+    {
+        placed.push_back(before.select("live/stream_" + std::to_string(i))->host);
+    }
+    EXPECT_EQ(before.select("live/stream_42")->host, placed[42]);
+
+    nodes.push_back({"10.0.0.100", 1935, 1});
+    NodeBalancer after(BalanceStrategy::ConsistentHash, nodes, 1e9);
+    int moved = 0;
+    for (int i = 0; i < kKeys; ++i)
+    {
+        const auto& host = after.select("live/stream_" + std::to_string(i))->host;
+        if (host != placed[i])
+        {
+            // 只会迁往新节点
+            EXPECT_EQ(host, "10.0.0.100");
+            ++moved;
+        }
+    }
+    // 期望 1/9 ≈ 444
+    EXPECT_GT(moved, kKeys / 9 - 150);
+    EXPECT_LT(moved, kKeys / 9 + 150);
+}
+
+// 有界负载：首选节点超过 c * 平均值时顺延，任何节点都不会超过上限
+TEST(NodeBalancerTest, ConsistentHash_ShouldRespectLoadBound)
+{
+    NodeBalancer balancer(BalanceStrategy::ConsistentHash, makeNodes({1, 1, 1, 1}), 1.25);
+
+    // 同一个热门 key 反复放置：首选节点填到上限后溢出到其它节点
+    for (int i = 0; i < 400; ++i)
+    {
+        ASSERT_NE(balancer.select("live/hot"), nullptr);
+    }
+    for (uint64_t load : balancer.loads())
+    {
+        EXPECT_LE(load, 125u + 1u);
+    }
+
+    // 空 key 退化为最少任务
+    NodeBalancer empty_key(BalanceStrategy::ConsistentHash, makeNodes({1, 1}));
+    empty_key.updateLoads({{"10.0.0.1", 1935, 1, 9}});
+    EXPECT_EQ(indexOf(empty_key, empty_key.select()), 1u);
+}
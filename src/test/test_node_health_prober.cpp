@@ -0,0 +1,319 @@
+//
+// Unit test for NodeHealthProber
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "NodeBalancer.h"
+#include "NodeHealthProber.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    // 127.0.0.1 上的监听套接字；port = 0 时由内核分配
+    class LocalListener
+    {
+    public:
+        explicit LocalListener(int port = 0)
+        {
+            _fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            const int one = 1;
+            ::setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(port));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (::bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(_fd, 64) != 0)
+            {
+                ::close(_fd);
+                _fd = -1;
+                return;
+            }
+
+            socklen_t len = sizeof(addr);
+            ::getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+            _port = ntohs(addr.sin_port);
+        }
+
+        ~LocalListener()
+        {
+            close();
+        }
+
+        // 以固定状态行应答每个连接，直到析构
+        void serveHttp(std::string status_line)
+        {
+            _server = std::jthread([this, status = std::move(status_line)](const std::stop_token& stoken)
+            {
+                while (!stoken.stop_requested())
+                {
+                    pollfd pfd{_fd, POLLIN, 0};
+                    if (::poll(&pfd, 1, 20) <= 0)continue;
+
+                    const int client = ::accept(_fd, nullptr, nullptr);
+                    if (client < 0)continue;
+
+                    char buf[1024];
+                    (void)::recv(client, buf, sizeof(buf), 0);
+                    const std::string response = status + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                    (void)::send(client, response.data(), response.size(), MSG_NOSIGNAL);
+                    ::close(client);
+                }
+            });
+        }
+
+        void close()
+        {
+            if (_server.joinable())
+            {
+                _server.request_stop();
+                _server.join();
+            }
+            if (_fd >= 0)
+            {
+                ::close(_fd);
+                _fd = -1;
+            }
+        }
+
+        [[nodiscard]] bool ok() const
+        {
+            return _fd >= 0;
+        }
+
+        [[nodiscard]] int port() const
+        {
+            return _port;
+        }
+
+    private:
+        int _fd = -1;
+        int _port = 0;
+        std::jthread _server;
+    };
+
+    // 取一个当前没有监听者的端口
+    int closedPort()
+    {
+        LocalListener probe;
+        const int port = probe.port();
+        probe.close();
+        return port;
+    }
+
+    NodeConfig makeConfig(std::initializer_list<int> rtmp_ports)
+    {
+        NodeConfig cfg;
+        for (int port : rtmp_ports)
+        {
+            cfg.rtmp_srt.push_back({"127.0.0.1", port});
+        }
+        return cfg;
+    }
+
+    NodeHealthProber::Config fastConfig()
+    {
+        NodeHealthProber::Config cfg;
+        cfg.timeout = std::chrono::milliseconds(300);
+        cfg.failure_threshold = 2;
+        cfg.readmit_successes = 2;
+        cfg.base_ejection = std::chrono::milliseconds(100);
+        return cfg;
+    }
+
+    const NodeProbeStatus& statusOf(const NodeHealthSnapshot& snap, size_t index)
+    {
+        return snap.nodes.at(index);
+    }
+}
+
+// 初始全部可调度；连续失败达到阈值才剔除
+TEST(NodeHealthProberTest, TcpProbe_ShouldEjectAfterFailureThreshold)
+{
+    LocalListener up;
+    ASSERT_TRUE(up.ok());
+    const int down = closedPort();
+
+    NodeHealthProber prober(makeConfig({up.port(), down}), fastConfig());
+    EXPECT_EQ(prober.snapshot()->eligibleFor(NodeConfig::Category::RTMP_SRT)->size(), 2u);
+    EXPECT_EQ((*prober.snapshot()->eligibleFor(NodeConfig::Category::RTMP_SRT))[1], 1);
+
+    prober.probeOnce();
+    auto snap = prober.snapshot();
+    EXPECT_EQ(statusOf(*snap, 1).state, NodeHealthState::Healthy);
+    EXPECT_EQ(statusOf(*snap, 1).consecutive_failures, 1u);
+    EXPECT_FALSE(statusOf(*snap, 1).last_error.empty());
+
+    prober.probeOnce();
+    snap = prober.snapshot();
+    EXPECT_EQ(snap->round, 2u);
+    EXPECT_EQ(statusOf(*snap, 0).state, NodeHealthState::Healthy);
+    EXPECT_GT(statusOf(*snap, 0).ewma_ms, 0.0);
+    EXPECT_EQ(statusOf(*snap, 1).state, NodeHealthState::Ejected);
+    EXPECT_EQ(statusOf(*snap, 1).ejections, 1u);
+
+    const auto& eligible = *snap->eligibleFor(NodeConfig::Category::RTMP_SRT);
+    EXPECT_EQ(eligible[0], 1);
+    EXPECT_EQ(eligible[1], 0);
+}
+
+// 剔除期满后半开试探：连续成功 readmit_successes 次重新接纳
+TEST(NodeHealthProberTest, HalfOpen_ShouldReadmitRecoveredNode)
+{
+    const int port = closedPort();
+    NodeHealthProber prober(makeConfig({port}), fastConfig());
+
+    prober.probeOnce();
+    prober.probeOnce();
+    ASSERT_EQ(statusOf(*prober.snapshot(), 0).state, NodeHealthState::Ejected);
+
+    LocalListener recovered(port);
+    ASSERT_TRUE(recovered.ok());
+
+    // 剔除期内不探测
+    prober.probeOnce();
+    EXPECT_EQ(statusOf(*prober.snapshot(), 0).probes, 2u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    prober.probeOnce();
+    EXPECT_EQ(statusOf(*prober.snapshot(), 0).state, NodeHealthState::HalfOpen);
+    EXPECT_EQ((*prober.snapshot()->eligibleFor(NodeConfig::Category::RTMP_SRT))[0], 0);
+
+    prober.probeOnce();
+    EXPECT_EQ(statusOf(*prober.snapshot(), 0).state, NodeHealthState::Healthy);
+    EXPECT_EQ((*prober.snapshot()->eligibleFor(NodeConfig::Category::RTMP_SRT))[0], 1);
+}
+
+// 半开试探失败立即重新剔除，且剔除时长翻倍
+TEST(NodeHealthProberTest, HalfOpenFailure_ShouldBackOff)
+{
+    NodeHealthProber prober(makeConfig({closedPort()}), fastConfig());
+
+    prober.probeOnce();
+    prober.probeOnce();
+    ASSERT_EQ(statusOf(*prober.snapshot(), 0).ejections, 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    prober.probeOnce();
+    EXPECT_EQ(statusOf(*prober.snapshot(), 0).state, NodeHealthState::Ejected);
+    EXPECT_EQ(statusOf(*prober.snapshot(), 0).ejections, 2u);
+
+    // 第二次剔除 200ms：150ms 后仍在剔除期内，不会被探测
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    prober.probeOnce();
+    EXPECT_EQ(statusOf(*prober.snapshot(), 0).probes, 3u);
+}
+
+// HTTP 探测：2xx/3xx 健康，5xx 计为失败
+TEST(NodeHealthProberTest, HttpProbe_ShouldCheckStatusCode)
+{
+    LocalListener healthy;
+    LocalListener broken;
+    ASSERT_TRUE(healthy.ok() && broken.ok());
+    healthy.serveHttp("HTTP/1.1 200 OK");
+    broken.serveHttp("HTTP/1.1 503 Service Unavailable");
+
+    auto cfg = fastConfig();
+    cfg.http_path = "/health";
+    cfg.failure_threshold = 1;
+    NodeHealthProber prober(makeConfig({healthy.port(), broken.port()}), cfg);
+
+    prober.probeOnce();
+    const auto snap = prober.snapshot();
+    EXPECT_EQ(statusOf(*snap, 0).state, NodeHealthState::Healthy);
+    EXPECT_EQ(statusOf(*snap, 0).failures, 0u);
+    EXPECT_EQ(statusOf(*snap, 1).state, NodeHealthState::Ejected);
+    EXPECT_EQ(statusOf(*snap, 1).last_error, "http: status 503");
+}
+
+// 后台线程按周期探测，stop 可重复调用
+TEST(NodeHealthProberTest, StartStop_ShouldProbePeriodically)
+{
+    LocalListener up;
+    ASSERT_TRUE(up.ok());
+
+    auto cfg = fastConfig();
+    cfg.interval = std::chrono::milliseconds(10);
+    NodeHealthProber prober(makeConfig({up.port()}), cfg);
+    prober.start();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (prober.snapshot()->round < 3 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    prober.stop();
+    prober.stop();
+
+    EXPECT_GE(prober.snapshot()->round, 3u);
+    EXPECT_EQ(statusOf(*prober.snapshot(), 0).state, NodeHealthState::Healthy);
+}
+
+// 调度侧：被剔除的节点不参与任何策略；全部不可用时忽略掩码
+TEST(NodeHealthProberTest, Balancer_ShouldSkipIneligibleNodes)
+{
+    const std::vector<NodeEndpoint> nodes = {{"10.0.0.1", 1935}, {"10.0.0.2", 1935}, {"10.0.0.3", 1935}};
+    const std::vector<uint8_t> mask = {1, 0, 1};
+
+    for (auto strategy : {BalanceStrategy::RoundRobin, BalanceStrategy::LeastTasks, BalanceStrategy::Weighted,
+                          BalanceStrategy::PowerOfTwo, BalanceStrategy::ConsistentHash})
+    {
+        NodeBalancer balancer(strategy, nodes);
+        for (int i = 0; i < 100; ++i)
+        {
+            const auto* node = balancer.select("stream_" + std::to_string(i), &mask);
+            ASSERT_NE(node, nullptr);
+            EXPECT_NE(node->host, "10.0.0.2") << balanceStrategyName(strategy);
+        }
+        EXPECT_EQ(balancer.loads()[1], 0u);
+    }
+
+    const std::vector<uint8_t> none = {0, 0, 0};
+    NodeBalancer balancer(BalanceStrategy::RoundRobin, nodes);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_NE(balancer.select({}, &none), nullptr);
+    }
+    EXPECT_EQ(balancer.loads(), (std::vector<uint64_t>{1, 1, 1}));
+}
+
+// 热加载：保留仍在列表中的节点的状态，新节点视为健康，指纹随之更新
+TEST(NodeHealthProberTest, UpdateNodes_ShouldCarryOverState)
+{
+    const int down = closedPort();
+    LocalListener fresh;
+    ASSERT_TRUE(fresh.ok());
+
+    auto cfg = fastConfig();
+    cfg.failure_threshold = 1;
+    const auto before = makeConfig({down});
+    NodeHealthProber prober(before, cfg);
+    prober.probeOnce();
+    ASSERT_EQ(statusOf(*prober.snapshot(), 0).state, NodeHealthState::Ejected);
+    EXPECT_EQ(prober.snapshot()->topology, before.fingerprint());
+
+    const auto after = makeConfig({fresh.port(), down});
+    prober.updateNodes(after);
+
+    const auto snap = prober.snapshot();
+    EXPECT_EQ(snap->topology, after.fingerprint());
+    EXPECT_NE(before.fingerprint(), after.fingerprint());
+    EXPECT_EQ(statusOf(*snap, 0).state, NodeHealthState::Healthy);
+    EXPECT_EQ(statusOf(*snap, 1).state, NodeHealthState::Ejected);
+    EXPECT_EQ(statusOf(*snap, 1).ejections, 1u);
+
+    const auto& eligible = *snap->eligibleFor(NodeConfig::Category::RTMP_SRT);
+    EXPECT_EQ(eligible, (std::vector<uint8_t>{1, 0}));
+}
@@ -0,0 +1,93 @@
+//
+// Unit test for PrometheusWriter / MetricsCollector::exportPrometheus
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "MetricsCollector.h"
+#include "PrometheusWriter.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace
+{
+    class FakeProvider final : public IMetricsProvider
+    {
+    public:
+        REGISTER_METRICS_NAME("fake_exposition_metrics")
+
+        void refresh() noexcept override
+        {
+            ++_round;
+            updateSnapshot({
+                {"status", "running"},
+                {"round", _round},
+                {"pool", {{"active", 3}, {"healthy", true}}}
+            });
+        }
+
+    private:
+        uint64_t _round = 0;
+    };
+}
+
+TEST(PrometheusWriterTest, AppendJson_ShouldFlattenNestedObject)
+{
+    const nlohmann::json j = {
+        {"status", "con\"nected"},
+        {"healthy", true},
+        {"latency-ms", -1},
+        {"hit_rate", 0.5},
+        {"nan", std::numeric_limits<double>::quiet_NaN()},
+        {"l1", {{"hits", 42u}, {"entries", 7}}},
+        {"ignored", nlohmann::json::array({1, 2})}
+    };
+
+    std::string out;
+    PrometheusWriter::appendJson(out, PrometheusWriter::metricPrefix("cache_metrics"), j);
+
+    EXPECT_NE(out.find("streamgate_cache_status_info{value=\"con\\\"nected\"} 1\n"), std::string::npos) << out;
+    EXPECT_NE(out.find("streamgate_cache_healthy 1\n"), std::string::npos) << out;
+    EXPECT_NE(out.find("streamgate_cache_latency_ms -1\n"), std::string::npos) << out;
+    EXPECT_NE(out.find("streamgate_cache_hit_rate 0.5\n"), std::string::npos) << out;
+    EXPECT_NE(out.find("streamgate_cache_nan NaN\n"), std::string::npos) << out;
+    EXPECT_NE(out.find("streamgate_cache_l1_hits 42\n"), std::string::npos) << out;
+    EXPECT_NE(out.find("streamgate_cache_l1_entries 7\n"), std::string::npos) << out;
+    EXPECT_EQ(out.find("ignored"), std::string::npos) << out;
+}
+
+TEST(PrometheusWriterTest, MetricPrefix_ShouldStripSuffixAndSanitize)
+{
+    EXPECT_EQ(PrometheusWriter::metricPrefix("auth_metrics"), "streamgate_auth");
+    EXPECT_EQ(PrometheusWriter::metricPrefix("logger"), "streamgate_logger");
+    EXPECT_EQ(PrometheusWriter::metricPrefix("hook.server-1"), "streamgate_hook_server_1");
+}
+
+// 快照同时携带 JSON 与文本；collector 只做拼接
+TEST(PrometheusWriterTest, Collector_ShouldConcatenatePreRenderedSnapshots)
+{
+    auto provider = std::make_shared<FakeProvider>();
+    provider->refresh();
+
+    const auto snap = provider->exportSnapshot();
+    EXPECT_EQ(snap->json["round"], 1);
+    EXPECT_NE(snap->exposition.find("streamgate_fake_exposition_round 1\n"), std::string::npos);
+
+    auto& collector = MetricsCollector::instance();
+    collector.registerProvider(provider);
+
+    const auto text = collector.exportPrometheus();
+    EXPECT_NE(text->find(snap->exposition), std::string::npos) << *text;
+    EXPECT_NE(text->find("streamgate_fake_exposition_pool_active 3\n"), std::string::npos);
+    EXPECT_NE(text->find("streamgate_metrics_refresh_timestamp_seconds "), std::string::npos);
+    EXPECT_EQ(text->back(), '\n');
+
+    // 快照是不可变的：刷新后旧指针内容不变
+    provider->refresh();
+    EXPECT_EQ(snap->json["round"], 1);
+    EXPECT_EQ(provider->exportMetrics()["round"], 2);
+}
@@ -0,0 +1,149 @@
+//
+// Unit test for ThreadLocalRegistry / ServerMetricsProvider
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "ServerMetricsProvider.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    ActionCounters totalOf(const ThreadLocalRegistry::Snapshot& snap)
+    {
+        ActionCounters total;
+        for (const auto& c : snap)total += c;
+        return total;
+    }
+
+    ActionCounters countersOf(HookAction action)
+    {
+        ThreadLocalRegistry::Snapshot snap;
+        ThreadLocalRegistry::instance().aggregate(snap);
+        return snap[static_cast<size_t>(action)];
+    }
+}
+
+// 各线程写自己的槽位；退出归还后计数并入历史，不丢不重
+TEST(ServerMetricsTest, BoundThreads_ShouldAggregatePerAction)
+{
+    auto& reg = ThreadLocalRegistry::instance();
+    const auto before_publish = countersOf(HookAction::Publish);
+    const auto before_play = countersOf(HookAction::Play);
+
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t)
+    {
+        threads.emplace_back([&reg, t]
+        {
+            ScopedWorkerStats scope;
+            const auto action = (t % 2 == 0) ? HookAction::Publish : HookAction::Play;
+            for (int i = 0; i < kPerThread; ++i)
+            {
+                reg.recordRequest(action, 100);
+                reg.recordResult(action, i % 10 != 0);
+                reg.recordBytesOut(action, 20);
+            }
+        });
+    }
+
+    // 并发汇总：counter 必须单调（归还槽位时不能短暂回退）
+    uint64_t last = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        uint64_t t, s, f;
+        reg.aggregate(t, s, f);
+        ASSERT_GE(t, last);
+        last = t;
+    }
+    for (auto& th : threads)th.join();
+
+    const auto publish = countersOf(HookAction::Publish);
+    const auto play = countersOf(HookAction::Play);
+    constexpr uint64_t kPerAction = kThreads / 2 * kPerThread;
+
+    EXPECT_EQ(publish.requests - before_publish.requests, kPerAction);
+    EXPECT_EQ(publish.success - before_publish.success, kPerAction / 10 * 9);
+    EXPECT_EQ(publish.failed - before_publish.failed, kPerAction / 10);
+    EXPECT_EQ(publish.bytes_in - before_publish.bytes_in, kPerAction * 100);
+    EXPECT_EQ(publish.bytes_out - before_publish.bytes_out, kPerAction * 20);
+    EXPECT_EQ(play.requests - before_play.requests, kPerAction);
+}
+
+// 未认领槽位的线程退化为共享原子累加
+TEST(ServerMetricsTest, UnboundThread_ShouldUseSharedCounters)
+{
+    auto& reg = ThreadLocalRegistry::instance();
+    const auto before = countersOf(HookAction::StreamNotFound);
+
+    std::thread([&reg]
+    {
+        reg.recordRequest(HookAction::StreamNotFound, 7);
+        reg.recordResult(HookAction::StreamNotFound, false);
+    }).join();
+
+    const auto after = countersOf(HookAction::StreamNotFound);
+    EXPECT_EQ(after.requests - before.requests, 1u);
+    EXPECT_EQ(after.failed - before.failed, 1u);
+    EXPECT_EQ(after.bytes_in - before.bytes_in, 7u);
+}
+
+// ThreadPool 的线程钩子：worker 启动即认领槽位，任务内记录走单写者路径
+TEST(ServerMetricsTest, ThreadPoolHooks_ShouldBindWorkers)
+{
+    auto& reg = ThreadLocalRegistry::instance();
+    const auto before = countersOf(HookAction::PlayDone);
+
+    std::atomic<int> started{0};
+    std::atomic<int> exited{0};
+    {
+        ThreadPool::Config cfg;
+        cfg.num_threads = 4;
+        cfg.on_thread_start = [&started]
+        {
+            ThreadLocalRegistry::instance().bindCurrentThread();
+            started.fetch_add(1);
+        };
+        cfg.on_thread_exit = [&exited]
+        {
+            ThreadLocalRegistry::instance().unbindCurrentThread();
+            exited.fetch_add(1);
+        };
+        ThreadPool pool(cfg);
+        for (int i = 0; i < 1000; ++i)
+        {
+            pool.post([&reg] { reg.recordResult(HookAction::PlayDone, true); });
+        }
+        pool.stop_and_wait();
+    }
+
+    EXPECT_EQ(started.load(), 4);
+    EXPECT_EQ(exited.load(), 4);
+    EXPECT_EQ(countersOf(HookAction::PlayDone).success - before.success, 1000u);
+}
+
+TEST(ServerMetricsTest, Refresh_ShouldExportPerActionCounters)
+{
+    ThreadLocalRegistry::instance().recordRequest(HookAction::PublishDone, 1);
+
+    ServerMetricsProvider provider;
+    provider.refresh();
+
+    const auto snap = provider.exportSnapshot();
+    EXPECT_GE(snap->json["actions"]["publish_done"]["requests"].get<uint64_t>(), 1u);
+    EXPECT_NE(snap->exposition.find("# TYPE streamgate_hook_requests_total counter\n"), std::string::npos);
+    EXPECT_NE(snap->exposition.find("streamgate_hook_requests_total{action=\"publish_done\"} "), std::string::npos);
+    EXPECT_NE(snap->exposition.find("streamgate_requests_total "), std::string::npos);
+
+    ThreadLocalRegistry::Snapshot all;
+    ThreadLocalRegistry::instance().aggregate(all);
+    EXPECT_EQ(snap->json["requests_total"].get<uint64_t>() <= totalOf(all).requests, true);
+}
@@ -0,0 +1,102 @@
+//
+// Unit test for SingleFlight (request coalescing)
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "SingleFlight.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 同 key 同 tag 的并发请求只执行一次加载，其余复用结果
+TEST(SingleFlightTest, SameTag_ShouldCoalesce)
+{
+    SingleFlight<int> flight;
+    std::atomic<int> loads{0};
+    std::atomic<bool> go{false};
+
+    constexpr int kThreads = 32;
+    std::vector<std::thread> threads;
+    std::vector<int> results(kThreads, 0);
+
+    for (int i = 0; i < kThreads; ++i)
+    {
+        threads.emplace_back([&, i]
+        {
+            while (!go.load())std::this_thread::yield();
+            results[i] = flight.execute("auth_data:live/a:c1", "token", [&]
+            {
+                loads.fetch_add(1);
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                return 42;
+            });
+        });
+    }
+
+    go.store(true);
+    for (auto& t : threads)t.join();
+
+    for (int r : results)EXPECT_EQ(r, 42);
+
+    const auto stats = flight.getStats();
+    EXPECT_EQ(static_cast<uint64_t>(loads.load()), stats.leaders);
+    EXPECT_EQ(stats.leaders + stats.coalesced_waiters, static_cast<uint64_t>(kThreads));
+    EXPECT_LT(stats.leaders, static_cast<uint64_t>(kThreads));
+    EXPECT_EQ(stats.waiting, 0u);
+    EXPECT_EQ(stats.in_flight, 0u);
+}
+
+// 同 key 不同 tag：结果不可共享，但加载必须串行
+TEST(SingleFlightTest, DifferentTag_ShouldSerialize)
+{
+    SingleFlight<std::string> flight;
+    std::atomic<int> concurrent{0};
+    std::atomic<int> max_concurrent{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&, i]
+        {
+            const auto tag = "token_" + std::to_string(i);
+            const auto r = flight.execute("same_key", tag, [&]
+            {
+                const int now = concurrent.fetch_add(1) + 1;
+                int prev = max_concurrent.load();
+                while (now > prev && !max_concurrent.compare_exchange_weak(prev, now))
+                {
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                concurrent.fetch_sub(1);
+                return tag;
+            });
+            EXPECT_EQ(r, tag);
+        });
+    }
+
+    for (auto& t : threads)t.join();
+
+    EXPECT_EQ(max_concurrent.load(), 1);
+    EXPECT_EQ(flight.getStats().leaders, 8u);
+}
+
+// leader 的异常应传播给共享结果的 waiter，且不残留在途记录
+TEST(SingleFlightTest, LeaderException_ShouldPropagate)
+{
+    SingleFlight<int> flight;
+
+    EXPECT_THROW(flight.execute("k", "t", []() -> int
+    {
+        throw std::runtime_error("db down");
+    }), std::runtime_error);
+
+    EXPECT_EQ(flight.getStats().in_flight, 0u);
+    EXPECT_EQ(flight.execute("k", "t", [] { return 7; }), 7);
+}
@@ -0,0 +1,217 @@
+//
+// Unit test for StreamTaskScheduler
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "AuthManager.h"
+#include "HookTrace.h"
+#include "HookUseCase.h"
+#include "InMemoryStreamStateManager.h"
+#include "LifecycleExecutor.h"
+#include "NodeConfig.h"
+#include "StreamTaskScheduler.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+
+namespace
+{
+    using namespace std::chrono_literals;
+    using Result = StreamTaskScheduler::SchedulerResult;
+
+    // 仿照 HybridAuthRepository：只经 HookTrace::current() 记录 AuthCache / AuthDb，并记下看到的上下文
+    class TracingRepository : public IAuthRepository
+    {
+    public:
+        TracingRepository(std::atomic<const HookTrace*>& seen, std::atomic<HookAction>& seenAction)
+            : _seen(seen), _seenAction(seenAction)
+        {
+        }
+
+        std::optional<StreamAuthData> getAuthData(const std::string& streamKey, const std::string& clientId,
+                                                  const std::string& authToken) override
+        {
+            // worker 上的副本在回调返回后即销毁，只能在这里读取
+            const HookTrace* trace = HookTrace::current();
+            _seen.store(trace);
+            _seenAction.store(trace ? trace->action() : HookAction::Unknown);
+            {
+                StageTimer cache(HookTrace::current(), HookStage::AuthCache);
+            }
+            StageTimer db(HookTrace::current(), HookStage::AuthDb);
+            return StreamAuthData{streamKey, clientId, authToken, true};
+        }
+
+        bool isHealthy() override
+        {
+            return true;
+        }
+
+    private:
+        std::atomic<const HookTrace*>& _seen;
+        std::atomic<HookAction>& _seenAction;
+    };
+
+    uint64_t countOf(HookAction action, HookStage stage)
+    {
+        return LatencyHistogramRegistry::instance().snapshot().at(action, stage).count;
+    }
+
+    struct SchedulerFixture
+    {
+        std::atomic<const HookTrace*> seen{nullptr};
+        std::atomic<HookAction> seenAction{HookAction::Unknown};
+        InMemoryStreamStateManager state;
+        ThreadPool pool{2};
+        AuthManager auth{std::make_unique<TracingRepository>(seen, seenAction), pool, AuthManager::Config{}};
+        StreamTaskScheduler scheduler{auth, state, NodeConfig{}, StreamTaskScheduler::Config{}};
+    };
+
+    Result await(std::future<Result>& future)
+    {
+        EXPECT_EQ(future.wait_for(2s), std::future_status::ready);
+        return future.get();
+    }
+}
+
+// 推流 / 播放：QueueWait、AuthCache、AuthDb、RegisterTask 各记录一次；worker 侧写的是副本而不是会话持有的实例
+TEST(StreamTaskSchedulerTest, Trace_ShouldRecordAuthAndRegisterStages)
+{
+    SchedulerFixture f;
+
+    for (const auto action : {HookAction::Publish, HookAction::Play})
+    {
+        constexpr HookStage kStages[] = {
+            HookStage::QueueWait, HookStage::AuthCache, HookStage::AuthDb, HookStage::RegisterTask
+        };
+        uint64_t before[std::size(kStages)];
+        for (size_t i = 0; i < std::size(kStages); ++i)before[i] = countOf(action, kStages[i]);
+
+        HookTrace trace;
+        trace.reset(action, HookTrace::Clock::now());
+        f.seen.store(nullptr);
+
+        std::promise<Result> done;
+        auto future = done.get_future();
+        auto callback = [&done](const Result& r) { done.set_value(r); };
+        if (action == HookAction::Publish)
+        {
+            f.scheduler.onPublish("live", "pub", "tk", StreamProtocol::RTMP, callback, &trace);
+        }
+        else
+        {
+            f.scheduler.onPlay("live", "p1", "tk", StreamProtocol::HTTP_FLV, callback, &trace);
+        }
+
+        const auto result = await(future);
+        EXPECT_TRUE(result.isSuccess()) << result.message;
+        ASSERT_NE(f.seen.load(), nullptr);
+        EXPECT_NE(f.seen.load(), &trace);
+        EXPECT_EQ(f.seenAction.load(), action);
+
+        for (size_t i = 0; i < std::size(kStages); ++i)
+        {
+            EXPECT_EQ(countOf(action, kStages[i]), before[i] + 1) << static_cast<int>(kStages[i]);
+        }
+    }
+}
+
+// 不传 trace 时仓储层看不到上下文，也不记录任何阶段
+TEST(StreamTaskSchedulerTest, NullTrace_ShouldRecordNothing)
+{
+    SchedulerFixture f;
+    const uint64_t before = countOf(HookAction::Publish, HookStage::RegisterTask);
+
+    const HookTrace sentinel; // 非空哨兵，确认被覆盖为 nullptr
+    f.seen.store(&sentinel);
+
+    std::promise<Result> done;
+    auto future = done.get_future();
+    f.scheduler.onPublish("quiet", "pub", "tk", StreamProtocol::RTMP,
+                          [&done](const Result& r) { done.set_value(r); });
+
+    EXPECT_TRUE(await(future).isSuccess());
+    EXPECT_EQ(f.seen.load(), nullptr);
+    EXPECT_EQ(countOf(HookAction::Publish, HookStage::RegisterTask), before);
+}
+
+// 推流位冲突时撤销 select() 计入的负载：被拒绝的推流不占节点，下一路流落到真正空闲的节点
+TEST(StreamTaskSchedulerTest, RejectedPublish_ShouldReleaseNodeLoad)
+{
+    std::atomic<const HookTrace*> seen{nullptr};
+    std::atomic<HookAction> seenAction{HookAction::Unknown};
+    InMemoryStreamStateManager state;
+    ThreadPool pool{2};
+    AuthManager auth{std::make_unique<TracingRepository>(seen, seenAction), pool, AuthManager::Config{}};
+    NodeConfig nodes;
+    nodes.rtmp_srt = {{"10.0.0.1", 1935, 1}, {"10.0.0.2", 1935, 1}};
+    StreamTaskScheduler scheduler{auth, state, nodes, StreamTaskScheduler::Config{}};
+
+    auto publish = [&scheduler](const std::string& stream, const std::string& client)
+    {
+        std::promise<Result> done;
+        auto future = done.get_future();
+        scheduler.onPublish(stream, client, "tk", StreamProtocol::RTMP,
+                            [&done](const Result& r) { done.set_value(r); });
+        return await(future);
+    };
+
+    const auto first = publish("s1", "pub1");
+    ASSERT_TRUE(first.isSuccess());
+    ASSERT_TRUE(first.task.has_value());
+
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(publish("s1", "other" + std::to_string(i)).error, Result::Error::ALREADY_PUBLISHING);
+    }
+
+    const auto second = publish("s2", "pub2");
+    ASSERT_TRUE(second.isSuccess());
+    ASSERT_TRUE(second.task.has_value());
+    EXPECT_NE(second.task->server_ip, first.task->server_ip);
+}
+
+// lifecycle 队列已满：Done 事件不在调用线程就地清理（会越过同一条流仍在排队的事件），计入 rejected 留给超时扫描
+TEST(HookUseCaseTest, PlayDone_ShouldNotRunInlineWhenLaneIsFull)
+{
+    SchedulerFixture f;
+    LifecycleExecutor lifecycle({1, 1});
+    HookUseCase useCase(f.scheduler, &lifecycle);
+
+    ZlmHookRequestView req;
+    req.action = HookAction::PlayDone;
+    req.stream = "room";
+    req.client_id = "p1";
+
+    StreamTask task;
+    task.stream_name = req.stream_key();
+    task.client_id = "p1";
+    task.type = StreamType::PLAYER;
+    task.state = StreamState::ACTIVE;
+    ASSERT_TRUE(f.state.registerTask(task));
+
+    std::promise<void> release;
+    std::promise<void> started;
+    ASSERT_TRUE(lifecycle.submit(req.stream_key(), [&started, gate = release.get_future().share()]
+    {
+        started.set_value();
+        gate.wait();
+    }));
+    started.get_future().wait();
+    ASSERT_TRUE(lifecycle.submit(req.stream_key(), [] {}));
+
+    EXPECT_EQ(useCase.processPlayDone(req).outcome, HookDecision::Outcome::Allow);
+    EXPECT_TRUE(f.state.getTask(req.stream_key(), "p1").has_value());
+    EXPECT_EQ(lifecycle.get_stats().rejected_tasks, 1u);
+
+    release.set_value();
+    lifecycle.stop_and_wait();
+    EXPECT_TRUE(f.state.getTask(req.stream_key(), "p1").has_value());
+}
@@ -0,0 +1,129 @@
+//
+// Unit test for StreamTaskSerializer (compact encoding)
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "StreamTaskSerializer.h"
+
+namespace
+{
+    StreamTask makeTask()
+    {
+        StreamTask task;
+        task.task_id = 42;
+        task.stream_name = "live/room_1";
+        task.client_id = "c1";
+        task.type = StreamType::PUBLISHER;
+        task.state = StreamState::ACTIVE;
+        task.protocol = StreamProtocol::HTTP_FLV;
+        task.server_ip = "10.0.3.17";
+        task.server_port = 1935;
+        task.start_time = std::chrono::system_clock::time_point(std::chrono::milliseconds{1790000000123LL});
+        task.user_id = "u_1001";
+        task.auth_token = "tok";
+        task.region = "cn-east";
+        task.need_record = true;
+        task.transcoding_profile = "720p";
+        return task;
+    }
+
+    std::string toMsString(std::chrono::system_clock::time_point tp)
+    {
+        return std::to_string(
+            std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count());
+    }
+}
+
+TEST(StreamTaskSerializerTest, Compact_ShouldRoundTripAllEncodedFields)
+{
+    const StreamTask task = makeTask();
+    const std::string blob = StreamTaskSerializer::encodeCompact(task);
+
+    StreamTask out;
+    ASSERT_TRUE(StreamTaskSerializer::decodeCompact(blob, out));
+    EXPECT_EQ(out.task_id, task.task_id);
+    EXPECT_EQ(out.type, task.type);
+    EXPECT_EQ(out.state, task.state);
+    EXPECT_EQ(out.protocol, task.protocol);
+    EXPECT_EQ(out.server_ip, task.server_ip);
+    EXPECT_EQ(out.server_port, task.server_port);
+    EXPECT_EQ(out.start_time, task.start_time);
+    EXPECT_EQ(out.user_id, task.user_id);
+    EXPECT_EQ(out.auth_token, task.auth_token);
+    EXPECT_EQ(out.region, task.region);
+    EXPECT_FALSE(out.need_transcode);
+    EXPECT_TRUE(out.need_record);
+    EXPECT_EQ(out.transcoding_profile, task.transcoding_profile);
+
+    // stream_name / client_id 由 key 携带，不进入编码
+    EXPECT_TRUE(out.stream_name.empty());
+    EXPECT_LT(blob.size(), 48u);
+}
+
+TEST(StreamTaskSerializerTest, Compact_ShouldKeepNonIpv4AddressAndMissingRegion)
+{
+    StreamTask task = makeTask();
+    task.type = StreamType::PLAYER;
+    task.state = StreamState::CLOSED;
+    task.protocol = StreamProtocol::Unknown;
+    task.server_ip = "edge-3.internal";
+    task.region.reset();
+
+    StreamTask out;
+    out.region = "stale";
+    ASSERT_TRUE(StreamTaskSerializer::decodeCompact(StreamTaskSerializer::encodeCompact(task), out));
+    EXPECT_EQ(out.type, StreamType::PLAYER);
+    EXPECT_EQ(out.state, StreamState::CLOSED);
+    EXPECT_EQ(out.protocol, StreamProtocol::Unknown);
+    EXPECT_EQ(out.server_ip, "edge-3.internal");
+    EXPECT_FALSE(out.region.has_value());
+}
+
+TEST(StreamTaskSerializerTest, Compact_ShouldRejectTruncatedOrForeignData)
+{
+    const std::string blob = StreamTaskSerializer::encodeCompact(makeTask());
+    StreamTask out;
+
+    for (size_t len = 0; len < blob.size(); ++len)
+    {
+        EXPECT_FALSE(StreamTaskSerializer::decodeCompact(std::string_view(blob).substr(0, len), out)) << len;
+    }
+    EXPECT_FALSE(StreamTaskSerializer::decodeCompact(blob + "x", out));
+
+    std::string wrong_version = blob;
+    wrong_version[0] = static_cast<char>(StreamTaskSerializer::COMPACT_VERSION + 1);
+    EXPECT_FALSE(StreamTaskSerializer::decodeCompact(wrong_version, out));
+}
+
+TEST(StreamTaskSerializerTest, LegacyHash_ShouldDecodeSixteenFieldLayout)
+{
+    const StreamTask task = makeTask();
+    const auto ms = toMsString(task.start_time);
+    const std::unordered_map<std::string, std::string> fields{
+        {"stream_name", task.stream_name}, {"client_id", task.client_id}, {"active", "1"},
+        {"type", "publisher"}, {"state", "active"}, {"protocol", "http-flv"},
+        {"server_ip", task.server_ip}, {"server_port", "1935"},
+        {"start_time_ms", ms}, {"last_active_time_ms", ms},
+        {"user_id", task.user_id}, {"auth_token", task.auth_token}, {"region", ""},
+        {"need_transcode", "0"}, {"need_record", "1"}, {"transcoding_profile", task.transcoding_profile}
+    };
+
+    const auto out = StreamTaskSerializer::decodeLegacyHash(fields);
+    ASSERT_TRUE(out.has_value());
+    EXPECT_EQ(out->stream_name, task.stream_name);
+    EXPECT_EQ(out->client_id, task.client_id);
+    EXPECT_EQ(out->type, StreamType::PUBLISHER);
+    EXPECT_EQ(out->server_port, 1935);
+    EXPECT_EQ(out->last_active_time, task.start_time);
+    EXPECT_FALSE(out->region.has_value());
+    EXPECT_TRUE(out->need_record);
+
+    auto broken = fields;
+    broken["start_time_ms"] = "12";
+    EXPECT_FALSE(StreamTaskSerializer::decodeLegacyHash(broken).has_value());
+    broken.erase("type");
+    EXPECT_FALSE(StreamTaskSerializer::decodeLegacyHash(broken).has_value());
+}
@@ -0,0 +1,259 @@
+//
+// Unit test for TaskExpiryListener
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "TaskExpiryListener.h"
+#include "AuthManager.h"
+#include "CacheManager.h"
+#include "InMemoryStreamStateManager.h"
+#include "LifecycleExecutor.h"
+#include "NodeConfig.h"
+#include "StreamTaskScheduler.h"
+#include "ThreadPool.h"
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using Call = std::pair<std::string, std::string>;
+
+    // 记录 handler 调用的桩：不需要 Redis，订阅连接从不建立
+    class RecordingHandler
+    {
+    public:
+        TaskExpiryListener::Handler handler()
+        {
+            return [this](const std::string& stream, const std::string& client)
+            {
+                std::lock_guard lock(_mutex);
+                _calls.emplace_back(stream, client);
+                _threads.push_back(std::this_thread::get_id());
+            };
+        }
+
+        [[nodiscard]] std::vector<Call> calls() const
+        {
+            std::lock_guard lock(_mutex);
+            return _calls;
+        }
+
+        [[nodiscard]] std::vector<std::thread::id> threads() const
+        {
+            std::lock_guard lock(_mutex);
+            return _threads;
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        std::vector<Call> _calls;
+        std::vector<std::thread::id> _threads;
+    };
+
+    // 模拟 Redis 后端的 TTL 语义：任务仍在时清理并返回，否则视为已被其它实例处理
+    class ExpiringStateManager : public InMemoryStreamStateManager
+    {
+    public:
+        std::optional<StreamTask> reclaimExpiredTask(const std::string& stream_name,
+                                                     const std::string& client_id) override
+        {
+            {
+                std::lock_guard lock(_mutex);
+                _reclaimed.emplace_back(stream_name, client_id);
+            }
+            auto task = getTask(stream_name, client_id);
+            if (task)deregisterTask(stream_name, client_id);
+            return task;
+        }
+
+        [[nodiscard]] std::vector<Call> reclaimed() const
+        {
+            std::lock_guard lock(_mutex);
+            return _reclaimed;
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        std::vector<Call> _reclaimed;
+    };
+
+    class DenyAllRepository : public IAuthRepository
+    {
+    public:
+        std::optional<StreamAuthData> getAuthData(const std::string&, const std::string&,
+                                                  const std::string&) override
+        {
+            return std::nullopt;
+        }
+
+        bool isHealthy() override
+        {
+            return true;
+        }
+    };
+
+    StreamTask makeTask(const std::string& stream, const std::string& client, StreamType type)
+    {
+        StreamTask task;
+        task.stream_name = stream;
+        task.client_id = client;
+        task.type = type;
+        task.state = StreamState::ACTIVE;
+        task.protocol = StreamProtocol::RTMP;
+        task.server_ip = "10.0.0.1";
+        task.server_port = 1935;
+        return task;
+    }
+}
+
+TEST(TaskExpiryListenerTest, ParseTaskKey_ShouldSplitAtLastColon)
+{
+    std::string stream;
+    std::string client;
+
+    ASSERT_TRUE(TaskExpiryListener::parseTaskKey("task:live:c1", stream, client));
+    EXPECT_EQ(stream, "live");
+    EXPECT_EQ(client, "c1");
+
+    // 流名可以包含 ':'（如 app:stream），client_id 取最后一段，与超时扫描脚本一致
+    ASSERT_TRUE(TaskExpiryListener::parseTaskKey("task:app:room:42:c2", stream, client));
+    EXPECT_EQ(stream, "app:room:42");
+    EXPECT_EQ(client, "c2");
+}
+
+TEST(TaskExpiryListenerTest, ParseTaskKey_ShouldRejectForeignOrMalformedKeys)
+{
+    std::string stream;
+    std::string client;
+
+    EXPECT_FALSE(TaskExpiryListener::parseTaskKey("auth:live:c1", stream, client));
+    EXPECT_FALSE(TaskExpiryListener::parseTaskKey("pub:live", stream, client));
+    EXPECT_FALSE(TaskExpiryListener::parseTaskKey("task:live", stream, client));
+    EXPECT_FALSE(TaskExpiryListener::parseTaskKey("task::c1", stream, client));
+    EXPECT_FALSE(TaskExpiryListener::parseTaskKey("task:live:", stream, client));
+    EXPECT_FALSE(TaskExpiryListener::parseTaskKey("task:", stream, client));
+}
+
+// 只有 task: 前缀的过期通知转给 handler，其余 key 与畸形 key 静默忽略
+TEST(TaskExpiryListenerTest, Dispatch_ShouldForwardOnlyTaskKeys)
+{
+    RecordingHandler recorder;
+    TaskExpiryListener listener(CacheManager::instance(), recorder.handler());
+
+    for (const char* key : {"task:live:c1", "auth_data:live:c1", "pub:live", "task:live", "task:app:room:p2"})
+    {
+        listener.dispatch(key);
+    }
+
+    EXPECT_EQ(recorder.calls(), (std::vector<Call>{{"live", "c1"}, {"app:room", "p2"}}));
+    EXPECT_EQ(listener.eventCount(), 2u);
+}
+
+// handler 抛异常不能打断后续通知
+TEST(TaskExpiryListenerTest, Dispatch_ShouldContainHandlerExceptions)
+{
+    int calls = 0;
+    TaskExpiryListener listener(CacheManager::instance(), [&calls](const std::string&, const std::string&)
+    {
+        ++calls;
+        throw std::runtime_error("boom");
+    });
+
+    EXPECT_NO_THROW(listener.dispatch("task:live:c1"));
+    EXPECT_NO_THROW(listener.dispatch("task:live:c2"));
+    EXPECT_EQ(calls, 2);
+}
+
+// 投递到 lifecycle：回调在 lane 线程上按通知顺序执行；执行器停止后的通知丢弃并计入 rejected，不在调用线程就地执行
+TEST(TaskExpiryListenerTest, PostToLifecycle_ShouldRunOnLaneAndNeverInline)
+{
+    LifecycleExecutor executor({2, 0});
+    RecordingHandler recorder;
+    TaskExpiryListener listener(CacheManager::instance(),
+                                TaskExpiryListener::postToLifecycle(executor, recorder.handler()));
+
+    listener.dispatch("task:live:c1");
+    listener.dispatch("task:live:c2");
+    executor.stop_and_wait();
+
+    ASSERT_EQ(recorder.calls(), (std::vector<Call>{{"live", "c1"}, {"live", "c2"}}));
+    for (const auto& id : recorder.threads())
+    {
+        EXPECT_NE(id, std::this_thread::get_id());
+    }
+
+    listener.dispatch("task:live:c3");
+    EXPECT_EQ(recorder.calls().size(), 2u);
+    EXPECT_EQ(executor.get_stats().rejected_tasks, 1u);
+}
+
+// lane 已满：新通知不能越过排队中的事件先执行，丢弃后同一条流上的顺序不变
+TEST(TaskExpiryListenerTest, PostToLifecycle_ShouldDropWhenLaneIsFull)
+{
+    LifecycleExecutor executor({1, 1});
+    RecordingHandler recorder;
+    TaskExpiryListener listener(CacheManager::instance(),
+                                TaskExpiryListener::postToLifecycle(executor, recorder.handler()));
+
+    std::promise<void> release;
+    std::promise<void> started;
+    ASSERT_TRUE(executor.submit("live", [&started, gate = release.get_future().share()]
+    {
+        started.set_value();
+        gate.wait();
+    }));
+    started.get_future().wait();
+
+    listener.dispatch("task:live:c1"); // 占满唯一的队列位
+    listener.dispatch("task:live:c2"); // 被拒绝
+    EXPECT_TRUE(recorder.calls().empty());
+    EXPECT_EQ(executor.get_stats().rejected_tasks, 1u);
+
+    release.set_value();
+    executor.stop_and_wait();
+    EXPECT_EQ(recorder.calls(), (std::vector<Call>{{"live", "c1"}}));
+}
+
+// 与 main.cpp 相同的接线：通知 -> lifecycle -> scheduler.onTaskExpired -> reclaimExpiredTask
+// 播放端过期只清理自身；推流端过期联动清场；已被回收的 key 重复通知不产生副作用
+TEST(TaskExpiryListenerTest, ExpiredKeys_ShouldReclaimThroughScheduler)
+{
+    ExpiringStateManager state;
+    ThreadPool pool(1);
+    AuthManager auth(std::make_unique<DenyAllRepository>(), pool, AuthManager::Config{});
+    StreamTaskScheduler scheduler(auth, state, NodeConfig{}, StreamTaskScheduler::Config{});
+    LifecycleExecutor executor({2, 0});
+
+    ASSERT_TRUE(state.registerTask(makeTask("live", "pub", StreamType::PUBLISHER)));
+    ASSERT_TRUE(state.registerTask(makeTask("live", "p1", StreamType::PLAYER)));
+    ASSERT_TRUE(state.registerTask(makeTask("live", "p2", StreamType::PLAYER)));
+    ASSERT_TRUE(state.registerTask(makeTask("other", "p3", StreamType::PLAYER)));
+
+    TaskExpiryListener listener(CacheManager::instance(), TaskExpiryListener::postToLifecycle(
+                                    executor, [&scheduler](const std::string& stream, const std::string& client)
+                                    {
+                                        scheduler.onTaskExpired(stream, client);
+                                    }));
+
+    listener.dispatch("task:live:p1");
+    listener.dispatch("task:live:p1");
+    listener.dispatch("auth_data:other:p3");
+    listener.dispatch("task:live:pub");
+    executor.stop_and_wait();
+
+    EXPECT_EQ(state.reclaimed(), (std::vector<Call>{{"live", "p1"}, {"live", "p1"}, {"live", "pub"}}));
+    EXPECT_FALSE(state.getPublisherTask("live").has_value());
+    EXPECT_TRUE(state.getStreamClientIds("live").empty());
+    EXPECT_EQ(state.getStreamClientIds("other"), (std::vector<std::string>{"p3"}));
+    EXPECT_EQ(scheduler.getMetrics().keyspace_expired, 2u);
+}
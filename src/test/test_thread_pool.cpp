@@ -0,0 +1,232 @@
+//
+// Unit test for ThreadPool (SharedQueue / WorkStealing)
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <array>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class ThreadPoolModeTest : public ::testing::TestWithParam<ThreadPool::Mode>
+{
+protected:
+    static ThreadPool::Config makeConfig(size_t threads, size_t max_queue)
+    {
+        ThreadPool::Config cfg;
+        cfg.num_threads = threads;
+        cfg.max_queue_size = max_queue;
+        cfg.log_exceptions = false;
+        cfg.mode = GetParam();
+        return cfg;
+    }
+};
+
+// 多生产者并发提交，结果必须全部可取回
+TEST_P(ThreadPoolModeTest, ConcurrentSubmit_ShouldRunEveryTask)
+{
+    ThreadPool pool(makeConfig(8, 0));
+
+    constexpr int kProducers = 8;
+    constexpr int kTasksPerProducer = 2000;
+
+    std::vector<std::vector<std::future<int>>> futures(kProducers);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p)
+    {
+        producers.emplace_back([&pool, &futures, p]
+        {
+            for (int i = 0; i < kTasksPerProducer; ++i)
+            {
+                futures[p].push_back(pool.submit([](int v) { return v * 2; }, i));
+            }
+        });
+    }
+    for (auto& t : producers)t.join();
+
+    for (int p = 0; p < kProducers; ++p)
+    {
+        for (int i = 0; i < kTasksPerProducer; ++i)
+        {
+            ASSERT_EQ(futures[p][i].get(), i * 2);
+        }
+    }
+
+    const auto stats = pool.get_stats();
+    EXPECT_EQ(stats.total_submitted, static_cast<uint64_t>(kProducers * kTasksPerProducer));
+    EXPECT_EQ(stats.rejected_tasks, 0u);
+}
+
+// 任务内再次提交（WorkStealing 下进入本地 deque），停机时必须一并排空
+TEST_P(ThreadPoolModeTest, NestedSubmit_ShouldDrainOnStop)
+{
+    ThreadPool pool(makeConfig(4, 0));
+    std::atomic<int> parents{0};
+    std::atomic<int> children{0};
+
+    constexpr int kParents = 200;
+    constexpr int kChildren = 10;
+    for (int i = 0; i < kParents; ++i)
+    {
+        (void)pool.submit([&pool, &parents, &children]
+        {
+            for (int c = 0; c < kChildren; ++c)
+            {
+                (void)pool.submit([&children]
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    children.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+            parents.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+
+    // 等父任务全部跑完，子任务都已入队后再停机
+    while (parents.load() < kParents)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.stop_and_wait();
+
+    EXPECT_EQ(children.load(), kParents * kChildren);
+    EXPECT_THROW((void)pool.submit([] {}), std::runtime_error);
+
+    const auto stats = pool.get_stats();
+    EXPECT_EQ(stats.completed_tasks, static_cast<uint64_t>(kParents * (kChildren + 1)));
+    EXPECT_EQ(stats.rejected_tasks, 1u);
+    EXPECT_EQ(stats.queued_tasks, 0u);
+}
+
+// 队列满时拒绝；submit 的异常由 future 携带，不计入 failed
+TEST_P(ThreadPoolModeTest, QueueFull_ShouldRejectAndKeepAccepted)
+{
+    ThreadPool pool(makeConfig(1, 4));
+
+    std::promise<void> gate;
+    auto gate_future = gate.get_future().share();
+    std::atomic<bool> started{false};
+    (void)pool.submit([gate_future, &started]
+    {
+        started = true;
+        gate_future.wait();
+    });
+    while (!started.load())std::this_thread::yield();
+
+    std::vector<std::future<void>> accepted;
+    int rejected = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        try
+        {
+            accepted.push_back(pool.submit([] { throw std::logic_error("boom"); }));
+        }
+        catch (const std::runtime_error&)
+        {
+            ++rejected;
+        }
+    }
+    EXPECT_EQ(accepted.size(), 4u);
+    EXPECT_EQ(rejected, 12);
+
+    gate.set_value();
+    for (auto& f : accepted)
+    {
+        EXPECT_THROW(f.get(), std::logic_error);
+    }
+    pool.stop_and_wait();
+
+    const auto stats = pool.get_stats();
+    EXPECT_EQ(stats.completed_tasks, 5u);
+    EXPECT_EQ(stats.failed_tasks, 0u);
+    EXPECT_EQ(stats.rejected_tasks, 12u);
+}
+
+// post 不分配：内联 callable 的任务分配计数为 0；submit 每个任务 2 次
+TEST_P(ThreadPoolModeTest, PostAndSubmit_ShouldReportAllocations)
+{
+    ThreadPool pool(makeConfig(2, 0));
+    std::atomic<int> done{0};
+
+    constexpr int kTasks = 1000;
+    for (int i = 0; i < kTasks; ++i)
+    {
+        // 只可移动的捕获体同样可以投递
+        pool.post([&done, p = std::make_unique<int>(i)]
+        {
+            done.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    while (done.load() < kTasks)std::this_thread::yield();
+    EXPECT_EQ(pool.get_stats().task_allocations, 0u);
+
+    // 超出内联缓冲区的捕获体退化为一次堆分配
+    std::array<char, InlineTask::kInlineSize + 1> big{};
+    ASSERT_TRUE(pool.try_post([&done, big]
+    {
+        done.fetch_add(static_cast<int>(big.size() > 0), std::memory_order_relaxed);
+    }));
+
+    (void)pool.submit([] {}).get();
+    pool.stop_and_wait();
+
+    const auto stats = pool.get_stats();
+    EXPECT_EQ(stats.task_allocations, 3u);
+    EXPECT_EQ(stats.total_submitted, static_cast<uint64_t>(kTasks + 2));
+    EXPECT_FALSE(pool.try_post([] {}));
+    EXPECT_THROW(pool.post([] {}), std::runtime_error);
+    EXPECT_EQ(pool.get_stats().rejected_tasks, 2u);
+}
+
+// post 的异常由 worker 捕获并计入 failed
+TEST_P(ThreadPoolModeTest, PostException_ShouldBeCountedAsFailed)
+{
+    ThreadPool pool(makeConfig(1, 0));
+    pool.post([] { throw std::runtime_error("boom"); });
+    pool.post([] {});
+    pool.stop_and_wait();
+
+    const auto stats = pool.get_stats();
+    EXPECT_EQ(stats.failed_tasks, 1u);
+    EXPECT_EQ(stats.completed_tasks, 1u);
+}
+
+TEST(InlineTaskTest, MoveAndReset_ShouldDestroyCaptureOnce)
+{
+    auto tracker = std::make_shared<int>(0);
+    {
+        InlineTask a([tracker] { ++*tracker; });
+        ASSERT_TRUE(a.is_inline());
+        EXPECT_EQ(tracker.use_count(), 2);
+
+        InlineTask b(std::move(a));
+        EXPECT_FALSE(static_cast<bool>(a));
+        b();
+        EXPECT_EQ(*tracker, 1);
+        EXPECT_EQ(tracker.use_count(), 2);
+
+        InlineTask c;
+        c = std::move(b);
+        c();
+        EXPECT_EQ(*tracker, 2);
+        c.reset();
+        EXPECT_EQ(tracker.use_count(), 1);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, ThreadPoolModeTest,
+                         ::testing::Values(ThreadPool::Mode::SharedQueue, ThreadPool::Mode::WorkStealing),
+                         [](const ::testing::TestParamInfo<ThreadPool::Mode>& info)
+                         {
+                             return info.param == ThreadPool::Mode::WorkStealing ? "WorkStealing" : "SharedQueue";
+                         });
@@ -0,0 +1,128 @@
+//
+// Unit test for TimingWheel
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "TimingWheel.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = TimingWheel::Clock;
+    using std::chrono::milliseconds;
+
+    const Clock::time_point kStart{};
+
+    TimingWheel::Config smallWheel()
+    {
+        TimingWheel::Config cfg;
+        cfg.tick = milliseconds(10);
+        cfg.slots_per_level = 8;
+        cfg.levels = 3;
+        return cfg;
+    }
+
+    Clock::time_point at(int64_t ms)
+    {
+        return kStart + milliseconds(ms);
+    }
+
+    std::vector<std::string> sorted(std::vector<std::string> keys)
+    {
+        std::ranges::sort(keys);
+        return keys;
+    }
+}
+
+// 截止时间向上取整到 tick：不会提前到期
+TEST(TimingWheelTest, Schedule_ShouldFireOnDeadlineTick)
+{
+    TimingWheel wheel(smallWheel(), kStart);
+    EXPECT_TRUE(wheel.schedule("a", at(25)));
+    EXPECT_TRUE(wheel.schedule("b", at(30)));
+    EXPECT_EQ(wheel.size(), 2u);
+
+    EXPECT_TRUE(wheel.advance(at(29)).empty());
+    EXPECT_EQ(sorted(wheel.advance(at(30))), (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(wheel.size(), 0u);
+    EXPECT_TRUE(wheel.advance(at(1000)).empty());
+}
+
+// 刷新（心跳）推迟到期；提前截止时间立即生效
+TEST(TimingWheelTest, Reschedule_ShouldMoveDeadline)
+{
+    TimingWheel wheel(smallWheel(), kStart);
+    wheel.schedule("late", at(50));
+    EXPECT_FALSE(wheel.schedule("late", at(900)));
+    wheel.schedule("early", at(500));
+    EXPECT_FALSE(wheel.schedule("early", at(60)));
+
+    EXPECT_EQ(wheel.advance(at(60)), (std::vector<std::string>{"early"}));
+    EXPECT_TRUE(wheel.advance(at(890)).empty());
+    EXPECT_EQ(wheel.advance(at(900)), (std::vector<std::string>{"late"}));
+}
+
+TEST(TimingWheelTest, Cancel_ShouldRemoveKey)
+{
+    TimingWheel wheel(smallWheel(), kStart);
+    wheel.schedule("a", at(100));
+    wheel.schedule("b", at(100));
+
+    EXPECT_TRUE(wheel.cancel("a"));
+    EXPECT_FALSE(wheel.cancel("a"));
+    EXPECT_EQ(wheel.advance(at(100)), (std::vector<std::string>{"b"}));
+
+    // 已过期的截止时间在下一个 tick 到期；节点复用不串键
+    wheel.schedule("c", at(0));
+    EXPECT_EQ(wheel.advance(at(110)), (std::vector<std::string>{"c"}));
+}
+
+// 随机截止时间（含超出总跨度 8^3 tick 的）与随机刷新：每个 key 恰好在最终截止 tick 到期
+TEST(TimingWheelTest, RandomDeadlines_ShouldFireExactlyOnTime)
+{
+    TimingWheel wheel(smallWheel(), kStart);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int64_t> delay(1, 2000);
+
+    std::map<std::string, int64_t> expected_tick;
+    int64_t now_tick = 0;
+    for (int i = 0; i < 3000; ++i)
+    {
+        const std::string key = "k" + std::to_string(rng() % 400);
+        const int64_t deadline = now_tick + delay(rng);
+        wheel.schedule(key, at(deadline * 10));
+        expected_tick[key] = deadline;
+
+        if (i % 7 == 0)
+        {
+            const int64_t previous = now_tick;
+            now_tick += static_cast<int64_t>(rng() % 5);
+            for (const auto& fired : wheel.advance(at(now_tick * 10)))
+            {
+                ASSERT_GT(expected_tick.at(fired), previous) << fired;
+                ASSERT_LE(expected_tick.at(fired), now_tick) << fired;
+                expected_tick.erase(fired);
+            }
+        }
+    }
+
+    while (!expected_tick.empty())
+    {
+        ++now_tick;
+        for (const auto& fired : wheel.advance(at(now_tick * 10)))
+        {
+            ASSERT_EQ(expected_tick.at(fired), now_tick) << fired;
+            expected_tick.erase(fired);
+        }
+        ASSERT_LT(now_tick, 10000);
+    }
+    EXPECT_EQ(wheel.size(), 0u);
+}
@@ -0,0 +1,267 @@
+//
+// Unit test for WriteBehindStreamStateManager
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "InMemoryStreamStateManager.h"
+#include "WriteBehindStreamStateManager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    StreamTask makeTask(const std::string& stream, const std::string& client, StreamType type)
+    {
+        StreamTask task;
+        task.stream_name = stream;
+        task.client_id = client;
+        task.type = type;
+        task.state = StreamState::ACTIVE;
+        task.protocol = StreamProtocol::RTMP;
+        task.server_ip = "10.0.0.1";
+        task.server_port = 1935;
+        return task;
+    }
+
+    // 不会自动刷新的配置：只有 stop() / 推流端同步注册才会写后端
+    WriteBehindStreamStateManager::Config manualFlush()
+    {
+        WriteBehindStreamStateManager::Config cfg;
+        cfg.shards = 4;
+        cfg.flush_interval = std::chrono::hours(1);
+        cfg.flush_batch = 1000;
+        return cfg;
+    }
+
+    bool waitUntil(const std::function<bool()>& pred)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + 2s;
+        while (!pred())
+        {
+            if (std::chrono::steady_clock::now() > deadline)return false;
+            std::this_thread::sleep_for(2ms);
+        }
+        return true;
+    }
+
+    std::vector<std::string> sorted(std::vector<std::string> v)
+    {
+        std::ranges::sort(v);
+        return v;
+    }
+
+    // 仿照 RedisStreamStateManager 的计数行为：注册成功的播放端 +1，批量注销不论任务是否存在都 -1；可注入注册失败
+    class CountingBackend : public InMemoryStreamStateManager
+    {
+    public:
+        std::atomic<bool> failRegisters{false};
+        std::atomic<int64_t> players{0};
+
+        size_t registerTasksBatch(const std::vector<StreamTask>& tasks, std::vector<bool>* results) override
+        {
+            if (failRegisters.load())
+            {
+                if (results)results->assign(tasks.size(), false);
+                return 0;
+            }
+            std::vector<bool> ok;
+            const size_t count = InMemoryStreamStateManager::registerTasksBatch(tasks, &ok);
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                if (ok[i] && tasks[i].type == StreamType::PLAYER)players.fetch_add(1);
+            }
+            if (results)*results = std::move(ok);
+            return count;
+        }
+
+        size_t deregisterTasksBatch(const std::vector<TaskIdentifier>& tasks) override
+        {
+            for (const auto& task : tasks)
+            {
+                if (task.type == StreamType::PLAYER)players.fetch_sub(1);
+            }
+            (void)InMemoryStreamStateManager::deregisterTasksBatch(tasks);
+            return tasks.size();
+        }
+    };
+}
+
+// 播放端注册与心跳先落在本地：读到自己的写入，后端在 stop() 排空后才可见，多次心跳合并为一次写入
+TEST(WriteBehindStreamStateManagerTest, PlayerWrites_ShouldBeVisibleLocallyAndDrainedOnStop)
+{
+    InMemoryStreamStateManager backend;
+    WriteBehindStreamStateManager wb(backend, manualFlush());
+
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p1", StreamType::PLAYER)));
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p2", StreamType::PLAYER)));
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(wb.touchTask("live", "p1"));
+    }
+    EXPECT_TRUE(wb.deregisterTask("live", "p2"));
+
+    EXPECT_EQ(backend.getActivePlayerCount(), 0u);
+    EXPECT_TRUE(wb.getTask("live", "p1").has_value());
+    EXPECT_FALSE(wb.getTask("live", "p2").has_value());
+    EXPECT_EQ(wb.getStreamClientIds("live"), (std::vector<std::string>{"p1"}));
+    // p2 的注册与注销在本地抵消
+    EXPECT_EQ(wb.stats().pending, 1u);
+
+    wb.stop();
+    const auto s = wb.stats();
+    EXPECT_EQ(s.pending, 0u);
+    EXPECT_EQ(s.flushed_ops, 1u);
+    EXPECT_EQ(s.coalesced_ops, 11u);
+    EXPECT_EQ(backend.getStreamClientIds("live"), (std::vector<std::string>{"p1"}));
+    EXPECT_EQ(backend.getActivePlayerCount(), 1u);
+}
+
+// 推流端同步抢占推流位；同一条流上本地未落盘的注销先写入后端，新推流端才能抢到
+TEST(WriteBehindStreamStateManagerTest, PublisherRegister_ShouldBeSynchronousAndOrdered)
+{
+    InMemoryStreamStateManager backend;
+    WriteBehindStreamStateManager wb(backend, manualFlush());
+
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "pub1", StreamType::PUBLISHER)));
+    EXPECT_TRUE(backend.getPublisherTask("live").has_value());
+    EXPECT_FALSE(wb.registerTask(makeTask("live", "pub2", StreamType::PUBLISHER)));
+
+    EXPECT_TRUE(wb.deregisterTask("live", "pub1"));
+    EXPECT_FALSE(wb.getPublisherTask("live").has_value());
+    EXPECT_FALSE(wb.getPublisherLocation("live").has_value());
+    EXPECT_TRUE(backend.getPublisherTask("live").has_value());
+
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "pub2", StreamType::PUBLISHER)));
+    const auto pub = backend.getPublisherTask("live");
+    ASSERT_TRUE(pub.has_value());
+    EXPECT_EQ(pub->client_id, "pub2");
+    EXPECT_EQ(wb.getPublisherTask("live")->client_id, "pub2");
+    EXPECT_EQ(wb.getPublisherLocation("live")->client_id, "pub2");
+}
+
+// 整流注销丢弃本地未落盘的变更，之后到达的注册不受影响
+TEST(WriteBehindStreamStateManagerTest, DeregisterAllMembers_ShouldDropPendingWrites)
+{
+    InMemoryStreamStateManager backend;
+    WriteBehindStreamStateManager wb(backend, manualFlush());
+
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "pub", StreamType::PUBLISHER)));
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p1", StreamType::PLAYER)));
+    ASSERT_TRUE(wb.registerTask(makeTask("other", "p2", StreamType::PLAYER)));
+
+    wb.deregisterAllMembers("live");
+    EXPECT_TRUE(wb.getStreamClientIds("live").empty());
+    EXPECT_EQ(wb.stats().pending, 1u);
+
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p3", StreamType::PLAYER)));
+    wb.stop();
+    EXPECT_EQ(sorted(backend.getStreamClientIds("live")), (std::vector<std::string>{"p3"}));
+    EXPECT_EQ(backend.getStreamClientIds("other"), (std::vector<std::string>{"p2"}));
+    EXPECT_EQ(backend.getActivePublisherCount(), 0u);
+}
+
+// 后台线程按周期刷新；后端已回收的任务在心跳落盘失败后剔除缓存，之后的心跳如实返回 false
+TEST(WriteBehindStreamStateManagerTest, Flusher_ShouldWriteBatchesAndEvictStaleTasks)
+{
+    InMemoryStreamStateManager backend;
+    auto cfg = manualFlush();
+    cfg.flush_interval = 5ms;
+    WriteBehindStreamStateManager wb(backend, cfg);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        ASSERT_TRUE(wb.registerTask(makeTask("live", "p" + std::to_string(i), StreamType::PLAYER)));
+    }
+    ASSERT_TRUE(waitUntil([&] { return backend.getActivePlayerCount() == 20; }));
+    EXPECT_GE(wb.stats().batches, 1u);
+    EXPECT_GE(wb.stats().max_batch_size, 1u);
+
+    // 模拟其它实例注销了该任务
+    ASSERT_TRUE(backend.deregisterTask("live", "p0"));
+    EXPECT_TRUE(wb.touchTask("live", "p0"));
+    ASSERT_TRUE(waitUntil([&] { return wb.stats().pending == 0 && wb.stats().cached == 19; }));
+    EXPECT_FALSE(wb.touchTask("live", "p0"));
+    EXPECT_TRUE(wb.touchTask("live", "p1"));
+}
+
+// 待写 key 达到上限且没有刷新时，写入方等待超时后按存储故障返回 false
+TEST(WriteBehindStreamStateManagerTest, Backpressure_ShouldRejectWhenPendingIsFull)
+{
+    InMemoryStreamStateManager backend;
+    auto cfg = manualFlush();
+    cfg.max_pending = 2;
+    cfg.backpressure_timeout = 20ms;
+    WriteBehindStreamStateManager wb(backend, cfg);
+
+    EXPECT_TRUE(wb.registerTask(makeTask("live", "p1", StreamType::PLAYER)));
+    EXPECT_TRUE(wb.registerTask(makeTask("live", "p2", StreamType::PLAYER)));
+    EXPECT_FALSE(wb.registerTask(makeTask("live", "p3", StreamType::PLAYER)));
+    EXPECT_EQ(wb.stats().rejected, 1u);
+    EXPECT_EQ(wb.stats().backpressure_waits, 1u);
+}
+
+// 未落盘的注册与随后的注销在本地抵消，后端计数不会被多减
+TEST(WriteBehindStreamStateManagerTest, RegisterThenDeregister_ShouldCancelLocally)
+{
+    CountingBackend backend;
+    WriteBehindStreamStateManager wb(backend, manualFlush());
+
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p1", StreamType::PLAYER)));
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p2", StreamType::PLAYER)));
+    EXPECT_TRUE(wb.deregisterTask("live", "p1"));
+    EXPECT_FALSE(wb.getTask("live", "p1").has_value());
+    EXPECT_EQ(wb.stats().pending, 1u);
+    EXPECT_EQ(wb.stats().cached, 1u);
+
+    wb.stop();
+    EXPECT_EQ(backend.players.load(), 1);
+    EXPECT_EQ(backend.getStreamClientIds("live"), (std::vector<std::string>{"p2"}));
+}
+
+// 注册写入失败后到达的注销：注册从未到达后端，两者一并丢弃
+TEST(WriteBehindStreamStateManagerTest, DeregisterAfterFailedRegister_ShouldNotReachBackend)
+{
+    CountingBackend backend;
+    auto cfg = manualFlush();
+    cfg.flush_interval = 5ms;
+    WriteBehindStreamStateManager wb(backend, cfg);
+
+    backend.failRegisters.store(true);
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p1", StreamType::PLAYER)));
+    ASSERT_TRUE(waitUntil([&] { return wb.stats().flush_errors >= 1; }));
+
+    EXPECT_TRUE(wb.deregisterTask("live", "p1"));
+    backend.failRegisters.store(false);
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p2", StreamType::PLAYER)));
+    ASSERT_TRUE(waitUntil([&] { return wb.stats().pending == 0 && wb.stats().cached == 1; }));
+
+    wb.stop();
+    EXPECT_EQ(backend.players.load(), 1);
+    EXPECT_EQ(backend.getStreamClientIds("live"), (std::vector<std::string>{"p2"}));
+}
+
+// 已落盘的注册照常写注销
+TEST(WriteBehindStreamStateManagerTest, DeregisterAfterFlush_ShouldReachBackend)
+{
+    CountingBackend backend;
+    auto cfg = manualFlush();
+    cfg.flush_interval = 5ms;
+    WriteBehindStreamStateManager wb(backend, cfg);
+
+    ASSERT_TRUE(wb.registerTask(makeTask("live", "p1", StreamType::PLAYER)));
+    ASSERT_TRUE(waitUntil([&] { return backend.players.load() == 1; }));
+    EXPECT_TRUE(wb.deregisterTask("live", "p1"));
+
+    wb.stop();
+    EXPECT_EQ(backend.players.load(), 0);
+    EXPECT_TRUE(backend.getStreamClientIds("live").empty());
+}
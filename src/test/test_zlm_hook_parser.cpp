@@ -0,0 +1,158 @@
+//
+// Unit test for ZlmHookRequestView (zero-copy hook parser)
+// Author: wxx
+// Date: 2026/10/16
+//
+
+#include "gtest/gtest.h"
+
+#include "ZlmHookCommon.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    // 典型 on_publish 请求体 (ZLMediaKit 实际推送字段)
+    const std::string kPublishBody = R"({
+        "mediaServerId": "your_server_id",
+        "app": "live",
+        "id": "140186529001776",
+        "ip": "10.0.0.12",
+        "params": "token=abc123&sg=1",
+        "port": 65284,
+        "schema": "rtmp",
+        "protocol": "rtmp",
+        "stream": "camera_01",
+        "vhost": "__defaultVhost__",
+        "originType": 0,
+        "originTypeStr": "unknown",
+        "originUrl": "",
+        "originSock": {"identifier": "140186529001776", "local_ip": "10.0.0.1", "local_port": 1935},
+        "hook_index": 12,
+        "enabled": true,
+        "tags": [1, 2.5e3, null, false, {"k": []}]
+    })";
+
+    // 用完整路径解析，作为行为基准
+    ZlmHookRequest parseReference(const std::string& body)
+    {
+        auto req = ZlmHookRequest::from_json(json::parse(body));
+        EXPECT_TRUE(req.has_value());
+        return *req;
+    }
+
+    void expectSame(const ZlmHookRequestView& v, const ZlmHookRequest& ref)
+    {
+        EXPECT_EQ(v.protocol, ref.protocol);
+        EXPECT_EQ(v.app, ref.app);
+        EXPECT_EQ(v.stream, ref.stream);
+        EXPECT_EQ(v.vhost, ref.vhost);
+        EXPECT_EQ(v.client_id, ref.client_id);
+        EXPECT_EQ(v.ip, ref.ip);
+        EXPECT_EQ(v.stream_key(), ref.stream_key());
+        EXPECT_EQ(v.get_token(), ref.get_token());
+        for (const auto& [key,value] : ref.params)
+        {
+            EXPECT_EQ(v.find_param(key), value) << key;
+        }
+    }
+}
+
+TEST(ZlmHookParserTest, TypicalPayload_ShouldMatchFromJson)
+{
+    ZlmHookRequestView view;
+    ASSERT_TRUE(ZlmHookRequestView::parse(kPublishBody, view));
+    expectSame(view, parseReference(kPublishBody));
+
+    // 视图字段必须直接指向原始请求体，而不是拷贝
+    const auto* begin = kPublishBody.data();
+    const auto* end = begin + kPublishBody.size();
+    EXPECT_GE(view.stream.data(), begin);
+    EXPECT_LT(view.stream.data(), end);
+}
+
+TEST(ZlmHookParserTest, MissingFields_ShouldUseDefaults)
+{
+    const std::string body = R"({"stream":"s1","protocol":"webrtc"})";
+
+    ZlmHookRequestView view;
+    ASSERT_TRUE(ZlmHookRequestView::parse(body, view));
+    expectSame(view, parseReference(body));
+    EXPECT_EQ(view.protocol, StreamProtocol::WebRTC);
+    EXPECT_EQ(view.stream_key(), "__defaultVhost__/live/s1");
+}
+
+TEST(ZlmHookParserTest, DuplicateParams_LastShouldWin)
+{
+    const std::string body = R"({"stream":"s1","params":"token=a&x=1&token=b"})";
+
+    ZlmHookRequestView view;
+    ASSERT_TRUE(ZlmHookRequestView::parse(body, view));
+    expectSame(view, parseReference(body));
+    EXPECT_EQ(view.get_token(), "b");
+}
+
+// 快速路径无法零拷贝表达的输入：必须回退，交由 from_json 裁决
+TEST(ZlmHookParserTest, UnsupportedInput_ShouldFallback)
+{
+    const std::vector<std::string> bodies = {
+        R"({"stream":"s1","params":"{\"token\":\"abc\"}"})", // JSON 编码的 params
+        R"({"stream":"cam\u0031"})",                        // 字段含转义
+        R"({"stream":1})",                                   // 字段类型不符
+        R"({"stream":"s1",})",                               // 非法 JSON
+        R"({"stream":"s1"} trailing)",
+        R"([])",
+        R"()",
+    };
+
+    for (const auto& body : bodies)
+    {
+        ZlmHookRequestView view;
+        EXPECT_FALSE(ZlmHookRequestView::parse(body, view)) << body;
+    }
+}
+
+// 非法数字：快速路径必须与 json::parse 同样拒绝，不得放行
+TEST(ZlmHookParserTest, MalformedNumber_ShouldRejectLikeDom)
+{
+    const std::vector<std::string> numbers = {
+        "--1e", "1.2.3", "+5", "e", "-", "01", "1.", ".5", "1e", "1e+", "-e1",
+    };
+
+    for (const auto& num : numbers)
+    {
+        const std::string body = R"({"stream":"s1","port":)" + num + "}";
+        ZlmHookRequestView view;
+        EXPECT_FALSE(ZlmHookRequestView::parse(body, view)) << body;
+        EXPECT_FALSE(json::accept(body)) << body;
+    }
+}
+
+// 合法数字：两条路径均应接受
+TEST(ZlmHookParserTest, ValidNumber_ShouldAccept)
+{
+    const std::vector<std::string> numbers = {
+        "0", "-0", "12", "-3.25", "1e9", "2.5E-3", "0.0e+0",
+    };
+
+    for (const auto& num : numbers)
+    {
+        const std::string body = R"({"stream":"s1","port":)" + num + "}";
+        ZlmHookRequestView view;
+        EXPECT_TRUE(ZlmHookRequestView::parse(body, view)) << body;
+        EXPECT_TRUE(json::accept(body)) << body;
+        EXPECT_EQ(view.stream, "s1");
+    }
+}
+
+// DOM 兜底路径转换出的视图应与原对象等价
+TEST(ZlmHookParserTest, OwnedRequestView_ShouldMatch)
+{
+    const std::string body = R"({"stream":"s1","params":"{\"token\":\"abc\",\"sg\":\"1\"}"})";
+    const auto ref = parseReference(body);
+
+    const auto view = ref.view();
+    expectSame(view, ref);
+    EXPECT_EQ(view.get_token(), "abc");
+}
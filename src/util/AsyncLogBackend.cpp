@@ -0,0 +1,546 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "AsyncLogBackend.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace
+{
+    std::atomic<uint64_t> g_nextBackendId{1};
+
+    // 单次 writev 的 iovec 上限（POSIX 保证 IOV_MAX >= 16，Linux 为 1024）
+    constexpr size_t kMaxIov = 1024;
+    // 控制台每条记录占 3 个 iovec：颜色 / 正文 / 复位
+    constexpr size_t kRecordsPerWrite = kMaxIov / 3;
+
+    constexpr std::string_view kColorReset = "\033[0m";
+    constexpr std::string_view kTruncatedMark = "...[truncated]";
+
+    int64_t nowMicros()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // 处理 EINTR 与部分写；失败返回 false
+    bool writeFully(int fd, iovec* iov, int count)
+    {
+        while (count > 0)
+        {
+            const ssize_t n = ::writev(fd, iov, count);
+            if (n < 0)
+            {
+                if (errno == EINTR)continue;
+                return false;
+            }
+
+            auto remaining = static_cast<size_t>(n);
+            while (count > 0 && remaining >= iov->iov_len)
+            {
+                remaining -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count > 0)
+            {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+                iov->iov_len -= remaining;
+            }
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief 线程局部的环句柄
+ * * 线程退出时标记 closed，后台线程排空后将其从注册表移除。
+ */
+struct AsyncLogRingHandle
+{
+    uint64_t backend_id = 0;
+    std::shared_ptr<AsyncLogBackend::ThreadRing> ring;
+
+    ~AsyncLogRingHandle()
+    {
+        if (ring)
+        {
+            ring->closed.store(true, std::memory_order_release);
+        }
+    }
+};
+
+namespace
+{
+    thread_local AsyncLogRingHandle tls_ring;
+}
+
+AsyncLogBackend::ThreadRing::ThreadRing(size_t capacity)
+    // 不做值初始化：上千条 * 512 字节的清零没有意义，页面按需触达
+    : slots(std::make_unique_for_overwrite<Record[]>(capacity)),
+      mask(capacity - 1)
+{
+}
+
+AsyncLogBackend::AsyncLogBackend(const Config& config)
+    : _id(g_nextBackendId.fetch_add(1, std::memory_order_relaxed)),
+      _ringCapacity(std::bit_ceil(std::max<size_t>(config.ring_capacity, 2))),
+      _overflowPolicy(config.overflow_policy),
+      _flushInterval(config.flush_interval),
+      _toConsole(config.to_console),
+      _includeMs(config.include_milliseconds)
+{
+    if (!config.file_path.empty())
+    {
+        _fileFd = ::open(config.file_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (_fileFd < 0)
+        {
+            // 后端自身不能走 Logger，否则 Block 策略下可能自锁
+            const std::string msg = "[AsyncLogBackend] Failed to open: " + config.file_path + "\n";
+            (void)::write(STDERR_FILENO, msg.data(), msg.size());
+        }
+    }
+
+    _batch.reserve(_ringCapacity);
+    _plain.reserve(kRecordsPerWrite * 160);
+    _spans.reserve(kRecordsPerWrite);
+
+    _running.store(true, std::memory_order_release);
+    _worker = std::jthread([this](std::stop_token stoken)
+    {
+        run(stoken);
+    });
+}
+
+AsyncLogBackend::~AsyncLogBackend()
+{
+    stop();
+    if (_fileFd >= 0)
+    {
+        ::close(_fileFd);
+    }
+}
+
+AsyncLogBackend::ThreadRing* AsyncLogBackend::localRing()
+{
+    auto& handle = tls_ring;
+    if (handle.backend_id == _id)[[likely]]
+    {
+        return handle.ring.get();
+    }
+
+    // 首次写日志，或上一个后端已被替换：旧环交给旧后端排空回收
+    if (handle.ring)
+    {
+        handle.ring->closed.store(true, std::memory_order_release);
+    }
+
+    handle.ring = std::make_shared<ThreadRing>(_ringCapacity);
+    handle.backend_id = _id;
+    {
+        std::lock_guard<std::mutex> lock(_ringsMutex);
+        _rings.push_back(handle.ring);
+    }
+    _ringsVersion.fetch_add(1, std::memory_order_release);
+    return handle.ring.get();
+}
+
+bool AsyncLogBackend::enqueue(LogLevel level, std::string_view message, const char* file, int line)
+{
+    if (!_running.load(std::memory_order_acquire))[[unlikely]]
+    {
+        return false;
+    }
+
+    ThreadRing& ring = *localRing();
+    const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+
+    if (tail - ring.cached_head >= _ringCapacity)
+    {
+        ring.cached_head = ring.head.load(std::memory_order_acquire);
+        if (tail - ring.cached_head >= _ringCapacity)
+        {
+            if (_overflowPolicy == LogOverflowPolicy::Drop || !waitForSpace(ring, tail))
+            {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    Record& record = ring.slots[tail & ring.mask];
+    record.timestamp_us = nowMicros();
+    record.file = file;
+    record.line = line;
+    record.level = level;
+
+    const size_t length = std::min(message.size(), kTextCapacity);
+    std::memcpy(record.text, message.data(), length);
+    record.length = static_cast<uint16_t>(length);
+    record.truncated = length < message.size();
+    if (record.truncated)[[unlikely]]
+    {
+        _truncated.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ring.tail.store(tail + 1, std::memory_order_release);
+
+    // 与 stop() 中的栅栏配对：这里仍看到 running，则 stop() 的最后一轮排空一定能看到这条记录
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!_running.load(std::memory_order_relaxed))[[unlikely]]
+    {
+        return settleAfterStop(ring, tail);
+    }
+
+    // 过半时提前唤醒后台线程，避免等到下一次轮询；只有缓存的 head 显示过半时才去读真实 head
+    const uint64_t half = _ringCapacity / 2;
+    if (tail + 1 - ring.cached_head >= half)
+    {
+        ring.cached_head = ring.head.load(std::memory_order_acquire);
+        if (tail + 1 - ring.cached_head >= half)
+        {
+            wake();
+        }
+    }
+    return true;
+}
+
+bool AsyncLogBackend::waitForSpace(ThreadRing& ring, uint64_t tail)
+{
+    _blocked.fetch_add(1, std::memory_order_relaxed);
+    while (_running.load(std::memory_order_acquire))
+    {
+        wake();
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+        ring.cached_head = ring.head.load(std::memory_order_acquire);
+        if (tail - ring.cached_head < _ringCapacity)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 记录发布时后端恰好停止
+ * * 最后一轮排空尚未执行：由它写出；已执行且已带上这条记录：同样算写出；
+ * * 已执行但没有带上：撤回记录（此时没有消费者），返回 false 让调用方同步输出，既不丢也不重复。
+ */
+bool AsyncLogBackend::settleAfterStop(ThreadRing& ring, uint64_t tail)
+{
+    std::lock_guard<std::mutex> lock(_finalDrainMutex);
+    if (!_finalDrained || ring.head.load(std::memory_order_acquire) > tail)
+    {
+        return true;
+    }
+
+    ring.tail.store(tail, std::memory_order_relaxed);
+    return false;
+}
+
+void AsyncLogBackend::wake()
+{
+    if (!_wakePending.exchange(true, std::memory_order_acq_rel))
+    {
+        _wakeCondition.notify_one();
+    }
+}
+
+void AsyncLogBackend::flush()
+{
+    std::unique_lock<std::mutex> lock(_wakeMutex);
+    if (!_running.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    const uint64_t target = ++_flushRequested;
+    _wakePending.store(true, std::memory_order_release);
+    _wakeCondition.notify_one();
+
+    _flushCondition.wait(lock, [this, target]
+    {
+        return _flushCompleted >= target;
+    });
+}
+
+void AsyncLogBackend::stop()
+{
+    if (!_running.exchange(false, std::memory_order_seq_cst))
+    {
+        return;
+    }
+    // 与 enqueue 发布记录后的栅栏配对，见 settleAfterStop
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    _worker.request_stop();
+    _wakeCondition.notify_one();
+    if (_worker.joinable())
+    {
+        _worker.join();
+    }
+
+    // 后台线程退出前已完成最后一轮排空；这里再补一轮，覆盖与 stop 并发入队的记录
+    {
+        std::lock_guard<std::mutex> lock(_finalDrainMutex);
+        (void)drainOnce();
+        _finalDrained = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _flushCompleted = _flushRequested;
+    }
+    _flushCondition.notify_all();
+}
+
+/**
+ * @brief 后台线程主循环
+ * * 每轮：记下当前 flush 请求号 -> 排空所有环 -> 宣告该请求号之前的 flush 完成。
+ * * 收到停止信号后仍会完成当轮排空再退出。
+ */
+void AsyncLogBackend::run(const std::stop_token& stoken)
+{
+    while (true)
+    {
+        uint64_t flush_target;
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            flush_target = _flushRequested;
+        }
+
+        const size_t drained = drainOnce();
+
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            if (_flushCompleted < flush_target)
+            {
+                _flushCompleted = flush_target;
+            }
+        }
+        _flushCondition.notify_all();
+
+        if (stoken.stop_requested())
+        {
+            break;
+        }
+
+        if (drained == 0)
+        {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wakeCondition.wait_for(lock, stoken, _flushInterval, [this]
+            {
+                return _wakePending.load(std::memory_order_acquire) || _flushRequested != _flushCompleted;
+            });
+        }
+        _wakePending.store(false, std::memory_order_release);
+    }
+}
+
+void AsyncLogBackend::refreshRings()
+{
+    const uint64_t version = _ringsVersion.load(std::memory_order_acquire);
+    if (version == _drainVersion)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_ringsMutex);
+    _drainRings = _rings;
+    _drainVersion = version;
+}
+
+/**
+ * @brief 排空各环在本轮开始时已发布的记录
+ * * 收集所有记录指针后按时间戳稳定排序（同一线程内保持原顺序），分块格式化并写出，最后统一推进 head。
+ * @return 本轮写出的记录数
+ */
+size_t AsyncLogBackend::drainOnce()
+{
+    refreshRings();
+
+    _batch.clear();
+    _snapshots.resize(_drainRings.size());
+    for (size_t i = 0; i < _drainRings.size(); ++i)
+    {
+        ThreadRing& ring = *_drainRings[i];
+        const uint64_t head = ring.head.load(std::memory_order_relaxed);
+        const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+        _snapshots[i] = tail;
+        for (uint64_t pos = head; pos < tail; ++pos)
+        {
+            _batch.push_back(&ring.slots[pos & ring.mask]);
+        }
+    }
+
+    const size_t total = _batch.size();
+    if (total > 0)
+    {
+        std::stable_sort(_batch.begin(), _batch.end(), [](const Record* a, const Record* b)
+        {
+            return a->timestamp_us < b->timestamp_us;
+        });
+
+        for (size_t begin = 0; begin < total; begin += kRecordsPerWrite)
+        {
+            const size_t end = std::min(total, begin + kRecordsPerWrite);
+            _plain.clear();
+            _spans.clear();
+            for (size_t i = begin; i < end; ++i)
+            {
+                appendFormatted(*_batch[i]);
+            }
+            writeBatch();
+        }
+
+        for (size_t i = 0; i < _drainRings.size(); ++i)
+        {
+            _drainRings[i]->head.store(_snapshots[i], std::memory_order_release);
+        }
+        _written.fetch_add(total, std::memory_order_relaxed);
+    }
+
+    // 回收所属线程已退出且已排空的环
+    bool reclaimed = false;
+    for (const auto& ring : _drainRings)
+    {
+        if (ring->closed.load(std::memory_order_acquire) &&
+            ring->head.load(std::memory_order_relaxed) == ring->tail.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(_ringsMutex);
+            if (const auto it = std::find(_rings.begin(), _rings.end(), ring); it != _rings.end())
+            {
+                _retiredEnqueued += ring->tail.load(std::memory_order_relaxed);
+                _rings.erase(it);
+                reclaimed = true;
+            }
+        }
+    }
+    if (reclaimed)
+    {
+        _ringsVersion.fetch_add(1, std::memory_order_release);
+    }
+
+    return total;
+}
+
+/**
+ * @brief 格式化单条记录，格式与同步路径一致：[时间][级别][文件:行]消息
+ * * 时间前缀按秒缓存，同一秒内的记录不再调用 localtime_r / strftime。
+ */
+void AsyncLogBackend::appendFormatted(const Record& record)
+{
+    const int64_t second = record.timestamp_us / 1'000'000;
+    if (second != _cachedSecond)
+    {
+        const auto tt = static_cast<std::time_t>(second);
+        std::tm tm_buf{};
+        localtime_r(&tt, &tm_buf);
+        std::strftime(_cachedPrefix, sizeof(_cachedPrefix), "%Y-%m-%d %H:%M:%S", &tm_buf);
+        _cachedSecond = second;
+    }
+
+    const size_t offset = _plain.size();
+    _plain += '[';
+    _plain += _cachedPrefix;
+    if (_includeMs)
+    {
+        const auto ms = static_cast<int>((record.timestamp_us / 1000) % 1000);
+        _plain += '.';
+        _plain += static_cast<char>('0' + ms / 100);
+        _plain += static_cast<char>('0' + ms / 10 % 10);
+        _plain += static_cast<char>('0' + ms % 10);
+    }
+    _plain += "][";
+    _plain += Logger::level_to_string(record.level);
+    _plain += ']';
+
+    if (record.file && record.line >= 0)
+    {
+        const char* filename = std::strrchr(record.file, '/');
+        char line_buf[16];
+        const auto [end, ec] = std::to_chars(std::begin(line_buf), std::end(line_buf), record.line);
+        _plain += '[';
+        _plain += filename ? filename + 1 : record.file;
+        _plain += ':';
+        _plain.append(line_buf, end);
+        _plain += ']';
+    }
+
+    _plain.append(record.text, record.length);
+    if (record.truncated)
+    {
+        _plain += kTruncatedMark;
+    }
+    _plain += '\n';
+
+    _spans.push_back(Span{offset, _plain.size() - offset, record.level});
+}
+
+/**
+ * @brief 写出当前块
+ * * 控制台：每条记录拆成 颜色 / 正文 / 复位 三段，由一次 writev 交付，正文不再为着色复制。
+ * * 文件：_plain 本身是连续的无色文本，整块写出。
+ */
+void AsyncLogBackend::writeBatch()
+{
+    if (_spans.empty())
+    {
+        return;
+    }
+
+    if (_toConsole)
+    {
+        iovec iov[kMaxIov];
+        size_t count = 0;
+        for (const auto& span : _spans)
+        {
+            const char* color = Logger::level_to_color_code(span.level);
+            iov[count++] = {const_cast<char*>(color), std::strlen(color)};
+            iov[count++] = {_plain.data() + span.offset, span.length};
+            iov[count++] = {const_cast<char*>(kColorReset.data()), kColorReset.size()};
+        }
+        if (!writeFully(STDERR_FILENO, iov, static_cast<int>(count)))
+        {
+            _writeErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (_fileFd >= 0)
+    {
+        iovec iov{_plain.data(), _plain.size()};
+        if (!writeFully(_fileFd, &iov, 1))
+        {
+            _writeErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+LogAsyncStats AsyncLogBackend::getStats() const
+{
+    LogAsyncStats s{};
+    s.enabled = _running.load(std::memory_order_relaxed);
+    s.written = _written.load(std::memory_order_relaxed);
+    s.dropped = _dropped.load(std::memory_order_relaxed);
+    s.truncated = _truncated.load(std::memory_order_relaxed);
+    s.blocked = _blocked.load(std::memory_order_relaxed);
+    s.write_errors = _writeErrors.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(_ringsMutex);
+    s.enqueued = _retiredEnqueued;
+    for (const auto& ring : _rings)
+    {
+        s.enqueued += ring->tail.load(std::memory_order_relaxed);
+    }
+    s.active_threads = _rings.size();
+    return s;
+}
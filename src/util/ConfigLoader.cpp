@@ -46,6 +46,55 @@ bool ConfigLoader::parseBool(const std::string& str)
     throw ConfigException("Invalid boolean value: " + str);
 }
 
+ConfigSnapshot::ConfigSnapshot(const std::map<std::string, std::string>& entries, uint64_t version)
+    : _version(version)
+{
+    _values.reserve(entries.size());
+    for (const auto& [key, text] : entries)
+    {
+        Value value{text, std::nullopt, std::nullopt, std::nullopt};
+        // 与旧 getter 的解析规则保持一致：stoi / stod 允许尾随字符
+        try
+        {
+            value.as_int = std::stoi(text);
+        }
+        catch (...)
+        {
+        }
+        try
+        {
+            value.as_double = std::stod(text);
+        }
+        catch (...)
+        {
+        }
+        try
+        {
+            value.as_bool = ConfigLoader::parseBool(text);
+        }
+        catch (...)
+        {
+        }
+        _values.emplace(key, std::move(value));
+    }
+}
+
+const ConfigSnapshot::Value* ConfigSnapshot::find(std::string_view key) const noexcept
+{
+    const auto it = _values.find(key);
+    return it != _values.end() ? &it->second : nullptr;
+}
+
+std::map<std::string, std::string> ConfigSnapshot::entries() const
+{
+    std::map<std::string, std::string> out;
+    for (const auto& [key, value] : _values)
+    {
+        out.emplace(key, value.text);
+    }
+    return out;
+}
+
 const std::vector<std::string>& ConfigLoader::getDefaultEnvKeys()
 {
     static const std::vector<std::string> keys = {
@@ -59,7 +108,7 @@ const std::vector<std::string>& ConfigLoader::getDefaultEnvKeys()
 
 ConfigLoader::ConfigLoader()
     : _mutex(),
-      _configMap(),
+      _snapshot(std::make_shared<const ConfigSnapshot>(std::map<std::string, std::string>{}, 0)),
       _last_ini_file{},
       _last_env_file{},
       _last_options(),
@@ -97,10 +146,10 @@ bool ConfigLoader::load(const std::string& ini_filename, const std::string& env_
             return false;
         }
 
-        //只有所有步骤都成功，才加锁进行原子交换
+        //只有所有步骤都成功，才发布新快照；读者要么看到旧快照，要么看到新快照
         {
             std::lock_guard<std::mutex> lock(_mutex);
-            _configMap.swap(nextConfig); // O(1) 线程安全切换
+            publish(nextConfig);
             _last_ini_file = ini_filename;
             _last_env_file = env_filename;
             _last_options = options;
@@ -116,7 +165,34 @@ bool ConfigLoader::load(const std::string& ini_filename, const std::string& env_
     }
 }
 
-void ConfigLoader::reload()
+void ConfigLoader::publish(const std::map<std::string, std::string>& entries)
+{
+    const uint64_t next = _version.load(std::memory_order_relaxed) + 1;
+    _snapshot.store(std::make_shared<const ConfigSnapshot>(entries, next), std::memory_order_release);
+    // 先发布快照再递增版本号：读者看到新版本号时必然能加载到不旧于它的快照
+    _version.store(next, std::memory_order_release);
+}
+
+const ConfigSnapshot& ConfigLoader::current() const noexcept
+{
+    struct Cache
+    {
+        const ConfigLoader* owner = nullptr;
+        uint64_t version = 0;
+        std::shared_ptr<const ConfigSnapshot> snapshot;
+    };
+    thread_local Cache cache;
+
+    if (cache.owner != this || cache.version != _version.load(std::memory_order_acquire))
+    {
+        cache.snapshot = _snapshot.load(std::memory_order_acquire);
+        cache.version = cache.snapshot->version();
+        cache.owner = this;
+    }
+    return *cache.snapshot;
+}
+
+bool ConfigLoader::reload()
 {
     LoadOptions currentOptions;
     std::string ini, env;
@@ -127,7 +203,12 @@ void ConfigLoader::reload()
         currentOptions = _last_options;
     }
 
-    load(ini, env, currentOptions);
+    if (ini.empty())
+    {
+        LOG_WARN("ConfigLoader: reload() called before load(), ignored.");
+        return false;
+    }
+    return load(ini, env, currentOptions);
 }
 
 void ConfigLoader::parseFileToMap(const std::string& filename, std::map<std::string, std::string>& targetMap,
@@ -194,100 +275,76 @@ bool ConfigLoader::validateMap(const std::map<std::string, std::string>& targetM
     });
 }
 
-//类型安全 Getters (带全量互斥保护)
+//类型安全 Getters (无锁：读线程本地缓存的快照)
 std::string ConfigLoader::getString(const std::string& key) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    const auto it = _configMap.find(key);
-    if (it == _configMap.end())
+    const auto* value = current().find(key);
+    if (!value)
         throw ConfigException("Missing required key: " + key);
-    return it->second;
+    return value->text;
 }
 
 std::string ConfigLoader::getString(const std::string& key, const std::string& default_value) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    const auto it = _configMap.find(key);
-    return (it != _configMap.end()) ? it->second : default_value;
+    const auto* value = current().find(key);
+    return value ? value->text : default_value;
 }
 
 int ConfigLoader::getInt(const std::string& key) const
 {
-    const std::string val = getString(key);
-    return std::stoi(val);
+    const auto* value = current().find(key);
+    if (!value)
+        throw ConfigException("Missing required key: " + key);
+    // 解析失败时沿用 std::stoi 的异常
+    return value->as_int ? *value->as_int : std::stoi(value->text);
 }
 
 int ConfigLoader::getInt(const std::string& key, int default_value) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    const auto it = _configMap.find(key);
-    if (it == _configMap.end())
-        return default_value;
-
-    try
-    {
-        return std::stoi(it->second);
-    }
-    catch (...)
-    {
-        return default_value;
-    }
+    const auto* value = current().find(key);
+    return value && value->as_int ? *value->as_int : default_value;
 }
 
 bool ConfigLoader::getBool(const std::string& key) const
 {
-    return parseBool(getString(key));
+    const auto* value = current().find(key);
+    if (!value)
+        throw ConfigException("Missing required key: " + key);
+    return value->as_bool ? *value->as_bool : parseBool(value->text);
 }
 
 bool ConfigLoader::getBool(const std::string& key, bool default_value) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    const auto it = _configMap.find(key);
-    if (it == _configMap.end())
-        return default_value;
-
-    try
-    {
-        return parseBool(it->second);
-    }
-    catch (...)
-    {
-        return default_value;
-    }
+    const auto* value = current().find(key);
+    return value && value->as_bool ? *value->as_bool : default_value;
 }
 
 double ConfigLoader::getDouble(const std::string& key) const
 {
-    return std::stod(getString(key));
+    const auto* value = current().find(key);
+    if (!value)
+        throw ConfigException("Missing required key: " + key);
+    return value->as_double ? *value->as_double : std::stod(value->text);
 }
 
 double ConfigLoader::getDouble(const std::string& key, double default_value) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    const auto it = _configMap.find(key);
-    if (it == _configMap.end())
-        return default_value;
-
-    try
-    {
-        return std::stod(it->second);
-    }
-    catch (...)
-    {
-        return default_value;
-    }
+    const auto* value = current().find(key);
+    return value && value->as_double ? *value->as_double : default_value;
 }
 
 bool ConfigLoader::has(const std::string& key) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _configMap.contains(key);
+    return current().find(key) != nullptr;
 }
 
+// 写时复制：set 只在启动与测试中使用，整表重建的开销可以接受
 void ConfigLoader::set(const std::string& key, const std::string& value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
-    _configMap[key] = value;
+    auto entries = _snapshot.load(std::memory_order_relaxed)->entries();
+    entries[key] = value;
+    publish(entries);
 }
 
 void ConfigLoader::addValidator(const std::string& key, Validator validator, const std::string& err_msg)
@@ -0,0 +1,187 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "ConfigWatcher.h"
+#include "Logger.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+ConfigWatcher::ConfigWatcher(std::chrono::milliseconds debounce)
+    : _debounce(debounce),
+      _eventFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (_eventFd < 0)
+    {
+        LOG_ERROR("ConfigWatcher: eventfd 创建失败: " + std::string(std::strerror(errno)));
+    }
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    stop();
+    if (_inotifyFd >= 0)::close(_inotifyFd);
+    if (_eventFd >= 0)::close(_eventFd);
+}
+
+void ConfigWatcher::watch(const std::string& path, Callback on_change)
+{
+    Entry entry;
+    entry.path = path;
+    if (const auto slash = path.find_last_of('/'); slash == std::string::npos)
+    {
+        entry.dir = ".";
+        entry.name = path;
+    }
+    else
+    {
+        entry.dir = slash == 0 ? "/" : path.substr(0, slash);
+        entry.name = path.substr(slash + 1);
+    }
+    entry.callback = std::move(on_change);
+    _entries.push_back(std::move(entry));
+}
+
+void ConfigWatcher::start()
+{
+    if (_worker.joinable())return;
+
+    _inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotifyFd < 0)
+    {
+        LOG_WARN("ConfigWatcher: inotify 不可用, 仅支持 SIGHUP 触发: " + std::string(std::strerror(errno)));
+    }
+    else
+    {
+        for (auto& entry : _entries)
+        {
+            // 同一目录重复添加返回同一个 wd
+            entry.wd = ::inotify_add_watch(_inotifyFd, entry.dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (entry.wd < 0)
+            {
+                LOG_WARN("ConfigWatcher: 无法监视 " + entry.dir + ": " + std::strerror(errno));
+            }
+        }
+    }
+
+    _worker = std::jthread([this](const std::stop_token& stoken) { run(stoken); });
+    LOG_INFO("ConfigWatcher: 已启动, 监视文件数=" + std::to_string(_entries.size()));
+}
+
+void ConfigWatcher::stop()
+{
+    if (!_worker.joinable())return;
+    _worker.request_stop();
+    requestReload(); // 唤醒 poll
+    _worker.join();
+}
+
+void ConfigWatcher::requestReload() noexcept
+{
+    if (_eventFd < 0)return;
+    const uint64_t one = 1;
+    // eventfd 计数溢出前不会失败；失败也只是少一次唤醒
+    [[maybe_unused]] const auto n = ::write(_eventFd, &one, sizeof(one));
+}
+
+void ConfigWatcher::run(const std::stop_token& stoken)
+{
+    using Clock = std::chrono::steady_clock;
+    auto deadline = Clock::time_point::max(); // 最早一个待触发文件的时间点
+
+    while (!stoken.stop_requested())
+    {
+        pollfd fds[2] = {{_eventFd, POLLIN, 0}, {_inotifyFd, POLLIN, 0}};
+        const nfds_t nfds = _inotifyFd >= 0 ? 2 : 1;
+
+        int timeout = -1;
+        if (deadline != Clock::time_point::max())
+        {
+            const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            timeout = static_cast<int>(std::max<int64_t>(remaining, 0));
+        }
+
+        if (::poll(fds, nfds, timeout) < 0 && errno != EINTR)
+        {
+            LOG_ERROR("ConfigWatcher: poll 失败: " + std::string(std::strerror(errno)));
+            break;
+        }
+        if (stoken.stop_requested())break;
+
+        if (fds[0].revents & POLLIN)
+        {
+            uint64_t count = 0;
+            [[maybe_unused]] const auto n = ::read(_eventFd, &count, sizeof(count));
+            // 显式请求（SIGHUP）不做防抖，立即重载全部文件
+            LOG_INFO("ConfigWatcher: 收到重载请求");
+            for (auto& entry : _entries)
+            {
+                entry.pending = false;
+                fire(entry);
+            }
+            deadline = Clock::time_point::max();
+            continue;
+        }
+
+        if (nfds == 2 && (fds[1].revents & POLLIN))
+        {
+            drainInotify(deadline);
+        }
+
+        if (Clock::now() >= deadline)
+        {
+            deadline = Clock::time_point::max();
+            for (auto& entry : _entries)
+            {
+                if (!entry.pending)continue;
+                entry.pending = false;
+                fire(entry);
+            }
+        }
+    }
+}
+
+void ConfigWatcher::drainInotify(std::chrono::steady_clock::time_point& deadline)
+{
+    alignas(inotify_event) char buf[4096];
+    while (true)
+    {
+        const ssize_t len = ::read(_inotifyFd, buf, sizeof(buf));
+        if (len <= 0)break;
+
+        for (ssize_t offset = 0; offset < len;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(buf + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            if (event->len == 0)continue;
+
+            const std::string_view name(event->name);
+            for (auto& entry : _entries)
+            {
+                if (entry.wd == event->wd && entry.name == name && !entry.pending)
+                {
+                    entry.pending = true;
+                    deadline = std::min(deadline, std::chrono::steady_clock::now() + _debounce);
+                }
+            }
+        }
+    }
+}
+
+void ConfigWatcher::fire(Entry& entry)
+{
+    try
+    {
+        entry.callback();
+        _reloads.fetch_add(1, std::memory_order_relaxed);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("ConfigWatcher: 重载 " + entry.path + " 失败: " + e.what());
+    }
+}
@@ -0,0 +1,25 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "HookTrace.h"
+
+namespace
+{
+    thread_local HookTrace* tls_current_trace = nullptr;
+}
+
+HookTrace* HookTrace::current() noexcept
+{
+    return tls_current_trace;
+}
+
+HookTrace::Scope::Scope(HookTrace* trace) noexcept
+    : _previous(tls_current_trace)
+{
+    tls_current_trace = trace;
+}
+
+HookTrace::Scope::~Scope()
+{
+    tls_current_trace = _previous;
+}
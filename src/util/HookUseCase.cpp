@@ -2,39 +2,66 @@
 // Created by wxx on 2026/1/22.
 //
 #include "HookUseCase.h"
+#include "Logger.h"
 
-void HookUseCase::processPublish(const ZlmHookRequest& req, HookDecisionCallback cb) const
+void HookUseCase::processPublish(const ZlmHookRequestView& req, HookDecisionCallback cb) const
 {
-    _scheduler.onPublish(req.stream_key(), req.client_id, req.get_token(), req.protocol,
+    _scheduler.onPublish(req.stream_key(), std::string(req.client_id), std::string(req.get_token()), req.protocol,
                          [cb=std::move(cb)](const auto& res)
                          {
                              cb(mapResult(res));
-                         });
+                         }, req.trace);
 }
 
-void HookUseCase::processPlay(const ZlmHookRequest& req, HookDecisionCallback cb) const
+void HookUseCase::processPlay(const ZlmHookRequestView& req, HookDecisionCallback cb) const
 {
-    LOG_INFO("Processing play request for stream: " + req.stream);
+    LOG_INFO("Processing play request for stream: " + std::string(req.stream));
 
-    _scheduler.onPlay(req.stream_key(), req.client_id, req.get_token(), req.protocol,
+    _scheduler.onPlay(req.stream_key(), std::string(req.client_id), std::string(req.get_token()), req.protocol,
                       [cb=std::move(cb)](const auto& res)
                       {
                           cb(mapResult(res));
-                      });
+                      }, req.trace);
 }
 
-HookDecision HookUseCase::processPublishDone(const ZlmHookRequest& req) const
+HookDecision HookUseCase::processPublishDone(const ZlmHookRequestView& req) const
 {
-    _scheduler.onPublishDone(req.stream_key(), req.client_id);
+    auto stream_key = req.stream_key();
+    dispatchLifecycle(stream_key, [&scheduler = _scheduler, stream_key, client_id = std::string(req.client_id)]
+    {
+        scheduler.onPublishDone(stream_key, client_id);
+    });
     return HookDecision::allow();
 }
 
-HookDecision HookUseCase::processPlayDone(const ZlmHookRequest& req) const
+HookDecision HookUseCase::processPlayDone(const ZlmHookRequestView& req) const
 {
-    _scheduler.onPlayDone(req.stream_key(), req.client_id);
+    auto stream_key = req.stream_key();
+    dispatchLifecycle(stream_key, [&scheduler = _scheduler, stream_key, client_id = std::string(req.client_id)]
+    {
+        scheduler.onPlayDone(stream_key, client_id);
+    });
     return HookDecision::allow();
 }
 
+void HookUseCase::dispatchLifecycle(const std::string& stream_key, LifecycleExecutor::Task task) const
+{
+    if (!_lifecycle)
+    {
+        // 未注入执行器：所有清理都在调用线程同步执行，顺序天然一致
+        task();
+        return;
+    }
+
+    // 队列满 / 已关闭：不能在 I/O 线程就地执行，否则会越过同一条流仍在 Lane 中排队的事件；
+    // 拒绝数已计入 lifecycle 的 rejected 指标，遗留任务交给超时扫描回收
+    if (!_lifecycle->submit(stream_key, std::move(task)))[[unlikely]]
+    {
+        LOG_WARN("HookUseCase: Lifecycle lane rejected cleanup for stream: " + stream_key +
+            ", left to timeout sweep");
+    }
+}
+
 HookDecision HookUseCase::mapResult(const StreamTaskScheduler::SchedulerResult& res)
 {
     if (res.error == StreamTaskScheduler::SchedulerResult::Error::SUCCESS)return HookDecision::allow();
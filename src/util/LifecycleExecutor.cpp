@@ -0,0 +1,184 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "LifecycleExecutor.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+LifecycleExecutor::LifecycleExecutor(const Config& config)
+    : _maxQueuePerLane(config.max_queue_per_lane)
+{
+    if (config.num_lanes == 0)
+        throw std::invalid_argument("LifecycleExecutor: lanes must > 0");
+
+    _lanes.reserve(config.num_lanes);
+    for (size_t i = 0; i < config.num_lanes; ++i)
+    {
+        _lanes.push_back(std::make_unique<Lane>());
+    }
+
+    _threads.reserve(config.num_lanes);
+    for (auto& lane : _lanes)
+    {
+        _threads.emplace_back([this, l = lane.get()](const std::stop_token& st)
+        {
+            lane_thread(*l, st);
+        });
+    }
+
+    LOG_INFO("[LifecycleExecutor] Initialized with " + std::to_string(config.num_lanes) + " lanes");
+}
+
+LifecycleExecutor::~LifecycleExecutor()
+{
+    stop_and_wait();
+}
+
+bool LifecycleExecutor::submit(std::string_view ordering_key, Task&& task)
+{
+    if (!task)return false;
+
+    // 同一 key 永远落在同一 Lane，从而获得单流内的 FIFO 语义
+    auto& lane = *_lanes[std::hash<std::string_view>{}(ordering_key) % _lanes.size()];
+
+    {
+        std::lock_guard<std::mutex> lock(lane.mutex);
+
+        if (_stop.load(std::memory_order_relaxed))[[unlikely]]
+        {
+            _rejectedTasks.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (_maxQueuePerLane > 0 && lane.queue.size() >= _maxQueuePerLane)[[unlikely]]
+        {
+            _rejectedTasks.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        lane.queue.push_back({std::move(task), std::chrono::steady_clock::now()});
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        _totalSubmitted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    lane.cv.notify_one();
+    return true;
+}
+
+/**
+ * @brief Lane 主循环 (Drain 语义与 ThreadPool 一致：队列排空后才允许退出)
+ */
+void LifecycleExecutor::lane_thread(Lane& lane, const std::stop_token& stoken)
+{
+    while (true)
+    {
+        Item item;
+
+        {
+            std::unique_lock<std::mutex> lock(lane.mutex);
+
+            lane.cv.wait(lock, stoken, [&lane]
+            {
+                return !lane.queue.empty();
+            });
+
+            if (lane.queue.empty())
+            {
+                if (stoken.stop_requested())[[unlikely]]
+                {
+                    return;
+                }
+                continue;
+            }
+
+            item = std::move(lane.queue.front());
+            lane.queue.pop_front();
+        }
+
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+        recordLag(std::chrono::steady_clock::now() - item.enqueued_at);
+
+        try
+        {
+            item.task();
+            _completedTasks.fetch_add(1, std::memory_order_relaxed);
+        }
+        catch (const std::exception& e)
+        {
+            _failedTasks.fetch_add(1, std::memory_order_relaxed);
+            LOG_ERROR("[LifecycleExecutor] Task exception: " + std::string(e.what()));
+        }
+        catch (...)
+        {
+            _failedTasks.fetch_add(1, std::memory_order_relaxed);
+            LOG_ERROR("[LifecycleExecutor] Task unknown exception");
+        }
+    }
+}
+
+void LifecycleExecutor::recordLag(std::chrono::steady_clock::duration lag) noexcept
+{
+    const auto lag_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(lag).count());
+    _lastLagUs.store(lag_us, std::memory_order_relaxed);
+
+    uint64_t prev = _maxLagUs.load(std::memory_order_relaxed);
+    while (lag_us > prev && !_maxLagUs.compare_exchange_weak(prev, lag_us, std::memory_order_relaxed))
+    {
+    }
+}
+
+void LifecycleExecutor::stop_and_wait()
+{
+    if (_stop.exchange(true, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    //在各 Lane 锁内确认关闸，避免与 submit 竞争导致事件入队后无人消费
+    for (auto& lane : _lanes)
+    {
+        std::lock_guard<std::mutex> lock(lane->mutex);
+    }
+
+    for (auto& t : _threads)
+    {
+        t.request_stop();
+    }
+
+    // jthread 析构时 join，Lane 线程会先排空自己的队列
+    _threads.clear();
+
+    LOG_INFO("[LifecycleExecutor] Stopped. completed=" + std::to_string(_completedTasks.load()) +
+        " failed=" + std::to_string(_failedTasks.load()) +
+        " rejected=" + std::to_string(_rejectedTasks.load()));
+}
+
+LifecycleExecutor::Stats LifecycleExecutor::get_stats() const
+{
+    Stats s{};
+    s.num_lanes = _lanes.size();
+    s.queue_depth = _pending.load(std::memory_order_relaxed);
+    s.total_submitted = _totalSubmitted.load(std::memory_order_relaxed);
+    s.completed_tasks = _completedTasks.load(std::memory_order_relaxed);
+    s.failed_tasks = _failedTasks.load(std::memory_order_relaxed);
+    s.rejected_tasks = _rejectedTasks.load(std::memory_order_relaxed);
+    s.last_lag_us = _lastLagUs.load(std::memory_order_relaxed);
+    s.max_lag_us = _maxLagUs.load(std::memory_order_relaxed);
+
+    //队头即该 Lane 最老的事件：只看队头，锁持有时间为 O(1)
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto& lane : _lanes)
+    {
+        std::lock_guard<std::mutex> lock(lane->mutex);
+        if (lane->queue.empty())continue;
+
+        const auto age = std::chrono::duration_cast<std::chrono::microseconds>(
+            now - lane->queue.front().enqueued_at).count();
+        s.oldest_pending_us = std::max(s.oldest_pending_us, static_cast<uint64_t>(age));
+    }
+
+    return s;
+}
@@ -2,12 +2,26 @@
 // Created by X on 2025/12/2.
 //
 #include "Logger.h"
+#include "AsyncLogBackend.h"
 
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 
+Logger::Logger()
+{
+    _min_level.store(LogLevel::INFO);
+
+    std::lock_guard<std::mutex> lock1(_config_mutex);
+    std::lock_guard<std::mutex> lock2(_file_mutex);
+
+    _config = Config{};
+    _file_stream = nullptr;
+}
+
+Logger::~Logger() = default;
+
 const char* Logger::level_to_string(LogLevel level)
 {
     switch (level)
@@ -61,6 +75,23 @@ std::string Logger::get_timestamp(bool include_ms)
 
 void Logger::log(LogLevel level, const std::string& message, const char* file, int line) const
 {
+    // 宏已做过一次判断；这里兜住直接调用 log() 的路径，避免低级别日志占用异步缓冲区
+    if (level < _min_level.load(std::memory_order_relaxed))return;
+
+    if (auto* backend = _async_view.load(std::memory_order_acquire))
+    {
+        if (backend->enqueue(level, message, file, line))[[likely]]
+        {
+            // FATAL 之后进程通常马上退出，等它真正落盘
+            if (level == LogLevel::FATAL)[[unlikely]]
+            {
+                backend->flush();
+            }
+            return;
+        }
+        // 后端已停止：退回同步输出
+    }
+
     write_log(level, message, file, line);
 }
 
@@ -140,6 +171,61 @@ void Logger::set_config(const Config& config)
     {
         _file_stream.reset();
     }
+
+    retire_async_backend();
+
+    if (_config.async)
+    {
+        AsyncLogBackend::Config backend_cfg;
+        backend_cfg.ring_capacity = _config.async_ring_capacity;
+        backend_cfg.overflow_policy = _config.overflow_policy;
+        backend_cfg.to_console = _config.log_to_console;
+        backend_cfg.file_path = _config.log_to_file ? _config.log_file_path : std::string{};
+        backend_cfg.include_milliseconds = _config.include_milliseconds;
+
+        _async_backend = std::make_unique<AsyncLogBackend>(backend_cfg);
+        _async_view.store(_async_backend.get(), std::memory_order_release);
+    }
+}
+
+/**
+ * @brief 下线当前异步后端（调用方持有 _config_mutex）
+ * * 先撤下指针让新日志走同步路径，再停止后端写出剩余记录；对象本身保留，防止其他线程刚读到的指针悬空。
+ */
+void Logger::retire_async_backend()
+{
+    if (!_async_backend)
+    {
+        return;
+    }
+
+    _async_view.store(nullptr, std::memory_order_release);
+    _async_backend->stop();
+    _retired_backends.push_back(std::move(_async_backend));
+}
+
+void Logger::flush() const
+{
+    if (auto* backend = _async_view.load(std::memory_order_acquire))
+    {
+        backend->flush();
+    }
+}
+
+void Logger::stop_async()
+{
+    std::lock_guard<std::mutex> lock(_config_mutex);
+    retire_async_backend();
+    _config.async = false;
+}
+
+LogAsyncStats Logger::get_async_stats() const
+{
+    if (auto* backend = _async_view.load(std::memory_order_acquire))
+    {
+        return backend->getStats();
+    }
+    return LogAsyncStats{};
 }
 
 void Logger::set_min_level(LogLevel level)
@@ -142,6 +142,45 @@ NodeConfig::Category NodeConfig::stringToCategory(const std::string& category)
     return (it != mapping.end()) ? it->second : Category::UNKNOWN;
 }
 
+std::string_view NodeConfig::categoryName(Category category) noexcept
+{
+    switch (category)
+    {
+    case Category::RTMP_SRT: return "rtmp_srt";
+    case Category::HTTP_HLS: return "http_hls";
+    case Category::WEBRTC: return "webrtc";
+    default: return "unknown";
+    }
+}
+
+uint64_t NodeConfig::fingerprint() const noexcept
+{
+    // FNV-1a；分隔符避免 "a"+"bc" 与 "ab"+"c" 撞车
+    uint64_t h = 14695981039346656037ULL;
+    auto feed = [&h](std::string_view data)
+    {
+        for (const char c : data)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ULL;
+        }
+        h ^= 0xff;
+        h *= 1099511628211ULL;
+    };
+
+    for (const auto* list : {&rtmp_srt, &http_hls, &webrtc})
+    {
+        feed("|");
+        for (const auto& ep : *list)
+        {
+            feed(ep.host);
+            feed(std::to_string(ep.port));
+            feed(std::to_string(ep.weight));
+        }
+    }
+    return h;
+}
+
 /**
  * @brief 线程安全的随机调度
  */
@@ -219,6 +258,11 @@ NodeConfig NodeConfig::fromJsonFile(const std::string& filepath, const Validatio
                 throw std::runtime_error("NodeConfig Validation: Port out of range in " + context);
             }
 
+            if (ep.weight <= 0)
+            {
+                throw std::runtime_error("NodeConfig Validation: Weight must be positive in " + context);
+            }
+
             // 检查常见的配置失误：比如 RTMP 默认不该是 80 端口
             if (name == "rtmp_srt" && ep.port == 80)
             {
@@ -0,0 +1,468 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "NodeHealthProber.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+std::string_view nodeHealthStateName(NodeHealthState state) noexcept
+{
+    switch (state)
+    {
+    case NodeHealthState::Healthy: return "healthy";
+    case NodeHealthState::Ejected: return "ejected";
+    case NodeHealthState::HalfOpen: return "half_open";
+    }
+    return "unknown";
+}
+
+namespace
+{
+    // 非阻塞 connect；返回 -1 表示立即失败（error 已填写）
+    int startConnect(const std::string& host, int port, bool& connected, std::string& error)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        addrinfo* res = nullptr;
+        const std::string service = std::to_string(port);
+        if (const int rc = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &res); rc != 0 || !res)
+        {
+            error = std::string("resolve: ") + ::gai_strerror(rc);
+            return -1;
+        }
+
+        const int fd = ::socket(res->ai_family, res->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, res->ai_protocol);
+        if (fd < 0)
+        {
+            error = std::string("socket: ") + std::strerror(errno);
+            ::freeaddrinfo(res);
+            return -1;
+        }
+
+        const int rc = ::connect(fd, res->ai_addr, res->ai_addrlen);
+        ::freeaddrinfo(res);
+
+        if (rc == 0)
+        {
+            connected = true;
+            return fd;
+        }
+        if (errno == EINPROGRESS)
+        {
+            connected = false;
+            return fd;
+        }
+
+        error = std::string("connect: ") + std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+
+    // 解析 "HTTP/1.1 200 OK"；返回状态码，格式不对返回 0
+    int parseStatusCode(std::string_view line)
+    {
+        const auto space = line.find(' ');
+        if (!line.starts_with("HTTP/") || space == std::string_view::npos || line.size() < space + 4)return 0;
+
+        int code = 0;
+        for (size_t i = space + 1; i < space + 4; ++i)
+        {
+            if (line[i] < '0' || line[i] > '9')return 0;
+            code = code * 10 + (line[i] - '0');
+        }
+        return code;
+    }
+}
+
+NodeHealthProber::NodeHealthProber(const NodeConfig& nodes, Config cfg)
+    : _config(std::move(cfg))
+{
+    assignNodes(nodes);
+    publish();
+}
+
+void NodeHealthProber::updateNodes(const NodeConfig& nodes)
+{
+    std::lock_guard<std::mutex> lock(_probeMutex);
+    assignNodes(nodes);
+    publish();
+    LOG_INFO("NodeHealthProber: 节点列表已更新, 节点数=" + std::to_string(_nodes.size()));
+}
+
+void NodeHealthProber::assignNodes(const NodeConfig& nodes)
+{
+    std::vector<NodeState> previous = std::move(_nodes);
+    _nodes.clear();
+
+    auto add = [&](NodeConfig::Category category, const std::vector<NodeEndpoint>& endpoints)
+    {
+        for (const auto& ep : endpoints)
+        {
+            const auto it = std::ranges::find_if(previous, [&](const NodeState& old)
+            {
+                return old.status.category == category && old.status.endpoint.host == ep.host &&
+                    old.status.endpoint.port == ep.port;
+            });
+
+            NodeState state;
+            if (it != previous.end())state = *it;
+            state.status.category = category;
+            state.status.endpoint = ep; // weight 可能变化
+            _nodes.push_back(std::move(state));
+        }
+    };
+
+    // 顺序与 NodeHealthSnapshot::eligible 的构建顺序一致
+    add(NodeConfig::Category::RTMP_SRT, nodes.rtmp_srt);
+    add(NodeConfig::Category::HTTP_HLS, nodes.http_hls);
+    add(NodeConfig::Category::WEBRTC, nodes.webrtc);
+    _topology = nodes.fingerprint();
+}
+
+NodeHealthProber::~NodeHealthProber()
+{
+    stop();
+}
+
+void NodeHealthProber::start()
+{
+    if (_worker.joinable())return;
+    _worker = std::jthread([this](const std::stop_token& stoken) { run(stoken); });
+    LOG_INFO("NodeHealthProber: 已启动, 节点数=" + std::to_string(_nodes.size()) +
+        (_config.http_path.empty() ? " (TCP)" : " (HTTP " + _config.http_path + ")"));
+}
+
+void NodeHealthProber::stop()
+{
+    if (!_worker.joinable())return;
+    _worker.request_stop();
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _wakeCondition.notify_all();
+    }
+    _worker.join();
+}
+
+void NodeHealthProber::run(const std::stop_token& stoken)
+{
+    while (!stoken.stop_requested())
+    {
+        try
+        {
+            probeOnce();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("NodeHealthProber: 探测异常: " + std::string(e.what()));
+        }
+
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wakeCondition.wait_for(lock, stoken, _config.interval, [] { return false; });
+    }
+}
+
+void NodeHealthProber::probeOnce()
+{
+    std::lock_guard<std::mutex> lock(_probeMutex);
+    const auto now = Clock::now();
+
+    // 剔除期满的节点进入试探；仍在剔除期内的节点本轮不探测
+    std::vector<size_t> targets;
+    for (size_t i = 0; i < _nodes.size(); ++i)
+    {
+        auto& node = _nodes[i];
+        if (node.status.state == NodeHealthState::Ejected)
+        {
+            if (now < node.ejected_until)continue;
+            node.status.state = NodeHealthState::HalfOpen;
+            node.status.consecutive_successes = 0;
+        }
+        targets.push_back(i);
+    }
+
+    const auto results = probeAll(targets);
+    const auto done = Clock::now();
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        applyResult(_nodes[targets[i]], results[i], done);
+    }
+
+    ejectOutliers(done);
+    ++_round;
+    publish();
+}
+
+std::vector<NodeHealthProber::ProbeResult> NodeHealthProber::probeAll(const std::vector<size_t>& targets) const
+{
+    enum class Phase { Connecting, Sending, Reading, Done };
+
+    struct Pending
+    {
+        int fd = -1;
+        Phase phase = Phase::Connecting;
+        std::string request;
+        size_t sent = 0;
+        std::string response;
+    };
+
+    const bool use_http = !_config.http_path.empty();
+    const auto start = Clock::now();
+    const auto deadline = start + _config.timeout;
+
+    std::vector<ProbeResult> results(targets.size());
+    std::vector<Pending> pending(targets.size());
+
+    auto finish = [&](size_t i, bool ok, std::string error)
+    {
+        auto& p = pending[i];
+        if (p.fd >= 0)
+        {
+            ::close(p.fd);
+            p.fd = -1;
+        }
+        p.phase = Phase::Done;
+        results[i].ok = ok;
+        results[i].error = std::move(error);
+        results[i].latency_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    auto onConnected = [&](size_t i)
+    {
+        if (!use_http)
+        {
+            finish(i, true, {});
+            return;
+        }
+        const auto& ep = _nodes[targets[i]].status.endpoint;
+        pending[i].request = "GET " + _config.http_path + " HTTP/1.1\r\nHost: " + ep.host +
+            "\r\nUser-Agent: StreamGate-Prober\r\nConnection: close\r\n\r\n";
+        pending[i].phase = Phase::Sending;
+    };
+
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        const auto& ep = _nodes[targets[i]].status.endpoint;
+        const int port = use_http && _config.http_port > 0 ? _config.http_port : ep.port;
+
+        bool connected = false;
+        std::string error;
+        pending[i].fd = startConnect(ep.host, port, connected, error);
+        if (pending[i].fd < 0)
+        {
+            finish(i, false, std::move(error));
+        }
+        else if (connected)
+        {
+            onConnected(i);
+        }
+    }
+
+    std::vector<pollfd> fds;
+    std::vector<size_t> owners;
+    while (true)
+    {
+        fds.clear();
+        owners.clear();
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            const auto& p = pending[i];
+            if (p.phase == Phase::Done)continue;
+            fds.push_back({p.fd, static_cast<short>(p.phase == Phase::Reading ? POLLIN : POLLOUT), 0});
+            owners.push_back(i);
+        }
+        if (fds.empty())break;
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (remaining <= 0)break;
+
+        const int n = ::poll(fds.data(), fds.size(), static_cast<int>(remaining));
+        if (n < 0 && errno != EINTR)break;
+
+        for (size_t k = 0; k < fds.size(); ++k)
+        {
+            if (fds[k].revents == 0)continue;
+            const size_t i = owners[k];
+            auto& p = pending[i];
+
+            if (p.phase == Phase::Connecting)
+            {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                ::getsockopt(p.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                if (err != 0)
+                {
+                    finish(i, false, std::string("connect: ") + std::strerror(err));
+                }
+                else
+                {
+                    onConnected(i);
+                }
+            }
+            else if (p.phase == Phase::Sending)
+            {
+                const ssize_t w = ::send(p.fd, p.request.data() + p.sent, p.request.size() - p.sent, MSG_NOSIGNAL);
+                if (w < 0 && errno != EAGAIN && errno != EINTR)
+                {
+                    finish(i, false, std::string("send: ") + std::strerror(errno));
+                }
+                else if (w > 0 && (p.sent += static_cast<size_t>(w)) == p.request.size())
+                {
+                    p.phase = Phase::Reading;
+                }
+            }
+            else if (p.phase == Phase::Reading)
+            {
+                char buf[512];
+                const ssize_t r = ::recv(p.fd, buf, sizeof(buf), 0);
+                if (r > 0)
+                {
+                    p.response.append(buf, static_cast<size_t>(r));
+                }
+                else if (r == 0 || (errno != EAGAIN && errno != EINTR))
+                {
+                    finish(i, false, "http: connection closed before status line");
+                    continue;
+                }
+
+                if (const auto eol = p.response.find("\r\n"); eol != std::string::npos)
+                {
+                    const int code = parseStatusCode(std::string_view(p.response).substr(0, eol));
+                    if (code >= 200 && code < 400)
+                    {
+                        finish(i, true, {});
+                    }
+                    else
+                    {
+                        finish(i, false, "http: status " + std::to_string(code));
+                    }
+                }
+                else if (p.response.size() > 4096)
+                {
+                    finish(i, false, "http: malformed response");
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < pending.size(); ++i)
+    {
+        if (pending[i].phase != Phase::Done)
+        {
+            finish(i, false, "timeout");
+        }
+    }
+    return results;
+}
+
+void NodeHealthProber::applyResult(NodeState& node, const ProbeResult& result, Clock::time_point now)
+{
+    auto& s = node.status;
+    ++s.probes;
+
+    if (result.ok)
+    {
+        s.consecutive_failures = 0;
+        ++s.consecutive_successes;
+        s.ewma_ms = s.ewma_ms == 0
+                        ? result.latency_ms
+                        : _config.ewma_alpha * result.latency_ms + (1 - _config.ewma_alpha) * s.ewma_ms;
+
+        if (s.state == NodeHealthState::HalfOpen && s.consecutive_successes >= _config.readmit_successes)
+        {
+            s.state = NodeHealthState::Healthy;
+            node.backoff_level = 0;
+            LOG_INFO("NodeHealthProber: 节点恢复 " + s.endpoint.toString());
+        }
+        return;
+    }
+
+    ++s.failures;
+    ++s.consecutive_failures;
+    s.consecutive_successes = 0;
+    s.last_error = result.error;
+
+    if (s.state == NodeHealthState::HalfOpen)
+    {
+        // 试探失败：剔除时长翻倍
+        ++node.backoff_level;
+        eject(node, now, "half-open probe failed: " + result.error);
+    }
+    else if (s.state == NodeHealthState::Healthy && s.consecutive_failures >= _config.failure_threshold)
+    {
+        eject(node, now, result.error);
+    }
+}
+
+void NodeHealthProber::ejectOutliers(Clock::time_point now)
+{
+    std::vector<double> latencies;
+    size_t ejected = 0;
+    for (const auto& node : _nodes)
+    {
+        if (node.status.state == NodeHealthState::Healthy && node.status.ewma_ms > 0)
+        {
+            latencies.push_back(node.status.ewma_ms);
+        }
+        if (node.status.state != NodeHealthState::Healthy)++ejected;
+    }
+
+    // 至少 3 个样本时中位数才有意义
+    if (latencies.size() < 3)return;
+    std::ranges::nth_element(latencies, latencies.begin() + static_cast<std::ptrdiff_t>(latencies.size() / 2));
+    const double median = latencies[latencies.size() / 2];
+    const double threshold = std::max(median * _config.outlier_factor,
+                                      static_cast<double>(_config.outlier_min_latency.count()));
+
+    const size_t max_ejected = _nodes.size() * _config.max_ejection_percent / 100;
+    for (auto& node : _nodes)
+    {
+        if (ejected >= max_ejected)break;
+        if (node.status.state != NodeHealthState::Healthy || node.status.ewma_ms <= threshold)continue;
+
+        eject(node, now, "latency outlier: ewma " + std::to_string(node.status.ewma_ms) + "ms, median " +
+              std::to_string(median) + "ms");
+        ++ejected;
+    }
+}
+
+void NodeHealthProber::eject(NodeState& node, Clock::time_point now, const std::string& reason)
+{
+    const auto factor = uint64_t{1} << std::min<uint32_t>(node.backoff_level, 16);
+    const auto duration = std::min<std::chrono::milliseconds>(_config.base_ejection * factor, _config.max_ejection);
+
+    node.status.state = NodeHealthState::Ejected;
+    node.status.consecutive_successes = 0;
+    node.ejected_until = now + duration;
+    ++node.status.ejections;
+
+    LOG_WARN("NodeHealthProber: 剔除节点 " + node.status.endpoint.toString() + " " +
+        std::to_string(duration.count()) + "ms, 原因: " + reason);
+}
+
+void NodeHealthProber::publish()
+{
+    auto snap = std::make_shared<NodeHealthSnapshot>();
+    snap->round = _round;
+    snap->topology = _topology;
+    snap->nodes.reserve(_nodes.size());
+    for (const auto& node : _nodes)
+    {
+        snap->nodes.push_back(node.status);
+        const auto category = static_cast<size_t>(node.status.category);
+        if (category < NodeHealthSnapshot::kCategoryCount)
+        {
+            snap->eligible[category].push_back(node.status.state == NodeHealthState::Healthy ? 1 : 0);
+        }
+    }
+    _snapshot.store(std::move(snap), std::memory_order_release);
+}
@@ -3,7 +3,120 @@
 //
 #include "StreamTaskSerializer.h"
 #include "EnumToString.h"
+#include <arpa/inet.h>
+#include <array>
+#include <charconv>
 #include <chrono>
+#include <cstring>
+
+namespace
+{
+    // 时间戳合理性范围（2020-01-01 至 2038-01-01 UTC）
+    constexpr int64_t MIN_REASONABLE_MS = 1577836800000LL;
+    constexpr int64_t MAX_REASONABLE_MS = 2145916800000LL;
+
+    // 枚举的线上编号：只允许在末尾追加，不依赖枚举声明顺序
+    constexpr std::array kWireTypes{StreamType::PUBLISHER, StreamType::PLAYER};
+    constexpr std::array kWireStates{
+        StreamState::INITIALIZING, StreamState::ACTIVE, StreamState::INACTIVE, StreamState::ERROR, StreamState::CLOSED
+    };
+    constexpr std::array kWireProtocols{
+        StreamProtocol::Unknown, StreamProtocol::RTMP, StreamProtocol::HTTP_FLV, StreamProtocol::HLS,
+        StreamProtocol::RTSP, StreamProtocol::WebRTC, StreamProtocol::SRT, StreamProtocol::HTTP_TS,
+        StreamProtocol::HTTP_FMP4
+    };
+
+    // 头部第 2 字节：bit0 类型，bit1-3 状态，bit4-7 标志
+    constexpr uint8_t kFlagTranscode = 1u << 4;
+    constexpr uint8_t kFlagRecord = 1u << 5;
+    constexpr uint8_t kFlagRegion = 1u << 6;
+    constexpr uint8_t kFlagIpv4 = 1u << 7; // server_ip 以 4 字节网络序存储
+
+    template <typename E, size_t N>
+    uint8_t toWire(const std::array<E, N>& table, E value)
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (table[i] == value)return static_cast<uint8_t>(i);
+        }
+        return 0;
+    }
+
+    int64_t toMs(std::chrono::system_clock::time_point tp)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+    }
+
+    void putVarint(std::string& out, uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            out.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    void putString(std::string& out, std::string_view s)
+    {
+        putVarint(out, s.size());
+        out.append(s);
+    }
+
+    class CompactReader
+    {
+    public:
+        explicit CompactReader(std::string_view data) : _data(data)
+        {
+        }
+
+        bool u8(uint8_t& v)
+        {
+            if (_pos >= _data.size())return false;
+            v = static_cast<uint8_t>(_data[_pos++]);
+            return true;
+        }
+
+        bool varint(uint64_t& v)
+        {
+            v = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                uint8_t b = 0;
+                if (!u8(b))return false;
+                v |= static_cast<uint64_t>(b & 0x7f) << shift;
+                if ((b & 0x80) == 0)return true;
+            }
+            return false;
+        }
+
+        bool bytes(size_t n, std::string_view& out)
+        {
+            if (n > _data.size() - _pos)return false;
+            out = _data.substr(_pos, n);
+            _pos += n;
+            return true;
+        }
+
+        bool str(std::string& s)
+        {
+            uint64_t len = 0;
+            std::string_view raw;
+            if (!varint(len) || !bytes(static_cast<size_t>(len), raw))return false;
+            s.assign(raw);
+            return true;
+        }
+
+        [[nodiscard]] bool done() const
+        {
+            return _pos == _data.size();
+        }
+
+    private:
+        std::string_view _data;
+        size_t _pos = 0;
+    };
+}
 
 std::map<std::string, std::string> StreamTaskSerializer::serialize(const StreamTask& task)
 {
@@ -103,3 +216,167 @@ std::string StreamTaskSerializer::get_field(const std::map<std::string, std::str
     }
     return default_val;
 }
+
+std::string StreamTaskSerializer::encodeCompact(const StreamTask& task)
+{
+    uint8_t head = toWire(kWireTypes, task.type) | static_cast<uint8_t>(toWire(kWireStates, task.state) << 1);
+    if (task.need_transcode)head |= kFlagTranscode;
+    if (task.need_record)head |= kFlagRecord;
+    if (task.region)head |= kFlagRegion;
+
+    in_addr ipv4{};
+    if (::inet_pton(AF_INET, task.server_ip.c_str(), &ipv4) == 1)head |= kFlagIpv4;
+
+    std::string out;
+    out.reserve(24 + task.user_id.size() + task.auth_token.size() + task.transcoding_profile.size() +
+        (task.region ? task.region->size() : 0) + ((head & kFlagIpv4) ? 0 : task.server_ip.size()));
+
+    out.push_back(static_cast<char>(COMPACT_VERSION));
+    out.push_back(static_cast<char>(head));
+    out.push_back(static_cast<char>(toWire(kWireProtocols, task.protocol)));
+
+    if (head & kFlagIpv4)
+    {
+        out.append(reinterpret_cast<const char*>(&ipv4.s_addr), 4);
+    }
+    else
+    {
+        putString(out, task.server_ip);
+    }
+    putVarint(out, static_cast<uint64_t>(std::max(task.server_port, 0)));
+    putVarint(out, static_cast<uint64_t>(std::max<int64_t>(toMs(task.start_time), 0)));
+    putVarint(out, task.task_id);
+
+    putString(out, task.user_id);
+    putString(out, task.auth_token);
+    if (task.region)putString(out, *task.region);
+    putString(out, task.transcoding_profile);
+    return out;
+}
+
+bool StreamTaskSerializer::decodeCompact(std::string_view data, StreamTask& task)
+{
+    CompactReader in(data);
+    uint8_t version = 0, head = 0, protocol = 0;
+    if (!in.u8(version) || version != COMPACT_VERSION || !in.u8(head) || !in.u8(protocol))return false;
+
+    const size_t type = head & 0x01u;
+    const size_t state = (head >> 1) & 0x07u;
+    if (state >= kWireStates.size() || protocol >= kWireProtocols.size())return false;
+    task.type = kWireTypes[type];
+    task.state = kWireStates[state];
+    task.protocol = kWireProtocols[protocol];
+    task.need_transcode = (head & kFlagTranscode) != 0;
+    task.need_record = (head & kFlagRecord) != 0;
+
+    if (head & kFlagIpv4)
+    {
+        std::string_view raw;
+        if (!in.bytes(4, raw))return false;
+        in_addr ipv4{};
+        std::memcpy(&ipv4.s_addr, raw.data(), 4);
+        char buf[INET_ADDRSTRLEN];
+        if (!::inet_ntop(AF_INET, &ipv4, buf, sizeof(buf)))return false;
+        task.server_ip.assign(buf);
+    }
+    else if (!in.str(task.server_ip))
+    {
+        return false;
+    }
+
+    uint64_t port = 0, start_ms = 0, task_id = 0;
+    if (!in.varint(port) || !in.varint(start_ms) || !in.varint(task_id))return false;
+    task.server_port = static_cast<int>(port);
+    task.start_time = std::chrono::system_clock::time_point(std::chrono::milliseconds{start_ms});
+    task.task_id = task_id;
+
+    if (!in.str(task.user_id) || !in.str(task.auth_token))return false;
+    if (head & kFlagRegion)
+    {
+        std::string region;
+        if (!in.str(region))return false;
+        task.region = std::move(region);
+    }
+    else
+    {
+        task.region.reset();
+    }
+    return in.str(task.transcoding_profile) && in.done();
+}
+
+std::optional<StreamTask> StreamTaskSerializer::decodeLegacyHash(
+    const std::unordered_map<std::string, std::string>& fields)
+{
+    for (constexpr std::array required{"stream_name", "client_id", "type", "start_time_ms", "last_active_time_ms"};
+         const auto& key : required)
+    {
+        if (!fields.contains(key))
+        {
+            return std::nullopt;
+        }
+    }
+
+    StreamTask task;
+    task.stream_name = fields.at("stream_name");
+    task.client_id = fields.at("client_id");
+
+    const auto& type_str = fields.at("type");
+    if (type_str != "publisher" && type_str != "player")
+    {
+        return std::nullopt;
+    }
+    task.type = parseType(type_str);
+
+    const auto it_state = fields.find("state");
+    task.state = it_state != fields.end() ? parseState(it_state->second) : StreamState::INITIALIZING;
+
+    const auto it_protocol = fields.find("protocol");
+    task.protocol = it_protocol != fields.end() ? parseProtocol(it_protocol->second) : StreamProtocol::Unknown;
+
+    if (auto it = fields.find("server_ip"); it != fields.end())
+    {
+        task.server_ip = it->second;
+    }
+    if (auto it = fields.find("server_port"); it != fields.end())
+    {
+        // 解析失败保持 0
+        (void)std::from_chars(it->second.data(), it->second.data() + it->second.size(), task.server_port);
+    }
+
+    int64_t start_ms = 0;
+    int64_t last_ms = 0;
+    const auto& start_str = fields.at("start_time_ms");
+    const auto& last_str = fields.at("last_active_time_ms");
+    if (std::from_chars(start_str.data(), start_str.data() + start_str.size(), start_ms).ec != std::errc{} ||
+        std::from_chars(last_str.data(), last_str.data() + last_str.size(), last_ms).ec != std::errc{} ||
+        start_ms < MIN_REASONABLE_MS || start_ms > MAX_REASONABLE_MS ||
+        last_ms < MIN_REASONABLE_MS || last_ms > MAX_REASONABLE_MS)
+    {
+        return std::nullopt;
+    }
+    task.start_time = std::chrono::system_clock::time_point(std::chrono::milliseconds{start_ms});
+    task.last_active_time = std::chrono::system_clock::time_point(std::chrono::milliseconds{last_ms});
+
+    if (auto it = fields.find("user_id"); it != fields.end())
+    {
+        task.user_id = it->second;
+    }
+    if (auto it = fields.find("auth_token"); it != fields.end())
+    {
+        task.auth_token = it->second;
+    }
+    if (auto it = fields.find("region"); it != fields.end() && !it->second.empty())
+    {
+        task.region = it->second;
+    }
+
+    task.need_transcode = (fields.contains("need_transcode") && fields.at("need_transcode") == "1");
+    task.need_record = (fields.contains("need_record") && fields.at("need_record") == "1");
+
+    if (auto it = fields.find("transcoding_profile"); it != fields.end())
+    {
+        task.transcoding_profile = it->second;
+    }
+
+    return task;
+}
@@ -7,25 +7,87 @@
 #include <stdexcept>
 #include "Logger.h"
 
+namespace
+{
+    // 本地 deque 容量：写满后池内提交回退到注入队列
+    constexpr size_t kLocalQueueCapacity = 1024;
+    // max_queue_size = 0 时注入队列的容量
+    constexpr size_t kDefaultInjectionCapacity = 65536;
+    // park 之前的自旋搜索轮数
+    constexpr int kSearchRounds = 4;
+
+    struct WorkerContext
+    {
+        const ThreadPool* pool = nullptr;
+        size_t index = 0;
+        uint32_t rng = 0;
+    };
+
+    thread_local WorkerContext tls_worker;
+
+    uint32_t nextRandom()
+    {
+        // xorshift32：只用于挑选窃取起点，够用即可
+        uint32_t x = tls_worker.rng;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        tls_worker.rng = x;
+        return x;
+    }
+}
+
 ThreadPool::ThreadPool(size_t threads)
-    : ThreadPool(Config{threads, 1000, true})
+    : ThreadPool(Config{.num_threads = threads})
 {
 }
 
 ThreadPool::ThreadPool(const Config& config)
     : _numThreads(config.num_threads),
       _maxQueueSize(config.max_queue_size),
-      _logExceptions(config.log_exceptions)
+      _logExceptions(config.log_exceptions),
+      _mode(config.mode),
+      _onThreadStart(config.on_thread_start),
+      _onThreadExit(config.on_thread_exit)
 {
     if (_numThreads == 0)
         throw std::invalid_argument("Threads must > 0");
 
-    LOG_INFO("[ThreadPool] Initialized with " + std::to_string(_numThreads) + " workers");
+    const bool stealing = (_mode == Mode::WorkStealing);
+    LOG_INFO("[ThreadPool] Initialized with " + std::to_string(_numThreads) + " workers | Mode: " +
+        (stealing ? "work_stealing" : "shared_queue"));
+
+    // 队列必须先于 worker 就绪
+    if (stealing)
+    {
+        _injection = std::make_unique<MpmcBoundedQueue<Task>>(
+            _maxQueueSize > 0 ? _maxQueueSize : kDefaultInjectionCapacity);
+        _localQueues.reserve(_numThreads);
+        for (size_t i = 0; i < _numThreads; ++i)
+        {
+            _localQueues.push_back(std::make_unique<WorkerQueue>(kLocalQueueCapacity));
+        }
+    }
 
     _workers.reserve(_numThreads);
     for (size_t i = 0; i < _numThreads; ++i)
     {
-        _workers.emplace_back(&ThreadPool::worker_thread, this);
+        // jthread 只会把 stop_token 作为第一个参数传给可调用对象，成员函数需经 lambda 转发
+        _workers.emplace_back([this, i, stealing](std::stop_token stoken)
+        {
+            if (_onThreadStart)_onThreadStart();
+
+            if (stealing)
+            {
+                work_stealing_thread(std::move(stoken), i);
+            }
+            else
+            {
+                worker_thread(std::move(stoken));
+            }
+
+            if (_onThreadExit)_onThreadExit();
+        });
     }
 }
 
@@ -34,6 +96,108 @@ ThreadPool::~ThreadPool()
     stop_and_wait();
 }
 
+ThreadPool::EnqueueStatus ThreadPool::enqueue(Task&& task, uint32_t allocations)
+{
+    uint64_t total_allocations = allocations + (task.is_inline() ? 0 : 1);
+
+    const EnqueueStatus status = (_mode == Mode::WorkStealing)
+                                     ? enqueueStealing(task, total_allocations)
+                                     : enqueueShared(task);
+
+    if (status != EnqueueStatus::Ok)[[unlikely]]
+    {
+        _rejectedTasks.fetch_add(1, std::memory_order_relaxed);
+        return status;
+    }
+
+    _totalSubmitted.fetch_add(1, std::memory_order_relaxed);
+    // 零分配路径不碰这个计数器，避免多生产者争抢同一缓存行
+    if (total_allocations > 0)
+    {
+        _taskAllocations.fetch_add(total_allocations, std::memory_order_relaxed);
+    }
+    return status;
+}
+
+void ThreadPool::throwIfRejected(EnqueueStatus status) const
+{
+    switch (status)
+    {
+    case EnqueueStatus::Ok:
+        return;
+    case EnqueueStatus::Stopped:
+        throw std::runtime_error("ThreadPool is stopping or closed");
+    case EnqueueStatus::Full:
+        throw std::runtime_error("ThreadPool queue is full (" + std::to_string(_maxQueueSize) + ")");
+    }
+}
+
+ThreadPool::EnqueueStatus ThreadPool::enqueueShared(Task& task)
+{
+    {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+
+        //严格的状态判定：关闭后拒绝所有新任务
+        if (_stop.load(std::memory_order_relaxed))[[unlikely]]
+        {
+            return EnqueueStatus::Stopped;
+        }
+
+        //队列容量保护
+        if (_maxQueueSize > 0 && _tasks.size() >= _maxQueueSize)
+        {
+            return EnqueueStatus::Full;
+        }
+
+        _tasks.emplace(std::move(task));
+
+        if (_tasks.size() > _maxQueueSize / 2)[[unlikely]]
+        {
+            checkQueueSize(_tasks.size());
+        }
+    }
+
+    _condition.notify_one();
+    return EnqueueStatus::Ok;
+}
+
+ThreadPool::EnqueueStatus ThreadPool::enqueueStealing(Task& task, uint64_t& allocations)
+{
+    if (_stop.load(std::memory_order_acquire))[[unlikely]]
+    {
+        return EnqueueStatus::Stopped;
+    }
+
+    //池内线程提交：压入自己的 deque，由本线程趁热执行或被空闲 worker 窃取
+    // deque 只能存指针，这里需要一个节点分配；写满时回退到注入队列
+    if (tls_worker.pool == this)
+    {
+        auto node = std::make_unique<Task>(std::move(task));
+        if (_localQueues[tls_worker.index]->deque.push(node.get()))
+        {
+            (void)node.release();
+            ++allocations;
+            notifyWorker();
+            return EnqueueStatus::Ok;
+        }
+        task = std::move(*node);
+    }
+
+    const size_t depth = _injection->size_approx();
+    if ((_maxQueueSize > 0 && depth >= _maxQueueSize) || !_injection->try_push(std::move(task)))
+    {
+        return EnqueueStatus::Full;
+    }
+
+    if (depth > _maxQueueSize / 2)[[unlikely]]
+    {
+        checkQueueSize(depth);
+    }
+
+    notifyWorker();
+    return EnqueueStatus::Ok;
+}
+
 /**
  * @brief 工作线程主循环 (Drain 模式实现)
  * @param stoken C++20 自动提供的停止令牌
@@ -44,7 +208,7 @@ void ThreadPool::worker_thread(std::stop_token stoken)// NOLINT(performance-unne
     // stoken 仅用于唤醒 wait 和作为「准许退出」的信号，严禁用于中断尚未处理的任务。
     while (true)
     {
-        std::function<void()> task;
+        Task task;
 
         {
             std::unique_lock<std::mutex> lock(_queueMutex);
@@ -74,30 +238,254 @@ void ThreadPool::worker_thread(std::stop_token stoken)// NOLINT(performance-unne
             task = std::move(_tasks.front());
             _tasks.pop();
         }
-        //执行任务 (双重异常防御)
-        try
+        runTask(task);
+    }
+}
+
+/**
+ * @brief Work-Stealing 工作线程主循环
+ * * 取任务顺序：本地 deque (LIFO) -> 注入队列 -> 随机起点轮询窃取。
+ * * 与 worker_thread 相同的 Drain 语义：只有 stop 已请求且全局看不到任何任务时才退出。
+ */
+void ThreadPool::work_stealing_thread(std::stop_token stoken, size_t index)// NOLINT(performance-unnecessary-value-param)
+{
+    tls_worker = WorkerContext{this, index, static_cast<uint32_t>(index * 2654435761u) | 1u};
+
+    Task task;
+    while (true)
+    {
+        if (findTask(index, task) || searchTask(index, task))
         {
-            if (task)[[likely]]
-            {
-                task();
-                _completedTasks.fetch_add(1, std::memory_order_relaxed);
-            }
+            runTask(task);
+            task.reset();
+            continue;
         }
-        catch (const std::exception& e)
+
+        if (!parkWorker(stoken))
         {
-            _failedTasks.fetch_add(1, std::memory_order_relaxed);
-            if (_logExceptions)[[unlikely]]
-            {
-                LOG_ERROR("[ThreadPool] Task exception: " + std::string(e.what()));
-            }
+            break;
         }
-        catch (...)
+    }
+
+    tls_worker = WorkerContext{};
+}
+
+bool ThreadPool::findTask(size_t index, Task& out)
+{
+    Task* node = nullptr;
+    if (_localQueues[index]->deque.pop(node))
+    {
+        out = std::move(*node);
+        delete node;
+        return true;
+    }
+
+    if (_injection->try_pop(out))
+    {
+        return true;
+    }
+
+    return stealTask(index, out);
+}
+
+bool ThreadPool::stealTask(size_t index, Task& out)
+{
+    const size_t n = _localQueues.size();
+    if (n < 2)
+    {
+        return false;
+    }
+
+    const size_t start = nextRandom() % n;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t victim = (start + i) % n;
+        if (victim == index)
         {
-            _failedTasks.fetch_add(1, std::memory_order_relaxed);
-            if (_logExceptions)[[unlikely]]
-            {
-                LOG_ERROR("[ThreadPool] Task unknown exception");
-            }
+            continue;
+        }
+
+        Task* node = nullptr;
+        if (_localQueues[victim]->deque.steal(node))
+        {
+            out = std::move(*node);
+            delete node;
+            _stolenTasks.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief park 前的短暂自旋搜索
+ * * 搜索期间 _searchingWorkers > 0，提交方据此跳过唤醒，避免每次提交都去抢 _parkMutex。
+ */
+bool ThreadPool::searchTask(size_t index, Task& out)
+{
+    _searchingWorkers.fetch_add(1, std::memory_order_seq_cst);
+
+    bool found = false;
+    for (int round = 0; round < kSearchRounds && !found; ++round)
+    {
+        std::this_thread::yield();
+        found = findTask(index, out);
+    }
+
+    // 最后一个搜索者拿到任务后接力唤醒一个同伴，否则搜索期间被跳过的唤醒会丢失
+    if (_searchingWorkers.fetch_sub(1, std::memory_order_seq_cst) == 1 && found)
+    {
+        notifyWorker();
+    }
+    return found;
+}
+
+/**
+ * @brief 挂起当前 worker，直到有新任务或收到停止信号
+ * @return false 表示 stop 已请求且已无任务可做（Drain 完成），worker 应退出
+ */
+bool ThreadPool::parkWorker(const std::stop_token& stoken)
+{
+    std::unique_lock<std::mutex> lock(_parkMutex);
+
+    // 与 notifyWorker 的「入队 -> fence -> 读 idle」构成 Dekker 式握手：
+    // 要么提交方看到本 worker 已 idle 并唤醒它，要么这里的复查能看到新任务
+    _idleWorkers.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (hasVisibleWork())
+    {
+        _idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (stoken.stop_requested())[[unlikely]]
+    {
+        _idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    _parkCondition.wait(lock, stoken, [this]
+    {
+        return _pendingWakes > 0;
+    });
+
+    if (_pendingWakes > 0)
+    {
+        // 唤醒方已替我们扣减了 _idleWorkers
+        --_pendingWakes;
+    }
+    else
+    {
+        _idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool ThreadPool::hasVisibleWork() const
+{
+    if (_injection->size_approx() > 0)
+    {
+        return true;
+    }
+
+    for (const auto& queue : _localQueues)
+    {
+        if (queue->deque.size_approx() > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::notifyWorker()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // 已有 worker 在搜索时由它接力，无需唤醒
+    if (_idleWorkers.load(std::memory_order_relaxed) == 0 ||
+        _searchingWorkers.load(std::memory_order_relaxed) > 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_parkMutex);
+        if (_idleWorkers.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+        // 在锁内认领一个 idle worker：后续提交看到的 idle 数随之减少，不会重复唤醒同一批线程
+        _idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+        ++_pendingWakes;
+    }
+    _parkCondition.notify_one();
+}
+
+size_t ThreadPool::queuedStealing() const
+{
+    size_t queued = _injection->size_approx();
+    for (const auto& queue : _localQueues)
+    {
+        queued += queue->deque.size_approx();
+    }
+    return queued;
+}
+
+/**
+ * @brief 回收 worker 全部退出后仍残留的任务节点
+ * * 只有 stop 与 submit 并发时才可能出现（提交方已通过 _stop 检查但尚未入队），
+ * * 对应 packaged_task 析构后调用方会拿到 broken_promise。
+ */
+size_t ThreadPool::discardLeftovers()
+{
+    size_t dropped = 0;
+
+    Task task;
+    while (_injection->try_pop(task))
+    {
+        task.reset();
+        ++dropped;
+    }
+
+    Task* node = nullptr;
+    for (const auto& queue : _localQueues)
+    {
+        while (queue->deque.pop(node))
+        {
+            delete node;
+            ++dropped;
+        }
+    }
+    return dropped;
+}
+
+void ThreadPool::runTask(Task& task)
+{
+    //执行任务 (双重异常防御)
+    try
+    {
+        if (task)[[likely]]
+        {
+            task();
+            _completedTasks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        _failedTasks.fetch_add(1, std::memory_order_relaxed);
+        if (_logExceptions)[[unlikely]]
+        {
+            LOG_ERROR("[ThreadPool] Task exception: " + std::string(e.what()));
+        }
+    }
+    catch (...)
+    {
+        _failedTasks.fetch_add(1, std::memory_order_relaxed);
+        if (_logExceptions)[[unlikely]]
+        {
+            LOG_ERROR("[ThreadPool] Task unknown exception");
         }
     }
 }
@@ -122,6 +510,12 @@ void ThreadPool::stop_and_wait(std::chrono::milliseconds timeout)
 
     _condition.notify_all();
 
+    if (_mode == Mode::WorkStealing)
+    {
+        // request_stop 已唤醒 park 中的 worker，这里再补一次 notify 以防万一
+        _parkCondition.notify_all();
+    }
+
     //锁定任务锚点：确定停机瞬间的总任务数
     const size_t target = _totalSubmitted.load(std::memory_order_acquire);
 
@@ -162,6 +556,14 @@ void ThreadPool::stop_and_wait(std::chrono::milliseconds timeout)
     // 析构函数会阻塞 join，直到 worker_thread 真正 return
     _workers.clear();
 
+    if (_mode == Mode::WorkStealing)
+    {
+        if (const size_t dropped = discardLeftovers(); dropped > 0)[[unlikely]]
+        {
+            LOG_WARN(std::format("[ThreadPool] 停机时丢弃 {} 个与 stop 并发提交的任务", dropped));
+        }
+    }
+
     std::string statsMsg = std::format(
         "[ThreadPool] 优雅停机成功. 最终战报: 成功={} 失败={} 拒绝={}",
         _completedTasks.load(std::memory_order_relaxed),
@@ -174,15 +576,26 @@ void ThreadPool::stop_and_wait(std::chrono::milliseconds timeout)
 
 ThreadPool::Stats ThreadPool::get_stats() const
 {
-    std::lock_guard<std::mutex> lock(_queueMutex);
+    size_t queued = 0;
+    if (_mode == Mode::WorkStealing)
+    {
+        queued = queuedStealing();
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        queued = _tasks.size();
+    }
 
     return Stats{
         _numThreads,
-        _tasks.size(),
+        queued,
         _totalSubmitted.load(),
         _completedTasks.load(),
         _failedTasks.load(),
-        _rejectedTasks.load()
+        _rejectedTasks.load(),
+        _stolenTasks.load(),
+        _taskAllocations.load()
     };
 }
 
@@ -192,6 +605,8 @@ void ThreadPool::reset_stats()
     _completedTasks = 0;
     _failedTasks = 0;
     _rejectedTasks = 0;
+    _stolenTasks = 0;
+    _taskAllocations = 0;
 }
 
 void ThreadPool::checkQueueSize(size_t size)
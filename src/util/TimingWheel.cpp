@@ -0,0 +1,208 @@
+//
+// Created by wxx on 2026/10/16.
+//
+#include "TimingWheel.h"
+
+#include <algorithm>
+#include <bit>
+
+TimingWheel::TimingWheel(const Config& config, Clock::time_point start)
+    : _tick(std::max(config.tick, std::chrono::milliseconds(1))),
+      _start(start),
+      _bits(static_cast<uint32_t>(std::countr_zero(std::bit_ceil(std::max<size_t>(config.slots_per_level, 2))))),
+      _levels(static_cast<uint32_t>(std::max<size_t>(config.levels, 1))),
+      _mask((uint64_t{1} << _bits) - 1)
+{
+    _slots.assign(static_cast<size_t>(_levels) << _bits, kNil);
+}
+
+uint64_t TimingWheel::toTick(Clock::time_point tp, bool round_up) const
+{
+    if (tp <= _start)return 0;
+
+    const auto elapsed = tp - _start;
+    const auto tick = std::chrono::duration_cast<Clock::duration>(_tick);
+    auto ticks = static_cast<uint64_t>(elapsed / tick);
+    if (round_up && elapsed % tick != Clock::duration::zero())
+    {
+        ++ticks;
+    }
+    return ticks;
+}
+
+bool TimingWheel::schedule(const std::string& key, Clock::time_point deadline)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    // 截止时间已过的 key 在下一个 tick 到期
+    const uint64_t tick = std::max(toTick(deadline, true), _current + 1);
+
+    if (const auto it = _index.find(key); it != _index.end())
+    {
+        Node& node = _nodes[it->second];
+        if (tick >= node.deadline)
+        {
+            // 推迟：节点留在原槽，到时按新截止时间重新放置
+            node.deadline = tick;
+        }
+        else
+        {
+            unlink(it->second);
+            node.deadline = tick;
+            place(it->second);
+        }
+        return false;
+    }
+
+    const uint32_t index = allocate();
+    _nodes[index].key = key;
+    _nodes[index].deadline = tick;
+    place(index);
+    _index.emplace(key, index);
+    return true;
+}
+
+bool TimingWheel::cancel(std::string_view key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _index.find(key);
+    if (it == _index.end())return false;
+
+    const uint32_t index = it->second;
+    _index.erase(it);
+    unlink(index);
+    release(index);
+    return true;
+}
+
+std::vector<std::string> TimingWheel::advance(Clock::time_point now)
+{
+    std::vector<std::string> expired;
+    const uint64_t target = toTick(now, false);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_index.empty())
+    {
+        _current = std::max(_current, target);
+        return expired;
+    }
+
+    while (_current < target)
+    {
+        const uint64_t t = ++_current;
+
+        // 先级联高层：高层落下的节点可能正好落入本 tick 要级联的低层槽
+        for (uint32_t level = _levels - 1; level >= 1; --level)
+        {
+            if ((t & ((uint64_t{1} << (_bits * level)) - 1)) != 0)continue;
+
+            const auto slot = static_cast<uint32_t>((level << _bits) | ((t >> (_bits * level)) & _mask));
+            for (uint32_t i = detachSlot(slot); i != kNil;)
+            {
+                const uint32_t next = _nodes[i].next;
+                place(i);
+                i = next;
+            }
+        }
+
+        for (uint32_t i = detachSlot(static_cast<uint32_t>(t & _mask)); i != kNil;)
+        {
+            const uint32_t next = _nodes[i].next;
+            if (_nodes[i].deadline > t)
+            {
+                place(i);
+            }
+            else
+            {
+                _index.erase(_nodes[i].key);
+                expired.push_back(std::move(_nodes[i].key));
+                release(i);
+            }
+            i = next;
+        }
+    }
+    return expired;
+}
+
+size_t TimingWheel::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _index.size();
+}
+
+/**
+ * @brief 按截止 tick 与当前 tick 的最高不同位选层
+ * * 该层上截止 tick 的槽号一定大于当前 tick 的槽号，因此在截止前恰好被级联一次，不会绕圈。
+ */
+void TimingWheel::place(uint32_t index)
+{
+    const uint64_t deadline = _nodes[index].deadline;
+    uint32_t level = 0;
+    if (const uint64_t diff = deadline ^ _current; deadline > _current && diff > _mask)
+    {
+        level = std::min(static_cast<uint32_t>((std::bit_width(diff) - 1) / _bits), _levels - 1);
+    }
+    link(index, static_cast<uint32_t>((level << _bits) | ((deadline >> (_bits * level)) & _mask)));
+}
+
+void TimingWheel::link(uint32_t index, uint32_t slot)
+{
+    Node& node = _nodes[index];
+    node.slot = slot;
+    node.prev = kNil;
+    node.next = _slots[slot];
+    if (node.next != kNil)
+    {
+        _nodes[node.next].prev = index;
+    }
+    _slots[slot] = index;
+}
+
+void TimingWheel::unlink(uint32_t index)
+{
+    Node& node = _nodes[index];
+    if (node.prev != kNil)
+    {
+        _nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        _slots[node.slot] = node.next;
+    }
+    if (node.next != kNil)
+    {
+        _nodes[node.next].prev = node.prev;
+    }
+    node.slot = kNil;
+    node.prev = kNil;
+    node.next = kNil;
+}
+
+uint32_t TimingWheel::detachSlot(uint32_t slot)
+{
+    const uint32_t head = _slots[slot];
+    _slots[slot] = kNil;
+    return head;
+}
+
+uint32_t TimingWheel::allocate()
+{
+    if (_freeHead != kNil)
+    {
+        const uint32_t index = _freeHead;
+        _freeHead = _nodes[index].next;
+        _nodes[index].next = kNil;
+        return index;
+    }
+    _nodes.emplace_back();
+    return static_cast<uint32_t>(_nodes.size() - 1);
+}
+
+void TimingWheel::release(uint32_t index)
+{
+    Node& node = _nodes[index];
+    node.key.clear();
+    node.slot = kNil;
+    node.prev = kNil;
+    node.next = _freeHead;
+    _freeHead = index;
+}
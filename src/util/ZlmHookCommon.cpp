@@ -3,6 +3,20 @@
 //
 #include "ZlmHookCommon.h"
 
+std::string_view hookActionLabel(HookAction action) noexcept
+{
+    switch (action)
+    {
+    case HookAction::Publish: return "publish";
+    case HookAction::PublishDone: return "publish_done";
+    case HookAction::Play: return "play";
+    case HookAction::PlayDone: return "play_done";
+    case HookAction::StreamNoneReader: return "stream_none_reader";
+    case HookAction::StreamNotFound: return "stream_not_found";
+    default: return "unknown";
+    }
+}
+
 HookAction ZlmHookRequest::parse_action(std::string_view action_str)
 {
     static const std::unordered_map<std::string_view, HookAction> m = {
@@ -110,6 +124,307 @@ void ZlmHookRequest::parse_url_params(const std::string& query, std::map<std::st
     }
 }
 
+ZlmHookRequestView ZlmHookRequest::view() const
+{
+    ZlmHookRequestView v;
+    v.action = action;
+    v.protocol = protocol;
+    v.app = app;
+    v.stream = stream;
+    v.vhost = vhost;
+    v.client_id = client_id;
+    v.ip = ip;
+
+    v.params.reserve(params.size());
+    for (const auto& [key,value] : params)
+    {
+        v.params.push_back({key, value});
+    }
+    return v;
+}
+
+// ==========================================
+// ZlmHookRequestView: 零拷贝快速解析
+// ==========================================
+
+namespace
+{
+    /**
+     * @brief 极简 JSON 扫描器：只识别 Hook 请求体需要的结构，不构建任何中间对象
+     * * 遇到无法零拷贝表达的内容（例如字符串中的转义）时由调用方决定是否回退
+     */
+    class HookBodyScanner
+    {
+    public:
+        explicit HookBodyScanner(std::string_view body)
+            : _p(body.data()),
+              _end(body.data() + body.size())
+        {
+        }
+
+        void skip_ws()
+        {
+            while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r'))++_p;
+        }
+
+        bool consume(char c)
+        {
+            skip_ws();
+            if (_p < _end && *_p == c)
+            {
+                ++_p;
+                return true;
+            }
+            return false;
+        }
+
+        [[nodiscard]] bool at_end()
+        {
+            skip_ws();
+            return _p == _end;
+        }
+
+        [[nodiscard]] char peek()
+        {
+            skip_ws();
+            return _p < _end ? *_p : '\0';
+        }
+
+        /**
+         * @brief 读取字符串，out 指向引号内的原始字节
+         * @param escaped 字符串中出现反斜杠转义时置 true（out 此时不是解码后的值）
+         */
+        bool read_string(std::string_view& out, bool& escaped)
+        {
+            if (!consume('"'))return false;
+
+            const char* begin = _p;
+            escaped = false;
+            while (_p < _end)
+            {
+                const auto c = static_cast<unsigned char>(*_p);
+                if (c == '"')
+                {
+                    out = std::string_view(begin, static_cast<size_t>(_p - begin));
+                    ++_p;
+                    return true;
+                }
+                if (c == '\\')
+                {
+                    escaped = true;
+                    if (++_p == _end)return false;
+                }
+                else if (c < 0x20)[[unlikely]]
+                {
+                    // JSON 不允许未转义的控制字符
+                    return false;
+                }
+                ++_p;
+            }
+            return false;
+        }
+
+        /**
+         * @brief 跳过任意 JSON 值 (嵌套对象 / 数组 / 数字 / 字面量)
+         */
+        bool skip_value(int depth = 0)
+        {
+            if (depth > kMaxDepth)[[unlikely]] return false;
+
+            std::string_view sv;
+            bool escaped;
+            switch (peek())
+            {
+            case '"':
+                return read_string(sv, escaped);
+
+            case '{':
+                ++_p;
+                if (consume('}'))return true;
+                do
+                {
+                    if (!read_string(sv, escaped) || !consume(':') || !skip_value(depth + 1))return false;
+                }
+                while (consume(','));
+                return consume('}');
+
+            case '[':
+                ++_p;
+                if (consume(']'))return true;
+                do
+                {
+                    if (!skip_value(depth + 1))return false;
+                }
+                while (consume(','));
+                return consume(']');
+
+            case 't':
+                return skip_literal("true");
+            case 'f':
+                return skip_literal("false");
+            case 'n':
+                return skip_literal("null");
+
+            default:
+                return skip_number();
+            }
+        }
+
+    private:
+        static constexpr int kMaxDepth = 32;
+
+        bool skip_literal(std::string_view lit)
+        {
+            if (static_cast<size_t>(_end - _p) < lit.size() || std::string_view(_p, lit.size()) != lit)return false;
+            _p += lit.size();
+            return true;
+        }
+
+        //严格按 JSON 数字文法：-? (0 | [1-9][0-9]*) (.[0-9]+)? ([eE][+-]?[0-9]+)?
+        //畸形数字一律返回 false，交由 DOM 路径裁决，保证两条解析路径对非法输入结论一致
+        bool skip_number()
+        {
+            consume_char('-');
+            if (!consume_char('0'))
+            {
+                if (_p >= _end || *_p < '1' || *_p > '9')return false;
+                skip_digits();
+            }
+
+            if (consume_char('.') && !skip_digits())return false;
+
+            if (consume_char('e') || consume_char('E'))
+            {
+                if (!consume_char('+'))consume_char('-');
+                if (!skip_digits())return false;
+            }
+            return true;
+        }
+
+        bool consume_char(char c)
+        {
+            if (_p < _end && *_p == c)
+            {
+                ++_p;
+                return true;
+            }
+            return false;
+        }
+
+        bool skip_digits()
+        {
+            const char* begin = _p;
+            while (_p < _end && *_p >= '0' && *_p <= '9')++_p;
+            return _p != begin;
+        }
+
+        const char* _p;
+        const char* _end;
+    };
+}
+
+std::string ZlmHookRequestView::stream_key() const
+{
+    std::string key;
+    key.reserve(vhost.size() + app.size() + stream.size() + 2);
+    key.append(vhost).append("/").append(app).append("/").append(stream);
+    return key;
+}
+
+std::string_view ZlmHookRequestView::find_param(std::string_view key) const
+{
+    //逆序查找：与 map 的 out[key]=value 覆盖语义保持一致
+    for (auto it = params.rbegin(); it != params.rend(); ++it)
+    {
+        if (it->key == key)return it->value;
+    }
+    return {};
+}
+
+bool ZlmHookRequestView::parse(std::string_view body, ZlmHookRequestView& out)
+{
+    out = ZlmHookRequestView{};
+
+    HookBodyScanner sc(body);
+    if (!sc.consume('{'))return false;
+
+    std::optional<std::string_view> schema;
+    std::optional<std::string_view> protocol;
+    std::string_view params_str;
+
+    if (!sc.consume('}'))
+    {
+        do
+        {
+            std::string_view key;
+            bool escaped;
+            if (!sc.read_string(key, escaped) || escaped || !sc.consume(':'))return false;
+
+            // 只关心少数字符串字段，其余 (mediaServerId / originSock / port ...) 直接跳过
+            std::string_view* target = nullptr;
+            std::optional<std::string_view>* opt_target = nullptr;
+
+            if (key == "app")target = &out.app;
+            else if (key == "stream")target = &out.stream;
+            else if (key == "vhost")target = &out.vhost;
+            else if (key == "id")target = &out.client_id;
+            else if (key == "ip")target = &out.ip;
+            else if (key == "params")target = &params_str;
+            else if (key == "schema")opt_target = &schema;
+            else if (key == "protocol")opt_target = &protocol;
+
+            if (key == "action")
+            {
+                std::string_view value;
+                if (sc.peek() != '"' || !sc.read_string(value, escaped) || escaped)return false;
+                out.action = ZlmHookRequest::parse_action(value);
+            }
+            else if (target || opt_target)
+            {
+                // 字段类型不符或含转义：交给完整路径裁决
+                std::string_view value;
+                if (sc.peek() != '"' || !sc.read_string(value, escaped) || escaped)return false;
+
+                if (target)*target = value;
+                else *opt_target = value;
+            }
+            else if (!sc.skip_value())
+            {
+                return false;
+            }
+        }
+        while (sc.consume(','));
+
+        if (!sc.consume('}'))return false;
+    }
+
+    if (!sc.at_end())return false;
+
+    //Schema 判定：优先取 schema，次选 protocol，默认 rtmp (与 from_json 一致)
+    out.protocol = ZlmHookRequest::parse_protocol(schema.value_or(protocol.value_or("rtmp")));
+
+    // JSON 编码的 params 必然含有转义引号，已在上面回退；这里只剩 URL 形式 (token=xx&sg=1)
+    parse_url_params(params_str, out.params);
+    return true;
+}
+
+void ZlmHookRequestView::parse_url_params(std::string_view query, ParamList& out)
+{
+    size_t pos = 0;
+    while (pos < query.size())
+    {
+        size_t eq = query.find('=', pos);
+        if (eq == std::string_view::npos)break;
+
+        size_t amp = query.find('&', eq);
+        if (amp == std::string_view::npos)amp = query.size();
+
+        out.push_back({query.substr(pos, eq - pos), query.substr(eq + 1, amp - eq - 1)});
+
+        pos = amp + 1;
+    }
+}
+
 ZlmHookResponse HookDecision::to_response() const
 {
     //成功分支